@@ -41,9 +41,11 @@ run_command(cmd % ("group__rtree__functions", "rtree_functions"))
 run_command(cmd % ("structboost_1_1geometry_1_1index_1_1linear", "rtree_linear"))
 run_command(cmd % ("structboost_1_1geometry_1_1index_1_1quadratic", "rtree_quadratic"))
 run_command(cmd % ("structboost_1_1geometry_1_1index_1_1rstar", "rtree_rstar"))
+run_command(cmd % ("structboost_1_1geometry_1_1index_1_1kmeans", "rtree_kmeans"))
 run_command(cmd % ("classboost_1_1geometry_1_1index_1_1dynamic__linear", "rtree_dynamic_linear"))
 run_command(cmd % ("classboost_1_1geometry_1_1index_1_1dynamic__quadratic", "rtree_dynamic_quadratic"))
 run_command(cmd % ("classboost_1_1geometry_1_1index_1_1dynamic__rstar", "rtree_dynamic_rstar"))
+run_command(cmd % ("classboost_1_1geometry_1_1index_1_1dynamic__kmeans", "rtree_dynamic_kmeans"))
 
 run_command(cmd % ("structboost_1_1geometry_1_1index_1_1indexable", "indexable"))
 run_command(cmd % ("structboost_1_1geometry_1_1index_1_1equal__to", "equal_to"))
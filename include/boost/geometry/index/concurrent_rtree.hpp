@@ -0,0 +1,489 @@
+// Boost.Geometry Index
+//
+// R-tree allowing concurrent queries and modifications
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_CONCURRENT_RTREE_HPP
+#define BOOST_GEOMETRY_INDEX_CONCURRENT_RTREE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <boost/geometry/index/rtree.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree {
+
+// The number of readers of one of the versions of the data.
+// The counter is split into several cache lines indexed by the id of a thread
+// so readers running on different cores don't write to the same memory.
+class read_indicator
+{
+public:
+    static const std::size_t stripes_count = 16;
+
+    read_indicator()
+    {
+        for ( std::size_t i = 0 ; i < stripes_count ; ++i )
+            m_stripes[i].count.store(0, std::memory_order_relaxed);
+    }
+
+    static std::size_t current_stripe()
+    {
+        return std::hash<std::thread::id>()(std::this_thread::get_id()) % stripes_count;
+    }
+
+    void arrive(std::size_t stripe)
+    {
+        m_stripes[stripe].count.fetch_add(1);
+    }
+
+    void depart(std::size_t stripe)
+    {
+        m_stripes[stripe].count.fetch_sub(1);
+    }
+
+    bool is_empty() const
+    {
+        for ( std::size_t i = 0 ; i < stripes_count ; ++i )
+        {
+            if ( m_stripes[i].count.load() != 0 )
+                return false;
+        }
+        return true;
+    }
+
+private:
+    read_indicator(read_indicator const&);
+    read_indicator & operator=(read_indicator const&);
+
+    struct alignas(64) stripe
+    {
+        std::atomic<std::size_t> count;
+    };
+
+    stripe m_stripes[stripes_count];
+};
+
+}} // namespace detail::rtree
+
+/*!
+\brief The R-tree allowing concurrent queries and modifications.
+
+Two instances of the rtree are kept. Readers access one of them through a snapshot
+which is an immutable view of the data valid as long as the snapshot exists. Readers
+never wait, neither for the other readers nor for the writers. Writers are serialized.
+A modification is applied to the instance not accessed by the readers, then the new
+version is published atomically, then the writer waits until the readers of the old
+version release their snapshots and applies the modification to the old instance.
+This is the Left-Right technique described in P. Ramalhete, A. Correia,
+"Left-Right: A Concurrency Control Technique with Wait-Free Population Oblivious Reads".
+
+Therefore the read throughput scales with the number of cores under a steady stream
+of modifications at the cost of twice the memory and twice the work of writers.
+Snapshots should be released quickly because writers wait for them.
+
+\tparam Value           The type of objects stored in the container.
+\tparam Parameters      Compile-time parameters.
+\tparam IndexableGetter The function object extracting Indexable from Value.
+\tparam EqualTo         The function object comparing objects of type Value.
+\tparam Allocator       The allocator used to allocate/deallocate memory,
+                        construct/destroy nodes and Values.
+*/
+template
+<
+    typename Value,
+    typename Parameters,
+    typename IndexableGetter = index::indexable<Value>,
+    typename EqualTo = index::equal_to<Value>,
+    typename Allocator = boost::container::new_allocator<Value>
+>
+class concurrent_rtree
+{
+public:
+    /*! \brief The type of the rtree accessed through snapshots. */
+    typedef index::rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> rtree_type;
+
+    /*! \brief The type of Value stored in the container. */
+    typedef typename rtree_type::value_type value_type;
+    /*! \brief R-tree parameters type. */
+    typedef typename rtree_type::parameters_type parameters_type;
+    /*! \brief The function object extracting Indexable from Value. */
+    typedef typename rtree_type::indexable_getter indexable_getter;
+    /*! \brief The function object comparing objects of type Value. */
+    typedef typename rtree_type::value_equal value_equal;
+    /*! \brief The type of allocator. */
+    typedef typename rtree_type::allocator_type allocator_type;
+    /*! \brief Unsigned integral type used by the container. */
+    typedef typename rtree_type::size_type size_type;
+
+    /*!
+    \brief The immutable view of the data.
+
+    The rtree accessed through the snapshot is not modified as long as the snapshot exists.
+    */
+    class snapshot
+    {
+        friend class concurrent_rtree;
+
+    public:
+        snapshot(snapshot && other)
+            : m_owner(other.m_owner)
+            , m_version(other.m_version)
+            , m_stripe(other.m_stripe)
+            , m_tree(other.m_tree)
+        {
+            other.m_owner = nullptr;
+        }
+
+        ~snapshot()
+        {
+            if ( m_owner )
+                m_owner->m_readers[m_version].depart(m_stripe);
+        }
+
+        /*! \brief Returns the rtree. */
+        rtree_type const& operator*() const { return m_owner->m_trees[m_tree]; }
+        /*! \brief Returns the pointer to the rtree. */
+        rtree_type const* operator->() const { return &m_owner->m_trees[m_tree]; }
+
+    private:
+        explicit snapshot(concurrent_rtree const& owner)
+            : m_owner(&owner)
+            , m_version(owner.m_version.load())
+            , m_stripe(detail::rtree::read_indicator::current_stripe())
+        {
+            m_owner->m_readers[m_version].arrive(m_stripe);
+            m_tree = m_owner->m_current.load();
+        }
+
+        snapshot(snapshot const&);
+        snapshot & operator=(snapshot const&);
+
+        concurrent_rtree const* m_owner;
+        std::size_t m_version;
+        std::size_t m_stripe;
+        std::size_t m_tree;
+    };
+
+    /*!
+    \brief The constructor.
+
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+    \param allocator    The allocator object.
+
+    \par Throws
+    If allocator copy constructor throws.
+    */
+    explicit concurrent_rtree(parameters_type const& parameters = parameters_type(),
+                              indexable_getter const& getter = indexable_getter(),
+                              value_equal const& equal = value_equal(),
+                              allocator_type const& allocator = allocator_type())
+        : m_trees{ rtree_type(parameters, getter, equal, allocator),
+                   rtree_type(parameters, getter, equal, allocator) }
+        , m_current(0)
+        , m_version(0)
+    {}
+
+    /*!
+    \brief The constructor.
+
+    The tree is created using packing algorithm.
+
+    \param rng          The range of Values.
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+    \param allocator    The allocator object.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+    */
+    template <typename Range>
+    explicit concurrent_rtree(Range const& rng,
+                              parameters_type const& parameters = parameters_type(),
+                              indexable_getter const& getter = indexable_getter(),
+                              value_equal const& equal = value_equal(),
+                              allocator_type const& allocator = allocator_type())
+        : m_trees{ rtree_type(rng, parameters, getter, equal, allocator),
+                   rtree_type(parameters, getter, equal, allocator) }
+        , m_current(0)
+        , m_version(0)
+    {
+        m_trees[1] = m_trees[0];                                                    // MAY THROW
+    }
+
+    /*!
+    \brief Returns the snapshot of the current version of the data.
+
+    \par Example
+    \verbatim
+    {
+        auto s = tree.read();
+        s->query(bgi::intersects(box), std::back_inserter(result));
+        std::size_t count = s->size(); // the same version of the data
+    }
+    \endverbatim
+
+    \par Throws
+    Nothing.
+    */
+    snapshot read() const
+    {
+        return snapshot(*this);
+    }
+
+    /*!
+    \brief Finds values meeting passed predicates in the current version of the data.
+
+    It calls \c rtree::query() using a temporary snapshot.
+    */
+    template <typename Predicates, typename OutIter>
+    size_type query(Predicates const& predicates, OutIter out_it) const
+    {
+        snapshot s(*this);
+        return s->query(predicates, out_it);
+    }
+
+    /*!
+    \brief Returns the number of stored values in the current version of the data.
+    */
+    size_type size() const
+    {
+        snapshot s(*this);
+        return s->size();
+    }
+
+    /*!
+    \brief Query if there are no values in the current version of the data.
+    */
+    bool empty() const
+    {
+        snapshot s(*this);
+        return s->empty();
+    }
+
+    /*!
+    \brief Insert a value.
+
+    \par Throws
+    If Value copy constructor or copy assignment throws.
+    If allocation throws or returns invalid value.
+
+    \par Exception-safety
+    If an exception is thrown the new version of the data is not published
+    or both instances are restored to the version which was published.
+    */
+    void insert(value_type const& value)
+    {
+        modify([&](rtree_type & t) { t.insert(value); });
+    }
+
+    /*!
+    \brief Insert a range of values.
+
+    The range is traversed once for each of the instances. Values passed by
+    single pass iterators are copied into a temporary container first.
+
+    \par Exception-safety
+    See insert(value_type const&).
+    */
+    template <typename Iterator>
+    void insert(Iterator first, Iterator last)
+    {
+        apply_range(first, last, [&](rtree_type & t, auto f, auto l) { t.insert(f, l); });
+    }
+
+    /*!
+    \brief Insert a value created using convertible object or a range of values.
+
+    \par Exception-safety
+    See insert(value_type const&).
+    */
+    template <typename ConvertibleOrRange>
+    void insert(ConvertibleOrRange const& conv_or_rng)
+    {
+        modify([&](rtree_type & t) { t.insert(conv_or_rng); });
+    }
+
+    /*!
+    \brief Remove a value.
+
+    \return 1 if the value was removed, 0 otherwise.
+
+    \par Exception-safety
+    See insert(value_type const&).
+    */
+    size_type remove(value_type const& value)
+    {
+        // both instances contain the same values so the results are equal
+        size_type result = 0;
+        modify([&](rtree_type & t) { result = t.remove(value); });
+        return result;
+    }
+
+    /*!
+    \brief Remove a range of values.
+
+    The range is traversed once for each of the instances. Values passed by
+    single pass iterators are copied into a temporary container first.
+
+    \return The number of removed values.
+
+    \par Exception-safety
+    See insert(value_type const&).
+    */
+    template <typename Iterator>
+    size_type remove(Iterator first, Iterator last)
+    {
+        // both instances contain the same values so the results are equal
+        size_type result = 0;
+        apply_range(first, last, [&](rtree_type & t, auto f, auto l) { result = t.remove(f, l); });
+        return result;
+    }
+
+    /*!
+    \brief Remove value corresponding to an object convertible to it or a range of values.
+
+    \return The number of removed values.
+
+    \par Exception-safety
+    See insert(value_type const&).
+    */
+    template <typename ConvertibleOrRange>
+    size_type remove(ConvertibleOrRange const& conv_or_rng)
+    {
+        // both instances contain the same values so the results are equal
+        size_type result = 0;
+        modify([&](rtree_type & t) { result = t.remove(conv_or_rng); });
+        return result;
+    }
+
+    /*!
+    \brief Removes all values stored in the container.
+
+    \par Throws
+    Nothing.
+    */
+    void clear()
+    {
+        modify([](rtree_type & t) { t.clear(); });
+    }
+
+    /*!
+    \brief Applies a modification to the data.
+
+    The function object is called with a reference to each of the instances of the rtree,
+    first to the one not accessed by the readers, then to the other one. It must modify
+    both of them in the same way.
+
+    \par Example
+    \verbatim
+    tree.modify([&](auto & t) { t.insert(v1); t.remove(v2); });
+    \endverbatim
+
+    \par Exception-safety
+    See insert(value_type const&).
+    */
+    template <typename Function>
+    void modify(Function const& f)
+    {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+
+        std::size_t const current = m_current.load();
+        std::size_t const next = 1 - current;
+
+        BOOST_TRY
+        {
+            f(m_trees[next]);                                                       // MAY THROW
+        }
+        BOOST_CATCH(...)
+        {
+            // the instance not accessed by the readers may be left in an inconsistent state
+            m_trees[next] = m_trees[current];                                       // MAY THROW
+            BOOST_RETHROW
+        }
+        BOOST_CATCH_END
+
+        m_current.store(next);
+        wait_for_readers();
+
+        BOOST_TRY
+        {
+            f(m_trees[current]);                                                    // MAY THROW
+        }
+        BOOST_CATCH(...)
+        {
+            m_trees[current] = m_trees[next];                                       // MAY THROW
+            BOOST_RETHROW
+        }
+        BOOST_CATCH_END
+    }
+
+private:
+    // The modification is applied to both instances so the range must be traversed twice.
+    template <typename Iterator, typename Function>
+    void apply_range(Iterator first, Iterator last, Function const& f)
+    {
+        typedef typename std::iterator_traits<Iterator>::iterator_category category;
+        apply_range(first, last, f, std::is_convertible<category, std::forward_iterator_tag>());
+    }
+
+    template <typename Iterator, typename Function>
+    void apply_range(Iterator first, Iterator last, Function const& f, std::true_type /*is_multi_pass*/)
+    {
+        modify([&](rtree_type & t) { f(t, first, last); });
+    }
+
+    template <typename Iterator, typename Function>
+    void apply_range(Iterator first, Iterator last, Function const& f, std::false_type /*is_multi_pass*/)
+    {
+        std::vector<value_type> const values(first, last);                         // MAY THROW
+        modify([&](rtree_type & t) { f(t, values.begin(), values.end()); });
+    }
+
+    // Waits until there are no readers of the previous instance.
+    // Readers which started before the switch of the instance are counted in the
+    // current version. New readers are directed to the other version so when it
+    // is empty, the previous version is waited for as well.
+    void wait_for_readers()
+    {
+        std::size_t const previous = m_version.load();
+        std::size_t const next = 1 - previous;
+
+        while ( ! m_readers[next].is_empty() )
+            std::this_thread::yield();
+
+        m_version.store(next);
+
+        while ( ! m_readers[previous].is_empty() )
+            std::this_thread::yield();
+    }
+
+    concurrent_rtree(concurrent_rtree const&);
+    concurrent_rtree & operator=(concurrent_rtree const&);
+
+    rtree_type m_trees[2];
+    std::atomic<std::size_t> m_current;
+    std::atomic<std::size_t> m_version;
+    mutable detail::rtree::read_indicator m_readers[2];
+    std::mutex m_writer_mutex;
+};
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_CONCURRENT_RTREE_HPP
@@ -0,0 +1,237 @@
+// Boost.Geometry Index
+//
+// Vectorized disjoint test of a block of cartesian boxes
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_BOXES_DISJOINT_SIMD_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_BOXES_DISJOINT_SIMD_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+#include <boost/geometry/core/access.hpp>
+#include <boost/geometry/core/coordinate_dimension.hpp>
+#include <boost/geometry/core/coordinate_type.hpp>
+
+// The instruction set is selected at compile time. Define
+// BOOST_GEOMETRY_INDEX_DISABLE_SIMD to test the boxes one by one.
+#if ! defined(BOOST_GEOMETRY_INDEX_DISABLE_SIMD)
+#if defined(__AVX__)
+#define BOOST_GEOMETRY_INDEX_DETAIL_SIMD_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BOOST_GEOMETRY_INDEX_DETAIL_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
+namespace boost { namespace geometry { namespace index { namespace detail {
+
+namespace simd {
+
+// The number of boxes tested at once.
+static const std::size_t block_size = 8;
+
+// Coordinates of the boxes of the elements of a node, the i-th lane refers to
+// the box of l[i]->first.
+template <std::size_t I, typename Iterator>
+inline auto min_coord(Iterator const* l, std::size_t i)
+{
+    return geometry::get<min_corner, I>(l[i]->first);
+}
+
+template <std::size_t I, typename Iterator>
+inline auto max_coord(Iterator const* l, std::size_t i)
+{
+    return geometry::get<max_corner, I>(l[i]->first);
+}
+
+// Operations on the I-th coordinates of consecutive lanes. disjoint() returns
+// the mask with the i-th bit set if the i-th range of coordinates is disjoint
+// with [qmin, qmax]. The comparisons are the same as in the cartesian
+// disjoint(box, box), in particular the ranges having NaN coordinates are not
+// disjoint. The vectors are built from the coordinates directly, storing them in
+// memory and loading as vectors would stall on store forwarding.
+template <typename T>
+struct lanes;
+
+#if defined(BOOST_GEOMETRY_INDEX_DETAIL_SIMD_AVX)
+
+template <>
+struct lanes<double>
+{
+    static const std::size_t size = 4;
+
+    template <std::size_t I, typename Iterator>
+    static inline unsigned disjoint(Iterator const* l, double qmin, double qmax)
+    {
+        __m256d const mins = _mm256_set_pd(min_coord<I>(l, 3), min_coord<I>(l, 2),
+                                           min_coord<I>(l, 1), min_coord<I>(l, 0));
+        __m256d const maxs = _mm256_set_pd(max_coord<I>(l, 3), max_coord<I>(l, 2),
+                                           max_coord<I>(l, 1), max_coord<I>(l, 0));
+        __m256d const gt = _mm256_cmp_pd(mins, _mm256_set1_pd(qmax), _CMP_GT_OQ);
+        __m256d const lt = _mm256_cmp_pd(maxs, _mm256_set1_pd(qmin), _CMP_LT_OQ);
+        return unsigned(_mm256_movemask_pd(_mm256_or_pd(gt, lt)));
+    }
+};
+
+template <>
+struct lanes<float>
+{
+    static const std::size_t size = 8;
+
+    template <std::size_t I, typename Iterator>
+    static inline unsigned disjoint(Iterator const* l, float qmin, float qmax)
+    {
+        __m256 const mins = _mm256_set_ps(min_coord<I>(l, 7), min_coord<I>(l, 6),
+                                          min_coord<I>(l, 5), min_coord<I>(l, 4),
+                                          min_coord<I>(l, 3), min_coord<I>(l, 2),
+                                          min_coord<I>(l, 1), min_coord<I>(l, 0));
+        __m256 const maxs = _mm256_set_ps(max_coord<I>(l, 7), max_coord<I>(l, 6),
+                                          max_coord<I>(l, 5), max_coord<I>(l, 4),
+                                          max_coord<I>(l, 3), max_coord<I>(l, 2),
+                                          max_coord<I>(l, 1), max_coord<I>(l, 0));
+        __m256 const gt = _mm256_cmp_ps(mins, _mm256_set1_ps(qmax), _CMP_GT_OQ);
+        __m256 const lt = _mm256_cmp_ps(maxs, _mm256_set1_ps(qmin), _CMP_LT_OQ);
+        return unsigned(_mm256_movemask_ps(_mm256_or_ps(gt, lt)));
+    }
+};
+
+#elif defined(BOOST_GEOMETRY_INDEX_DETAIL_SIMD_SSE2)
+
+template <>
+struct lanes<double>
+{
+    static const std::size_t size = 2;
+
+    template <std::size_t I, typename Iterator>
+    static inline unsigned disjoint(Iterator const* l, double qmin, double qmax)
+    {
+        __m128d const mins = _mm_set_pd(min_coord<I>(l, 1), min_coord<I>(l, 0));
+        __m128d const maxs = _mm_set_pd(max_coord<I>(l, 1), max_coord<I>(l, 0));
+        __m128d const gt = _mm_cmpgt_pd(mins, _mm_set1_pd(qmax));
+        __m128d const lt = _mm_cmplt_pd(maxs, _mm_set1_pd(qmin));
+        return unsigned(_mm_movemask_pd(_mm_or_pd(gt, lt)));
+    }
+};
+
+template <>
+struct lanes<float>
+{
+    static const std::size_t size = 4;
+
+    template <std::size_t I, typename Iterator>
+    static inline unsigned disjoint(Iterator const* l, float qmin, float qmax)
+    {
+        __m128 const mins = _mm_set_ps(min_coord<I>(l, 3), min_coord<I>(l, 2),
+                                       min_coord<I>(l, 1), min_coord<I>(l, 0));
+        __m128 const maxs = _mm_set_ps(max_coord<I>(l, 3), max_coord<I>(l, 2),
+                                       max_coord<I>(l, 1), max_coord<I>(l, 0));
+        __m128 const gt = _mm_cmpgt_ps(mins, _mm_set1_ps(qmax));
+        __m128 const lt = _mm_cmplt_ps(maxs, _mm_set1_ps(qmin));
+        return unsigned(_mm_movemask_ps(_mm_or_ps(gt, lt)));
+    }
+};
+
+#endif
+
+// Coordinate types for which the vectorized version is used. Without SIMD
+// instructions testing the boxes one by one is faster.
+template <typename T>
+struct is_simd_coordinate
+    : std::integral_constant
+        <
+            bool,
+#if defined(BOOST_GEOMETRY_INDEX_DETAIL_SIMD_AVX) || defined(BOOST_GEOMETRY_INDEX_DETAIL_SIMD_SSE2)
+            std::is_same<T, float>::value || std::is_same<T, double>::value
+#else
+            false
+#endif
+        >
+{};
+
+template <typename T, std::size_t I, std::size_t Dimension>
+struct disjoint_dimensions
+{
+    template <typename Iterator>
+    static inline unsigned apply(Iterator const* l, T const* qmins, T const* qmaxs)
+    {
+        unsigned result = 0;
+        for ( std::size_t i = 0 ; i < block_size ; i += lanes<T>::size )
+        {
+            result |= lanes<T>::template disjoint<I>(l + i, qmins[I], qmaxs[I]) << i;
+        }
+        return result | disjoint_dimensions<T, I + 1, Dimension>::apply(l, qmins, qmaxs);
+    }
+};
+
+template <typename T, std::size_t Dimension>
+struct disjoint_dimensions<T, Dimension, Dimension>
+{
+    template <typename Iterator>
+    static inline unsigned apply(Iterator const*, T const*, T const*)
+    {
+        return 0;
+    }
+};
+
+template <std::size_t I, std::size_t Dimension>
+struct box_coordinates
+{
+    template <typename Box, typename T>
+    static inline void apply(Box const& b, T * mins, T * maxs)
+    {
+        mins[I] = geometry::get<min_corner, I>(b);
+        maxs[I] = geometry::get<max_corner, I>(b);
+        box_coordinates<I + 1, Dimension>::apply(b, mins, maxs);
+    }
+};
+
+template <std::size_t Dimension>
+struct box_coordinates<Dimension, Dimension>
+{
+    template <typename Box, typename T>
+    static inline void apply(Box const&, T *, T *)
+    {}
+};
+
+// A cartesian box tested against the boxes of the elements of a node in blocks.
+template <typename T, std::size_t Dimension>
+class box_tester
+{
+public:
+    template <typename Box>
+    explicit box_tester(Box const& b)
+    {
+        box_coordinates<0, Dimension>::apply(b, m_mins, m_maxs);
+    }
+
+    // Returns the mask with the i-th bit set if the box of the i-th of count
+    // elements starting at first intersects the box, 0 < count <= block_size.
+    template <typename Iterator>
+    inline unsigned intersects(Iterator first, std::size_t count) const
+    {
+        // the lanes past count refer to the last element, the result is ignored
+        Iterator l[block_size];
+        for ( std::size_t i = 0 ; i < block_size ; ++i )
+        {
+            l[i] = first + std::ptrdiff_t(i < count ? i : count - 1);
+        }
+
+        unsigned const disjoint = disjoint_dimensions<T, 0, Dimension>::apply(l, m_mins, m_maxs);
+        return ~disjoint & ((1u << count) - 1u);
+    }
+
+private:
+    T m_mins[Dimension];
+    T m_maxs[Dimension];
+};
+
+} // namespace simd
+
+}}}} // namespace boost::geometry::index::detail
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_BOXES_DISJOINT_SIMD_HPP
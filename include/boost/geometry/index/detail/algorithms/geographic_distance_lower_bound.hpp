@@ -0,0 +1,130 @@
+// Boost.Geometry Index
+//
+// lower bound of the geodesic distance between point and box
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_GEOGRAPHIC_DISTANCE_LOWER_BOUND_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_GEOGRAPHIC_DISTANCE_LOWER_BOUND_HPP
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/geometry/core/access.hpp>
+#include <boost/geometry/core/radian_access.hpp>
+#include <boost/geometry/core/radius.hpp>
+#include <boost/geometry/util/math.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail {
+
+namespace geographic_bound {
+
+// geodetic latitude to geocentric latitude, k = b^2 / a^2
+template <typename T>
+inline T geocentric_latitude(T const& lat, T const& k)
+{
+    using std::atan2;
+    using std::cos;
+    using std::sin;
+    return atan2(k * sin(lat), cos(lat));
+}
+
+// the central angle between the points of the unit sphere
+template <typename T>
+inline T central_angle(T const& lat1, T const& lat2, T const& dlon)
+{
+    using std::asin;
+    using std::cos;
+    using std::sin;
+    using std::sqrt;
+    T const s1 = sin((lat2 - lat1) / T(2));
+    T const s2 = sin(dlon / T(2));
+    T const h = s1 * s1 + cos(lat1) * cos(lat2) * s2 * s2;
+    return T(2) * asin((std::min)(sqrt(h), T(1)));
+}
+
+// the angle between the point and the meridian segment of the unit sphere
+// dlon is the difference of longitudes in [0, pi]
+template <typename T>
+inline T meridian_segment_angle(T const& lat, T const& dlon, T const& lat_min, T const& lat_max)
+{
+    using std::asin;
+    using std::atan2;
+    using std::cos;
+    using std::sin;
+
+    T const cos_dlon = cos(dlon);
+    if ( cos_dlon > T(0) )
+    {
+        // the latitude of the point of the meridian closest to the point
+        T const cos_lat = cos(lat);
+        T const lat_closest = atan2(sin(lat), cos_lat * cos_dlon);
+        if ( lat_min <= lat_closest && lat_closest <= lat_max )
+            return asin((std::min)(cos_lat * sin(dlon), T(1)));
+    }
+
+    // otherwise the distance to the meridian is monotonic between the endpoints
+    return (std::min)(central_angle(lat, lat_min, dlon),
+                      central_angle(lat, lat_max, dlon));
+}
+
+} // namespace geographic_bound
+
+// The lower bound of the length of the geodesics between the point and the points
+// of the box on the spheroid. A curve on the surface of the spheroid is not shorter
+// than its radial projection onto the sphere with the radius equal to the smaller
+// radius of the spheroid because this projection doesn't expand the distances outside
+// of the sphere. The projection preserves the longitudes and converts the geodetic
+// latitudes to geocentric ones monotonically so the box is projected onto the box
+// of the sphere and the spherical distance between them is the bound. It is decreased
+// by a small tolerance covering the errors of the approximate geodesic formulas.
+template <typename CalculationType, typename Point, typename Box, typename Spheroid>
+inline CalculationType geographic_distance_lower_bound(Point const& point, Box const& box,
+                                                       Spheroid const& spheroid)
+{
+    typedef CalculationType calc_t;
+
+    calc_t const two_pi = math::two_pi<calc_t>();
+    calc_t const a = calc_t(get_radius<0>(spheroid));
+    calc_t const b = calc_t(get_radius<2>(spheroid));
+    calc_t const k = (b * b) / (a * a);
+
+    calc_t const lon = calc_t(geometry::get_as_radian<0>(point));
+    calc_t const lat = geographic_bound::geocentric_latitude(calc_t(geometry::get_as_radian<1>(point)), k);
+    calc_t const lon_min = calc_t(geometry::get_as_radian<min_corner, 0>(box));
+    calc_t const lon_max = calc_t(geometry::get_as_radian<max_corner, 0>(box));
+    calc_t const lat_min = geographic_bound::geocentric_latitude(calc_t(geometry::get_as_radian<min_corner, 1>(box)), k);
+    calc_t const lat_max = geographic_bound::geocentric_latitude(calc_t(geometry::get_as_radian<max_corner, 1>(box)), k);
+
+    // the longitude of the point relative to the western edge of the box in [0, 2pi)
+    calc_t dlon = std::fmod(lon - lon_min, two_pi);
+    if ( dlon < calc_t(0) )
+        dlon += two_pi;
+
+    calc_t angle = 0;
+    if ( dlon <= lon_max - lon_min )
+    {
+        angle = lat < lat_min ? lat_min - lat
+              : lat_max < lat ? lat - lat_max
+              : calc_t(0);
+    }
+    else
+    {
+        // the distance to the closer meridian edge
+        calc_t const dlon_edge = (std::min)(dlon - (lon_max - lon_min), two_pi - dlon);
+        angle = geographic_bound::meridian_segment_angle(lat, dlon_edge, lat_min, lat_max);
+    }
+
+    // relative tolerance for the approximations of the formulas and absolute
+    // tolerance for the rounding errors of the trigonometric functions, e.g. asin()
+    // of the haversine formula loses precision for nearly antipodal points
+    angle = angle * calc_t(0.999) - calc_t(1e-7);
+
+    return angle > calc_t(0) ? (std::min)(a, b) * angle : calc_t(0);
+}
+
+}}}} // namespace boost::geometry::index::detail
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_GEOGRAPHIC_DISTANCE_LOWER_BOUND_HPP
@@ -0,0 +1,160 @@
+// Boost.Geometry Index
+//
+// Hilbert curve key
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_HILBERT_KEY_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_HILBERT_KEY_HPP
+
+#include <cstdint>
+
+#include <boost/geometry/core/access.hpp>
+#include <boost/geometry/core/coordinate_dimension.hpp>
+#include <boost/geometry/core/static_assert.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail {
+
+namespace hilbert_key_detail {
+
+template <std::size_t I, std::size_t Dimension>
+struct coordinates
+{
+    template <typename Box>
+    static inline void box(Box const& b, double * mins, double * maxs)
+    {
+        mins[I] = static_cast<double>(geometry::get<min_corner, I>(b));
+        maxs[I] = static_cast<double>(geometry::get<max_corner, I>(b));
+        coordinates<I + 1, Dimension>::box(b, mins, maxs);
+    }
+
+    template <typename Point>
+    static inline void point(Point const& p, double * coords)
+    {
+        coords[I] = static_cast<double>(geometry::get<I>(p));
+        coordinates<I + 1, Dimension>::point(p, coords);
+    }
+};
+
+template <std::size_t Dimension>
+struct coordinates<Dimension, Dimension>
+{
+    template <typename Box>
+    static inline void box(Box const&, double *, double *) {}
+
+    template <typename Point>
+    static inline void point(Point const&, double *) {}
+};
+
+} // namespace hilbert_key_detail
+
+// Calculates the position of a Point on the Hilbert curve filling the Box.
+// Each coordinate is quantized to 64/Dimension bits (at most 16) so the key
+// fits in 64 bits. Points outside the Box are clamped to its bounds.
+// The transposition is the one described in J. Skilling,
+// "Programming the Hilbert curve", AIP Conf. Proc. 707, 2004.
+template <typename Point>
+class hilbert_key
+{
+public:
+    static const std::size_t dimension = geometry::dimension<Point>::value;
+
+    BOOST_GEOMETRY_STATIC_ASSERT((0 < dimension && dimension <= 64),
+        "Hilbert key is supported for dimensions in range [1, 64].",
+        Point);
+
+    static const std::size_t bits = 64 / dimension < 16 ? 64 / dimension : 16;
+
+    typedef std::uint64_t result_type;
+
+    template <typename Box>
+    explicit hilbert_key(Box const& box)
+    {
+        double maxs[dimension];
+        hilbert_key_detail::coordinates<0, dimension>::box(box, m_mins, maxs);
+
+        double const cells = static_cast<double>((std::uint64_t(1) << bits) - 1);
+        for ( std::size_t i = 0 ; i < dimension ; ++i )
+        {
+            double const length = maxs[i] - m_mins[i];
+            m_scales[i] = length > 0 ? cells / length : 0;
+        }
+    }
+
+    result_type operator()(Point const& pt) const
+    {
+        double coords[dimension];
+        hilbert_key_detail::coordinates<0, dimension>::point(pt, coords);
+
+        std::uint32_t const max_cell = static_cast<std::uint32_t>((std::uint64_t(1) << bits) - 1);
+        std::uint32_t x[dimension];
+        for ( std::size_t i = 0 ; i < dimension ; ++i )
+        {
+            double const c = (coords[i] - m_mins[i]) * m_scales[i];
+            // also handles NaN
+            x[i] = c > 0 ? (c < max_cell ? static_cast<std::uint32_t>(c) : max_cell) : 0;
+        }
+
+        axes_to_transpose(x);
+
+        // interleave the bits of the transposed coordinates, most significant first
+        result_type key = 0;
+        for ( std::size_t b = bits ; b > 0 ; --b )
+        {
+            for ( std::size_t i = 0 ; i < dimension ; ++i )
+            {
+                key = (key << 1) | ((x[i] >> (b - 1)) & 1u);
+            }
+        }
+        return key;
+    }
+
+private:
+    static inline void axes_to_transpose(std::uint32_t * x)
+    {
+        std::uint32_t const m = std::uint32_t(1) << (bits - 1);
+
+        // inverse undo
+        for ( std::uint32_t q = m ; q > 1 ; q >>= 1 )
+        {
+            std::uint32_t const p = q - 1;
+            for ( std::size_t i = 0 ; i < dimension ; ++i )
+            {
+                // branchless version of:
+                // if ( x[i] & q ) invert: x[0] ^= p
+                // else exchange the low bits of x[0] and x[i]
+                std::uint32_t const set = 0u - ((x[i] & q) != 0 ? 1u : 0u);
+                std::uint32_t const t = (x[0] ^ x[i]) & p & ~set;
+                x[0] ^= (p & set) | t;
+                x[i] ^= t;
+            }
+        }
+
+        // gray encode
+        for ( std::size_t i = 1 ; i < dimension ; ++i )
+        {
+            x[i] ^= x[i - 1];
+        }
+        std::uint32_t t = 0;
+        for ( std::uint32_t q = m ; q > 1 ; q >>= 1 )
+        {
+            // branchless version of:
+            // if ( x[dimension - 1] & q ) t ^= q - 1
+            std::uint32_t const set = 0u - ((x[dimension - 1] & q) != 0 ? 1u : 0u);
+            t ^= (q - 1) & set;
+        }
+        for ( std::size_t i = 0 ; i < dimension ; ++i )
+        {
+            x[i] ^= t;
+        }
+    }
+
+    double m_mins[dimension];
+    double m_scales[dimension];
+};
+
+}}}} // namespace boost::geometry::index::detail
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_ALGORITHMS_HILBERT_KEY_HPP
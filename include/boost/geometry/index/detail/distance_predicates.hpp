@@ -16,11 +16,24 @@
 #ifndef BOOST_GEOMETRY_INDEX_DETAIL_DISTANCE_PREDICATES_HPP
 #define BOOST_GEOMETRY_INDEX_DETAIL_DISTANCE_PREDICATES_HPP
 
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <boost/geometry/core/cs.hpp>
 #include <boost/geometry/core/static_assert.hpp>
+#include <boost/geometry/core/tags.hpp>
+#include <boost/geometry/srs/spheroid.hpp>
+#include <boost/geometry/strategies/distance.hpp>
+#include <boost/geometry/strategies/distance/comparable.hpp>
+#include <boost/geometry/strategies/distance/services.hpp>
+#include <boost/geometry/strategies/index/geographic.hpp>
+#include <boost/geometry/util/select_most_precise.hpp>
 
 #include <boost/geometry/index/detail/algorithms/comparable_distance_near.hpp>
 #include <boost/geometry/index/detail/algorithms/comparable_distance_far.hpp>
 #include <boost/geometry/index/detail/algorithms/comparable_distance_centroid.hpp>
+#include <boost/geometry/index/detail/algorithms/geographic_distance_lower_bound.hpp>
 #include <boost/geometry/index/detail/algorithms/path_intersection.hpp>
 #include <boost/geometry/index/detail/predicates.hpp>
 #include <boost/geometry/index/detail/tags.hpp>
@@ -134,6 +147,195 @@ struct comparable_distance_call<G1, G2, default_strategy>
     }
 };
 
+// Converts the distance into the comparable distance between the geometries
+// calculated by comparable_distance_call for the same strategy.
+template
+<
+    typename G1, typename G2, typename Strategies
+>
+struct comparable_distance_bound_call
+{
+    typedef typename comparable_distance_call
+        <
+            G1, G2, Strategies
+        >::result_type result_type;
+
+    template <typename Distance>
+    static inline result_type apply(G1 const& g1, G2 const& g2, Distance const& d, Strategies const& s)
+    {
+        typedef decltype(s.distance(g1, g2)) strategy_type;
+        typedef typename geometry::strategy::distance::services::comparable_type
+            <
+                strategy_type
+            >::type comparable_strategy_type;
+
+        return apply(g1, g2, d, s, std::is_same<strategy_type, comparable_strategy_type>());
+    }
+
+private:
+    // the comparable distance is the distance, e.g. in geographic CS
+    template <typename Distance>
+    static inline result_type apply(G1 const&, G2 const&, Distance const& d, Strategies const&,
+                                    std::true_type /*is_comparable*/)
+    {
+        return static_cast<result_type>(d);
+    }
+
+    template <typename Distance>
+    static inline result_type apply(G1 const& g1, G2 const& g2, Distance const& d, Strategies const& s,
+                                    std::false_type /*is_comparable*/)
+    {
+        typedef strategies::distance::detail::comparable<Strategies> comparable_strategies;
+        auto const strategy = comparable_strategies(s).distance(g1, g2);
+        typedef std::remove_const_t<decltype(strategy)> strategy_type;
+        return static_cast<result_type>(
+                    geometry::strategy::distance::services::result_from_distance
+                        <
+                            strategy_type, G1, G2
+                        >::apply(strategy, d));
+    }
+};
+
+template
+<
+    typename G1, typename G2
+>
+struct comparable_distance_bound_call<G1, G2, default_strategy>
+{
+    typedef typename strategies::distance::services::default_strategy
+        <
+            G1, G2
+        >::type strategies_type;
+    typedef comparable_distance_bound_call<G1, G2, strategies_type> call_type;
+    typedef typename call_type::result_type result_type;
+
+    template <typename Distance>
+    static inline result_type apply(G1 const& g1, G2 const& g2, Distance const& d, default_strategy const&)
+    {
+        return call_type::apply(g1, g2, d, strategies_type());
+    }
+};
+
+// The distance used to sort and prune the nodes in the k nearest neighbors search.
+// It may be smaller than the comparable distance between the geometry and the box
+// if it can be calculated faster.
+template
+<
+    typename Geometry, typename Box, typename Strategy,
+    typename CSTag = typename geometry::cs_tag<Geometry>::type,
+    typename GeometryTag = typename geometry::tag<Geometry>::type
+>
+struct comparable_distance_lower_bound_call
+    : comparable_distance_call<Geometry, Box, Strategy>
+{};
+
+// The geodesic distance between a point and a box is expensive, the distance on
+// the sphere inscribed in the spheroid is used instead. The exact distances are
+// calculated only for the values.
+template <typename Point, typename Box, typename Spheroid>
+struct geographic_distance_lower_bound_call
+{
+    typedef typename geometry::select_most_precise
+        <
+            typename geometry::coordinate_type<Point>::type,
+            typename geometry::coordinate_type<Box>::type,
+            double
+        >::type calculation_type;
+
+    template <typename ResultType>
+    static inline ResultType apply(Point const& p, Box const& b, Spheroid const& spheroid)
+    {
+        return static_cast<ResultType>(
+                    geographic_distance_lower_bound<calculation_type>(p, b, spheroid));
+    }
+};
+
+template <typename Point, typename Box>
+struct comparable_distance_lower_bound_call<Point, Box, default_strategy, geographic_tag, point_tag>
+{
+    typedef typename comparable_distance_call
+        <
+            Point, Box, default_strategy
+        >::result_type result_type;
+
+    static inline result_type apply(Point const& p, Box const& b, default_strategy const&)
+    {
+        typedef srs::spheroid<double> spheroid_type;
+        return geographic_distance_lower_bound_call<Point, Box, spheroid_type>
+                ::template apply<result_type>(p, b, spheroid_type());
+    }
+};
+
+template <typename Point, typename Box, typename FormulaPolicy, typename Spheroid, typename CalculationType>
+struct comparable_distance_lower_bound_call
+    <
+        Point, Box,
+        strategies::index::geographic<FormulaPolicy, Spheroid, CalculationType>,
+        geographic_tag, point_tag
+    >
+{
+    typedef strategies::index::geographic<FormulaPolicy, Spheroid, CalculationType> strategy_type;
+    typedef typename comparable_distance_call
+        <
+            Point, Box, strategy_type
+        >::result_type result_type;
+
+    static inline result_type apply(Point const& p, Box const& b, strategy_type const& s)
+    {
+        return geographic_distance_lower_bound_call<Point, Box, Spheroid>
+                ::template apply<result_type>(p, b, s.model());
+    }
+};
+
+// ------------------------------------------------------------------ //
+// within_distance
+// ------------------------------------------------------------------ //
+
+template <typename Geometry, typename Distance, typename Tag>
+struct predicate_check<predicates::within_distance<Geometry, Distance>, Tag>
+{
+    typedef predicates::within_distance<Geometry, Distance> Pred;
+
+    // Indexable is a Box for bounds_tag so only the nodes which may contain
+    // values closer than the maximum distance are traversed
+    template <typename Value, typename Indexable, typename Strategy>
+    static inline bool apply(Pred const& p, Value const&, Indexable const& i, Strategy const& s)
+    {
+        typedef comparable_distance_call<Geometry, Indexable, Strategy> call_type;
+        typedef comparable_distance_bound_call<Geometry, Indexable, Strategy> bound_call_type;
+
+        return call_type::apply(p.geometry, i, s)
+            <= bound_call_type::apply(p.geometry, i, p.max_distance, s);
+    }
+};
+
+// the maximum comparable distance of the predicate for nodes or values
+template <typename Predicate>
+inline auto const& comparable_max_distance(Predicate const& p, value_tag)
+{
+    return p.value_max_distance;
+}
+
+template <typename Predicate>
+inline auto const& comparable_max_distance(Predicate const& p, bounds_tag)
+{
+    return p.bounds_max_distance;
+}
+
+template <typename Geometry, typename BoundsDistance, typename ValueDistance, typename Tag>
+struct predicate_check<predicates::within_comparable_distance<Geometry, BoundsDistance, ValueDistance>, Tag>
+{
+    typedef predicates::within_comparable_distance<Geometry, BoundsDistance, ValueDistance> Pred;
+
+    template <typename Value, typename Indexable, typename Strategy>
+    static inline bool apply(Pred const& p, Value const&, Indexable const& i, Strategy const& s)
+    {
+        typedef comparable_distance_call<Geometry, Indexable, Strategy> call_type;
+
+        return call_type::apply(p.geometry, i, s) <= comparable_max_distance(p, Tag());
+    }
+};
+
 // ------------------------------------------------------------------ //
 // calculate_distance
 // ------------------------------------------------------------------ //
@@ -151,19 +353,114 @@ template <typename PointRelation, typename Indexable, typename Strategy, typenam
 struct calculate_distance< predicates::nearest<PointRelation>, Indexable, Strategy, Tag>
 {
     typedef detail::relation<PointRelation> relation;
-    typedef comparable_distance_call
+    // the nodes may be sorted by the lower bound of the distance to the nearest point
+    typedef typename std::conditional
+        <
+            std::is_same<Tag, bounds_tag>::value
+         && std::is_same<typename relation::tag, to_nearest_tag>::value,
+            comparable_distance_lower_bound_call
+                <
+                    typename relation::value_type,
+                    Indexable,
+                    Strategy
+                >,
+            comparable_distance_call
+                <
+                    typename relation::value_type,
+                    Indexable,
+                    Strategy
+                >
+        >::type call_type;
+    typedef typename call_type::result_type result_type;
+
+    static inline bool apply(predicates::nearest<PointRelation> const& p, Indexable const& i,
+                             Strategy const& s, result_type & result)
+    {
+        result = call_type::apply(relation::value(p.point_or_relation), i, s);
+        return true;
+    }
+};
+
+// values and nodes further than the maximum distance are rejected
+template <typename PointRelation, typename Distance, typename Indexable, typename Strategy, typename Tag>
+struct calculate_distance< predicates::bounded_nearest<PointRelation, Distance>, Indexable, Strategy, Tag>
+{
+    typedef detail::relation<PointRelation> relation;
+
+    BOOST_GEOMETRY_STATIC_ASSERT(
+        (std::is_same<typename relation::tag, to_nearest_tag>::value),
+        "Only the distance to the nearest point of the Indexable may be bounded.",
+        PointRelation);
+
+    // the nodes may be sorted and pruned by the lower bound of the distance,
+    // a node is never rejected if it may contain a value closer than the maximum
+    typedef typename std::conditional
+        <
+            std::is_same<Tag, bounds_tag>::value,
+            comparable_distance_lower_bound_call
+                <
+                    typename relation::value_type,
+                    Indexable,
+                    Strategy
+                >,
+            comparable_distance_call
+                <
+                    typename relation::value_type,
+                    Indexable,
+                    Strategy
+                >
+        >::type call_type;
+    typedef comparable_distance_bound_call
         <
             typename relation::value_type,
             Indexable,
             Strategy
-        > call_type;
+        > bound_call_type;
     typedef typename call_type::result_type result_type;
 
-    static inline bool apply(predicates::nearest<PointRelation> const& p, Indexable const& i,
+    static inline bool apply(predicates::bounded_nearest<PointRelation, Distance> const& p, Indexable const& i,
                              Strategy const& s, result_type & result)
     {
         result = call_type::apply(relation::value(p.point_or_relation), i, s);
-        return true;
+        return result <= bound_call_type::apply(relation::value(p.point_or_relation), i, p.max_distance, s);
+    }
+};
+
+// the maximum distance is already converted into the comparable distance
+template <typename PointRelation, typename BoundsDistance, typename ValueDistance,
+          typename Indexable, typename Strategy, typename Tag>
+struct calculate_distance
+    <
+        predicates::bounded_comparable_nearest<PointRelation, BoundsDistance, ValueDistance>,
+        Indexable, Strategy, Tag
+    >
+{
+    typedef detail::relation<PointRelation> relation;
+    typedef predicates::bounded_comparable_nearest<PointRelation, BoundsDistance, ValueDistance> predicate_type;
+
+    typedef typename std::conditional
+        <
+            std::is_same<Tag, bounds_tag>::value,
+            comparable_distance_lower_bound_call
+                <
+                    typename relation::value_type,
+                    Indexable,
+                    Strategy
+                >,
+            comparable_distance_call
+                <
+                    typename relation::value_type,
+                    Indexable,
+                    Strategy
+                >
+        >::type call_type;
+    typedef typename call_type::result_type result_type;
+
+    static inline bool apply(predicate_type const& p, Indexable const& i,
+                             Strategy const& s, result_type & result)
+    {
+        result = call_type::apply(relation::value(p.point_or_relation), i, s);
+        return result <= comparable_max_distance(p, Tag());
     }
 };
 
@@ -215,6 +512,121 @@ struct calculate_distance< predicates::path<SegmentOrLinestring>, Indexable, Str
     }
 };
 
+// ------------------------------------------------------------------ //
+// comparable_bounds_predicates
+// ------------------------------------------------------------------ //
+
+// Converts the maximum distances of within_distance() and bounded nearest()
+// into the comparable distances of the strategy once per query, so they're
+// not converted for each node and value. Only the types of the geometries
+// are used to get the strategies so default constructed ones are passed.
+template <typename Predicate, typename Box, typename Indexable, typename Strategy>
+struct comparable_bounds_predicate
+{
+    typedef Predicate type;
+
+    static inline type const& apply(Predicate const& p, Strategy const&)
+    {
+        return p;
+    }
+};
+
+template <typename Geometry, typename Distance, typename Box, typename Indexable, typename Strategy>
+struct comparable_bounds_predicate<predicates::within_distance<Geometry, Distance>, Box, Indexable, Strategy>
+{
+    typedef comparable_distance_bound_call<Geometry, Box, Strategy> bounds_call_type;
+    typedef comparable_distance_bound_call<Geometry, Indexable, Strategy> value_call_type;
+    typedef predicates::within_comparable_distance
+        <
+            Geometry,
+            typename bounds_call_type::result_type,
+            typename value_call_type::result_type
+        > type;
+
+    static inline type apply(predicates::within_distance<Geometry, Distance> const& p, Strategy const& s)
+    {
+        Box const box = Box();
+        Indexable const indexable = Indexable();
+        return type(p.geometry,
+                    bounds_call_type::apply(p.geometry, box, p.max_distance, s),
+                    value_call_type::apply(p.geometry, indexable, p.max_distance, s));
+    }
+};
+
+template <typename PointRelation, typename Distance, typename Box, typename Indexable, typename Strategy>
+struct comparable_bounds_predicate<predicates::bounded_nearest<PointRelation, Distance>, Box, Indexable, Strategy>
+{
+    typedef detail::relation<PointRelation> relation;
+    typedef typename relation::value_type point_type;
+    typedef comparable_distance_bound_call<point_type, Box, Strategy> bounds_call_type;
+    typedef comparable_distance_bound_call<point_type, Indexable, Strategy> value_call_type;
+    typedef predicates::bounded_comparable_nearest
+        <
+            PointRelation,
+            typename bounds_call_type::result_type,
+            typename value_call_type::result_type
+        > type;
+
+    static inline type apply(predicates::bounded_nearest<PointRelation, Distance> const& p, Strategy const& s)
+    {
+        point_type const& pt = relation::value(p.point_or_relation);
+        Box const box = Box();
+        Indexable const indexable = Indexable();
+        return type(p.point_or_relation, p.count,
+                    bounds_call_type::apply(pt, box, p.max_distance, s),
+                    value_call_type::apply(pt, indexable, p.max_distance, s));
+    }
+};
+
+template <typename ...Ts, typename Box, typename Indexable, typename Strategy>
+struct comparable_bounds_predicate<std::tuple<Ts...>, Box, Indexable, Strategy>
+{
+    typedef std::tuple
+        <
+            typename comparable_bounds_predicate<Ts, Box, Indexable, Strategy>::type...
+        > type;
+
+    static inline type apply(std::tuple<Ts...> const& p, Strategy const& s)
+    {
+        return apply(p, s, std::index_sequence_for<Ts...>());
+    }
+
+private:
+    template <std::size_t ...Is>
+    static inline type apply(std::tuple<Ts...> const& p, Strategy const& s, std::index_sequence<Is...>)
+    {
+        return type(comparable_bounds_predicate<Ts, Box, Indexable, Strategy>::apply(std::get<Is>(p), s)...);
+    }
+};
+
+// The predicates are referenced if there is nothing to convert.
+template <typename Predicates, typename Box, typename Indexable, typename Strategy>
+struct comparable_bounds_predicates
+{
+    typedef comparable_bounds_predicate<Predicates, Box, Indexable, Strategy> impl;
+    typedef typename impl::type type;
+
+    static const bool is_converted = ! std::is_same<type, Predicates>::value;
+
+    typedef std::conditional_t<is_converted, type, Predicates const&> reference_type;
+
+    static inline reference_type apply(Predicates const& p, Strategy const& s)
+    {
+        return apply(p, s, std::integral_constant<bool, is_converted>());
+    }
+
+private:
+    static inline type apply(Predicates const& p, Strategy const& s, std::true_type /*is_converted*/)
+    {
+        return impl::apply(p, s);
+    }
+
+    static inline Predicates const& apply(Predicates const& p, Strategy const&, std::false_type /*is_converted*/)
+    {
+        return p;
+    }
+};
+
 }}}} // namespace boost::geometry::index::detail
 
 #endif // BOOST_GEOMETRY_INDEX_RTREE_DISTANCE_PREDICATES_HPP
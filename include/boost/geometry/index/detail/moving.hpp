@@ -0,0 +1,305 @@
+// Boost.Geometry Index
+//
+// Moving points stored in the dual space and time-parameterized predicates
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_MOVING_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_MOVING_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+#include <boost/geometry/core/access.hpp>
+#include <boost/geometry/core/coordinate_dimension.hpp>
+#include <boost/geometry/core/coordinate_type.hpp>
+
+#include <boost/geometry/index/detail/distance_predicates.hpp>
+#include <boost/geometry/index/detail/predicates.hpp>
+#include <boost/geometry/index/detail/tags.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail {
+
+// Moving points are stored in the rtree as points of the space with twice as
+// many dimensions. The first half of the coordinates is the position at the
+// reference time and the second half is the velocity multiplied by the horizon.
+// The time passed to the predicates is relative to the reference time and
+// divided by the horizon so the position at time t is p + w * t. The box of
+// a node in this space contains the positions at the reference time and the
+// ranges of the velocities of its values. Hence it defines a time-parameterized
+// box containing the positions of all of the values at any time.
+
+namespace predicates {
+
+template <typename Box, typename Time>
+struct intersects_at
+{
+    intersects_at() {}
+    intersects_at(Box const& b, Time const& t)
+        : box(b), time(t)
+    {}
+
+    Box box;
+    Time time;
+};
+
+} // namespace predicates
+
+namespace moving {
+
+template <typename Point, typename Time>
+struct position_at
+{
+    position_at() {}
+    position_at(Point const& p, Time const& t)
+        : point(p), time(t)
+    {}
+
+    Point point;
+    Time time;
+};
+
+template <std::size_t I, std::size_t D>
+struct dual
+{
+    // the coordinates of the moving point at the reference time, dt is the
+    // difference between the reference time and the time of the moving point
+    template <typename MovingPoint, typename DualPoint, typename T>
+    static inline void assign(MovingPoint const& mp, DualPoint & dp, T const& dt, T const& horizon)
+    {
+        T const v = T(geometry::get<I>(mp.velocity));
+        geometry::set<I>(dp, T(geometry::get<I>(mp.position)) + v * dt);
+        geometry::set<D + I>(dp, v * horizon);
+        dual<I + 1, D>::assign(mp, dp, dt, horizon);
+    }
+
+    template <typename DualPoint, typename Box, typename T>
+    static inline bool point_intersects(DualPoint const& dp, Box const& b, T const& t)
+    {
+        T const x = T(geometry::get<I>(dp)) + T(geometry::get<D + I>(dp)) * t;
+        return T(geometry::get<min_corner, I>(b)) <= x
+            && x <= T(geometry::get<max_corner, I>(b))
+            && dual<I + 1, D>::point_intersects(dp, b, t);
+    }
+
+    template <typename DualBox, typename Box, typename T>
+    static inline bool box_intersects(DualBox const& db, Box const& b, T const& t)
+    {
+        T lo, hi;
+        interval(db, t, lo, hi);
+        return lo <= T(geometry::get<max_corner, I>(b))
+            && T(geometry::get<min_corner, I>(b)) <= hi
+            && dual<I + 1, D>::box_intersects(db, b, t);
+    }
+
+    template <typename Point, typename DualPoint, typename T>
+    static inline T point_distance(Point const& q, DualPoint const& dp, T const& t)
+    {
+        T const x = T(geometry::get<I>(dp)) + T(geometry::get<D + I>(dp)) * t;
+        T const d = T(geometry::get<I>(q)) - x;
+        return d * d + dual<I + 1, D>::point_distance(q, dp, t);
+    }
+
+    template <typename Point, typename DualBox, typename T>
+    static inline T box_distance(Point const& q, DualBox const& db, T const& t)
+    {
+        T lo, hi;
+        interval(db, t, lo, hi);
+        T const c = T(geometry::get<I>(q));
+        T const d = c < lo ? lo - c : hi < c ? c - hi : T(0);
+        return d * d + dual<I + 1, D>::box_distance(q, db, t);
+    }
+
+private:
+    // the range of the coordinates of the positions at time t
+    template <typename DualBox, typename T>
+    static inline void interval(DualBox const& db, T const& t, T & lo, T & hi)
+    {
+        T const vmin = T(geometry::get<min_corner, D + I>(db));
+        T const vmax = T(geometry::get<max_corner, D + I>(db));
+        lo = T(geometry::get<min_corner, I>(db)) + (t < T(0) ? vmax : vmin) * t;
+        hi = T(geometry::get<max_corner, I>(db)) + (t < T(0) ? vmin : vmax) * t;
+    }
+};
+
+template <std::size_t D>
+struct dual<D, D>
+{
+    template <typename MovingPoint, typename DualPoint, typename T>
+    static inline void assign(MovingPoint const&, DualPoint &, T const&, T const&) {}
+
+    template <typename DualPoint, typename Box, typename T>
+    static inline bool point_intersects(DualPoint const&, Box const&, T const&) { return true; }
+
+    template <typename DualBox, typename Box, typename T>
+    static inline bool box_intersects(DualBox const&, Box const&, T const&) { return true; }
+
+    template <typename Point, typename DualPoint, typename T>
+    static inline T point_distance(Point const&, DualPoint const&, T const&) { return T(0); }
+
+    template <typename Point, typename DualBox, typename T>
+    static inline T box_distance(Point const&, DualBox const&, T const&) { return T(0); }
+};
+
+// The IndexableGetter of the rtree returning the moving point in the dual space.
+template <typename IndexableGetter, typename DualPoint, typename Time>
+class dual_indexable
+{
+    typedef typename geometry::coordinate_type<DualPoint>::type coordinate_type;
+    static const std::size_t dimension = geometry::dimension<DualPoint>::value / 2;
+
+public:
+    typedef DualPoint result_type;
+
+    dual_indexable(IndexableGetter const& getter, Time const& reference_time, Time const& horizon)
+        : m_getter(getter), m_reference_time(reference_time), m_horizon(horizon)
+    {}
+
+    template <typename Value>
+    inline result_type operator()(Value const& v) const
+    {
+        auto const& mp = m_getter(v);
+        result_type result;
+        dual<0, dimension>::assign(mp, result,
+                                   coordinate_type(m_reference_time - mp.time),
+                                   coordinate_type(m_horizon));
+        return result;
+    }
+
+    IndexableGetter const& getter() const { return m_getter; }
+    Time const& reference_time() const { return m_reference_time; }
+    Time const& horizon() const { return m_horizon; }
+
+private:
+    IndexableGetter m_getter;
+    Time m_reference_time;
+    Time m_horizon;
+};
+
+// Converts the times of the predicates passed by the user to the times
+// relative to the reference time of the rtree, divided by the horizon.
+template <typename Predicate, typename T>
+struct convert_time
+{
+    typedef Predicate type;
+
+    template <typename Time>
+    static inline type const& apply(Predicate const& p, Time const&, Time const&)
+    {
+        return p;
+    }
+};
+
+template <typename Box, typename Time, typename T>
+struct convert_time<predicates::intersects_at<Box, Time>, T>
+{
+    typedef predicates::intersects_at<Box, T> type;
+
+    template <typename TreeTime>
+    static inline type apply(predicates::intersects_at<Box, Time> const& p,
+                             TreeTime const& reference_time, TreeTime const& horizon)
+    {
+        return type(p.box, T(p.time - reference_time) / T(horizon));
+    }
+};
+
+template <typename Point, typename Time, typename T>
+struct convert_time<predicates::nearest<position_at<Point, Time> >, T>
+{
+    typedef predicates::nearest<position_at<Point, T> > type;
+
+    template <typename TreeTime>
+    static inline type apply(predicates::nearest<position_at<Point, Time> > const& p,
+                             TreeTime const& reference_time, TreeTime const& horizon)
+    {
+        position_at<Point, T> const pos(p.point_or_relation.point,
+                                        T(p.point_or_relation.time - reference_time) / T(horizon));
+        return type(pos, p.count);
+    }
+};
+
+template <typename ...Ts, typename T>
+struct convert_time<std::tuple<Ts...>, T>
+{
+    typedef std::tuple<typename convert_time<Ts, T>::type...> type;
+
+    template <typename Time>
+    static inline type apply(std::tuple<Ts...> const& p, Time const& reference_time, Time const& horizon)
+    {
+        return apply(p, reference_time, horizon, std::index_sequence_for<Ts...>());
+    }
+
+private:
+    template <typename Time, std::size_t ...I>
+    static inline type apply(std::tuple<Ts...> const& p, Time const& reference_time, Time const& horizon,
+                             std::index_sequence<I...>)
+    {
+        return type(convert_time<Ts, T>::apply(std::get<I>(p), reference_time, horizon)...);
+    }
+};
+
+} // namespace moving
+
+// ------------------------------------------------------------------ //
+
+template <typename Box, typename Time>
+struct predicate_check<predicates::intersects_at<Box, Time>, value_tag>
+{
+    template <typename Value, typename Indexable, typename Strategy>
+    static inline bool apply(predicates::intersects_at<Box, Time> const& p, Value const&,
+                             Indexable const& i, Strategy const&)
+    {
+        static const std::size_t dimension = geometry::dimension<Indexable>::value / 2;
+        return moving::dual<0, dimension>::point_intersects(i, p.box, p.time);
+    }
+};
+
+template <typename Box, typename Time>
+struct predicate_check<predicates::intersects_at<Box, Time>, bounds_tag>
+{
+    template <typename Value, typename Indexable, typename Strategy>
+    static inline bool apply(predicates::intersects_at<Box, Time> const& p, Value const&,
+                             Indexable const& i, Strategy const&)
+    {
+        static const std::size_t dimension = geometry::dimension<Indexable>::value / 2;
+        return moving::dual<0, dimension>::box_intersects(i, p.box, p.time);
+    }
+};
+
+// the comparable distance between the point and the position at the time
+template <typename Point, typename Time, typename Indexable, typename Strategy>
+struct calculate_distance<predicates::nearest<moving::position_at<Point, Time> >, Indexable, Strategy, value_tag>
+{
+    typedef typename geometry::coordinate_type<Indexable>::type result_type;
+    static const std::size_t dimension = geometry::dimension<Indexable>::value / 2;
+
+    static inline bool apply(predicates::nearest<moving::position_at<Point, Time> > const& p,
+                             Indexable const& i, Strategy const&, result_type & result)
+    {
+        result = moving::dual<0, dimension>::point_distance(p.point_or_relation.point, i,
+                                                            result_type(p.point_or_relation.time));
+        return true;
+    }
+};
+
+template <typename Point, typename Time, typename Indexable, typename Strategy>
+struct calculate_distance<predicates::nearest<moving::position_at<Point, Time> >, Indexable, Strategy, bounds_tag>
+{
+    typedef typename geometry::coordinate_type<Indexable>::type result_type;
+    static const std::size_t dimension = geometry::dimension<Indexable>::value / 2;
+
+    static inline bool apply(predicates::nearest<moving::position_at<Point, Time> > const& p,
+                             Indexable const& i, Strategy const&, result_type & result)
+    {
+        result = moving::dual<0, dimension>::box_distance(p.point_or_relation.point, i,
+                                                          result_type(p.point_or_relation.time));
+        return true;
+    }
+};
+
+}}}} // namespace boost::geometry::index::detail
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_MOVING_HPP
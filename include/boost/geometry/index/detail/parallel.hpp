@@ -0,0 +1,85 @@
+// Boost.Geometry Index
+//
+// Parallel execution utilities
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_PARALLEL_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_PARALLEL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include <boost/config.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail {
+
+// Calls f(i) for each i in [0, count) using at most threads threads,
+// the current one included. The indexes are distributed dynamically.
+// If f throws the remaining indexes are not processed and the first
+// exception is rethrown after all of the threads are finished.
+template <typename Function>
+inline void parallel_for(std::size_t count, std::size_t threads, Function const& f)
+{
+    if ( threads > count )
+        threads = count;
+
+    if ( threads <= 1 )
+    {
+        for ( std::size_t i = 0 ; i < count ; ++i )
+            f(i);
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr exception;
+    std::mutex exception_mutex;
+
+    auto worker = [&]()
+    {
+        BOOST_TRY
+        {
+            for ( std::size_t i = next++ ; i < count ; i = next++ )
+                f(i);
+        }
+        BOOST_CATCH(...)
+        {
+            next = count;
+            std::lock_guard<std::mutex> lock(exception_mutex);
+            if ( ! exception )
+                exception = std::current_exception();
+        }
+        BOOST_CATCH_END
+    };
+
+    std::vector<std::future<void> > futures;
+    BOOST_TRY
+    {
+        futures.reserve(threads - 1);
+        for ( std::size_t t = 1 ; t < threads ; ++t )
+            futures.push_back(std::async(std::launch::async, worker));             // MAY THROW (thread creation)
+    }
+    BOOST_CATCH(...)
+    {
+        // less threads are used
+    }
+    BOOST_CATCH_END
+
+    worker();
+
+    for ( std::future<void> & fut : futures )
+        fut.wait();
+
+    if ( exception )
+        std::rethrow_exception(exception);
+}
+
+}}}} // namespace boost::geometry::index::detail
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_PARALLEL_HPP
@@ -116,6 +116,76 @@ struct path
     std::size_t count;
 };
 
+template <typename PointOrRelation, typename Distance>
+struct bounded_nearest
+{
+    bounded_nearest()
+//        : count(0)
+    {}
+    bounded_nearest(PointOrRelation const& por, std::size_t k, Distance const& d)
+        : point_or_relation(por)
+        , count(k)
+        , max_distance(d)
+    {}
+    PointOrRelation point_or_relation;
+    std::size_t count;
+    Distance max_distance;
+};
+
+// ------------------------------------------------------------------ //
+
+template <typename Geometry, typename Distance>
+struct within_distance
+{
+    within_distance()
+    {}
+    within_distance(Geometry const& g, Distance const& d)
+        : geometry(g)
+        , max_distance(d)
+    {}
+    Geometry geometry;
+    Distance max_distance;
+};
+
+// ------------------------------------------------------------------ //
+
+// The predicates with the maximum distance converted into the comparable
+// distances of the strategy of the tree, for boxes of nodes and for indexables.
+// They're created once per query, see comparable_bounds_predicates.
+
+template <typename PointOrRelation, typename BoundsDistance, typename ValueDistance>
+struct bounded_comparable_nearest
+{
+    bounded_comparable_nearest()
+    {}
+    bounded_comparable_nearest(PointOrRelation const& por, std::size_t k,
+                               BoundsDistance const& bd, ValueDistance const& vd)
+        : point_or_relation(por)
+        , count(k)
+        , bounds_max_distance(bd)
+        , value_max_distance(vd)
+    {}
+    PointOrRelation point_or_relation;
+    std::size_t count;
+    BoundsDistance bounds_max_distance;
+    ValueDistance value_max_distance;
+};
+
+template <typename Geometry, typename BoundsDistance, typename ValueDistance>
+struct within_comparable_distance
+{
+    within_comparable_distance()
+    {}
+    within_comparable_distance(Geometry const& g, BoundsDistance const& bd, ValueDistance const& vd)
+        : geometry(g)
+        , bounds_max_distance(bd)
+        , value_max_distance(vd)
+    {}
+    Geometry geometry;
+    BoundsDistance bounds_max_distance;
+    ValueDistance value_max_distance;
+};
+
 } // namespace predicates
 
 // ------------------------------------------------------------------ //
@@ -314,6 +384,27 @@ struct predicate_check<predicates::nearest<DistancePredicates>, value_tag>
     }
 };
 
+template <typename PointOrRelation, typename Distance>
+struct predicate_check<predicates::bounded_nearest<PointOrRelation, Distance>, value_tag>
+{
+    template <typename Value, typename Box, typename Strategy>
+    static inline bool apply(predicates::bounded_nearest<PointOrRelation, Distance> const&, Value const&, Box const&, Strategy const&)
+    {
+        return true;
+    }
+};
+
+template <typename PointOrRelation, typename BoundsDistance, typename ValueDistance>
+struct predicate_check<predicates::bounded_comparable_nearest<PointOrRelation, BoundsDistance, ValueDistance>, value_tag>
+{
+    template <typename Value, typename Box, typename Strategy>
+    static inline bool apply(predicates::bounded_comparable_nearest<PointOrRelation, BoundsDistance, ValueDistance> const&,
+                             Value const&, Box const&, Strategy const&)
+    {
+        return true;
+    }
+};
+
 template <typename Linestring>
 struct predicate_check<predicates::path<Linestring>, value_tag>
 {
@@ -506,6 +597,27 @@ struct predicate_check<predicates::nearest<DistancePredicates>, bounds_tag>
     }
 };
 
+template <typename PointOrRelation, typename Distance>
+struct predicate_check<predicates::bounded_nearest<PointOrRelation, Distance>, bounds_tag>
+{
+    template <typename Value, typename Box, typename Strategy>
+    static inline bool apply(predicates::bounded_nearest<PointOrRelation, Distance> const&, Value const&, Box const&, Strategy const&)
+    {
+        return true;
+    }
+};
+
+template <typename PointOrRelation, typename BoundsDistance, typename ValueDistance>
+struct predicate_check<predicates::bounded_comparable_nearest<PointOrRelation, BoundsDistance, ValueDistance>, bounds_tag>
+{
+    template <typename Value, typename Box, typename Strategy>
+    static inline bool apply(predicates::bounded_comparable_nearest<PointOrRelation, BoundsDistance, ValueDistance> const&,
+                             Value const&, Box const&, Strategy const&)
+    {
+        return true;
+    }
+};
+
 template <typename Linestring>
 struct predicate_check<predicates::path<Linestring>, bounds_tag>
 {
@@ -649,6 +761,18 @@ struct predicates_is_distance< predicates::nearest<DistancePredicates> >
     static const std::size_t value = 1;
 };
 
+template <typename DistancePredicates, typename Distance>
+struct predicates_is_distance< predicates::bounded_nearest<DistancePredicates, Distance> >
+{
+    static const std::size_t value = 1;
+};
+
+template <typename DistancePredicates, typename BoundsDistance, typename ValueDistance>
+struct predicates_is_distance< predicates::bounded_comparable_nearest<DistancePredicates, BoundsDistance, ValueDistance> >
+{
+    static const std::size_t value = 1;
+};
+
 template <typename Linestring>
 struct predicates_is_distance< predicates::path<Linestring> >
 {
@@ -0,0 +1,572 @@
+// Boost.Geometry Index
+//
+// R-tree flat layout packed in external memory
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_EXTERNAL_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_EXTERNAL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/algorithms/centroid.hpp>
+#include <boost/geometry/core/point_type.hpp>
+#include <boost/geometry/geometries/box.hpp>
+
+#include <boost/geometry/index/detail/algorithms/bounds.hpp>
+#include <boost/geometry/index/detail/algorithms/hilbert_key.hpp>
+#include <boost/geometry/index/detail/exception.hpp>
+#include <boost/geometry/index/detail/rtree/flat_layout.hpp>
+#include <boost/geometry/index/detail/rtree/pack_hilbert.hpp>
+#include <boost/geometry/index/parameters.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+namespace flat {
+
+// The packing of the flat layout in external memory
+//
+// The values are read from the input range once and stored in chunks in a
+// temporary file while the bounds of their centroids are calculated. Then each
+// chunk is sorted by the Hilbert keys of the centroids and stored as a sorted
+// run. The runs are merged and the sorted values are passed to the writer
+// which creates the nodes the same way pack_hilbert does. The structure of the
+// tree depends only on the number of values so the nodes are written before
+// the values and the values are written directly to the output stream. The
+// boxes of the nodes are calculated while the values are passed and stored in
+// temporary files, one per level. They are written at the end.
+// If all values fit in memory they are sorted in memory and only the boxes
+// are stored in temporary files.
+
+inline std::string default_temp_directory()
+{
+    char const* const variables[] = { "TMPDIR", "TMP", "TEMP" };
+    for ( char const* variable : variables )
+    {
+        char const* const directory = std::getenv(variable);
+        if ( directory && *directory )
+            return directory;
+    }
+#ifdef _WIN32
+    return ".";
+#else
+    return "/tmp";
+#endif
+}
+
+// The temporary file removed when destroyed.
+class temp_file
+{
+    temp_file(temp_file const&);
+    temp_file & operator=(temp_file const&);
+
+public:
+    explicit temp_file(std::string const& directory)
+    {
+        static std::atomic<unsigned int> counter(0);
+        std::random_device random;
+
+        std::ostringstream name;
+        name << directory << "/bgi-flat-" << std::hex << random() << random() << '-' << counter++ << ".tmp";
+        m_path = name.str();
+
+        m_stream.open(m_path.c_str(), std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+        if ( ! m_stream )
+        {
+            throw_runtime_error("boost::geometry::index::rtree flat layout temporary file creation failed");
+        }
+    }
+
+    ~temp_file()
+    {
+        m_stream.close();
+        std::remove(m_path.c_str());
+    }
+
+    template <typename T>
+    void write(T const* data, std::size_t count)
+    {
+        m_stream.write(reinterpret_cast<char const*>(data), std::streamsize(count * sizeof(T)));
+        if ( ! m_stream )
+        {
+            throw_runtime_error("boost::geometry::index::rtree flat layout temporary file writing failed");
+        }
+    }
+
+    template <typename T>
+    void read(T * data, std::size_t count)
+    {
+        m_stream.read(reinterpret_cast<char *>(data), std::streamsize(count * sizeof(T)));
+        if ( ! m_stream )
+        {
+            throw_runtime_error("boost::geometry::index::rtree flat layout temporary file reading failed");
+        }
+    }
+
+    // sets the position of the next read or write
+    void seek(std::uint64_t offset)
+    {
+        m_stream.seekg(std::streamoff(offset));
+        if ( ! m_stream )
+        {
+            throw_runtime_error("boost::geometry::index::rtree flat layout temporary file reading failed");
+        }
+    }
+
+private:
+    std::string m_path;
+    std::fstream m_stream;
+};
+
+// Writes the flat layout of the tree created from the values passed one by one
+// in the order of leafs.
+template <typename Value, typename Box, typename IndexableGetter, typename Strategy>
+class packed_writer
+{
+    typedef typename geometry::coordinate_type<Box>::type coordinate_type;
+    static const std::size_t dimension = geometry::dimension<Box>::value;
+    // the number of values or nodes written at once
+    static const std::size_t block_size = 4096;
+
+    // the node of a level currently filled with children or values
+    struct level_state
+    {
+        level_state()
+            : index(0), count(0), initialized(false)
+        {}
+
+        std::uint64_t index;
+        std::uint64_t count;
+        bool initialized;
+        Box box;
+    };
+
+public:
+    packed_writer(std::ostream & os, std::uint64_t values_count, std::uint64_t max_elements,
+                  IndexableGetter const& getter, Strategy const& strategy,
+                  std::string const& temp_directory)
+        : m_os(os)
+        , m_begin(os.tellp())
+        , m_getter(getter)
+        , m_strategy(strategy)
+        , m_values_count(values_count)
+        , m_pushed_count(0)
+    {
+        // the numbers of nodes of each level, from the root to the leafs
+        if ( values_count > 0 )
+        {
+            std::uint64_t count = (values_count + max_elements - 1) / max_elements;
+            m_sizes.push_back(count);
+            while ( count > 1 )
+            {
+                count = (count + max_elements - 1) / max_elements;
+                m_sizes.push_back(count);
+            }
+            std::reverse(m_sizes.begin(), m_sizes.end());
+        }
+
+        std::uint64_t nodes_count = 0;
+        for ( std::uint64_t size : m_sizes )
+        {
+            m_starts.push_back(nodes_count);
+            nodes_count += size;
+        }
+
+        std::memset(&m_header, 0, sizeof(header));
+        m_header.magic = magic;
+        m_header.version = version;
+        m_header.value_size = std::uint32_t(sizeof(Value));
+        m_header.box_size = std::uint32_t(sizeof(Box));
+        m_header.quantization_bits = 0;
+        m_header.leafs_level = m_sizes.empty() ? 0 : m_sizes.size() - 1;
+        m_header.values_count = values_count;
+        m_header.nodes_count = nodes_count;
+        m_header.nodes_offset = aligned(sizeof(header));
+        m_header.bounds_offset = aligned(m_header.nodes_offset + nodes_count * sizeof(node));
+        m_header.quantized_bounds_offset = aligned(m_header.bounds_offset
+                                                 + nodes_count * 2 * dimension * sizeof(coordinate_type));
+        m_header.values_offset = m_header.quantized_bounds_offset;
+        m_header.size = m_header.values_offset + values_count * sizeof(Value);
+
+        // the layout is written at the current position and the offsets are relative to it
+        if ( m_begin == std::streampos(-1) )
+        {
+            throw_runtime_error("boost::geometry::index::rtree flat layout writing failed");
+        }
+
+        m_levels.resize(m_sizes.size());
+        for ( std::size_t i = 1 ; i < m_sizes.size() ; ++i )
+        {
+            m_boxes_files.emplace_back(new temp_file(temp_directory));                  // MAY THROW
+        }
+
+        write_header_and_nodes();
+    }
+
+    void push(Value const& v)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(m_pushed_count < m_values_count, "unexpected number of values");
+
+        m_values.push_back(v);
+        if ( m_values.size() == block_size )
+        {
+            write_array(m_os, m_values.data(), m_values.size());
+            m_values.clear();
+        }
+        ++m_pushed_count;
+
+        add_to_node(m_sizes.size() - 1, m_getter(v));
+    }
+
+    void finish()
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(m_pushed_count == m_values_count, "unexpected number of values");
+
+        write_array(m_os, m_values.data(), m_values.size());
+        m_values.clear();
+
+        // the box of the root and the boxes of the children of each node, level by level
+        m_os.seekp(m_begin + std::streamoff(m_header.bounds_offset));
+        if ( ! m_sizes.empty() )
+        {
+            coordinate_type root[2 * dimension];
+            soa_box<Box>::store(m_root_box, root, 1, 0);
+            write_array(m_os, root, 2 * dimension);
+        }
+
+        std::vector<coordinate_type> boxes;
+        std::vector<coordinate_type> group;
+        for ( std::size_t level = 1 ; level < m_sizes.size() ; ++level )
+        {
+            temp_file & file = *m_boxes_files[level - 1];
+            file.seek(0);
+            for ( std::uint64_t i = 0 ; i < m_sizes[level - 1] ; ++i )
+            {
+                std::uint64_t const count = children_count(level - 1, i);
+                boxes.resize(count * 2 * dimension);
+                group.resize(count * 2 * dimension);
+                file.read(boxes.data(), boxes.size());
+                for ( std::uint64_t j = 0 ; j < count ; ++j )
+                {
+                    for ( std::size_t c = 0 ; c < 2 * dimension ; ++c )
+                    {
+                        group[c * count + j] = boxes[j * 2 * dimension + c];
+                    }
+                }
+                write_array(m_os, group.data(), group.size());
+            }
+        }
+
+        m_os.seekp(m_begin + std::streamoff(m_header.size));
+        if ( ! m_os )
+        {
+            throw_runtime_error("boost::geometry::index::rtree flat layout writing failed");
+        }
+    }
+
+private:
+    // the number of children or values of the i-th node of the level
+    std::uint64_t children_count(std::size_t level, std::uint64_t i) const
+    {
+        std::uint64_t const count = level + 1 < m_sizes.size() ? m_sizes[level + 1] : m_values_count;
+        std::uint64_t const nodes = m_sizes[level];
+        return count / nodes + (i < count % nodes ? 1 : 0);
+    }
+
+    // the index of the first child or value of the i-th node of the level
+    std::uint64_t first_child(std::size_t level, std::uint64_t i) const
+    {
+        std::uint64_t const count = level + 1 < m_sizes.size() ? m_sizes[level + 1] : m_values_count;
+        std::uint64_t const nodes = m_sizes[level];
+        std::uint64_t const first = i * (count / nodes) + (std::min)(i, count % nodes);
+        return level + 1 < m_sizes.size() ? m_starts[level + 1] + first : first;
+    }
+
+    // The header and the nodes are written at once. The space for the boxes
+    // is filled with zeros, the boxes are written by finish().
+    void write_header_and_nodes()
+    {
+        write_array(m_os, &m_header, 1);
+        write_padding(m_os, sizeof(header), m_header.nodes_offset);
+
+        std::vector<node> nodes;
+        nodes.reserve(block_size);
+        for ( std::size_t level = 0 ; level < m_sizes.size() ; ++level )
+        {
+            for ( std::uint64_t i = 0 ; i < m_sizes[level] ; ++i )
+            {
+                nodes.push_back(node{ first_child(level, i), children_count(level, i) });
+                if ( nodes.size() == block_size )
+                {
+                    write_array(m_os, nodes.data(), nodes.size());
+                    nodes.clear();
+                }
+            }
+        }
+        write_array(m_os, nodes.data(), nodes.size());
+
+        std::uint64_t offset = m_header.nodes_offset + m_header.nodes_count * sizeof(node);
+        write_padding(m_os, offset, m_header.bounds_offset);
+        std::vector<char> const zeros(block_size * alignment, 0);
+        for ( offset = m_header.bounds_offset ; offset < m_header.values_offset ; )
+        {
+            std::uint64_t const size = (std::min)(std::uint64_t(zeros.size()), m_header.values_offset - offset);
+            write_array(m_os, zeros.data(), std::size_t(size));
+            offset += size;
+        }
+
+        if ( ! m_os )
+        {
+            throw_runtime_error("boost::geometry::index::rtree flat layout writing failed");
+        }
+    }
+
+    // Expands the box of the node currently filled at the level. If the node
+    // is full its box is stored and added to its parent.
+    template <typename Indexable>
+    void add_to_node(std::size_t level, Indexable const& indexable)
+    {
+        level_state & state = m_levels[level];
+        if ( state.initialized )
+        {
+            index::detail::expand(state.box, indexable, m_strategy);
+        }
+        else
+        {
+            index::detail::bounds(indexable, state.box, m_strategy);
+            state.initialized = true;
+        }
+
+        if ( ++state.count < children_count(level, state.index) )
+        {
+            return;
+        }
+
+        Box const box = state.box;
+        ++state.index;
+        state.count = 0;
+        state.initialized = false;
+
+        if ( level == 0 )
+        {
+            m_root_box = box;
+        }
+        else
+        {
+            coordinate_type coordinates[2 * dimension];
+            soa_box<Box>::store(box, coordinates, 1, 0);
+            m_boxes_files[level - 1]->write(coordinates, 2 * dimension);                // MAY THROW
+            add_to_node(level - 1, box);
+        }
+    }
+
+    std::ostream & m_os;
+    std::streampos m_begin;
+    IndexableGetter const& m_getter;
+    Strategy const& m_strategy;
+
+    std::uint64_t m_values_count;
+    std::uint64_t m_pushed_count;
+    std::vector<std::uint64_t> m_sizes;
+    std::vector<std::uint64_t> m_starts;
+    header m_header;
+
+    std::vector<Value> m_values;
+    std::vector<level_state> m_levels;
+    std::vector<std::unique_ptr<temp_file> > m_boxes_files;
+    Box m_root_box;
+};
+
+template <typename Value, typename Box, typename Parameters, typename IndexableGetter, typename InIt>
+inline void write_external(InIt first, InIt last, std::ostream & os,
+                           Parameters const& parameters, IndexableGetter const& getter,
+                           std::size_t memory_limit, std::string const& temp_directory)
+{
+    BOOST_GEOMETRY_STATIC_ASSERT((is_storable<Value>::value),
+        "The Value stored in the flat layout must be trivially copy constructible and destructible.",
+        Value);
+
+    typedef typename geometry::point_type<Box>::type point_type;
+    typedef geometry::model::box<point_type> centroids_box_type;
+    typedef std::pair<std::uint64_t, Value> entry_type;
+    typedef std::vector<entry_type> entries_type;
+
+    typedef typename index::detail::strategy_type<Parameters>::type strategy_type;
+    strategy_type const& strategy = index::detail::get_strategy(parameters);
+
+    std::string const directory = temp_directory.empty() ? default_temp_directory() : temp_directory;
+
+    // the values, the entries and the buffer of the radix sort of a chunk fit in the memory limit
+    std::size_t const chunk_capacity = (std::max)(memory_limit / (sizeof(Value) + 2 * sizeof(entry_type)),
+                                                  std::size_t(1));
+
+    // read the values, storing all chunks but the last one in a temporary file
+    std::vector<Value> chunk;
+    chunk.reserve(chunk_capacity);                                                      // MAY THROW (A)
+    std::vector<std::size_t> chunks_sizes;
+    std::unique_ptr<temp_file> chunks_file;
+    std::uint64_t values_count = 0;
+    centroids_box_type centroids_box;
+    for ( ; first != last ; ++first )
+    {
+        typename std::iterator_traits<InIt>::reference in_ref = *first;
+        chunk.push_back(in_ref);                                                        // MAY THROW (A)
+
+        point_type pt;
+        geometry::centroid(getter(chunk.back()), pt, strategy);
+        if ( values_count == 0 )
+            index::detail::bounds(pt, centroids_box, strategy);
+        else
+            index::detail::expand(centroids_box, pt, strategy);
+        ++values_count;
+
+        if ( chunk.size() == chunk_capacity )
+        {
+            if ( ! chunks_file )
+                chunks_file.reset(new temp_file(directory));                            // MAY THROW
+            chunks_file->write(chunk.data(), chunk.size());                             // MAY THROW
+            chunks_sizes.push_back(chunk.size());
+            chunk.clear();
+        }
+    }
+
+    packed_writer<Value, Box, IndexableGetter, strategy_type>
+        writer(os, values_count, parameters.get_max_elements(), getter, strategy, directory);
+    if ( values_count == 0 )
+    {
+        writer.finish();
+        return;
+    }
+
+    detail::hilbert_key<point_type> const key(centroids_box);
+    entries_type entries;
+    entries_type buffer;
+    auto sort_chunk = [&]()
+    {
+        entries.clear();
+        entries.reserve(chunk.size());
+        for ( Value const& v : chunk )
+        {
+            point_type pt;
+            geometry::centroid(getter(v), pt, strategy);
+            entries.push_back(entry_type(key(pt), v));
+        }
+        pack_utils::radix_sort_by_key(entries, buffer);
+    };
+
+    // all values are in memory
+    if ( ! chunks_file )
+    {
+        sort_chunk();
+        chunk.clear();
+        chunk.shrink_to_fit();
+        for ( entry_type const& e : entries )
+            writer.push(e.second);
+        writer.finish();
+        return;
+    }
+
+    if ( ! chunk.empty() )
+    {
+        chunks_file->write(chunk.data(), chunk.size());                                 // MAY THROW
+        chunks_sizes.push_back(chunk.size());
+    }
+
+    // sort the chunks and store them as sorted runs
+    temp_file runs_file(directory);                                                     // MAY THROW
+    chunks_file->seek(0);
+    for ( std::size_t size : chunks_sizes )
+    {
+        chunk.resize(size);
+        chunks_file->read(chunk.data(), size);                                          // MAY THROW
+        sort_chunk();
+        runs_file.write(entries.data(), entries.size());                                // MAY THROW
+    }
+    chunks_file.reset();
+    chunk = std::vector<Value>();
+    buffer = entries_type();
+    entries = entries_type();
+
+    // merge the runs, each run has a buffer of the same size
+    struct run_type
+    {
+        std::uint64_t next;
+        std::uint64_t last;
+        entries_type entries;
+        std::size_t current;
+    };
+
+    std::size_t const runs_count = chunks_sizes.size();
+    std::size_t const run_capacity = (std::max)(memory_limit / (runs_count * sizeof(entry_type)), std::size_t(1));
+    std::vector<run_type> runs(runs_count);
+
+    auto fill = [&](run_type & run)
+    {
+        std::size_t const count = std::size_t((std::min)(std::uint64_t(run_capacity), run.last - run.next));
+        run.entries.resize(count);
+        runs_file.seek(run.next * sizeof(entry_type));
+        runs_file.read(run.entries.data(), count);                                      // MAY THROW
+        run.next += count;
+        run.current = 0;
+    };
+
+    typedef std::pair<std::uint64_t, std::size_t> head_type;
+    std::priority_queue<head_type, std::vector<head_type>, std::greater<head_type> > heads;
+    std::uint64_t offset = 0;
+    for ( std::size_t i = 0 ; i < runs_count ; ++i )
+    {
+        runs[i].next = offset;
+        runs[i].last = offset + chunks_sizes[i];
+        offset = runs[i].last;
+        fill(runs[i]);
+        heads.push(head_type(runs[i].entries.front().first, i));
+    }
+
+    // the ties are resolved by the index of the run so the order is the same
+    // as the one of the stable sort of all values
+    while ( ! heads.empty() )
+    {
+        std::size_t const i = heads.top().second;
+        heads.pop();
+
+        run_type & run = runs[i];
+        writer.push(run.entries[run.current].second);                                   // MAY THROW
+        if ( ++run.current == run.entries.size() )
+        {
+            if ( run.next == run.last )
+            {
+                run.entries = entries_type();
+                continue;
+            }
+            fill(run);
+        }
+        heads.push(head_type(run.entries[run.current].first, i));
+    }
+
+    writer.finish();
+}
+
+} // namespace flat
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_EXTERNAL_HPP
@@ -0,0 +1,509 @@
+// Boost.Geometry Index
+//
+// R-tree flat, pointer-free layout
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_LAYOUT_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_LAYOUT_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+#include <boost/geometry/core/access.hpp>
+#include <boost/geometry/core/coordinate_dimension.hpp>
+#include <boost/geometry/core/coordinate_type.hpp>
+#include <boost/geometry/core/cs.hpp>
+#include <boost/geometry/core/static_assert.hpp>
+#include <boost/geometry/core/tags.hpp>
+
+#include <boost/geometry/index/detail/exception.hpp>
+#include <boost/geometry/index/detail/predicates.hpp>
+#include <boost/geometry/index/detail/rtree/node/node.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/view.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+namespace flat {
+
+// The layout of the data:
+// header, nodes, bounds, values
+// Nodes are stored in breadth-first order so the children of a node are stored
+// contiguously. The box of the i-th node is the i-th box, the box of the root
+// is the bounding box of all values. An internal node refers to the range of
+// its children in the array of nodes and a leaf to the range of its values in
+// the array of values. Each array starts at the offset aligned to 64 bytes.
+// The boxes of siblings are stored together as a structure of arrays, i.e. the
+// coordinates of the i-th box of the group of count boxes starting at the first
+// box are stored at:
+// (first * 2 * D) + (d * count) + (i - first)       - min coordinate d
+// (first * 2 * D) + ((D + d) * count) + (i - first) - max coordinate d
+// so the boxes of the children of a node may be tested all at once.
+// Optionally the boxes may be quantized. Then only the box of the root is
+// stored in the array of bounds. The boxes of the other nodes are stored in
+// the array of quantized bounds, in the same order, as 8 or 16-bit unsigned
+// integers relative to the decoded box of the parent. The coordinates are
+// rounded outwards so a decoded box always contains the original one.
+
+static const std::uint32_t magic = 0x46494742; // "BGIF"
+static const std::uint32_t version = 3;
+static const std::size_t alignment = 64;
+
+struct header
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t value_size;
+    std::uint32_t box_size;
+    std::uint32_t quantization_bits;
+    std::uint32_t reserved;
+    std::uint64_t leafs_level;
+    std::uint64_t values_count;
+    std::uint64_t nodes_count;
+    std::uint64_t nodes_offset;
+    std::uint64_t bounds_offset;
+    std::uint64_t quantized_bounds_offset;
+    std::uint64_t values_offset;
+    std::uint64_t size;
+};
+
+struct node
+{
+    std::uint64_t first;
+    std::uint64_t count;
+};
+
+// Objects which may be copied byte by byte, e.g. std::pair of such types.
+template <typename T>
+struct is_storable
+    : std::integral_constant
+        <
+            bool,
+            std::is_trivially_copy_constructible<T>::value
+         && std::is_trivially_destructible<T>::value
+        >
+{};
+
+// Stores and loads boxes to and from a group of siblings.
+template <typename Box, std::size_t I = 0, std::size_t D = geometry::dimension<Box>::value>
+struct soa_box
+{
+    typedef typename geometry::coordinate_type<Box>::type coordinate_type;
+
+    static inline void store(Box const& b, coordinate_type * group, std::size_t count, std::size_t i)
+    {
+        group[I * count + i] = geometry::get<min_corner, I>(b);
+        group[(D + I) * count + i] = geometry::get<max_corner, I>(b);
+        soa_box<Box, I + 1, D>::store(b, group, count, i);
+    }
+
+    static inline void load(Box & b, coordinate_type const* group, std::size_t count, std::size_t i)
+    {
+        geometry::set<min_corner, I>(b, group[I * count + i]);
+        geometry::set<max_corner, I>(b, group[(D + I) * count + i]);
+        soa_box<Box, I + 1, D>::load(b, group, count, i);
+    }
+};
+
+template <typename Box, std::size_t D>
+struct soa_box<Box, D, D>
+{
+    typedef typename geometry::coordinate_type<Box>::type coordinate_type;
+
+    static inline void store(Box const&, coordinate_type *, std::size_t, std::size_t) {}
+    static inline void load(Box &, coordinate_type const*, std::size_t, std::size_t) {}
+};
+
+// Encodes a coordinate as an integer relative to the range [pmin, pmax]
+// of the parent and decodes it.
+template <typename Coordinate, typename Int>
+struct quantizer
+{
+    static const Int max_value = (std::numeric_limits<Int>::max)();
+
+    static inline Coordinate decode(Int q, Coordinate pmin, Coordinate pmax)
+    {
+        return q == max_value
+             ? pmax
+             : pmin + (pmax - pmin) * Coordinate(q) / Coordinate(max_value);
+    }
+
+    // The greatest integer decoded to a value not greater than c.
+    static inline Int encode_min(Coordinate c, Coordinate pmin, Coordinate pmax)
+    {
+        // all integers are decoded to the same value
+        if ( ! (pmin < pmax) )
+            return c < pmin ? Int(0) : max_value;
+
+        // the estimate is off by at most a few units due to the rounding errors,
+        // the range around it is widened only if it doesn't contain the result
+        Int const q = estimate(std::floor(ratio(c, pmin, pmax)));
+        Int lo = q > Int(2) ? Int(q - 2) : Int(0);
+        Int hi = q < Int(max_value - 2) ? Int(q + 2) : max_value;
+        if ( decode(lo, pmin, pmax) > c )
+            lo = 0;
+        if ( hi < max_value && decode(Int(hi + 1), pmin, pmax) <= c )
+            hi = max_value;
+
+        // decode() is non-decreasing
+        while ( lo < hi )
+        {
+            Int const mid = Int(hi - (hi - lo) / 2);
+            if ( decode(mid, pmin, pmax) <= c )
+                lo = mid;
+            else
+                hi = Int(mid - 1);
+        }
+        return lo;
+    }
+
+    // The smallest integer decoded to a value not smaller than c.
+    static inline Int encode_max(Coordinate c, Coordinate pmin, Coordinate pmax)
+    {
+        // all integers are decoded to the same value
+        if ( ! (pmin < pmax) )
+            return c > pmax ? max_value : Int(0);
+
+        Int const q = estimate(std::ceil(ratio(c, pmin, pmax)));
+        Int lo = q > Int(2) ? Int(q - 2) : Int(0);
+        Int hi = q < Int(max_value - 2) ? Int(q + 2) : max_value;
+        if ( decode(hi, pmin, pmax) < c )
+            hi = max_value;
+        if ( lo > 0 && decode(Int(lo - 1), pmin, pmax) >= c )
+            lo = 0;
+
+        while ( lo < hi )
+        {
+            Int const mid = Int(lo + (hi - lo) / 2);
+            if ( decode(mid, pmin, pmax) >= c )
+                hi = mid;
+            else
+                lo = Int(mid + 1);
+        }
+        return hi;
+    }
+
+private:
+    static inline Coordinate ratio(Coordinate c, Coordinate pmin, Coordinate pmax)
+    {
+        return pmin < pmax
+             ? (c - pmin) / (pmax - pmin) * Coordinate(max_value)
+             : Coordinate(0);
+    }
+
+    static inline Int estimate(Coordinate r)
+    {
+        return r <= Coordinate(0) ? Int(0)
+             : r >= Coordinate(max_value) ? max_value
+             : Int(r);
+    }
+};
+
+// Decodes quantized boxes [first, first + n) of a group of siblings relative to the
+// box of their parent defined by its min and max coordinates. The result is written
+// to the structure of arrays of n boxes.
+template <std::size_t D, typename Int, typename Coordinate>
+inline void soa_decode(Int const* group, std::size_t count, std::size_t first, std::size_t n,
+                       Coordinate const* min, Coordinate const* max, Coordinate * result)
+{
+    typedef quantizer<Coordinate, Int> quantizer_type;
+
+    for ( std::size_t d = 0 ; d < D ; ++d )
+    {
+        Int const* mins = group + d * count + first;
+        Int const* maxs = group + (D + d) * count + first;
+        Coordinate * result_mins = result + d * n;
+        Coordinate * result_maxs = result + (D + d) * n;
+        for ( std::size_t i = 0 ; i < n ; ++i )
+        {
+            result_mins[i] = quantizer_type::decode(mins[i], min[d], max[d]);
+            result_maxs[i] = quantizer_type::decode(maxs[i], min[d], max[d]);
+        }
+    }
+}
+
+// Tests boxes [first, first + n) of a group of siblings against a box defined by
+// its min and max coordinates. The result is written to hits.
+// The loops are simple enough to be vectorized by the compiler.
+template <std::size_t D, typename Coordinate>
+inline void soa_intersects(Coordinate const* group, std::size_t count, std::size_t first, std::size_t n,
+                           Coordinate const* min, Coordinate const* max, unsigned char * hits)
+{
+    for ( std::size_t i = 0 ; i < n ; ++i )
+        hits[i] = 1;
+
+    for ( std::size_t d = 0 ; d < D ; ++d )
+    {
+        Coordinate const* mins = group + d * count + first;
+        Coordinate const* maxs = group + (D + d) * count + first;
+        Coordinate const qmin = min[d];
+        Coordinate const qmax = max[d];
+        for ( std::size_t i = 0 ; i < n ; ++i )
+            hits[i] &= (unsigned char)((mins[i] <= qmax) & (maxs[i] >= qmin));
+    }
+}
+
+// Predicates for which the boxes of the children are tested using soa_intersects().
+template <typename Predicates, typename Box>
+struct is_soa_intersects
+    : std::false_type
+{};
+
+template <typename Geometry, typename Box>
+struct is_soa_intersects
+    <
+        index::detail::predicates::spatial_predicate
+            <
+                Geometry, index::detail::predicates::intersects_tag, false
+            >,
+        Box
+    >
+    : std::integral_constant
+        <
+            bool,
+            std::is_same<typename geometry::tag<Geometry>::type, box_tag>::value
+         && std::is_same<typename geometry::cs_tag<Geometry>::type, cartesian_tag>::value
+         && std::is_same<typename geometry::cs_tag<Box>::type, cartesian_tag>::value
+         && std::is_same
+                <
+                    typename geometry::coordinate_type<Geometry>::type,
+                    typename geometry::coordinate_type<Box>::type
+                >::value
+         && geometry::dimension<Geometry>::value == geometry::dimension<Box>::value
+        >
+{};
+
+inline std::uint64_t aligned(std::uint64_t offset)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// Collects the nodes and boxes of the tree in breadth-first order.
+template <typename MembersHolder>
+class collect_nodes
+    : public MembersHolder::visitor_const
+{
+    typedef typename MembersHolder::box_type box_type;
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+    typedef typename MembersHolder::node_pointer node_pointer;
+
+public:
+    collect_nodes()
+        : values_count(0)
+    {}
+
+    inline void operator()(internal_node const& n)
+    {
+        auto const& elements = rtree::elements(n);
+        nodes.push_back(node{ std::uint64_t(queue.size()), std::uint64_t(elements.size()) });
+        for ( auto const& p : elements )
+        {
+            queue.push_back(p.second);
+            boxes.push_back(p.first);
+        }
+    }
+
+    inline void operator()(leaf const& n)
+    {
+        auto const& elements = rtree::elements(n);
+        nodes.push_back(node{ values_count, std::uint64_t(elements.size()) });
+        values_count += elements.size();
+        leafs.push_back(&n);
+    }
+
+    std::vector<node_pointer> queue;
+    std::vector<node> nodes;
+    std::vector<box_type> boxes;
+    std::vector<leaf const*> leafs;
+    std::uint64_t values_count;
+};
+
+template <typename T>
+inline void write_array(std::ostream & os, T const* data, std::size_t count)
+{
+    os.write(reinterpret_cast<char const*>(data), std::streamsize(count * sizeof(T)));
+}
+
+inline void write_padding(std::ostream & os, std::uint64_t from, std::uint64_t to)
+{
+    static const char zeros[alignment] = {};
+    os.write(zeros, std::streamsize(to - from));
+}
+
+// Quantizes the boxes of the nodes other than the root. The boxes of the
+// children of a node are encoded relative to the decoded box of the node.
+template <typename Int, typename Nodes, typename Boxes>
+inline std::vector<Int> quantize(Nodes const& nodes, std::size_t internal_nodes_count, Boxes const& boxes)
+{
+    typedef typename Boxes::value_type box_type;
+    typedef typename geometry::coordinate_type<box_type>::type coordinate_type;
+    typedef quantizer<coordinate_type, Int> quantizer_type;
+    static const std::size_t dimension = geometry::dimension<box_type>::value;
+
+    std::vector<Int> result(boxes.size() * 2 * dimension, Int(0));
+    std::vector<coordinate_type> decoded(boxes.size() * 2 * dimension);
+    if ( ! boxes.empty() )
+    {
+        soa_box<box_type>::store(boxes[0], decoded.data(), 1, 0);
+    }
+
+    coordinate_type box[2 * dimension];
+    for ( std::size_t j = 0 ; j < internal_nodes_count ; ++j )
+    {
+        std::uint64_t const first = nodes[j].first;
+        std::uint64_t const count = nodes[j].count;
+        coordinate_type const* parent = decoded.data() + j * 2 * dimension;
+        Int * group = result.data() + first * 2 * dimension;
+        for ( std::uint64_t i = 0 ; i < count ; ++i )
+        {
+            soa_box<box_type>::store(boxes[first + i], box, 1, 0);
+            coordinate_type * child = decoded.data() + (first + i) * 2 * dimension;
+            for ( std::size_t d = 0 ; d < dimension ; ++d )
+            {
+                coordinate_type const pmin = parent[d];
+                coordinate_type const pmax = parent[dimension + d];
+                Int const qmin = quantizer_type::encode_min(box[d], pmin, pmax);
+                Int const qmax = quantizer_type::encode_max(box[dimension + d], pmin, pmax);
+                group[d * count + i] = qmin;
+                group[(dimension + d) * count + i] = qmax;
+                child[d] = quantizer_type::decode(qmin, pmin, pmax);
+                child[dimension + d] = quantizer_type::decode(qmax, pmin, pmax);
+            }
+        }
+    }
+
+    return result;
+}
+
+template <typename Rtree>
+inline void write(Rtree const& tree, std::ostream & os, unsigned int quantization_bits = 0)
+{
+    typedef utilities::view<Rtree> view_type;
+    typedef typename view_type::members_holder members_holder;
+    typedef typename view_type::value_type value_type;
+    typedef typename view_type::box_type box_type;
+
+    BOOST_GEOMETRY_STATIC_ASSERT((is_storable<value_type>::value),
+        "The Value stored in the flat layout must be trivially copy constructible and destructible.",
+        value_type);
+
+    typedef typename geometry::coordinate_type<box_type>::type coordinate_type;
+    static const std::size_t dimension = geometry::dimension<box_type>::value;
+
+    if ( quantization_bits != 0
+      && ( ( quantization_bits != 8 && quantization_bits != 16 )
+        || ! std::is_floating_point<coordinate_type>::value
+        || ! std::is_same<typename geometry::cs_tag<box_type>::type, cartesian_tag>::value ) )
+    {
+        throw_invalid_argument("boost::geometry::index::rtree flat layout supports 8 and 16-bit "
+                               "quantization of cartesian boxes with floating point coordinates");
+    }
+
+    view_type rtv(tree);
+
+    collect_nodes<members_holder> collect;
+    if ( ! tree.empty() )
+    {
+        collect.boxes.push_back(tree.bounds());
+        collect.queue.push_back(nullptr); // the root, visited below
+        rtv.apply_visitor(collect);
+        for ( std::size_t i = 1 ; i < collect.queue.size() ; ++i )
+        {
+            rtree::apply_visitor(collect, *collect.queue[i]);
+        }
+    }
+
+    std::size_t const internal_nodes_count = collect.nodes.size() - collect.leafs.size();
+
+    // the box of the root and the boxes of the children of each internal node,
+    // internal nodes are stored before leafs
+    std::vector<coordinate_type> bounds((quantization_bits == 0 ? collect.boxes.size() : 1)
+                                        * 2 * dimension);
+    auto store_group = [&](std::uint64_t first, std::uint64_t count)
+    {
+        coordinate_type * group = bounds.data() + first * 2 * dimension;
+        for ( std::uint64_t i = 0 ; i < count ; ++i )
+        {
+            soa_box<box_type>::store(collect.boxes[first + i], group, count, i);
+        }
+    };
+    if ( collect.boxes.empty() )
+    {
+        bounds.clear();
+    }
+    else
+    {
+        store_group(0, 1);
+    }
+
+    std::vector<std::uint8_t> quantized_bounds8;
+    std::vector<std::uint16_t> quantized_bounds16;
+    if ( quantization_bits == 0 )
+    {
+        for ( std::size_t j = 0 ; j < internal_nodes_count ; ++j )
+        {
+            store_group(collect.nodes[j].first, collect.nodes[j].count);
+        }
+    }
+    else if ( quantization_bits == 8 )
+    {
+        quantized_bounds8 = quantize<std::uint8_t>(collect.nodes, internal_nodes_count, collect.boxes);
+    }
+    else
+    {
+        quantized_bounds16 = quantize<std::uint16_t>(collect.nodes, internal_nodes_count, collect.boxes);
+    }
+    std::uint64_t const quantized_bounds_size = quantized_bounds8.size() * sizeof(std::uint8_t)
+                                              + quantized_bounds16.size() * sizeof(std::uint16_t);
+
+    header h;
+    std::memset(&h, 0, sizeof(header));
+    h.magic = magic;
+    h.version = version;
+    h.value_size = std::uint32_t(sizeof(value_type));
+    h.box_size = std::uint32_t(sizeof(box_type));
+    h.quantization_bits = quantization_bits;
+    h.leafs_level = tree.empty() ? 0 : rtv.depth();
+    h.values_count = collect.values_count;
+    h.nodes_count = collect.nodes.size();
+    h.nodes_offset = aligned(sizeof(header));
+    h.bounds_offset = aligned(h.nodes_offset + h.nodes_count * sizeof(node));
+    h.quantized_bounds_offset = aligned(h.bounds_offset + bounds.size() * sizeof(coordinate_type));
+    h.values_offset = aligned(h.quantized_bounds_offset + quantized_bounds_size);
+    h.size = h.values_offset + h.values_count * sizeof(value_type);
+
+    write_array(os, &h, 1);
+    write_padding(os, sizeof(header), h.nodes_offset);
+    write_array(os, collect.nodes.data(), collect.nodes.size());
+    write_padding(os, h.nodes_offset + h.nodes_count * sizeof(node), h.bounds_offset);
+    write_array(os, bounds.data(), bounds.size());
+    write_padding(os, h.bounds_offset + bounds.size() * sizeof(coordinate_type), h.quantized_bounds_offset);
+    write_array(os, quantized_bounds8.data(), quantized_bounds8.size());
+    write_array(os, quantized_bounds16.data(), quantized_bounds16.size());
+    write_padding(os, h.quantized_bounds_offset + quantized_bounds_size, h.values_offset);
+    for ( auto const* l : collect.leafs )
+    {
+        auto const& elements = rtree::elements(*l);
+        write_array(os, elements.data(), elements.size());
+    }
+
+    if ( ! os )
+    {
+        throw_runtime_error("boost::geometry::index::rtree flat layout writing failed");
+    }
+}
+
+} // namespace flat
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_FLAT_LAYOUT_HPP
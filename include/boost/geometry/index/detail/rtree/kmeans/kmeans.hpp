@@ -1,6 +1,6 @@
 // Boost.Geometry Index
 //
-// R-tree kmeans algorithm implementation
+// R-tree k-means algorithm implementation
 //
 // Copyright (c) 2011-2013 Adam Wulkiewicz, Lodz, Poland.
 //
@@ -15,6 +15,6 @@
 #ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_KMEANS_KMEANS_HPP
 #define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_KMEANS_KMEANS_HPP
 
-#include <boost/geometry/index/detail/rtree/kmeans/split.hpp>
+#include <boost/geometry/index/detail/rtree/kmeans/redistribute_elements.hpp>
 
 #endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_KMEANS_KMEANS_HPP
@@ -0,0 +1,274 @@
+// Boost.Geometry Index
+//
+// R-tree k-means split algorithm implementation
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_KMEANS_REDISTRIBUTE_ELEMENTS_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_KMEANS_REDISTRIBUTE_ELEMENTS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include <boost/geometry/core/access.hpp>
+#include <boost/geometry/core/coordinate_dimension.hpp>
+
+#include <boost/geometry/index/detail/algorithms/bounds.hpp>
+
+#include <boost/geometry/index/detail/rtree/node/node.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/insert.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree {
+
+namespace kmeans {
+
+// The maximum number of iterations of the k-means algorithm.
+static const std::size_t max_iterations = 16;
+
+template <std::size_t I, std::size_t Dimension>
+struct box_center
+{
+    template <typename Box>
+    static inline void apply(Box const& b, double * center)
+    {
+        center[I] = (static_cast<double>(geometry::get<min_corner, I>(b))
+                   + static_cast<double>(geometry::get<max_corner, I>(b))) / 2;
+        box_center<I + 1, Dimension>::apply(b, center);
+    }
+};
+
+template <std::size_t Dimension>
+struct box_center<Dimension, Dimension>
+{
+    template <typename Box>
+    static inline void apply(Box const&, double *)
+    {}
+};
+
+template <std::size_t Dimension>
+inline double comparable_distance(double const* p1, double const* p2)
+{
+    double result = 0;
+    for ( std::size_t d = 0 ; d < Dimension ; ++d )
+    {
+        double const diff = p1[d] - p2[d];
+        result += diff * diff;
+    }
+    return result;
+}
+
+template <std::size_t Dimension>
+inline void mean(double const* centers, std::size_t const* first, std::size_t const* last,
+                 double * result)
+{
+    std::fill(result, result + Dimension, 0.0);
+    for ( std::size_t const* it = first ; it != last ; ++it )
+    {
+        for ( std::size_t d = 0 ; d < Dimension ; ++d )
+        {
+            result[d] += centers[*it * Dimension + d];
+        }
+    }
+    double const count = static_cast<double>(last - first);
+    for ( std::size_t d = 0 ; d < Dimension ; ++d )
+    {
+        result[d] /= count;
+    }
+}
+
+template <std::size_t Dimension>
+inline std::size_t farthest(double const* centers, std::size_t count, double const* point)
+{
+    std::size_t result = 0;
+    double greatest_distance = -1;
+    for ( std::size_t i = 0 ; i < count ; ++i )
+    {
+        double const dist = comparable_distance<Dimension>(centers + i * Dimension, point);
+        if ( greatest_distance < dist )
+        {
+            greatest_distance = dist;
+            result = i;
+        }
+    }
+    return result;
+}
+
+// Clusters count points into two groups with the k-means algorithm. Each group
+// contains at least min_elements points. The indexes of the points are written
+// to order, the first group consists of the points order[0, result) and the
+// second one of order[result, count).
+// The initial means are the point farthest from the mean of all points and
+// the point farthest from it. Then the points are assigned to the closer mean
+// and the means are recalculated until the groups don't change. The points are
+// ordered by the difference of the distances to both means, so if one group
+// would have less than min_elements points the ones closest to it are moved
+// from the other group.
+template <std::size_t Dimension>
+inline std::size_t two_means(double const* centers, std::size_t count,
+                             std::size_t min_elements, std::size_t * order)
+{
+    BOOST_GEOMETRY_INDEX_ASSERT(2 * min_elements <= count, "unexpected number of elements");
+
+    double means[2][Dimension];
+    mean<Dimension>(centers, order, order + count, means[0]);
+    std::size_t const seed1 = farthest<Dimension>(centers, count, means[0]);
+    std::size_t const seed2 = farthest<Dimension>(centers, count, centers + seed1 * Dimension);
+    std::copy(centers + seed1 * Dimension, centers + (seed1 + 1) * Dimension, means[0]);
+    std::copy(centers + seed2 * Dimension, centers + (seed2 + 1) * Dimension, means[1]);
+
+    std::vector<double> keys(count);                                                                    // MAY THROW, STRONG (alloc)
+    std::vector<unsigned char> groups(count, 2);                                                        // MAY THROW, STRONG (alloc)
+    std::size_t result = 0;
+
+    for ( std::size_t iteration = 0 ; iteration < max_iterations ; ++iteration )
+    {
+        std::size_t closer_to_first = 0;
+        for ( std::size_t i = 0 ; i < count ; ++i )
+        {
+            double const* center = centers + i * Dimension;
+            keys[i] = comparable_distance<Dimension>(center, means[0])
+                    - comparable_distance<Dimension>(center, means[1]);
+            if ( keys[i] < 0 )
+            {
+                ++closer_to_first;
+            }
+        }
+
+        std::sort(order, order + count, [&](std::size_t l, std::size_t r)
+        {
+            return keys[l] < keys[r] || ( keys[l] == keys[r] && l < r );
+        });
+
+        result = (std::min)((std::max)(closer_to_first, min_elements), count - min_elements);
+
+        bool changed = false;
+        for ( std::size_t i = 0 ; i < count ; ++i )
+        {
+            unsigned char const group = i < result ? 0 : 1;
+            if ( groups[order[i]] != group )
+            {
+                groups[order[i]] = group;
+                changed = true;
+            }
+        }
+
+        if ( ! changed )
+        {
+            break;
+        }
+
+        mean<Dimension>(centers, order, order + result, means[0]);
+        mean<Dimension>(centers, order + result, order + count, means[1]);
+    }
+
+    return result;
+}
+
+} // namespace kmeans
+
+template <typename MembersHolder>
+struct redistribute_elements<MembersHolder, kmeans_tag>
+{
+    typedef typename MembersHolder::box_type box_type;
+    typedef typename MembersHolder::parameters_type parameters_type;
+    typedef typename MembersHolder::translator_type translator_type;
+    typedef typename MembersHolder::allocators_type allocators_type;
+
+    typedef typename MembersHolder::node node;
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+
+    static const std::size_t dimension = geometry::dimension<box_type>::value;
+
+    template <typename Node>
+    static inline void apply(Node & n,
+                             Node & second_node,
+                             box_type & box1,
+                             box_type & box2,
+                             parameters_type const& parameters,
+                             translator_type const& translator,
+                             allocators_type & allocators)
+    {
+        typedef typename rtree::elements_type<Node>::type elements_type;
+        typedef typename elements_type::value_type element_type;
+
+        typename index::detail::strategy_type<parameters_type>::type const&
+            strategy = index::detail::get_strategy(parameters);
+
+        elements_type & elements1 = rtree::elements(n);
+        elements_type & elements2 = rtree::elements(second_node);
+        const size_t elements1_count = parameters.get_max_elements() + 1;
+
+        BOOST_GEOMETRY_INDEX_ASSERT(elements1.size() == elements1_count, "unexpected number of elements");
+
+        // centers of the boxes of the elements
+        std::vector<double> centers(elements1_count * dimension);                                       // MAY THROW, STRONG (alloc)
+        for ( size_t i = 0 ; i < elements1_count ; ++i )
+        {
+            box_type box;
+            detail::bounds(rtree::element_indexable(elements1[i], translator), box, strategy);
+            kmeans::box_center<0, dimension>::apply(box, centers.data() + i * dimension);
+        }
+
+        std::vector<size_t> order(elements1_count);                                                     // MAY THROW, STRONG (alloc)
+        for ( size_t i = 0 ; i < elements1_count ; ++i )
+        {
+            order[i] = i;
+        }
+        size_t const split_index = kmeans::two_means<dimension>(centers.data(), elements1_count,
+                                                                parameters.get_min_elements(),
+                                                                order.data());                          // MAY THROW, STRONG (alloc)
+
+        // copy original elements - use in-memory storage (std::allocator)
+        // TODO: move if noexcept
+        typedef typename rtree::container_from_elements_type<elements_type, element_type>::type
+            container_type;
+        container_type elements_copy(elements1.begin(), elements1.end());                                   // MAY THROW, STRONG (alloc, copy)
+
+        // prepare nodes' elements containers
+        elements1.clear();
+        BOOST_GEOMETRY_INDEX_ASSERT(elements2.empty(), "unexpected container state");
+
+        BOOST_TRY
+        {
+            for ( size_t i = 0 ; i < elements1_count ; ++i )
+            {
+                element_type const& elem = elements_copy[order[i]];
+                if ( i < split_index )
+                {
+                    elements1.push_back(elem);                                                              // MAY THROW, STRONG (copy)
+                }
+                else
+                {
+                    elements2.push_back(elem);                                                              // MAY THROW, STRONG (alloc, copy)
+                }
+            }
+
+            // calculate boxes
+            box1 = rtree::elements_box<box_type>(elements1.begin(), elements1.end(), translator, strategy);
+            box2 = rtree::elements_box<box_type>(elements2.begin(), elements2.end(), translator, strategy);
+        }
+        BOOST_CATCH(...)
+        {
+            elements1.clear();
+            elements2.clear();
+
+            rtree::destroy_elements<MembersHolder>::apply(elements_copy, allocators);
+            //elements_copy.clear();
+
+            BOOST_RETHROW                                                                                     // RETHROW, BASIC
+        }
+        BOOST_CATCH_END
+    }
+};
+
+}} // namespace detail::rtree
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_KMEANS_REDISTRIBUTE_ELEMENTS_HPP
@@ -17,6 +17,8 @@
 
 #include <boost/geometry/core/static_assert.hpp>
 
+#include <boost/geometry/index/parameters.hpp>
+
 namespace boost { namespace geometry { namespace index {
 
 namespace detail { namespace rtree {
@@ -77,6 +79,21 @@ struct destroy_node
         Allocators, Node);
 };
 
+// The number of values stored in the subtree of an internal node, it's stored
+// only if the parameters are counted<>, see subtree_values_count
+template <typename Parameters, typename SizeType,
+          bool IsCounted = index::detail::is_counted<Parameters>::value>
+struct internal_node_values_count
+{
+    internal_node_values_count() : values_count(0) {}
+
+    SizeType values_count;
+};
+
+template <typename Parameters, typename SizeType>
+struct internal_node_values_count<Parameters, SizeType, false>
+{};
+
 }} // namespace detail::rtree
 
 }}} // namespace boost::geometry::index
@@ -171,6 +171,170 @@ private:
     {}
 };
 
+// The number of values stored in the subtree of a node. If the parameters are
+// counted<> the internal nodes store it and it's updated incrementally by the
+// algorithms modifying the tree, reverse_level is the level of the node storing
+// the elements counted from the leafs. Otherwise the functions updating the
+// counts do nothing, the functions counting the values of elements return 0
+// and get() counts the values traversing the subtree.
+template
+<
+    typename MembersHolder,
+    bool IsCounted = index::detail::is_counted<typename MembersHolder::parameters_type>::value
+>
+struct subtree_values_count
+{
+    typedef typename MembersHolder::value_type value_type;
+    typedef typename MembersHolder::box_type box_type;
+    typedef typename MembersHolder::size_type size_type;
+    typedef typename MembersHolder::node_pointer node_pointer;
+
+    typedef typename MembersHolder::node node;
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+
+    static const bool is_stored = true;
+
+    inline static size_type get(internal_node const& n)
+    {
+        return n.values_count;
+    }
+
+    inline static size_type get(leaf const& n)
+    {
+        return rtree::elements(n).size();
+    }
+
+    inline static size_type element_count(value_type const&, size_type)
+    {
+        return 1;
+    }
+
+    inline static size_type element_count(rtree::ptr_pair<box_type, node_pointer> const& el,
+                                          size_type reverse_level)
+    {
+        return reverse_level > 1
+             ? get(rtree::get<internal_node>(*el.second))
+             : get(rtree::get<leaf>(*el.second));
+    }
+
+    template <typename Elements>
+    inline static size_type elements_count(Elements const& elements, size_type reverse_level)
+    {
+        size_type result = 0;
+        for (auto const& el : elements)
+        {
+            result += element_count(el, reverse_level);
+        }
+        return result;
+    }
+
+    inline static void set(internal_node & n, size_type count)
+    {
+        n.values_count = count;
+    }
+
+    inline static void add(internal_node & n, size_type count)
+    {
+        n.values_count += count;
+    }
+
+    inline static void add(leaf &, size_type)
+    {}
+
+    inline static void subtract(internal_node & n, size_type count)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(count <= n.values_count, "unexpected values count");
+        n.values_count -= count;
+    }
+
+    inline static void subtract(leaf &, size_type)
+    {}
+
+    inline static void copy(internal_node & dst, internal_node const& src)
+    {
+        dst.values_count = src.values_count;
+    }
+
+    // calculates the count from the counts of the children
+    inline static void update(internal_node & n, size_type reverse_level)
+    {
+        n.values_count = elements_count(rtree::elements(n), reverse_level);
+    }
+
+    // moves the counts of the children moved into the other node by the split
+    inline static void split(internal_node & n, internal_node & other, size_type reverse_level)
+    {
+        other.values_count = elements_count(rtree::elements(other), reverse_level);
+        subtract(n, other.values_count);
+    }
+
+    inline static void split(leaf &, leaf &, size_type)
+    {}
+};
+
+template <typename MembersHolder>
+struct subtree_values_count<MembersHolder, false>
+{
+    typedef typename MembersHolder::value_type value_type;
+    typedef typename MembersHolder::box_type box_type;
+    typedef typename MembersHolder::size_type size_type;
+    typedef typename MembersHolder::node_pointer node_pointer;
+
+    typedef typename MembersHolder::node node;
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+
+    static const bool is_stored = false;
+
+    inline static size_type get(internal_node const& n)
+    {
+        size_type result = 0;
+        for (auto const& el : rtree::elements(n))
+        {
+            visitors::is_leaf<MembersHolder> ilv;
+            rtree::apply_visitor(ilv, *el.second);
+            result += ilv.result
+                    ? get(rtree::get<leaf>(*el.second))
+                    : get(rtree::get<internal_node>(*el.second));
+        }
+        return result;
+    }
+
+    inline static size_type get(leaf const& n)
+    {
+        return rtree::elements(n).size();
+    }
+
+    template <typename Element>
+    inline static size_type element_count(Element const&, size_type)
+    {
+        return 0;
+    }
+
+    template <typename Elements>
+    inline static size_type elements_count(Elements const&, size_type)
+    {
+        return 0;
+    }
+
+    template <typename Node>
+    inline static void set(Node &, size_type) {}
+
+    template <typename Node>
+    inline static void add(Node &, size_type) {}
+
+    template <typename Node>
+    inline static void subtract(Node &, size_type) {}
+
+    inline static void copy(internal_node &, internal_node const&) {}
+
+    inline static void update(internal_node &, size_type) {}
+
+    template <typename Node>
+    inline static void split(Node &, Node &, size_type) {}
+};
+
 // clears node, deletes all subtrees stored in node
 /*
 template <typename MembersHolder>
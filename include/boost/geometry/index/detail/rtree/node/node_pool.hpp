@@ -0,0 +1,165 @@
+// Boost.Geometry Index
+//
+// R-tree nodes pool
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_NODE_NODE_POOL_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_NODE_NODE_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+// The pool of memory blocks of sizes up to max_block_size.
+// The blocks are carved out of big chunks and kept in the free lists of blocks
+// of the same size after deallocation. The chunks are released at once when
+// the pool is destroyed.
+// The pool may be used by several threads, e.g. during parallel packing, so
+// the free lists are guarded by a spinlock which is cheap when not contended.
+// The memory of the deallocated blocks is reused but it's not returned to the
+// system before the pool is destroyed, the pool may be shared by many rtrees.
+class node_pool
+{
+    node_pool(node_pool const&);
+    node_pool & operator=(node_pool const&);
+
+    struct free_block
+    {
+        free_block * next;
+    };
+
+    struct chunk
+    {
+        chunk * next;
+    };
+
+    class lock_guard
+    {
+    public:
+        // the thread yields after a few unsuccessful attempts so the thread holding
+        // the lock can finish if there are more threads than cores
+        explicit lock_guard(std::atomic_flag & flag)
+            : m_flag(flag)
+        {
+            for ( std::size_t spins = 0 ; m_flag.test_and_set(std::memory_order_acquire) ; ++spins )
+            {
+                if ( spins >= max_spins )
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        ~lock_guard()
+        {
+            m_flag.clear(std::memory_order_release);
+        }
+
+    private:
+        static const std::size_t max_spins = 16;
+
+        std::atomic_flag & m_flag;
+    };
+
+public:
+    static const std::size_t alignment = alignof(std::max_align_t);
+    static const std::size_t max_block_size = 4096;
+
+    explicit node_pool(std::size_t chunk_size)
+        : m_chunks(nullptr)
+        , m_chunk_size(chunk_size)
+    {
+        m_lock.clear();
+        for ( std::size_t i = 0 ; i < classes_count ; ++i )
+        {
+            m_free_lists[i] = nullptr;
+        }
+    }
+
+    ~node_pool()
+    {
+        while ( m_chunks )
+        {
+            chunk * next = m_chunks->next;
+            ::operator delete(m_chunks);
+            m_chunks = next;
+        }
+    }
+
+    // size must be in range [1, max_block_size]
+    void * allocate(std::size_t size)
+    {
+        std::size_t const index = class_index(size);
+
+        lock_guard lock(m_lock);
+
+        if ( ! m_free_lists[index] )
+        {
+            allocate_chunk(index);                                                  // MAY THROW (alloc)
+        }
+
+        free_block * b = m_free_lists[index];
+        m_free_lists[index] = b->next;
+        return b;
+    }
+
+    void deallocate(void * p, std::size_t size) noexcept
+    {
+        std::size_t const index = class_index(size);
+
+        lock_guard lock(m_lock);
+
+        free_block * b = static_cast<free_block*>(p);
+        b->next = m_free_lists[index];
+        m_free_lists[index] = b;
+    }
+
+private:
+    static const std::size_t classes_count = max_block_size / alignment;
+    // the size of the chunk header preserving the alignment of blocks
+    static const std::size_t header_size = (sizeof(chunk) + alignment - 1) / alignment * alignment;
+
+    static std::size_t class_index(std::size_t size)
+    {
+        return (size + alignment - 1) / alignment - 1;
+    }
+
+    void allocate_chunk(std::size_t index)
+    {
+        std::size_t const block_size = (index + 1) * alignment;
+        std::size_t const blocks_count = m_chunk_size > block_size
+                                       ? m_chunk_size / block_size
+                                       : 1;
+
+        char * const data = static_cast<char*>(::operator new(header_size + blocks_count * block_size));   // MAY THROW (alloc)
+        chunk * const c = reinterpret_cast<chunk*>(data);
+        c->next = m_chunks;
+        m_chunks = c;
+
+        // the blocks are linked in the order of addresses
+        char * const blocks = data + header_size;
+        free_block * head = m_free_lists[index];
+        for ( std::size_t i = blocks_count ; i > 0 ; --i )
+        {
+            free_block * b = reinterpret_cast<free_block*>(blocks + (i - 1) * block_size);
+            b->next = head;
+            head = b;
+        }
+        m_free_lists[index] = head;
+    }
+
+    free_block * m_free_lists[classes_count];
+    chunk * m_chunks;
+    std::size_t m_chunk_size;
+    std::atomic_flag m_lock;
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_NODE_NODE_POOL_HPP
@@ -33,6 +33,7 @@ namespace detail { namespace rtree {
 
 template <typename Value, typename Parameters, typename Box, typename Allocators, typename Tag>
 struct variant_internal_node
+    : internal_node_values_count<Parameters, typename Allocators::size_type>
 {
     typedef rtree::ptr_pair<Box, typename Allocators::node_pointer> element_type;
     typedef typename boost::container::allocator_traits
@@ -36,6 +36,7 @@ struct node_weak_static_tag {};
 template <typename Value, typename Parameters, typename Box, typename Allocators, typename Tag>
 struct weak_internal_node
     : public weak_node<Value, Parameters, Box, Allocators, Tag>
+    , internal_node_values_count<Parameters, typename Allocators::size_type>
 {
     typedef rtree::ptr_pair<Box, typename Allocators::node_pointer> element_type;
     typedef typename boost::container::allocator_traits
@@ -25,6 +25,7 @@ namespace detail { namespace rtree {
 template <typename Value, typename Parameters, typename Box, typename Allocators>
 struct weak_internal_node<Value, Parameters, Box, Allocators, node_weak_static_tag>
     : public weak_node<Value, Parameters, Box, Allocators, node_weak_static_tag>
+    , internal_node_values_count<Parameters, typename Allocators::size_type>
 {
     typedef detail::varray<
         rtree::ptr_pair<Box, typename Allocators::node_pointer>,
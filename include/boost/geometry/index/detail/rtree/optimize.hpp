@@ -0,0 +1,404 @@
+// Boost.Geometry Index
+//
+// R-tree incremental repacking of subtrees
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_OPTIMIZE_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_OPTIMIZE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <vector>
+
+#include <boost/core/addressof.hpp>
+
+#include <boost/geometry/index/detail/algorithms/content.hpp>
+#include <boost/geometry/index/detail/algorithms/intersection_content.hpp>
+#include <boost/geometry/index/detail/rtree/node/node.hpp>
+#include <boost/geometry/index/detail/rtree/pack_create.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/destroy.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+// Repacks the subtrees of a tree degraded by insertions and removals.
+// The internal nodes are rated by the overlap of the boxes of their children
+// relative to the content of their own box. The worst subtrees storing at most
+// max_values values in total are then replaced by subtrees created from their
+// values by the packing algorithm. Only the subtrees for which pack creates
+// a subtree of the same height with at least min elements in its root are
+// considered, so the nodes outside of the repacked subtrees are not modified
+// and the tree stays balanced. The values are copied into a temporary container
+// and the old subtree is destroyed after the new one is created, so the
+// temporary memory is proportional to the size of the greatest repacked subtree.
+//
+// apply() rates all nodes including the root. apply_step() rates only a window
+// of the subtrees at the highest level at which a subtree may store at most
+// max_values values. The window starts at the cursor and stores about
+// scan_factor * max_values values, the cursor is then moved behind the window
+// so the consecutive steps scan the whole tree in a round-robin manner.
+// The root is never repacked by apply_step().
+template <typename MembersHolder>
+class optimize
+{
+    typedef typename MembersHolder::value_type value_type;
+    typedef typename MembersHolder::box_type box_type;
+    typedef typename MembersHolder::parameters_type parameters_type;
+    typedef typename MembersHolder::translator_type translator_type;
+    typedef typename MembersHolder::allocators_type allocators_type;
+
+    typedef typename MembersHolder::node node;
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+
+    typedef typename MembersHolder::node_pointer node_pointer;
+    typedef typename MembersHolder::size_type size_type;
+
+    typedef typename index::detail::strategy_type<parameters_type>::type strategy_type;
+    typedef typename index::detail::default_content_result<box_type>::type content_type;
+
+    typedef rtree::pack<MembersHolder> pack_type;
+
+    // the subtrees are identified by the range of the numbers of their
+    // internal nodes in the pre-order, the ranges of nested subtrees overlap
+    struct candidate
+    {
+        double score;
+        size_type values_count;
+        size_type first;
+        size_type last;
+        size_type reverse_level;
+        node_pointer ptr;
+        internal_node * parent;
+        size_type index;
+    };
+
+    struct candidate_worse
+    {
+        bool operator()(candidate const& l, candidate const& r) const
+        {
+            return l.score > r.score;
+        }
+    };
+
+    // the position of the window in the sequence of the scanned subtrees
+    struct window
+    {
+        size_type ordinal;
+        size_type begin;
+        size_type end;
+        size_type next;
+        size_type scanned_count;
+        size_type scan_limit;
+    };
+
+    static const size_type scan_factor = 4;
+
+public:
+    // Returns the number of repacked values.
+    inline static
+    size_type apply(node_pointer & root,
+                    size_type & leafs_level,
+                    size_type max_values,
+                    parameters_type const& parameters,
+                    translator_type const& translator,
+                    allocators_type & allocators)
+    {
+        if ( !root || leafs_level == 0 )
+            return 0;
+
+        optimize o(parameters, translator, allocators);
+
+        std::vector<candidate> candidates;
+        size_type preorder = 0;
+        o.find_candidates(root, 0, 0, leafs_level, max_values, candidates, preorder);         // MAY THROW (alloc)
+
+        return o.repack_worst(candidates, max_values, root, leafs_level);                     // MAY THROW (V, E: alloc, copy, N: alloc)
+    }
+
+    // Returns the number of repacked values.
+    inline static
+    size_type apply_step(node_pointer & root,
+                         size_type & leafs_level,
+                         size_type & cursor,
+                         size_type max_values,
+                         parameters_type const& parameters,
+                         translator_type const& translator,
+                         allocators_type & allocators)
+    {
+        if ( !root || leafs_level < 2 )
+            return 0;
+
+        // the smallest subtree not being the root at reverse level l stores
+        // at least min^(l+1) values
+        size_type const min_elements = parameters.get_min_elements();
+        size_type scan_level = 0;
+        size_type level_min_count = min_elements;
+        while ( scan_level + 1 < leafs_level && level_min_count <= max_values / min_elements )
+        {
+            level_min_count *= min_elements;
+            ++scan_level;
+        }
+
+        // leafs are never repacked
+        if ( scan_level == 0 )
+            return 0;
+
+        optimize o(parameters, translator, allocators);
+
+        std::vector<candidate> candidates;
+        size_type preorder = 0;
+
+        window w;
+        w.ordinal = 0;
+        w.begin = cursor;
+        w.end = (std::numeric_limits<size_type>::max)();
+        w.next = cursor;
+        w.scanned_count = 0;
+        w.scan_limit = max_values <= w.end / scan_factor ? max_values * scan_factor : w.end;
+        o.scan(root, 0, 0, leafs_level, scan_level, max_values, w, candidates, preorder);    // MAY THROW (alloc)
+
+        // wrap around
+        if ( w.scanned_count < w.scan_limit && 0 < cursor )
+        {
+            w.ordinal = 0;
+            w.begin = 0;
+            w.end = cursor;
+            o.scan(root, 0, 0, leafs_level, scan_level, max_values, w, candidates, preorder); // MAY THROW (alloc)
+        }
+
+        cursor = w.next;
+
+        return o.repack_worst(candidates, max_values, root, leafs_level);                     // MAY THROW (V, E: alloc, copy, N: alloc)
+    }
+
+private:
+    optimize(parameters_type const& parameters,
+             translator_type const& translator,
+             allocators_type & allocators)
+        : m_parameters(parameters)
+        , m_translator(translator)
+        , m_allocators(allocators)
+        , m_strategy(index::detail::get_strategy(parameters))
+    {}
+
+    // Returns false if the end of the window was reached.
+    bool scan(node_pointer ptr, internal_node * parent, size_type index,
+              size_type reverse_level, size_type scan_level, size_type max_values,
+              window & w, std::vector<candidate> & candidates, size_type & preorder) const
+    {
+        if ( reverse_level == scan_level )
+        {
+            size_type const ordinal = w.ordinal++;
+            if ( ordinal < w.begin )
+                return true;
+            if ( w.end <= ordinal || w.scan_limit <= w.scanned_count )
+                return false;
+
+            w.scanned_count += find_candidates(ptr, parent, index, reverse_level, max_values,
+                                               candidates, preorder);                          // MAY THROW (alloc)
+            w.next = ordinal + 1;
+            return true;
+        }
+
+        internal_node & n = rtree::get<internal_node>(*ptr);
+
+        // skip the subtrees before the window
+        if ( reverse_level == scan_level + 1 && w.ordinal + rtree::elements(n).size() <= w.begin )
+        {
+            w.ordinal += rtree::elements(n).size();
+            return true;
+        }
+
+        for ( size_type i = 0 ; i < rtree::elements(n).size() ; ++i )
+        {
+            if ( ! scan(rtree::elements(n)[i].second, boost::addressof(n), i,
+                        reverse_level - 1, scan_level, max_values, w, candidates, preorder) )      // MAY THROW (alloc)
+                return false;
+        }
+
+        return true;
+    }
+
+    // Returns the number of repacked values.
+    size_type repack_worst(std::vector<candidate> & candidates, size_type max_values,
+                           node_pointer & root, size_type & leafs_level) const
+    {
+        std::sort(candidates.begin(), candidates.end(), candidate_worse());
+
+        // the worst subtrees not nested in each other
+        std::vector<candidate> chosen;
+        std::map<size_type, size_type> chosen_ranges;
+        size_type values_count = 0;
+        for ( candidate const& c : candidates )
+        {
+            if ( max_values - values_count < c.values_count )
+                continue;
+
+            typename std::map<size_type, size_type>::iterator it = chosen_ranges.lower_bound(c.first);
+            if ( it != chosen_ranges.end() && it->first < c.last )
+                continue;
+            if ( it != chosen_ranges.begin() && c.first < (--it)->second )
+                continue;
+
+            chosen_ranges[c.first] = c.last;                                                    // MAY THROW (alloc)
+            chosen.push_back(c);                                                                // MAY THROW (alloc)
+            values_count += c.values_count;
+        }
+
+        // the parents and the positions of the chosen subtrees are not changed
+        // by the replacement of the other ones
+        for ( candidate const& c : chosen )
+        {
+            repack(c, root, leafs_level);                                                       // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+
+        return values_count;
+    }
+
+    // Returns the number of values stored in the subtree, the counts are
+    // calculated during the traversal so they don't have to be stored in nodes.
+    size_type find_candidates(node_pointer ptr, internal_node * parent, size_type index,
+                              size_type reverse_level, size_type max_values,
+                              std::vector<candidate> & candidates, size_type & preorder) const
+    {
+        internal_node & n = rtree::get<internal_node>(*ptr);
+
+        size_type values_count = 0;
+        size_type const first = preorder++;
+        if ( reverse_level > 1 )
+        {
+            for ( size_type i = 0 ; i < rtree::elements(n).size() ; ++i )
+            {
+                values_count += find_candidates(rtree::elements(n)[i].second, boost::addressof(n), i,
+                                                reverse_level - 1, max_values, candidates, preorder);
+            }
+        }
+        else
+        {
+            for ( auto const& el : rtree::elements(n) )
+                values_count += rtree::elements(rtree::get<leaf>(*el.second)).size();
+        }
+        size_type const last = preorder;
+
+        if ( values_count > max_values || ! is_repackable(values_count, reverse_level, parent == 0) )
+            return values_count;
+
+        double const s = score(n);
+        if ( s <= 0 )
+            return values_count;
+
+        candidate c;
+        c.score = s;
+        c.values_count = values_count;
+        c.first = first;
+        c.last = last;
+        c.reverse_level = reverse_level;
+        c.ptr = ptr;
+        c.parent = parent;
+        c.index = index;
+        candidates.push_back(c);                                                                // MAY THROW (alloc)
+
+        return values_count;
+    }
+
+    bool is_repackable(size_type values_count, size_type reverse_level, bool is_root) const
+    {
+        // the root is visited only by apply()
+        if ( is_root )
+            return true;
+
+        size_type packed_leafs_level = 0;
+        size_type const count = pack_type::root_elements_count(values_count, m_parameters, packed_leafs_level);
+        return packed_leafs_level == reverse_level
+            && m_parameters.get_min_elements() <= count;
+    }
+
+    // the sum of the contents of the pairwise intersections of the boxes
+    // of the children relative to the content of the box of the node
+    double score(internal_node const& n) const
+    {
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        box_type const box = rtree::elements_box<box_type>(elements.begin(), elements.end(),
+                                                           m_translator, m_strategy);
+        content_type const box_content = index::detail::content(box);
+        if ( box_content <= content_type(0) )
+            return 0;
+
+        content_type overlap = 0;
+        for ( size_type i = 0 ; i < elements.size() ; ++i )
+        {
+            for ( size_type j = i + 1 ; j < elements.size() ; ++j )
+            {
+                overlap += index::detail::intersection_content(elements[i].first, elements[j].first,
+                                                               m_strategy);
+            }
+        }
+
+        return double(overlap) / double(box_content);
+    }
+
+    void repack(candidate const& c, node_pointer & root, size_type & leafs_level) const
+    {
+        std::vector<value_type> values;
+        values.reserve(c.values_count);                                                         // MAY THROW (alloc)
+        collect_values(c.ptr, c.reverse_level, values);                                         // MAY THROW (V: alloc, copy)
+
+        size_type packed_values_count = 0;
+        size_type packed_leafs_level = 0;
+        node_pointer packed_root = pack_type::apply(std::make_move_iterator(values.begin()),
+                                                    std::make_move_iterator(values.end()),
+                                                    packed_values_count, packed_leafs_level,
+                                                    m_parameters, m_translator, m_allocators);   // MAY THROW (V, E: alloc, copy, N: alloc)
+
+        if ( c.parent )
+        {
+            BOOST_GEOMETRY_INDEX_ASSERT(packed_leafs_level == c.reverse_level, "unexpected height of the subtree");
+
+            typedef typename rtree::elements_type<internal_node>::type elements_type;
+            elements_type const& packed_elements = rtree::elements(rtree::get<internal_node>(*packed_root));
+
+            typename elements_type::value_type & el = rtree::elements(*c.parent)[c.index];
+            el.first = rtree::elements_box<box_type>(packed_elements.begin(), packed_elements.end(),
+                                                     m_translator, m_strategy);
+            el.second = packed_root;
+        }
+        else
+        {
+            root = packed_root;
+            leafs_level = packed_leafs_level;
+        }
+
+        rtree::visitors::destroy<MembersHolder>::apply(c.ptr, m_allocators);
+    }
+
+    void collect_values(node_pointer ptr, size_type reverse_level, std::vector<value_type> & values) const
+    {
+        if ( reverse_level == 0 )
+        {
+            for ( value_type const& v : rtree::elements(rtree::get<leaf>(*ptr)) )
+                values.push_back(v);                                                            // MAY THROW (V: alloc, copy)
+        }
+        else
+        {
+            for ( auto const& el : rtree::elements(rtree::get<internal_node>(*ptr)) )
+                collect_values(el.second, reverse_level - 1, values);                           // MAY THROW (V: alloc, copy)
+        }
+    }
+
+    parameters_type const& m_parameters;
+    translator_type const& m_translator;
+    allocators_type & m_allocators;
+    strategy_type m_strategy;
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_OPTIMIZE_HPP
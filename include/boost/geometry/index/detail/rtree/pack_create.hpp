@@ -16,6 +16,9 @@
 #ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_PACK_CREATE_HPP
 #define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_PACK_CREATE_HPP
 
+#include <future>
+#include <vector>
+
 #include <boost/core/ignore_unused.hpp>
 
 #include <boost/geometry/algorithms/detail/expand_by_epsilon.hpp>
@@ -183,6 +186,22 @@ public:
                        translator_type const& translator,
                        allocators_type & allocators,
                        TmpAlloc const& temp_allocator)
+    {
+        return apply(first, last, values_count, leafs_level, parameters, translator,
+                     allocators, temp_allocator, 1);
+    }
+
+    // The subtrees are created using at most threads threads.
+    // The resulting tree is the same regardless of the number of threads.
+    template <typename InIt, typename TmpAlloc> inline static
+    node_pointer apply(InIt first, InIt last,
+                       size_type & values_count,
+                       size_type & leafs_level,
+                       parameters_type const& parameters,
+                       translator_type const& translator,
+                       allocators_type & allocators,
+                       TmpAlloc const& temp_allocator,
+                       std::size_t threads)
     {
         typedef typename std::iterator_traits<InIt>::difference_type diff_type;
             
@@ -225,11 +244,22 @@ public:
 
         subtree_elements_counts subtree_counts = calculate_subtree_elements_counts(values_count, parameters, leafs_level);
         internal_element el = per_level(entries.begin(), entries.end(), hint_box.get(), values_count, subtree_counts,
-                                        parameters, translator, allocators);
+                                        parameters, translator, allocators, threads);
 
         return el.second;
     }
 
+    // The number of elements of the root of the tree created from values_count values.
+    // The leafs level of this tree is returned in leafs_level.
+    inline static
+    size_type root_elements_count(size_type values_count,
+                                  parameters_type const& parameters,
+                                  size_type & leafs_level)
+    {
+        subtree_elements_counts subtree_counts = calculate_subtree_elements_counts(values_count, parameters, leafs_level);
+        return calculate_nodes_count(values_count, subtree_counts);
+    }
+
 private:
     template <typename BoxType, typename Strategy>
     class expandable_box
@@ -294,7 +324,8 @@ private:
                                subtree_elements_counts const& subtree_counts,
                                parameters_type const& parameters,
                                translator_type const& translator,
-                               allocators_type & allocators)
+                               allocators_type & allocators,
+                               std::size_t threads)
     {
         BOOST_GEOMETRY_INDEX_ASSERT(0 < std::distance(first, last) && static_cast<size_type>(std::distance(first, last)) == values_count,
                                     "unexpected parameters");
@@ -362,28 +393,35 @@ private:
         // reserve space for values
         size_type nodes_count = calculate_nodes_count(values_count, subtree_counts);
         rtree::elements(in).reserve(nodes_count);                                                           // MAY THROW (A)
-        // calculate values box and copy values
-        expandable_box<box_type, strategy_type> elements_box(detail::get_strategy(parameters));
-        
         per_level_packets(first, last, hint_box, values_count, subtree_counts, next_subtree_counts,
-                          rtree::elements(in), elements_box,
-                          parameters, translator, allocators);
+                          rtree::elements(in),
+                          parameters, translator, allocators, threads);
+
+        rtree::subtree_values_count<MembersHolder>::set(in, values_count);
+
+        // calculate elements box
+        //   in the order of elements in order to get the same result for any number of threads
+        expandable_box<box_type, strategy_type> elements_box(detail::get_strategy(parameters));
+        for ( auto const& el : rtree::elements(in) )
+        {
+            elements_box.expand(el.first);
+        }
 
         auto_remover.release();
         return internal_element(elements_box.get(), n);
     }
 
-    template <typename EIt, typename ExpandableBox> inline static
+    template <typename EIt, typename Elements> inline static
     void per_level_packets(EIt first, EIt last,
                            box_type const& hint_box,
                            size_type values_count,
                            subtree_elements_counts const& subtree_counts,
                            subtree_elements_counts const& next_subtree_counts,
-                           internal_elements & elements,
-                           ExpandableBox & elements_box,
+                           Elements & elements,
                            parameters_type const& parameters,
                            translator_type const& translator,
-                           allocators_type & allocators)
+                           allocators_type & allocators,
+                           std::size_t threads)
     {
         BOOST_GEOMETRY_INDEX_ASSERT(0 < std::distance(first, last) && static_cast<size_type>(std::distance(first, last)) == values_count,
                                     "unexpected parameters");
@@ -396,7 +434,7 @@ private:
         {
             // the end, move to the next level
             internal_element el = per_level(first, last, hint_box, values_count, next_subtree_counts,
-                                            parameters, translator, allocators);
+                                            parameters, translator, allocators, threads);
 
             // in case if push_back() do throw here
             // and even if this is not probable (previously reserved memory, nonthrowing pairs copy)
@@ -406,7 +444,6 @@ private:
             elements.push_back(el);                                                 // MAY THROW (A?,C) - however in normal conditions shouldn't
             auto_remover.release();
 
-            elements_box.expand(el.first);
             return;
         }
         
@@ -419,15 +456,111 @@ private:
         box_type left, right;
         pack_utils::nth_element_and_half_boxes<0, dimension>
             ::apply(first, median, last, hint_box, left, right, greatest_dim_index);
+
+        if ( 1 < threads
+          && parallel_min_count <= median_count
+          && parallel_min_count <= values_count - median_count )
+        {
+            per_level_packets_parallel(first, median, last, left, right,
+                                       median_count, values_count - median_count,
+                                       subtree_counts, next_subtree_counts,
+                                       elements,
+                                       parameters, translator, allocators, threads);
+            return;
+        }
         
         per_level_packets(first, median, left,
                           median_count, subtree_counts, next_subtree_counts,
-                          elements, elements_box,
-                          parameters, translator, allocators);
+                          elements,
+                          parameters, translator, allocators, threads);
         per_level_packets(median, last, right,
                           values_count - median_count, subtree_counts, next_subtree_counts,
-                          elements, elements_box,
-                          parameters, translator, allocators);
+                          elements,
+                          parameters, translator, allocators, threads);
+    }
+
+    // Below this number of elements the halves are not created concurrently
+    static const size_type parallel_min_count = 4096;
+
+    // Create the left half in a separate thread and the right one in the current thread.
+    // The halves are created in local containers and then appended in the sequential order.
+    template <typename EIt, typename Elements> inline static
+    void per_level_packets_parallel(EIt first, EIt median, EIt last,
+                                    box_type const& left, box_type const& right,
+                                    size_type left_count, size_type right_count,
+                                    subtree_elements_counts const& subtree_counts,
+                                    subtree_elements_counts const& next_subtree_counts,
+                                    Elements & elements,
+                                    parameters_type const& parameters,
+                                    translator_type const& translator,
+                                    allocators_type & allocators,
+                                    std::size_t threads)
+    {
+        std::size_t const left_threads = threads / 2;
+        std::size_t const right_threads = threads - left_threads;
+
+        std::vector<internal_element> left_elements;
+        std::vector<internal_element> right_elements;
+
+        std::future<void> left_future;
+        BOOST_TRY
+        {
+            left_future = std::async(std::launch::async, [&]()
+            {
+                per_level_packets(first, median, left,
+                                  left_count, subtree_counts, next_subtree_counts,
+                                  left_elements,
+                                  parameters, translator, allocators, left_threads);
+            });                                                                     // MAY THROW (thread creation)
+        }
+        BOOST_CATCH(...)
+        {
+            // the thread couldn't be created, fall back to the sequential version
+            per_level_packets(first, median, left,
+                              left_count, subtree_counts, next_subtree_counts,
+                              elements,
+                              parameters, translator, allocators, 1);
+            per_level_packets(median, last, right,
+                              right_count, subtree_counts, next_subtree_counts,
+                              elements,
+                              parameters, translator, allocators, 1);
+            return;
+        }
+        BOOST_CATCH_END
+
+        BOOST_TRY
+        {
+            per_level_packets(median, last, right,
+                              right_count, subtree_counts, next_subtree_counts,
+                              right_elements,
+                              parameters, translator, allocators, right_threads);   // MAY THROW
+        }
+        BOOST_CATCH(...)
+        {
+            left_future.wait();
+            rtree::destroy_elements<MembersHolder>::apply(left_elements, allocators);
+            rtree::destroy_elements<MembersHolder>::apply(right_elements, allocators);
+            BOOST_RETHROW
+        }
+        BOOST_CATCH_END
+
+        BOOST_TRY
+        {
+            left_future.get();                                                      // MAY THROW
+        }
+        BOOST_CATCH(...)
+        {
+            rtree::destroy_elements<MembersHolder>::apply(left_elements, allocators);
+            rtree::destroy_elements<MembersHolder>::apply(right_elements, allocators);
+            BOOST_RETHROW
+        }
+        BOOST_CATCH_END
+
+        // elements have memory allocated, reserve() called outside
+        for ( internal_element const& el : left_elements )
+            elements.push_back(el);
+        for ( internal_element const& el : right_elements )
+            elements.push_back(el);
     }
 
     inline static
@@ -0,0 +1,377 @@
+// Boost.Geometry Index
+//
+// R-tree Hilbert curve packing
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_PACK_HILBERT_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_PACK_HILBERT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/container/vector.hpp>
+
+#include <boost/geometry/algorithms/centroid.hpp>
+#include <boost/geometry/algorithms/detail/expand_by_epsilon.hpp>
+
+#include <boost/geometry/index/detail/algorithms/bounds.hpp>
+#include <boost/geometry/index/detail/algorithms/hilbert_key.hpp>
+#include <boost/geometry/index/detail/algorithms/is_valid.hpp>
+#include <boost/geometry/index/detail/rtree/node/node_elements.hpp>
+#include <boost/geometry/index/detail/rtree/node/subtree_destroyer.hpp>
+#include <boost/geometry/index/parameters.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+namespace pack_utils {
+
+// Stable LSD radix sort of (key, payload) pairs by key, 8 bits per pass.
+// Passes where all keys have the same digit are skipped.
+template <typename Entries>
+inline void radix_sort_by_key(Entries & entries, Entries & buffer)
+{
+    typedef typename Entries::size_type size_type;
+    static const unsigned passes = 8;
+
+    size_type const count = entries.size();
+    if ( count < 2 )
+    {
+        return;
+    }
+
+    // histograms of all digits calculated at once
+    std::vector<size_type> offsets(passes * 256, 0);
+    for ( size_type i = 0 ; i < count ; ++i )
+    {
+        std::uint64_t const key = entries[i].first;
+        for ( unsigned pass = 0 ; pass < passes ; ++pass )
+        {
+            ++offsets[pass * 256 + ((key >> (pass * 8)) & 0xFF)];
+        }
+    }
+
+    buffer.resize(count, entries.front());
+
+    Entries * src = &entries;
+    Entries * dst = &buffer;
+    for ( unsigned pass = 0 ; pass < passes ; ++pass )
+    {
+        size_type * const pass_offsets = &offsets[pass * 256];
+        unsigned const shift = pass * 8;
+
+        if ( pass_offsets[(entries.front().first >> shift) & 0xFF] == count )
+        {
+            continue;
+        }
+
+        size_type sum = 0;
+        for ( unsigned d = 0 ; d < 256 ; ++d )
+        {
+            size_type const c = pass_offsets[d];
+            pass_offsets[d] = sum;
+            sum += c;
+        }
+
+        for ( size_type i = 0 ; i < count ; ++i )
+        {
+            (*dst)[pass_offsets[((*src)[i].first >> shift) & 0xFF]++] = (*src)[i];
+        }
+
+        std::swap(src, dst);
+    }
+
+    if ( src != &entries )
+    {
+        entries.swap(buffer);
+    }
+}
+
+} // namespace pack_utils
+
+// The Hilbert curve packing algorithm
+//
+// Values are sorted by the Hilbert key of the centroids of their Indexables
+// and then nodes are filled sequentially, level by level, bottom-up.
+// Sorting is done with radix sort so the complexity is O(n).
+//
+// For each level the number of nodes is the smallest one allowing to store
+// all of the elements and the elements are distributed evenly among them.
+// So the number of elements in nodes is between Min and Max
+// e.g. for 177 values Max = 5 and Min = 2 it will construct the following tree:
+// ROOT  2
+// L1    4     4
+// L2    4x5 + 4x4
+// L3    33x5 + 3x4
+
+template <typename MembersHolder>
+class pack_hilbert
+{
+    typedef typename MembersHolder::node node;
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+
+    typedef typename MembersHolder::node_pointer node_pointer;
+    typedef typename MembersHolder::size_type size_type;
+    typedef typename MembersHolder::parameters_type parameters_type;
+    typedef typename MembersHolder::translator_type translator_type;
+    typedef typename MembersHolder::allocators_type allocators_type;
+
+    typedef typename MembersHolder::box_type box_type;
+    typedef typename geometry::point_type<box_type>::type point_type;
+    typedef typename detail::strategy_type<parameters_type>::type strategy_type;
+
+    typedef typename rtree::elements_type<internal_node>::type internal_elements;
+    typedef typename internal_elements::value_type internal_element;
+
+    typedef rtree::subtree_destroyer<MembersHolder> subtree_destroyer;
+
+public:
+    template <typename InIt, typename TmpAlloc> inline static
+    node_pointer apply(InIt first, InIt last,
+                       size_type & values_count,
+                       size_type & leafs_level,
+                       parameters_type const& parameters,
+                       translator_type const& translator,
+                       allocators_type & allocators,
+                       TmpAlloc const& temp_allocator)
+    {
+        typedef typename std::iterator_traits<InIt>::difference_type diff_type;
+
+        diff_type diff = std::distance(first, last);
+        if ( diff <= 0 )
+            return node_pointer(0);
+
+        values_count = static_cast<size_type>(diff);
+
+        auto const& strategy = index::detail::get_strategy(parameters);
+
+        // calculate centroids and their bounds
+        typedef typename boost::container::allocator_traits<TmpAlloc>::
+            template rebind_alloc<point_type> temp_point_allocator_type;
+        boost::container::vector<point_type, temp_point_allocator_type>
+            centroids((temp_point_allocator_type(temp_allocator)));
+        centroids.reserve(values_count);
+
+        for ( InIt it = first ; it != last ; ++it )
+        {
+            // NOTE: see the NOTE in pack::apply()
+            typename std::iterator_traits<InIt>::reference in_ref = *it;
+            typename translator_type::result_type indexable = translator(in_ref);
+
+            BOOST_GEOMETRY_INDEX_ASSERT(detail::is_valid(indexable), "Indexable is invalid");
+
+            point_type pt;
+            geometry::centroid(indexable, pt, strategy);
+            centroids.push_back(pt);
+        }
+
+        expandable_box centroids_box(centroids.front(), strategy);
+        for ( point_type const& pt : centroids )
+        {
+            centroids_box.expand(pt);
+        }
+
+        // calculate and sort the keys
+        typedef std::pair<std::uint64_t, InIt> entry_type;
+        typedef typename boost::container::allocator_traits<TmpAlloc>::
+            template rebind_alloc<entry_type> temp_entry_allocator_type;
+        typedef boost::container::vector<entry_type, temp_entry_allocator_type> entries_type;
+
+        entries_type entries((temp_entry_allocator_type(temp_allocator)));
+        entries.reserve(values_count);
+        {
+            detail::hilbert_key<point_type> const key(centroids_box.get());
+            InIt it = first;
+            for ( point_type const& pt : centroids )
+            {
+                entries.push_back(entry_type(key(pt), it));
+                ++it;
+            }
+            centroids.clear();
+            centroids.shrink_to_fit();
+        }
+
+        {
+            entries_type buffer((temp_entry_allocator_type(temp_allocator)));
+            pack_utils::radix_sort_by_key(entries, buffer);
+        }
+
+        // create the levels
+        typedef typename boost::container::allocator_traits<TmpAlloc>::
+            template rebind_alloc<internal_element> temp_element_allocator_type;
+        typedef boost::container::vector<internal_element, temp_element_allocator_type> level_type;
+
+        level_type level((temp_element_allocator_type(temp_allocator)));
+        create_leafs(entries, level, parameters, translator, allocators);                         // MAY THROW
+
+        leafs_level = 0;
+        while ( 1 < level.size() )
+        {
+            level_type next_level((temp_element_allocator_type(temp_allocator)));
+            create_internal_nodes(level, next_level, leafs_level + 1, parameters, allocators);     // MAY THROW
+            level.swap(next_level);
+            ++leafs_level;
+        }
+
+        return level.front().second;
+    }
+
+private:
+    inline static
+    size_type nodes_count(size_type count, parameters_type const& parameters)
+    {
+        size_type const max_elements = parameters.get_max_elements();
+        return (count + max_elements - 1) / max_elements;
+    }
+
+    // the number of elements of i-th out of nodes_count nodes
+    inline static
+    size_type node_elements_count(size_type count, size_type nodes_count, size_type i)
+    {
+        return count / nodes_count + (i < count % nodes_count ? 1 : 0);
+    }
+
+    template <typename Entries, typename Level> inline static
+    void create_leafs(Entries const& entries, Level & level,
+                      parameters_type const& parameters,
+                      translator_type const& translator,
+                      allocators_type & allocators)
+    {
+        size_type const count = entries.size();
+        size_type const leafs_count = nodes_count(count, parameters);
+        level.reserve(leafs_count);                                                                 // MAY THROW (A)
+
+        BOOST_TRY
+        {
+            typename Entries::const_iterator it = entries.begin();
+            for ( size_type i = 0 ; i < leafs_count ; ++i )
+            {
+                size_type const leaf_count = node_elements_count(count, leafs_count, i);
+
+                node_pointer n = rtree::create_node<allocators_type, leaf>::apply(allocators);     // MAY THROW (A)
+                subtree_destroyer auto_remover(n, allocators);
+                leaf & l = rtree::get<leaf>(*n);
+
+                rtree::elements(l).reserve(leaf_count);                                             // MAY THROW (A)
+
+                // NOTE: see the NOTE in pack::per_level()
+                expandable_box elements_box(translator(*(it->second)), detail::get_strategy(parameters));
+                rtree::elements(l).push_back(*(it->second));                                        // MAY THROW (A?,C)
+                ++it;
+                for ( size_type j = 1 ; j < leaf_count ; ++j, ++it )
+                {
+                    elements_box.expand(translator(*(it->second)));
+                    rtree::elements(l).push_back(*(it->second));                                    // MAY THROW (A?,C)
+                }
+
+#ifdef BOOST_GEOMETRY_INDEX_EXPERIMENTAL_ENLARGE_BY_EPSILON
+                // see pack::per_level()
+                if ( BOOST_GEOMETRY_CONDITION((
+                        ! index::detail::is_bounding_geometry
+                            <
+                                typename indexable_type<translator_type>::type
+                            >::value )) )
+                {
+                    elements_box.expand_by_epsilon();
+                }
+#endif
+
+                level.push_back(internal_element(elements_box.get(), n));                           // reserved
+                auto_remover.release();
+            }
+        }
+        BOOST_CATCH(...)
+        {
+            rtree::destroy_elements<MembersHolder>::apply(level, allocators);
+            BOOST_RETHROW
+        }
+        BOOST_CATCH_END
+    }
+
+    template <typename Level> inline static
+    void create_internal_nodes(Level & level, Level & next_level,
+                               size_type reverse_level,
+                               parameters_type const& parameters,
+                               allocators_type & allocators)
+    {
+        size_type const count = level.size();
+        size_type const nodes = nodes_count(count, parameters);
+
+        // elements of level not yet moved to the nodes of next_level
+        typename Level::iterator it = level.begin();
+
+        BOOST_TRY
+        {
+            next_level.reserve(nodes);                                                              // MAY THROW (A)
+
+            for ( size_type i = 0 ; i < nodes ; ++i )
+            {
+                size_type const node_count = node_elements_count(count, nodes, i);
+
+                node_pointer n = rtree::create_node<allocators_type, internal_node>::apply(allocators); // MAY THROW (A)
+                subtree_destroyer auto_remover(n, allocators);
+                internal_node & in = rtree::get<internal_node>(*n);
+
+                rtree::elements(in).reserve(node_count);                                            // MAY THROW (A)
+
+                expandable_box elements_box(it->first, detail::get_strategy(parameters));
+                for ( size_type j = 0 ; j < node_count ; ++j, ++it )
+                {
+                    elements_box.expand(it->first);
+                    rtree::elements(in).push_back(*it);                                             // reserved
+                    it->second = 0;
+                }
+
+                rtree::subtree_values_count<MembersHolder>::update(in, reverse_level);
+
+                next_level.push_back(internal_element(elements_box.get(), n));                      // reserved
+                auto_remover.release();
+            }
+        }
+        BOOST_CATCH(...)
+        {
+            rtree::destroy_elements<MembersHolder>::apply(next_level, allocators);
+            rtree::destroy_elements<MembersHolder>::apply(it, level.end(), allocators);
+            BOOST_RETHROW
+        }
+        BOOST_CATCH_END
+    }
+
+    class expandable_box
+    {
+    public:
+        template <typename Indexable>
+        expandable_box(Indexable const& indexable, strategy_type const& strategy)
+            : m_strategy(strategy)
+        {
+            detail::bounds(indexable, m_box, m_strategy);
+        }
+
+        template <typename Indexable>
+        void expand(Indexable const& indexable)
+        {
+            detail::expand(m_box, indexable, m_strategy);
+        }
+
+        void expand_by_epsilon()
+        {
+            geometry::detail::expand_by_epsilon(m_box);
+        }
+
+        box_type const& get() const
+        {
+            return m_box;
+        }
+
+    private:
+        box_type m_box;
+        strategy_type m_strategy;
+    };
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_PACK_HILBERT_HPP
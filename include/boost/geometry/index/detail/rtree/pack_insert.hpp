@@ -0,0 +1,266 @@
+// Boost.Geometry Index
+//
+// R-tree bulk insertion of packed subtrees
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_PACK_INSERT_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_PACK_INSERT_HPP
+
+#include <boost/core/swap.hpp>
+
+#include <boost/geometry/index/detail/algorithms/intersection_content.hpp>
+#include <boost/geometry/index/detail/rtree/node/node.hpp>
+#include <boost/geometry/index/detail/rtree/pack_create.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/insert.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/is_leaf.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree {
+
+// Inserts a range of values into an existing tree.
+// The values are packed into a separate tree which is then grafted into
+// the existing one. The elements of the root of the lower tree are inserted
+// into the higher tree at the level corresponding to their height, so
+// one insertion is performed per packed subtree instead of per value.
+// A subtree overlapping the nodes of the same level of the higher tree
+// would increase the overlap of the nodes, so the elements of its root are
+// grafted one level lower instead, down to the insertion of single values.
+// Both trees are balanced and nodes other than the root of the lower tree
+// and the roots of the descended subtrees are not modified so the resulting
+// tree is balanced as well.
+template <typename MembersHolder>
+class pack_insert
+{
+    typedef typename MembersHolder::node node;
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+
+    typedef typename MembersHolder::box_type box_type;
+    typedef typename MembersHolder::node_pointer node_pointer;
+    typedef typename MembersHolder::size_type size_type;
+    typedef typename MembersHolder::parameters_type parameters_type;
+    typedef typename MembersHolder::translator_type translator_type;
+    typedef typename MembersHolder::allocators_type allocators_type;
+
+    typedef typename index::detail::strategy_type<parameters_type>::type strategy_type;
+    typedef typename index::detail::default_content_result<box_type>::type content_type;
+
+public:
+    // The root of the existing tree must exist.
+    template <typename InIt, typename TmpAlloc> inline static
+    void apply(InIt first, InIt last,
+               node_pointer & root,
+               size_type & values_count,
+               size_type & leafs_level,
+               parameters_type const& parameters,
+               translator_type const& translator,
+               allocators_type & allocators,
+               TmpAlloc const& temp_allocator)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(root, "The root must exist");
+
+        size_type packed_values_count = 0;
+        size_type packed_leafs_level = 0;
+        node_pointer packed_root = pack<MembersHolder>::apply(first, last,
+                                                              packed_values_count, packed_leafs_level,
+                                                              parameters, translator, allocators,
+                                                              temp_allocator);                       // MAY THROW (V, E: alloc, copy, N: alloc)
+        if ( !packed_root )
+            return;
+
+        // the elements of the lower tree are inserted into the higher tree
+        if ( leafs_level < packed_leafs_level )
+        {
+            boost::swap(root, packed_root);
+            boost::swap(leafs_level, packed_leafs_level);
+        }
+
+        // If exception is thrown, values_count may be invalid
+        values_count += packed_values_count;
+
+        visitors::is_leaf<MembersHolder> ilv;
+        rtree::apply_visitor(ilv, *packed_root);
+        if ( ilv.result )
+            graft_node<leaf>(packed_root, root, leafs_level, packed_leafs_level,
+                             parameters, translator, allocators);                                   // MAY THROW (V, E: alloc, copy, N: alloc)
+        else
+            graft_node<internal_node>(packed_root, root, leafs_level, packed_leafs_level,
+                                      parameters, translator, allocators);                          // MAY THROW (V, E: alloc, copy, N: alloc)
+    }
+
+private:
+    template <typename Node> inline static
+    void graft_node(node_pointer n,
+                    node_pointer & root,
+                    size_type & leafs_level,
+                    size_type node_relative_level,
+                    parameters_type const& parameters,
+                    translator_type const& translator,
+                    allocators_type & allocators)
+    {
+        BOOST_TRY
+        {
+            graft_node_elements(rtree::get<Node>(*n), root, leafs_level, node_relative_level,
+                                parameters, translator, allocators);                                // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+        BOOST_CATCH(...)
+        {
+            rtree::destroy_node<allocators_type, Node>::apply(allocators, n);
+            BOOST_RETHROW                                                                           // RETHROW
+        }
+        BOOST_CATCH_END
+
+        rtree::destroy_node<allocators_type, Node>::apply(allocators, n);
+    }
+
+    // Elements of a node at level node_relative_level counted from the leafs
+    // are inserted at the same level of the tree. The node is left empty.
+    template <typename Node> inline static
+    void graft_node_elements(Node & n,
+                             node_pointer & root,
+                             size_type & leafs_level,
+                             size_type node_relative_level,
+                             parameters_type const& parameters,
+                             translator_type const& translator,
+                             allocators_type & allocators)
+    {
+        typedef typename rtree::elements_type<Node>::type elements_type;
+        elements_type & elements = rtree::elements(n);
+
+        typename elements_type::iterator it = elements.begin();
+        BOOST_TRY
+        {
+            for ( ; it != elements.end() ; ++it )
+            {
+                graft_element(*it, root, leafs_level, node_relative_level,
+                              parameters, translator, allocators);                                  // MAY THROW (V, E: alloc, copy, N: alloc)
+            }
+        }
+        BOOST_CATCH(...)
+        {
+            ++it;
+            rtree::destroy_elements<MembersHolder>::apply(it, elements.end(), allocators);
+            elements.clear();
+            BOOST_RETHROW                                                                           // RETHROW
+        }
+        BOOST_CATCH_END
+
+        elements.clear();
+    }
+
+    template <typename Element> inline static
+    void insert_element(Element const& el,
+                        node_pointer & root,
+                        size_type & leafs_level,
+                        size_type node_relative_level,
+                        parameters_type const& parameters,
+                        translator_type const& translator,
+                        allocators_type & allocators)
+    {
+        visitors::insert<Element, MembersHolder>
+            insert_v(root, leafs_level, el,
+                     parameters, translator, allocators,
+                     node_relative_level);
+
+        rtree::apply_visitor(insert_v, *root);                                                      // MAY THROW (V, E: alloc, copy, N: alloc)
+    }
+
+    template <typename Value> inline static
+    void graft_element(Value const& v,
+                       node_pointer & root,
+                       size_type & leafs_level,
+                       size_type node_relative_level,
+                       parameters_type const& parameters,
+                       translator_type const& translator,
+                       allocators_type & allocators)
+    {
+        insert_element(v, root, leafs_level, node_relative_level,
+                       parameters, translator, allocators);                                         // MAY THROW (V, E: alloc, copy, N: alloc)
+    }
+
+    // The subtree is inserted as a whole if it doesn't overlap the nodes of the same
+    // level of the tree, otherwise the elements of its root are grafted one level lower.
+    inline static
+    void graft_element(rtree::ptr_pair<box_type, node_pointer> const& el,
+                       node_pointer & root,
+                       size_type & leafs_level,
+                       size_type node_relative_level,
+                       parameters_type const& parameters,
+                       translator_type const& translator,
+                       allocators_type & allocators)
+    {
+        if ( ! is_overlapping(el.first, root, leafs_level, node_relative_level, parameters) )
+        {
+            insert_element(el, root, leafs_level, node_relative_level,
+                           parameters, translator, allocators);                                     // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+        else if ( node_relative_level > 1 )
+        {
+            graft_node<internal_node>(el.second, root, leafs_level, node_relative_level - 1,
+                                      parameters, translator, allocators);                          // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+        else
+        {
+            graft_node<leaf>(el.second, root, leafs_level, 0,
+                             parameters, translator, allocators);                                   // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+    }
+
+    // Checks whether the box overlaps in more than half of its content the boxes
+    // of the children of the nodes at level node_relative_level of the tree.
+    // The degenerated boxes are overlapping if they intersect any of these boxes.
+    inline static
+    bool is_overlapping(box_type const& box,
+                        node_pointer root,
+                        size_type leafs_level,
+                        size_type node_relative_level,
+                        parameters_type const& parameters)
+    {
+        strategy_type const strategy = index::detail::get_strategy(parameters);
+
+        content_type overlap = 0;
+        bool intersects = false;
+        sum_overlap(box, root, leafs_level, node_relative_level, strategy, overlap, intersects);
+
+        content_type const content = index::detail::content(box);
+        return content <= content_type(0)
+             ? intersects
+             : content < overlap * 2;
+    }
+
+    inline static
+    void sum_overlap(box_type const& box,
+                     node_pointer ptr,
+                     size_type relative_level,
+                     size_type node_relative_level,
+                     strategy_type const& strategy,
+                     content_type & overlap,
+                     bool & intersects)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(node_relative_level <= relative_level && 0 < relative_level,
+                                    "unexpected level of the grafted subtree");
+
+        for ( auto const& el : rtree::elements(rtree::get<internal_node>(*ptr)) )
+        {
+            if ( index::detail::disjoint_box_box(el.first, box, strategy) )
+                continue;
+
+            if ( relative_level == node_relative_level )
+            {
+                intersects = true;
+                overlap += index::detail::intersection_content(el.first, box, strategy);
+            }
+            else
+            {
+                sum_overlap(box, el.second, relative_level - 1, node_relative_level,
+                            strategy, overlap, intersects);
+            }
+        }
+    }
+};
+
+}}}}} // namespace boost::geometry::index::detail::rtree
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_PACK_INSERT_HPP
@@ -15,9 +15,17 @@
 #ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_QUERY_ITERATORS_HPP
 #define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_QUERY_ITERATORS_HPP
 
-#include <boost/scoped_ptr.hpp>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <boost/container/allocator_traits.hpp>
+#include <boost/core/addressof.hpp>
+#include <boost/core/pointer_traits.hpp>
 
 #include <boost/geometry/index/detail/rtree/node/node_elements.hpp>
+#include <boost/geometry/index/detail/rtree/node/scoped_deallocator.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/distance_query.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/spatial_query.hpp>
 
@@ -216,7 +224,13 @@ public:
 
     virtual ~query_iterator_base() {}
 
-    virtual query_iterator_base * clone() const = 0;
+    // Creates the copy in the buffer if the object is buffered, otherwise
+    // allocates it with the allocator stored in the object.
+    virtual query_iterator_base * clone(void * buffer) const = 0;
+    // Moves the object to the buffer, it's called only if the object is buffered.
+    virtual query_iterator_base * move_to(void * buffer) = 0;
+    // Destroys and deallocates the object, it's called only if the object was allocated.
+    virtual void destroy() = 0;
     
     virtual bool is_end() const = 0;
     virtual reference dereference() const = 0;
@@ -224,11 +238,15 @@ public:
     virtual bool equals(query_iterator_base const&) const = 0;
 };
 
+template <typename Value, typename Allocators, typename Iterator>
+class query_iterator_allocated_wrapper;
+
 template <typename Value, typename Allocators, typename Iterator>
 class query_iterator_wrapper
     : public query_iterator_base<Value, Allocators>
 {
     typedef query_iterator_base<Value, Allocators> base_t;
+    typedef query_iterator_allocated_wrapper<Value, Allocators, Iterator> allocated_wrapper_t;
 
 public:
     typedef std::forward_iterator_tag iterator_category;
@@ -239,8 +257,40 @@ public:
 
     query_iterator_wrapper() : m_iterator() {}
     explicit query_iterator_wrapper(Iterator const& it) : m_iterator(it) {}
+    explicit query_iterator_wrapper(Iterator && it) : m_iterator(std::move(it)) {}
+
+    // The wrapper is stored in the buffer only if it can be moved without throwing.
+    static bool fits(std::size_t buffer_size)
+    {
+        return sizeof(query_iterator_wrapper) <= buffer_size
+            && std::alignment_of<query_iterator_wrapper>::value <= std::alignment_of<std::max_align_t>::value
+            && std::is_nothrow_move_constructible<Iterator>::value;
+    }
+
+    template <typename It>
+    static base_t * create(It && it, void * buffer, std::size_t buffer_size,
+                           Allocators const& allocators)
+    {
+        if ( fits(buffer_size) )
+            return new (buffer) query_iterator_wrapper(std::forward<It>(it));                 // MAY THROW (copy)
+
+        return allocated_wrapper_t::create(std::forward<It>(it), allocators.allocator());    // MAY THROW (alloc, copy)
+    }
+
+    virtual base_t * clone(void * buffer) const
+    {
+        return new (buffer) query_iterator_wrapper(m_iterator);                               // MAY THROW (copy)
+    }
+
+    virtual base_t * move_to(void * buffer)
+    {
+        return new (buffer) query_iterator_wrapper(std::move(m_iterator));
+    }
 
-    virtual base_t * clone() const { return new query_iterator_wrapper(m_iterator); }
+    virtual void destroy()
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(false, "buffered iterator can't be deallocated");
+    }
 
     virtual bool is_end() const { return m_iterator == end_query_iterator<Value, Allocators>(); }
     virtual reference dereference() const { return *m_iterator; }
@@ -256,12 +306,73 @@ private:
     Iterator m_iterator;
 };
 
+// The wrapper allocated with the allocator of the rtree. It stores a copy
+// of the allocator so it may be destroyed after the rtree, e.g. the copies
+// of node_pool_allocator keep the pool alive.
+template <typename Value, typename Allocators, typename Iterator>
+class query_iterator_allocated_wrapper
+    : public query_iterator_wrapper<Value, Allocators, Iterator>
+{
+    typedef query_iterator_base<Value, Allocators> base_t;
+    typedef query_iterator_wrapper<Value, Allocators, Iterator> wrapper_t;
+
+    typedef typename boost::container::allocator_traits
+        <
+            typename Allocators::allocator_type
+        >::template rebind_alloc<query_iterator_allocated_wrapper> wrapper_allocator_type;
+    typedef boost::container::allocator_traits<wrapper_allocator_type> wrapper_allocator_traits;
+    typedef typename wrapper_allocator_traits::pointer wrapper_pointer;
+
+public:
+    template <typename It>
+    query_iterator_allocated_wrapper(It && it, wrapper_allocator_type const& alloc)
+        : wrapper_t(std::forward<It>(it))
+        , m_allocator(alloc)
+    {}
+
+    template <typename It, typename Allocator>
+    static base_t * create(It && it, Allocator const& allocator)
+    {
+        wrapper_allocator_type alloc(allocator);
+        wrapper_pointer p = wrapper_allocator_traits::allocate(alloc, 1);                   // MAY THROW (alloc)
+        scoped_deallocator<wrapper_allocator_type> deallocator(p, alloc);
+        wrapper_allocator_traits::construct(alloc, boost::to_address(p),
+                                            std::forward<It>(it), alloc);                   // MAY THROW (copy)
+        deallocator.release();
+        return boost::to_address(p);
+    }
+
+    virtual base_t * clone(void * /*buffer*/) const
+    {
+        return create(static_cast<wrapper_t const&>(*this), m_allocator);                  // MAY THROW (alloc, copy)
+    }
+
+    virtual void destroy()
+    {
+        // the allocator is destroyed with this object
+        wrapper_allocator_type alloc(m_allocator);
+        wrapper_pointer p = boost::pointer_traits<wrapper_pointer>::pointer_to(*this);
+        wrapper_allocator_traits::destroy(alloc, this);
+        wrapper_allocator_traits::deallocate(alloc, p, 1);
+    }
+
+private:
+    wrapper_allocator_type m_allocator;
+};
+
 
+// The type-erased iterator. Wrapped iterators small enough are stored
+// in the internal buffer, so the common spatial and nearest query iterators
+// are wrapped without allocation. Bigger ones are allocated with the allocator
+// of the rtree. The wrapped iterators may still allocate memory on their own,
+// e.g. the copy of the spatial query iterator of a non-empty tree copies
+// the stack of the traversed nodes.
 template <typename Value, typename Allocators>
 class query_iterator
 {
     typedef query_iterator_base<Value, Allocators> iterator_base;
-    typedef boost::scoped_ptr<iterator_base> iterator_ptr;
+
+    static const std::size_t buffer_size = 32 * sizeof(void*);
 
 public:
     typedef std::forward_iterator_tag iterator_category;
@@ -270,26 +381,32 @@ public:
     typedef typename Allocators::difference_type difference_type;
     typedef typename Allocators::const_pointer pointer;
 
-    query_iterator() = default;
+    query_iterator()
+        : m_ptr(0)
+    {}
 
     template <typename It>
-    query_iterator(It const& it)
-        : m_ptr(static_cast<iterator_base*>(
-                    new query_iterator_wrapper<Value, Allocators, It>(it) ))
+    query_iterator(It const& it, Allocators const& allocators)
+        : m_ptr(query_iterator_wrapper<Value, Allocators, It>::create(it, buffer(), buffer_size, allocators))
     {}
 
     query_iterator(end_query_iterator<Value, Allocators> const& /*it*/)
+        : m_ptr(0)
     {}
 
     query_iterator(query_iterator const& o)
-        : m_ptr(o.m_ptr.get() ? o.m_ptr->clone() : 0)
+        : m_ptr(o.m_ptr ? o.m_ptr->clone(buffer()) : 0)
     {}
 
+    // the copy is created before this iterator is modified so it's
+    // left unchanged if the copy throws
     query_iterator & operator=(query_iterator const& o)
     {
         if ( this != boost::addressof(o) )
         {
-            m_ptr.reset(o.m_ptr.get() ? o.m_ptr->clone() : 0);
+            query_iterator temp(o);                                                             // MAY THROW (alloc, copy)
+            reset();
+            take(temp);
         }
         return *this;
     }
@@ -297,19 +414,24 @@ public:
     query_iterator(query_iterator && o)
         : m_ptr(0)
     {
-        m_ptr.swap(o.m_ptr);
+        take(o);
     }
 
     query_iterator & operator=(query_iterator && o)
     {
         if ( this != boost::addressof(o) )
         {
-            m_ptr.swap(o.m_ptr);
-            o.m_ptr.reset();
+            reset();
+            take(o);
         }
         return *this;
     }
 
+    ~query_iterator()
+    {
+        reset();
+    }
+
     reference operator*() const
     {
         return m_ptr->dereference();
@@ -335,16 +457,16 @@ public:
 
     friend bool operator==(query_iterator const& l, query_iterator const& r)
     {
-        if ( l.m_ptr.get() )
+        if ( l.m_ptr )
         {
-            if ( r.m_ptr.get() )
+            if ( r.m_ptr )
                 return l.m_ptr->equals(*r.m_ptr);
             else
                 return l.m_ptr->is_end();
         }
         else
         {
-            if ( r.m_ptr.get() )
+            if ( r.m_ptr )
                 return r.m_ptr->is_end();
             else
                 return true;
@@ -352,7 +474,42 @@ public:
     }
 
 private:
-    iterator_ptr m_ptr;
+    void * buffer()
+    {
+        return static_cast<void*>(&m_buffer);
+    }
+
+    bool is_buffered() const
+    {
+        return static_cast<void const*>(m_ptr) == static_cast<void const*>(&m_buffer);
+    }
+
+    void reset()
+    {
+        if ( is_buffered() )
+            m_ptr->~iterator_base();
+        else if ( m_ptr )
+            m_ptr->destroy();
+        m_ptr = 0;
+    }
+
+    // this iterator must be empty, the move of the buffered iterator doesn't throw
+    void take(query_iterator & o)
+    {
+        if ( o.is_buffered() )
+        {
+            m_ptr = o.m_ptr->move_to(buffer());
+            o.reset();
+        }
+        else
+        {
+            m_ptr = o.m_ptr;
+            o.m_ptr = 0;
+        }
+    }
+
+    iterator_base * m_ptr;
+    typename std::aligned_storage<buffer_size, std::alignment_of<std::max_align_t>::value>::type m_buffer;
 };
 
 }}}}}} // namespace boost::geometry::index::detail::rtree::iterators
@@ -238,6 +238,7 @@ struct level_insert_base
     typedef typename base::node node;
     typedef typename base::internal_node internal_node;
     typedef typename base::leaf leaf;
+    typedef typename base::values_count_type values_count_type;
 
     typedef typename level_insert_elements_type<InsertIndex, Element, MembersHolder>::type elements_type;
     typedef typename index::detail::rtree::container_from_elements_type<
@@ -283,6 +284,10 @@ struct level_insert_base
                     result_elements, n,
                     base::m_traverse_data.parent, base::m_traverse_data.current_child_index,
                     base::m_parameters, base::m_translator, base::m_allocators);                            // MAY THROW, BASIC (V, E: alloc, copy)
+
+                size_type const removed_count = values_count_type::elements_count(result_elements, result_relative_level);
+                values_count_type::subtract(n, removed_count);
+                base::m_values_count_removed += removed_count;
             }
             // node is root node
             else
@@ -375,6 +380,8 @@ struct level_insert
             // next traversing step
             base::traverse(*this, n);                                                                       // MAY THROW (E: alloc, copy, N: alloc)
 
+            base::update_values_count(n);
+
             // further insert
             if ( 0 < InsertIndex )
             {
@@ -406,6 +413,8 @@ struct level_insert
             }
             BOOST_CATCH_END
 
+            base::update_values_count(n);
+
             // first insert
             if ( 0 == InsertIndex )
             {
@@ -462,6 +471,8 @@ struct level_insert<InsertIndex, Value, MembersHolder, true>
         // next traversing step
         base::traverse(*this, n);                                                                       // MAY THROW (V, E: alloc, copy, N: alloc)
 
+        base::update_values_count(n);
+
         BOOST_GEOMETRY_INDEX_ASSERT(0 < base::m_level, "illegal level value, level shouldn't be the root level for 0 < InsertIndex");
         
         if ( base::m_traverse_data.current_level == base::m_level - 1 )
@@ -523,6 +534,8 @@ struct level_insert<0, Value, MembersHolder, true>
         // next traversing step
         base::traverse(*this, n);                                                                       // MAY THROW (V: alloc, copy, N: alloc)
 
+        base::update_values_count(n);
+
         base::recalculate_aabb_if_necessary(n);
     }
 
@@ -574,8 +587,15 @@ public:
         : m_root(root), m_leafs_level(leafs_level), m_element(element)
         , m_parameters(parameters), m_translator(translator)
         , m_relative_level(relative_level), m_allocators(allocators)
+        , m_hint(0)
     {}
 
+    // The hint is used only for the insertion of the element, not for reinsertions.
+    inline void set_hint(insert_hint * hint)
+    {
+        m_hint = hint;
+    }
+
     inline void operator()(internal_node & n)
     {
         boost::ignore_unused(n);
@@ -586,6 +606,8 @@ public:
         {
             rstar::level_insert<0, Element, MembersHolder> lins_v(
                 m_root, m_leafs_level, m_element, m_parameters, m_translator, m_allocators, m_relative_level);
+            if ( m_hint )
+                lins_v.set_hint(m_hint);
 
             rtree::apply_visitor(lins_v, *m_root);                                                              // MAY THROW (V, E: alloc, copy, N: alloc)
 
@@ -598,6 +620,8 @@ public:
         {
             visitors::insert<Element, MembersHolder, insert_default_tag> ins_v(
                 m_root, m_leafs_level, m_element, m_parameters, m_translator, m_allocators, m_relative_level);
+            if ( m_hint )
+                ins_v.set_hint(m_hint);
 
             rtree::apply_visitor(ins_v, *m_root); 
         }
@@ -613,6 +637,8 @@ public:
         {
             rstar::level_insert<0, Element, MembersHolder> lins_v(
                 m_root, m_leafs_level, m_element, m_parameters, m_translator, m_allocators, m_relative_level);
+            if ( m_hint )
+                lins_v.set_hint(m_hint);
 
             rtree::apply_visitor(lins_v, *m_root);                                                              // MAY THROW (V, E: alloc, copy, N: alloc)
 
@@ -623,6 +649,8 @@ public:
         {
             visitors::insert<Element, MembersHolder, insert_default_tag> ins_v(
                 m_root, m_leafs_level, m_element, m_parameters, m_translator, m_allocators, m_relative_level);
+            if ( m_hint )
+                ins_v.set_hint(m_hint);
 
             rtree::apply_visitor(ins_v, *m_root); 
         }
@@ -674,6 +702,8 @@ private:
     size_type m_relative_level;
 
     allocators_type & m_allocators;
+
+    insert_hint * m_hint;
 };
 
 }}} // namespace detail::rtree::visitors
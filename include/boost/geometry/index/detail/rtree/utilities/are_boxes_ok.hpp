@@ -106,7 +106,7 @@ public:
     bool result;
 
 private:
-    parameters_type const& m_parameters;
+    parameters_type m_parameters; // rtree::parameters() returns by value
     translator_type const& m_tr;
     box_type m_box;
     bool m_is_root;
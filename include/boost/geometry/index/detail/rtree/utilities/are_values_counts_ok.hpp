@@ -0,0 +1,83 @@
+// Boost.Geometry Index
+//
+// R-tree subtrees values counts validating visitor implementation
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_UTILITIES_ARE_VALUES_COUNTS_OK_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_UTILITIES_ARE_VALUES_COUNTS_OK_HPP
+
+#include <boost/geometry/index/detail/rtree/node/node.hpp>
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree { namespace utilities {
+
+namespace visitors {
+
+template <typename MembersHolder>
+class are_values_counts_ok
+    : public MembersHolder::visitor_const
+{
+    typedef typename MembersHolder::size_type size_type;
+
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+
+    typedef rtree::subtree_values_count<MembersHolder> values_count_type;
+
+public:
+    inline are_values_counts_ok()
+        : result(true), values_count(0)
+    {}
+
+    inline void operator()(internal_node const& n)
+    {
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type const& elements = rtree::elements(n);
+
+        size_type children_values_count = 0;
+
+        for ( typename elements_type::const_iterator it = elements.begin();
+              it != elements.end() && result == true ;
+              ++it)
+        {
+            rtree::apply_visitor(*this, *it->second);
+            children_values_count += values_count;
+        }
+
+        // the counts are checked only if they are stored in the nodes
+        result = result && ( ! values_count_type::is_stored
+                          || children_values_count == values_count_type::get(n) );
+        values_count = children_values_count;
+    }
+
+    inline void operator()(leaf const& n)
+    {
+        values_count = rtree::elements(n).size();
+    }
+
+    bool result;
+    size_type values_count;
+};
+
+} // namespace visitors
+
+template <typename Rtree> inline
+bool are_values_counts_ok(Rtree const& tree)
+{
+    typedef utilities::view<Rtree> RTV;
+    RTV rtv(tree);
+
+    visitors::are_values_counts_ok<
+        typename RTV::members_holder
+    > v;
+
+    rtv.apply_visitor(v);
+
+    return v.result && v.values_count == tree.size();
+}
+
+}}}}}} // namespace boost::geometry::index::detail::rtree::utilities
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_UTILITIES_ARE_VALUES_COUNTS_OK_HPP
@@ -0,0 +1,139 @@
+// Boost.Geometry Index
+//
+// R-tree queries traversal statistics
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_UTILITIES_QUERY_STATISTICS_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_UTILITIES_QUERY_STATISTICS_HPP
+
+#include <cstddef>
+#include <ostream>
+
+// The statistics are gathered only if BOOST_GEOMETRY_INDEX_ENABLE_QUERY_STATISTICS
+// is defined before including the rtree. Otherwise the counters are not touched
+// and the queries are not affected at all.
+//
+// Usage:
+//   utilities::query_statistics stats;
+//   {
+//       utilities::scoped_query_statistics guard(stats);
+//       rt.query(bgi::intersects(box), std::back_inserter(result));
+//   }
+//   // stats contains the numbers gathered by the queries performed
+//   // in the current thread while the guard existed
+
+namespace boost { namespace geometry { namespace index { namespace detail { namespace rtree { namespace utilities {
+
+struct query_statistics
+{
+    query_statistics()
+        : internal_nodes(0)
+        , leafs(0)
+        , values(0)
+        , predicates_checks(0)
+        , simd_blocks(0)
+        , branches_pushed(0)
+        , branches_popped(0)
+    {}
+
+    void reset()
+    {
+        *this = query_statistics();
+    }
+
+    query_statistics & operator+=(query_statistics const& other)
+    {
+        internal_nodes += other.internal_nodes;
+        leafs += other.leafs;
+        values += other.values;
+        predicates_checks += other.predicates_checks;
+        simd_blocks += other.simd_blocks;
+        branches_pushed += other.branches_pushed;
+        branches_popped += other.branches_popped;
+        return *this;
+    }
+
+    // the number of visited internal nodes
+    std::size_t internal_nodes;
+    // the number of visited leafs
+    std::size_t leafs;
+    // the number of values tested in the visited leafs
+    std::size_t values;
+    // the number of children of internal nodes and values checked against the predicates,
+    // counted where the check is made. Predicates combined with && are checked at once,
+    // stopping at the first one not met, so this is not the number of tested predicates.
+    // The boxes tested in blocks by the SIMD box tester are counted one by one.
+    std::size_t predicates_checks;
+    // the number of blocks of boxes of children tested at once by the SIMD box tester
+    std::size_t simd_blocks;
+    // the number of nodes pushed to and popped from the priority queue of a distance query
+    std::size_t branches_pushed;
+    std::size_t branches_popped;
+};
+
+template <typename Char, typename Traits>
+inline std::basic_ostream<Char, Traits> & operator<<(std::basic_ostream<Char, Traits> & os,
+                                                     query_statistics const& s)
+{
+    os << "internal nodes: " << s.internal_nodes
+       << ", leafs: " << s.leafs
+       << ", values: " << s.values
+       << ", predicates checks: " << s.predicates_checks
+       << ", simd blocks: " << s.simd_blocks
+       << ", branches pushed: " << s.branches_pushed
+       << ", branches popped: " << s.branches_popped;
+    return os;
+}
+
+#ifdef BOOST_GEOMETRY_INDEX_ENABLE_QUERY_STATISTICS
+
+// The statistics updated by the queries performed in the current thread.
+inline query_statistics *& current_query_statistics()
+{
+    static thread_local query_statistics * ptr = nullptr;
+    return ptr;
+}
+
+// Gathers the statistics of the queries performed in the current thread
+// during its lifetime. The guards may be nested, the previous statistics are
+// restored by the destructor.
+class scoped_query_statistics
+{
+    scoped_query_statistics(scoped_query_statistics const&);
+    scoped_query_statistics & operator=(scoped_query_statistics const&);
+
+public:
+    explicit scoped_query_statistics(query_statistics & stats)
+        : m_previous(current_query_statistics())
+    {
+        current_query_statistics() = &stats;
+    }
+
+    ~scoped_query_statistics()
+    {
+        current_query_statistics() = m_previous;
+    }
+
+private:
+    query_statistics * m_previous;
+};
+
+#define BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(MEMBER, COUNT)                         \
+    do {                                                                                        \
+        if (::boost::geometry::index::detail::rtree::utilities::query_statistics * bgi_stats_   \
+                = ::boost::geometry::index::detail::rtree::utilities::current_query_statistics()) \
+            bgi_stats_->MEMBER += (COUNT);                                                      \
+    } while (false)
+
+#else // BOOST_GEOMETRY_INDEX_ENABLE_QUERY_STATISTICS
+
+#define BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(MEMBER, COUNT) ((void)0)
+
+#endif // BOOST_GEOMETRY_INDEX_ENABLE_QUERY_STATISTICS
+
+}}}}}} // namespace boost::geometry::index::detail::rtree::utilities
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_UTILITIES_QUERY_STATISTICS_HPP
@@ -0,0 +1,337 @@
+// Boost.Geometry Index
+//
+// R-tree all k nearest neighbors (self join) implementation
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_ALL_NEAREST_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_ALL_NEAREST_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/index/detail/distance_predicates.hpp>
+#include <boost/geometry/index/detail/parallel.hpp>
+#include <boost/geometry/index/detail/rtree/node/node_elements.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/distance_query.hpp>
+#include <boost/geometry/index/parameters.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree { namespace visitors {
+
+// Finds k nearest neighbors of all values stored in the tree. The values are
+// processed leaf by leaf. The neighbors of all values of a leaf are found during
+// one traversal of the tree. First the values of the leaf itself are checked,
+// then the nodes are visited in the order of the distance between their boxes
+// and the box of the leaf so the neighboring leafs are processed before the
+// distant ones. A node is visited only if it may contain a value closer than
+// the furthest neighbor found so far for at least one of the values of the leaf.
+// The pairs of values and their neighbors are written to the output iterator
+// as std::pair<value_type, value_type>, leaf by leaf, for each value sorted
+// by the distance.
+template <typename MembersHolder>
+class all_nearest
+{
+    typedef typename MembersHolder::value_type value_type;
+    typedef typename MembersHolder::box_type box_type;
+    typedef typename MembersHolder::parameters_type parameters_type;
+    typedef typename MembersHolder::translator_type translator_type;
+
+    typedef typename index::detail::strategy_type<parameters_type>::type strategy_type;
+
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+
+    typedef typename MembersHolder::size_type size_type;
+    typedef typename MembersHolder::node_pointer node_pointer;
+
+    typedef typename indexable_type<translator_type>::type indexable_type;
+
+    typedef index::detail::comparable_distance_call<indexable_type, indexable_type, strategy_type> value_distance_call;
+    typedef index::detail::comparable_distance_call<indexable_type, box_type, strategy_type> node_distance_call;
+    typedef index::detail::comparable_distance_call<box_type, box_type, strategy_type> boxes_distance_call;
+    typedef typename value_distance_call::result_type value_distance_type;
+    typedef typename node_distance_call::result_type node_distance_type;
+    typedef typename boxes_distance_call::result_type boxes_distance_type;
+
+    typedef typename rtree::elements_type<leaf>::type leaf_elements;
+
+    using neighbor_data = std::pair<value_distance_type, const value_type *>;
+    using neighbors_type = std::vector<neighbor_data>;
+
+    struct leaf_data
+    {
+        leaf_data(leaf const* p, box_type const& b)
+            : ptr(p), box(b)
+        {}
+
+        leaf const* ptr;
+        box_type box;
+    };
+
+    // null box means that the node is a root
+    struct branch_data
+    {
+        branch_data(boxes_distance_type d, size_type rl, node_pointer p, box_type const* b)
+            : distance(d), reverse_level(rl), ptr(p), box(b)
+        {}
+
+        boxes_distance_type distance;
+        size_type reverse_level;
+        node_pointer ptr;
+        box_type const* box;
+    };
+    using branches_type = priority_queue<branch_data, branch_data_comp>;
+
+public:
+    typedef std::pair<value_type, value_type> result_type;
+
+    all_nearest(MembersHolder const& members, size_type k)
+        : m_members(members)
+        , m_tr(members.translator())
+        , m_strategy(index::detail::get_strategy(members.parameters()))
+        , m_count(k)
+    {}
+
+    // the number of leafs processed by a task of the parallel version
+    static const std::size_t leafs_per_task = 64;
+
+    // The leafs are split into ranges processed in parallel. Then the results
+    // are written in the order in which they would be written by the sequential
+    // version.
+    template <typename OutIter>
+    size_type apply(OutIter out_it, std::size_t threads)
+    {
+        if ( m_count == 0 || ! m_members.root )
+            return 0;
+
+        std::vector<leaf_data> leafs;
+        if ( m_members.leafs_level == 0 )
+        {
+            leaf_elements const& elements = rtree::elements(rtree::get<leaf>(*m_members.root));
+            leafs.push_back(leaf_data(boost::addressof(rtree::get<leaf>(*m_members.root)),
+                                      rtree::values_box<box_type>(elements.begin(), elements.end(),
+                                                                  m_tr, m_strategy)));
+        }
+        else
+        {
+            collect_leafs(m_members.root, m_members.leafs_level, leafs);                // MAY THROW (alloc)
+        }
+
+        if ( threads <= 1 || leafs.size() <= 1 )
+        {
+            size_type found_count = 0;
+            for ( leaf_data const& l : leafs )
+                found_count += process(l, out_it);
+            return found_count;
+        }
+
+        // the leafs are processed in waves of a limited number of leafs so the memory
+        // used by the results depends on the number of threads, not on the size of the tree
+        std::size_t const tasks_count = 4 * threads;
+        std::size_t const wave_size = tasks_count * leafs_per_task;
+        std::vector<std::vector<result_type> > results(tasks_count);
+
+        size_type found_count = 0;
+        for ( std::size_t wave_first = 0 ; wave_first < leafs.size() ; wave_first += wave_size )
+        {
+            std::size_t const wave_count = (std::min)(wave_size, leafs.size() - wave_first);
+            std::size_t const wave_tasks = (std::min)(tasks_count, wave_count);
+            index::detail::parallel_for(wave_tasks, threads, [&](std::size_t i)
+            {
+                std::size_t const first = wave_first + i * wave_count / wave_tasks;
+                std::size_t const last = wave_first + (i + 1) * wave_count / wave_tasks;
+                all_nearest worker(m_members, m_count);
+                results[i].clear();
+                auto out = std::back_inserter(results[i]);
+                for ( std::size_t l = first ; l < last ; ++l )
+                    worker.process(leafs[l], out);
+            });                                                                     // MAY THROW
+
+            for ( std::size_t i = 0 ; i < wave_tasks ; ++i )
+            {
+                for ( result_type const& v : results[i] )
+                {
+                    *out_it = v;                                                    // MAY THROW (V: copy)
+                    ++out_it;
+                }
+                found_count += results[i].size();
+            }
+        }
+        return found_count;
+    }
+
+private:
+    void collect_leafs(node_pointer ptr, size_type reverse_level, std::vector<leaf_data> & leafs) const
+    {
+        internal_node const& n = rtree::get<internal_node>(*ptr);
+        for ( auto const& p : rtree::elements(n) )
+        {
+            if ( reverse_level > 1 )
+                collect_leafs(p.second, reverse_level - 1, leafs);
+            else
+                leafs.push_back(leaf_data(boost::addressof(rtree::get<leaf>(*p.second)), p.first));
+        }
+    }
+
+    template <typename OutIter>
+    size_type process(leaf_data const& l, OutIter & out_it)
+    {
+        leaf_elements const& elements = rtree::elements(*l.ptr);
+        std::size_t const n = elements.size();
+
+        if ( m_neighbors.size() < n )
+            m_neighbors.resize(n);
+        for ( std::size_t i = 0 ; i < n ; ++i )
+            m_neighbors[i].clear();
+
+        // the values of the same leaf are likely to be the nearest ones
+        for ( std::size_t i = 0 ; i < n ; ++i )
+        {
+            for ( std::size_t j = i + 1 ; j < n ; ++j )
+            {
+                value_distance_type const d = value_distance_call::apply(m_tr(elements[i]),
+                                                                         m_tr(elements[j]),
+                                                                         m_strategy);
+                store_value(i, d, boost::addressof(elements[j]));
+                store_value(j, d, boost::addressof(elements[i]));
+            }
+        }
+
+        m_branches.clear();
+        m_branches.push(branch_data(boxes_distance_type(0), m_members.leafs_level, m_members.root, nullptr));
+
+        while ( ! m_branches.empty() )
+        {
+            branch_data const b = m_branches.top();
+            m_branches.pop();
+
+            // the neighbors could have been found since the branch was pushed
+            if ( b.box && ! is_closer(elements, *b.box) )
+                continue;
+
+            if ( b.reverse_level > 0 )
+            {
+                internal_node const& n = rtree::get<internal_node>(*b.ptr);
+                for ( auto const& p : rtree::elements(n) )
+                {
+                    if ( is_closer(elements, p.first) )
+                    {
+                        boxes_distance_type const d = boxes_distance_call::apply(l.box, p.first, m_strategy);
+                        m_branches.push(branch_data(d, b.reverse_level - 1, p.second, boost::addressof(p.first)));
+                    }
+                }
+            }
+            else
+            {
+                leaf const& other = rtree::get<leaf>(*b.ptr);
+                if ( boost::addressof(other) != l.ptr )
+                    search_leaf(elements, rtree::elements(other), b.box);
+            }
+        }
+
+        size_type found_count = 0;
+        for ( std::size_t i = 0 ; i < n ; ++i )
+        {
+            neighbors_type & neighbors = m_neighbors[i];
+            std::sort(neighbors.begin(), neighbors.end(), pair_first_less());
+
+            for ( neighbor_data const& p : neighbors )
+            {
+                *out_it = result_type(elements[i], *(p.second));                    // MAY THROW (V: copy)
+                ++out_it;
+            }
+            found_count += neighbors.size();
+        }
+        return found_count;
+    }
+
+    void search_leaf(leaf_elements const& elements, leaf_elements const& other, box_type const* other_box)
+    {
+        // the values of the processed leaf which may have neighbors in the other leaf
+        m_active.clear();
+        for ( std::size_t i = 0 ; i < elements.size() ; ++i )
+        {
+            if ( ! other_box || is_closer(i, elements[i], *other_box) )
+                m_active.push_back(i);
+        }
+
+        for ( auto const& v : other )
+        {
+            for ( std::size_t i : m_active )
+            {
+                value_distance_type const d = value_distance_call::apply(m_tr(elements[i]), m_tr(v),
+                                                                         m_strategy);
+                if ( ! ignore_value(i, d) )
+                    store_value(i, d, boost::addressof(v));
+            }
+        }
+    }
+
+    // true if the box may contain a value closer than the furthest neighbor of any value
+    bool is_closer(leaf_elements const& elements, box_type const& box) const
+    {
+        for ( std::size_t i = 0 ; i < elements.size() ; ++i )
+        {
+            if ( is_closer(i, elements[i], box) )
+                return true;
+        }
+        return false;
+    }
+
+    bool is_closer(std::size_t i, value_type const& v, box_type const& box) const
+    {
+        neighbors_type const& neighbors = m_neighbors[i];
+        return neighbors.size() < m_count
+            || node_distance_call::apply(m_tr(v), box, m_strategy) < neighbors.front().first;
+    }
+
+    bool ignore_value(std::size_t i, value_distance_type const& d) const
+    {
+        neighbors_type const& neighbors = m_neighbors[i];
+        return neighbors.size() == m_count
+            && neighbors.front().first <= d;
+    }
+
+    void store_value(std::size_t i, value_distance_type const& d, const value_type * ptr)
+    {
+        neighbors_type & neighbors = m_neighbors[i];
+        if ( neighbors.size() < m_count )
+        {
+            neighbors.push_back(std::make_pair(d, ptr));
+
+            if ( neighbors.size() == m_count )
+            {
+                std::make_heap(neighbors.begin(), neighbors.end(), pair_first_less());
+            }
+        }
+        else if ( d < neighbors.front().first )
+        {
+            std::pop_heap(neighbors.begin(), neighbors.end(), pair_first_less());
+            neighbors.back() = std::make_pair(d, ptr);
+            std::push_heap(neighbors.begin(), neighbors.end(), pair_first_less());
+        }
+    }
+
+    MembersHolder const& m_members;
+    translator_type const& m_tr;
+    strategy_type m_strategy;
+    size_type m_count;
+
+    // the neighbors of each value of the processed leaf
+    std::vector<neighbors_type> m_neighbors;
+    std::vector<std::size_t> m_active;
+    branches_type m_branches;
+};
+
+}}} // namespace detail::rtree::visitors
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_ALL_NEAREST_HPP
@@ -0,0 +1,237 @@
+// Boost.Geometry Index
+//
+// R-tree batch distance (knn) query visitor implementation
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_BATCH_DISTANCE_QUERY_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_BATCH_DISTANCE_QUERY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/algorithms/assign.hpp>
+#include <boost/geometry/algorithms/expand.hpp>
+#include <boost/geometry/core/tags.hpp>
+#include <boost/geometry/geometries/box.hpp>
+
+#include <boost/geometry/index/detail/algorithms/hilbert_key.hpp>
+#include <boost/geometry/index/detail/distance_predicates.hpp>
+#include <boost/geometry/index/detail/parallel.hpp>
+#include <boost/geometry/index/detail/predicates.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/distance_query.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree { namespace visitors {
+
+namespace batch_distance_query_detail {
+
+// The point of the distance predicate used to order the queries.
+// Queries of other distance predicates are performed in the original order.
+template <typename DistancePredicate, typename Enable = void>
+struct query_point
+{
+    static const bool enabled = false;
+};
+
+template <typename PointRelation>
+struct query_point
+    <
+        index::detail::predicates::nearest<PointRelation>,
+        std::enable_if_t
+            <
+                std::is_same
+                    <
+                        typename geometry::tag
+                            <
+                                typename index::detail::relation<PointRelation>::value_type
+                            >::type,
+                        point_tag
+                    >::value
+            >
+    >
+{
+    static const bool enabled = true;
+
+    typedef typename index::detail::relation<PointRelation>::value_type type;
+
+    static inline type const& get(index::detail::predicates::nearest<PointRelation> const& p)
+    {
+        return index::detail::relation<PointRelation>::value(p.point_or_relation);
+    }
+};
+
+} // namespace batch_distance_query_detail
+
+// Answers many k-nearest neighbors queries.
+// The storage of the branches and neighbors is reused by all of the queries
+// performed by a thread. The queries are performed in the order of the Hilbert
+// curve passing through their points so the upper levels of the tree and
+// neighbouring leafs are likely to still be in cache. The values are written
+// to the output iterator as pairs of the index of the query in the range of
+// predicates and the value, query after query. The queries are written in waves
+// of wave_size queries, in the order of the range within a wave.
+template <typename MembersHolder, typename PredicatesRange>
+class batch_distance_query
+{
+    typedef typename MembersHolder::value_type value_type;
+    typedef typename MembersHolder::size_type size_type;
+
+    typedef typename PredicatesRange::value_type predicates_type;
+    typedef index::detail::predicates_element
+        <
+            index::detail::predicates_find_distance<predicates_type>::value, predicates_type
+        > nearest_predicate_access;
+    typedef typename nearest_predicate_access::type nearest_predicate_type;
+    typedef batch_distance_query_detail::query_point<nearest_predicate_type> query_point;
+
+    typedef distance_query<MembersHolder, predicates_type> distance_query_type;
+
+    // the number of queries in the smallest part of the work handled by a thread
+    static const std::size_t min_chunk_size = 64;
+    // the number of queries performed before their results are written, it doesn't
+    // depend on the number of threads so the results are written in the same order
+    static const std::size_t wave_size = 64 * min_chunk_size;
+
+    // the results of a query stored in the buffer of a chunk
+    struct found_range
+    {
+        std::size_t chunk;
+        std::size_t first;
+        size_type count;
+    };
+
+public:
+    typedef std::pair<std::size_t, value_type> result_type;
+
+    batch_distance_query(MembersHolder const& members, PredicatesRange const& predicates)
+        : m_members(members)
+        , m_predicates(predicates)
+    {}
+
+    // The sorted queries are performed in waves. The results of a wave are stored
+    // in the buffers of the chunks of the wave and written in the order of the range
+    // of predicates before the next wave starts, then the buffers are reused.
+    template <typename OutIter>
+    size_type apply(OutIter out_it, std::size_t threads)
+    {
+        std::size_t const count = m_predicates.size();
+        if ( count == 0 )
+            return 0;
+
+        // the queries in the order in which they are performed
+        std::vector<std::size_t> order(count);
+        for ( std::size_t i = 0 ; i < count ; ++i )
+            order[i] = i;
+        sort_queries(order, std::integral_constant<bool, query_point::enabled>());
+
+        if ( threads < 1 )
+            threads = 1;
+
+        std::vector<std::vector<const value_type *> > found;
+        std::vector<found_range> ranges((std::min)(count, std::size_t(wave_size)));
+        std::vector<std::size_t> positions;
+        positions.reserve(ranges.size());
+
+        size_type found_count = 0;
+        for ( std::size_t wave_first = 0 ; wave_first < count ; wave_first += wave_size )
+        {
+            std::size_t const wave_count = (std::min)(std::size_t(wave_size), count - wave_first);
+            std::size_t chunk_size = wave_count / (4 * threads);
+            if ( chunk_size < min_chunk_size )
+                chunk_size = min_chunk_size;
+            std::size_t const chunks_count = (wave_count + chunk_size - 1) / chunk_size;
+            if ( found.size() < chunks_count )
+                found.resize(chunks_count);                                         // MAY THROW (alloc)
+
+            index::detail::parallel_for(chunks_count, threads, [&](std::size_t c)
+            {
+                std::size_t const first = c * chunk_size;
+                std::size_t const last = (std::min)(first + chunk_size, wave_count);
+
+                std::vector<const value_type *> & buffer = found[c];
+                buffer.clear();
+                distance_query_type query(m_members, m_predicates[order[wave_first + first]]);
+                for ( std::size_t j = first ; j < last ; ++j )
+                {
+                    found_range & r = ranges[j];
+                    r.chunk = c;
+                    r.first = buffer.size();
+                    r.count = query.apply_pointers(m_members, m_predicates[order[wave_first + j]],
+                                                   std::back_inserter(buffer));
+                }
+            });                                                                     // MAY THROW
+
+            // the queries of the wave in the order of the range of predicates
+            positions.clear();
+            for ( std::size_t j = 0 ; j < wave_count ; ++j )
+                positions.push_back(j);
+            std::sort(positions.begin(), positions.end(), [&](std::size_t l, std::size_t r)
+            {
+                return order[wave_first + l] < order[wave_first + r];
+            });
+
+            for ( std::size_t j : positions )
+            {
+                found_range const& r = ranges[j];
+                std::vector<const value_type *> const& buffer = found[r.chunk];
+                for ( size_type k = 0 ; k < r.count ; ++k )
+                {
+                    *out_it = result_type(order[wave_first + j], *buffer[r.first + k]);  // MAY THROW (V: copy)
+                    ++out_it;
+                }
+                found_count += r.count;
+            }
+        }
+        return found_count;
+    }
+
+private:
+    void sort_queries(std::vector<std::size_t> &, std::false_type) const
+    {}
+
+    void sort_queries(std::vector<std::size_t> & order, std::true_type) const
+    {
+        typedef typename query_point::type point_type;
+        typedef geometry::model::box<point_type> box_type;
+
+        box_type bounds;
+        geometry::assign_inverse(bounds);
+        for ( predicates_type const& p : m_predicates )
+        {
+            geometry::expand(bounds, query_point::get(nearest_predicate_access::get(p)));
+        }
+
+        std::vector<std::pair<std::uint64_t, std::size_t> > keys;
+        keys.reserve(order.size());
+        index::detail::hilbert_key<point_type> const key(bounds);
+        for ( std::size_t i : order )
+        {
+            keys.push_back(std::make_pair(key(query_point::get(nearest_predicate_access::get(m_predicates[i]))), i));
+        }
+
+        std::sort(keys.begin(), keys.end());
+
+        for ( std::size_t i = 0 ; i < keys.size() ; ++i )
+        {
+            order[i] = keys[i].second;
+        }
+    }
+
+    MembersHolder const& m_members;
+    PredicatesRange const& m_predicates;
+};
+
+}}} // namespace detail::rtree::visitors
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_BATCH_DISTANCE_QUERY_HPP
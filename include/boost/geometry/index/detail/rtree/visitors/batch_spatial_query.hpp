@@ -0,0 +1,283 @@
+// Boost.Geometry Index
+//
+// R-tree batch spatial query visitor implementation
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_BATCH_SPATIAL_QUERY_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_BATCH_SPATIAL_QUERY_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/index/detail/distance_predicates.hpp>
+#include <boost/geometry/index/detail/parallel.hpp>
+#include <boost/geometry/index/detail/predicates.hpp>
+#include <boost/geometry/index/detail/rtree/node/node_elements.hpp>
+#include <boost/geometry/index/parameters.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree { namespace visitors {
+
+// Answers many spatial queries in one traversal of the tree.
+// Each node is visited once for all of the queries whose predicates are met
+// by its bounds. Found values are written to the output iterator as pairs of
+// the index of the query in the range of predicates and the value.
+template <typename MembersHolder, typename PredicatesRange>
+class batch_spatial_query
+{
+    typedef typename MembersHolder::value_type value_type;
+    typedef typename MembersHolder::parameters_type parameters_type;
+    typedef typename MembersHolder::translator_type translator_type;
+    typedef typename MembersHolder::allocators_type allocators_type;
+
+    typedef typename index::detail::strategy_type<parameters_type>::type strategy_type;
+
+    typedef typename MembersHolder::node node;
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+
+    typedef typename allocators_type::node_pointer node_pointer;
+    typedef typename allocators_type::size_type size_type;
+
+    typedef index::detail::comparable_bounds_predicates
+        <
+            typename PredicatesRange::value_type,
+            typename MembersHolder::box_type,
+            typename index::detail::indexable_type<translator_type>::type,
+            strategy_type
+        > bounds_predicates;
+    typedef std::integral_constant<bool, bounds_predicates::is_converted> is_converted;
+
+    // the predicates with the maximum distances converted into the comparable ones
+    // are stored in a vector, otherwise the range passed by the user is referenced
+    typedef std::vector<typename bounds_predicates::type> converted_predicates_type;
+    typedef std::conditional_t
+        <
+            is_converted::value, converted_predicates_type, PredicatesRange
+        > predicates_range_type;
+
+    typedef std::vector<std::size_t> indexes_type;
+
+    // subtree and queries which are traversed independently
+    struct task
+    {
+        node_pointer ptr;
+        size_type reverse_level;
+        indexes_type queries;
+    };
+
+public:
+    typedef std::pair<std::size_t, value_type> result_type;
+
+    batch_spatial_query(MembersHolder const& members, PredicatesRange const& predicates)
+        : m_members(members)
+        , m_tr(members.translator())
+        , m_strategy(index::detail::get_strategy(members.parameters()))
+        , m_converted(convert(predicates, m_strategy, is_converted()))
+        , m_predicates(converted(predicates, m_converted, is_converted()))
+    {}
+
+    template <typename OutIter>
+    size_type apply(OutIter out_it)
+    {
+        indexes_type queries(m_predicates.size());
+        for ( std::size_t i = 0 ; i < queries.size() ; ++i )
+            queries[i] = i;
+
+        m_levels.resize(m_members.leafs_level);
+        return traverse(m_members.root, m_members.leafs_level, queries, out_it);
+    }
+
+    // The work is split into independent tasks, subtrees and queries, which are
+    // traversed in parallel. Then the results are written in the order in which
+    // they would be written by the sequential version.
+    template <typename OutIter>
+    size_type apply(OutIter out_it, std::size_t threads)
+    {
+        if ( threads <= 1 )
+            return apply(out_it);
+
+        std::vector<task> tasks(1);
+        tasks.front().ptr = m_members.root;
+        tasks.front().reverse_level = m_members.leafs_level;
+        tasks.front().queries.resize(m_predicates.size());
+        for ( std::size_t i = 0 ; i < m_predicates.size() ; ++i )
+            tasks.front().queries[i] = i;
+
+        // split the tasks, preserving the traversal order, until there is enough of them
+        std::size_t const min_tasks_count = 4 * threads;
+        while ( tasks.size() < min_tasks_count && split_tasks(tasks) )
+        {}
+
+        std::vector<std::vector<result_type> > results(tasks.size());
+        index::detail::parallel_for(tasks.size(), threads, [&](std::size_t i)
+        {
+            batch_spatial_query query(m_members, m_predicates, m_strategy);
+            query.m_levels.resize(tasks[i].reverse_level);
+            auto out = std::back_inserter(results[i]);
+            query.traverse(tasks[i].ptr, tasks[i].reverse_level, tasks[i].queries, out);
+        });                                                                         // MAY THROW
+
+        size_type found_count = 0;
+        for ( std::vector<result_type> const& r : results )
+        {
+            for ( result_type const& v : r )
+            {
+                *out_it = v;
+                ++out_it;
+            }
+            found_count += r.size();
+        }
+        return found_count;
+    }
+
+private:
+    // the task of the parallel query sharing the converted predicates
+    batch_spatial_query(MembersHolder const& members, predicates_range_type const& predicates,
+                        strategy_type const& strategy)
+        : m_members(members)
+        , m_tr(members.translator())
+        , m_strategy(strategy)
+        , m_predicates(predicates)
+    {}
+
+    static converted_predicates_type convert(PredicatesRange const& predicates,
+                                             strategy_type const& strategy,
+                                             std::true_type /*is_converted*/)
+    {
+        converted_predicates_type result;
+        result.reserve(predicates.size());                                          // MAY THROW
+        for ( auto const& p : predicates )
+            result.push_back(bounds_predicates::apply(p, strategy));
+        return result;
+    }
+
+    static converted_predicates_type convert(PredicatesRange const&, strategy_type const&,
+                                             std::false_type /*is_converted*/)
+    {
+        return converted_predicates_type();
+    }
+
+    static converted_predicates_type const& converted(PredicatesRange const&,
+                                                      converted_predicates_type const& c,
+                                                      std::true_type /*is_converted*/)
+    {
+        return c;
+    }
+
+    static PredicatesRange const& converted(PredicatesRange const& predicates,
+                                            converted_predicates_type const&,
+                                            std::false_type /*is_converted*/)
+    {
+        return predicates;
+    }
+
+    template <typename OutIter>
+    size_type traverse(node_pointer ptr, size_type reverse_level,
+                       indexes_type const& queries, OutIter & out_it)
+    {
+        namespace id = index::detail;
+
+        size_type found_count = 0;
+
+        if ( reverse_level > 0 )
+        {
+            internal_node& n = rtree::get<internal_node>(*ptr);
+            indexes_type & child_queries = m_levels[reverse_level - 1];
+            for ( auto const& p : rtree::elements(n) )
+            {
+                // queries meeting predicates in this child node (0 is dummy value)
+                child_queries.clear();
+                for ( std::size_t i : queries )
+                {
+                    if ( id::predicates_check<id::bounds_tag>(m_predicates[i], 0, p.first, m_strategy) )
+                        child_queries.push_back(i);
+                }
+
+                if ( ! child_queries.empty() )
+                {
+                    found_count += traverse(p.second, reverse_level - 1, child_queries, out_it);
+                }
+            }
+        }
+        else
+        {
+            leaf& n = rtree::get<leaf>(*ptr);
+            for ( auto const& v : rtree::elements(n) )
+            {
+                for ( std::size_t i : queries )
+                {
+                    if ( id::predicates_check<id::value_tag>(m_predicates[i], v, m_tr(v), m_strategy) )
+                    {
+                        *out_it = result_type(i, v);
+                        ++out_it;
+                        ++found_count;
+                    }
+                }
+            }
+        }
+
+        return found_count;
+    }
+
+    // Replaces tasks traversing internal nodes with tasks traversing their children.
+    // Returns false if there were no such tasks.
+    bool split_tasks(std::vector<task> & tasks) const
+    {
+        namespace id = index::detail;
+
+        std::vector<task> result;
+        bool split = false;
+        for ( task & t : tasks )
+        {
+            if ( t.reverse_level == 0 )
+            {
+                result.push_back(std::move(t));
+                continue;
+            }
+
+            split = true;
+            internal_node& n = rtree::get<internal_node>(*t.ptr);
+            for ( auto const& p : rtree::elements(n) )
+            {
+                task child;
+                child.ptr = p.second;
+                child.reverse_level = t.reverse_level - 1;
+                for ( std::size_t i : t.queries )
+                {
+                    if ( id::predicates_check<id::bounds_tag>(m_predicates[i], 0, p.first, m_strategy) )
+                        child.queries.push_back(i);
+                }
+
+                if ( ! child.queries.empty() )
+                    result.push_back(std::move(child));
+            }
+        }
+
+        tasks.swap(result);
+        return split;
+    }
+
+    MembersHolder const& m_members;
+    translator_type const& m_tr;
+    strategy_type m_strategy;
+
+    converted_predicates_type m_converted;
+    predicates_range_type const& m_predicates;
+
+    // the queries passed to the children, for each level
+    std::vector<indexes_type> m_levels;
+};
+
+}}} // namespace detail::rtree::visitors
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_BATCH_SPATIAL_QUERY_HPP
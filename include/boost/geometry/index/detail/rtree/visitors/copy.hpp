@@ -63,6 +63,8 @@ public:
             auto_result.release();
         }
 
+        rtree::subtree_values_count<MembersHolder>::copy(rtree::get<internal_node>(*new_node), n);
+
         result = new_node.get();
         new_node.release();
     }
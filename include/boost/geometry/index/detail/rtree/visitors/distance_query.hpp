@@ -21,6 +21,7 @@
 #include <boost/geometry/index/detail/predicates.hpp>
 #include <boost/geometry/index/detail/priority_dequeue.hpp>
 #include <boost/geometry/index/detail/rtree/node/node_elements.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/query_statistics.hpp>
 #include <boost/geometry/index/detail/translator.hpp>
 #include <boost/geometry/index/parameters.hpp>
 
@@ -164,12 +165,18 @@ class distance_query
     typedef typename MembersHolder::internal_node internal_node;
     typedef typename MembersHolder::leaf leaf;
 
+    typedef typename indexable_type<translator_type>::type indexable_type;
+    typedef index::detail::comparable_bounds_predicates
+        <
+            Predicates, box_type, indexable_type, strategy_type
+        > bounds_predicates;
+    typedef typename bounds_predicates::type predicates_type;
+
     typedef index::detail::predicates_element
         <
-            index::detail::predicates_find_distance<Predicates>::value, Predicates
+            index::detail::predicates_find_distance<predicates_type>::value, predicates_type
         > nearest_predicate_access;
     typedef typename nearest_predicate_access::type nearest_predicate_type;
-    typedef typename indexable_type<translator_type>::type indexable_type;
 
     typedef index::detail::calculate_distance<nearest_predicate_type, indexable_type, strategy_type, value_tag> calculate_value_distance;
     typedef index::detail::calculate_distance<nearest_predicate_type, box_type, strategy_type, bounds_tag> calculate_node_distance;
@@ -198,9 +205,15 @@ public:
     distance_query(MembersHolder const& members, Predicates const& pred)
         : m_tr(members.translator())
         , m_strategy(index::detail::get_strategy(members.parameters()))
-        , m_pred(pred)
+        , m_query_pred(boost::addressof(pred))
+        , m_pred(nullptr)
     {
-        m_neighbors.reserve((std::min)(members.values_count, size_type(max_count())));
+        typedef index::detail::predicates_element
+            <
+                index::detail::predicates_find_distance<Predicates>::value, Predicates
+            > query_nearest_access;
+
+        m_neighbors.reserve((std::min)(members.values_count, size_type(query_nearest_access::get(pred).count)));
         //m_branches.reserve(members.parameters().get_min_elements() * members.leafs_level); ?
         // min, max or average?
     }
@@ -208,18 +221,57 @@ public:
     template <typename OutIter>
     size_type apply(MembersHolder const& members, OutIter out_it)
     {
-        return apply(members.root, members.leafs_level, out_it);
+        search(members, *m_query_pred);
+
+        for (auto const& p : m_neighbors)
+        {
+            *out_it = *(p.second);
+            ++out_it;
+        }
+
+        return m_neighbors.size();
     }
 
-private:
+    // Performs the search for other predicates reusing the storage of the previous one.
+    // Pointers to the values found are written to the output iterator.
     template <typename OutIter>
-    size_type apply(node_pointer ptr, size_type reverse_level, OutIter out_it)
+    size_type apply_pointers(MembersHolder const& members, Predicates const& pred, OutIter out_it)
+    {
+        m_query_pred = boost::addressof(pred);
+        m_branches.clear();
+        m_neighbors.clear();
+
+        search(members, pred);
+
+        for (auto const& p : m_neighbors)
+        {
+            *out_it = p.second;
+            ++out_it;
+        }
+
+        return m_neighbors.size();
+    }
+
+private:
+    void search(MembersHolder const& members, Predicates const& pred)
+    {
+        // the maximum distances are converted into the comparable ones once per query,
+        // the converted predicates are alive only during the search
+        auto&& prepared = bounds_predicates::apply(pred, m_strategy);
+        m_pred = boost::addressof(prepared);
+
+        search(members.root, members.leafs_level);
+
+        m_pred = nullptr;
+    }
+
+    void search(node_pointer ptr, size_type reverse_level)
     {
         namespace id = index::detail;
 
         if (max_count() <= 0)
         {
-            return 0;
+            return;
         }
 
         for (;;)
@@ -227,13 +279,15 @@ private:
             if (reverse_level > 0)
             {
                 internal_node& n = rtree::get<internal_node>(*ptr);
+                BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(internal_nodes, 1);
                 // fill array of nodes meeting predicates
                 for (auto const& p : rtree::elements(n))
                 {
                     node_distance_type node_distance; // for distance predicate
 
                     // if current node meets predicates (0 is dummy value)
-                    if (id::predicates_check<id::bounds_tag>(m_pred, 0, p.first, m_strategy)
+                    BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(predicates_checks, 1);
+                    if (id::predicates_check<id::bounds_tag>(*m_pred, 0, p.first, m_strategy)
                         // and if distance is ok
                         && calculate_node_distance::apply(predicate(), p.first, m_strategy, node_distance)
                         // and if current node is closer than the furthest neighbor
@@ -241,19 +295,23 @@ private:
                     {
                         // add current node's data into the list
                         m_branches.push(branch_data(node_distance, reverse_level - 1, p.second));
+                        BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(branches_pushed, 1);
                     }
                 }
             }
             else
             {
                 leaf& n = rtree::get<leaf>(*ptr);
+                BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(leafs, 1);
+                BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(values, rtree::elements(n).size());
                 // search leaf for closest value meeting predicates
                 for (auto const& v : rtree::elements(n))
                 {
                     value_distance_type value_distance; // for distance predicate
 
                     // if value meets predicates
-                    if (id::predicates_check<id::value_tag>(m_pred, v, m_tr(v), m_strategy)
+                    BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(predicates_checks, 1);
+                    if (id::predicates_check<id::value_tag>(*m_pred, v, m_tr(v), m_strategy)
                         // and if distance is ok
                         && calculate_value_distance::apply(predicate(), m_tr(v), m_strategy, value_distance))
                     {
@@ -272,15 +330,8 @@ private:
             ptr = m_branches.top().ptr;
             reverse_level = m_branches.top().reverse_level;
             m_branches.pop();
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(branches_popped, 1);
         }
-
-        for (auto const& p : m_neighbors)
-        {
-            *out_it = *(p.second);
-            ++out_it;
-        }
-
-        return m_neighbors.size();
     }
 
     bool ignore_branch(node_distance_type const& node_distance) const
@@ -310,18 +361,19 @@ private:
 
     std::size_t max_count() const
     {
-        return nearest_predicate_access::get(m_pred).count;
+        return nearest_predicate_access::get(*m_pred).count;
     }
 
     nearest_predicate_type const& predicate() const
     {
-        return nearest_predicate_access::get(m_pred);
+        return nearest_predicate_access::get(*m_pred);
     }
 
     translator_type const& m_tr;
     strategy_type m_strategy;
 
-    Predicates const& m_pred;
+    Predicates const* m_query_pred;
+    predicates_type const* m_pred;
 
     branches_type m_branches;
     neighbors_type m_neighbors;
@@ -342,13 +394,19 @@ class distance_query_incremental
     typedef typename MembersHolder::internal_node internal_node;
     typedef typename MembersHolder::leaf leaf;
 
+    typedef typename indexable_type<translator_type>::type indexable_type;
+    typedef index::detail::comparable_bounds_predicates
+        <
+            Predicates, box_type, indexable_type, strategy_type
+        > bounds_predicates;
+    typedef typename bounds_predicates::type predicates_type;
+
     typedef index::detail::predicates_element
         <
-            index::detail::predicates_find_distance<Predicates>::value, Predicates
+            index::detail::predicates_find_distance<predicates_type>::value, predicates_type
         > nearest_predicate_access;
     typedef typename nearest_predicate_access::type nearest_predicate_type;
-    typedef typename indexable_type<translator_type>::type indexable_type;
-    
+
     typedef index::detail::calculate_distance<nearest_predicate_type, indexable_type, strategy_type, value_tag> calculate_value_distance;
     typedef index::detail::calculate_distance<nearest_predicate_type, box_type, strategy_type, bounds_tag> calculate_node_distance;
     typedef typename calculate_value_distance::result_type value_distance_type;
@@ -389,7 +447,7 @@ public:
     inline distance_query_incremental(Predicates const& pred)
         : m_tr(nullptr)
 //        , m_strategy()
-        , m_pred(pred)
+        , m_pred(bounds_predicates::apply(pred, strategy_type()))
         , m_neighbors_count(0)
         , m_neighbor_ptr(nullptr)        
     {}
@@ -397,7 +455,7 @@ public:
     inline distance_query_incremental(MembersHolder const& members, Predicates const& pred)
         : m_tr(::boost::addressof(members.translator()))
         , m_strategy(index::detail::get_strategy(members.parameters()))
-        , m_pred(pred)
+        , m_pred(bounds_predicates::apply(pred, m_strategy))
         , m_neighbors_count(0)
         , m_neighbor_ptr(nullptr)        
     {}
@@ -464,6 +522,7 @@ public:
                     node_pointer ptr = closest_branch.ptr;
                     size_type reverse_level = closest_branch.reverse_level;
                     m_branches.pop();
+                    BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(branches_popped, 1);
 
                     apply(ptr, reverse_level);
                 }
@@ -491,12 +550,14 @@ private:
         if (reverse_level > 0)
         {
             internal_node& n = rtree::get<internal_node>(*ptr);
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(internal_nodes, 1);
             // fill active branch list array of nodes meeting predicates
             for (auto const& p : rtree::elements(n))
             {
                 node_distance_type node_distance; // for distance predicate
 
                 // if current node meets predicates (0 is dummy value)
+                BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(predicates_checks, 1);
                 if (id::predicates_check<id::bounds_tag>(m_pred, 0, p.first, m_strategy)
                     // and if distance is ok
                     && calculate_node_distance::apply(predicate(), p.first, m_strategy, node_distance)
@@ -505,6 +566,7 @@ private:
                 {
                     // add current node into the queue
                     m_branches.push(branch_data(node_distance, reverse_level - 1, p.second));
+                    BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(branches_pushed, 1);
                 }
             }
         }
@@ -514,12 +576,15 @@ private:
         else
         {
             leaf& n = rtree::get<leaf>(*ptr);
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(leafs, 1);
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(values, rtree::elements(n).size());
             // search leaf for closest value meeting predicates
             for (auto const& v : rtree::elements(n))
             {
                 value_distance_type value_distance; // for distance predicate
 
                 // if value meets predicates
+                BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(predicates_checks, 1);
                 if (id::predicates_check<id::value_tag>(m_pred, v, (*m_tr)(v), m_strategy)
                     // and if distance is ok
                     && calculate_value_distance::apply(predicate(), (*m_tr)(v), m_strategy, value_distance)
@@ -559,7 +624,7 @@ private:
     const translator_type * m_tr;
     strategy_type m_strategy;
 
-    Predicates m_pred;
+    predicates_type m_pred;
     
     branches_type m_branches;
     neighbors_type m_neighbors;
@@ -0,0 +1,292 @@
+// Boost.Geometry Index
+//
+// R-tree visitor estimating the number of values meeting spatial predicates
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_ESTIMATE_COUNT_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_ESTIMATE_COUNT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <boost/geometry/algorithms/envelope.hpp>
+#include <boost/geometry/core/access.hpp>
+#include <boost/geometry/core/coordinate_dimension.hpp>
+#include <boost/geometry/core/static_assert.hpp>
+
+#include <boost/geometry/index/detail/rtree/node/node.hpp>
+#include <boost/geometry/index/detail/rtree/node/node_elements.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/spatial_count.hpp>
+#include <boost/geometry/index/detail/predicates.hpp>
+#include <boost/geometry/index/parameters.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree { namespace visitors {
+
+namespace estimate_count_detail {
+
+// The fraction of the box covered by the other box calculated for each dimension.
+// If the box is degenerated in some dimension the whole extent is covered.
+template <std::size_t Dimension, std::size_t DimensionCount>
+struct boxes_overlap_fraction
+{
+    template <typename Box1, typename Box2>
+    static inline double apply(Box1 const& b, Box2 const& other)
+    {
+        double const min1 = double(geometry::get<min_corner, Dimension>(b));
+        double const max1 = double(geometry::get<max_corner, Dimension>(b));
+        double const min2 = double(geometry::get<min_corner, Dimension>(other));
+        double const max2 = double(geometry::get<max_corner, Dimension>(other));
+
+        double const overlap = (std::min)(max1, max2) - (std::max)(min1, min2);
+        double const fraction = overlap < 0 ? 0.0
+                              : max1 <= min1 ? 1.0
+                              : (std::min)(overlap / (max1 - min1), 1.0);
+
+        return fraction * boxes_overlap_fraction<Dimension + 1, DimensionCount>::apply(b, other);
+    }
+};
+
+template <std::size_t DimensionCount>
+struct boxes_overlap_fraction<DimensionCount, DimensionCount>
+{
+    template <typename Box1, typename Box2>
+    static inline double apply(Box1 const&, Box2 const&)
+    {
+        return 1.0;
+    }
+};
+
+// The estimated fraction of values stored in a node meeting the predicate,
+// the values are assumed to be distributed uniformly in the bounds of the node.
+// The envelopes of the geometries are calculated once for all nodes.
+template <typename Predicate, typename Box>
+struct predicate_fraction
+{
+    BOOST_GEOMETRY_STATIC_ASSERT_FALSE(
+        "Only intersects(), within(), covered_by() and satisfies() predicates are supported.",
+        Predicate);
+};
+
+template <typename Fun, bool Negated, typename Box>
+struct predicate_fraction<index::detail::predicates::satisfies<Fun, Negated>, Box>
+{
+    explicit predicate_fraction(index::detail::predicates::satisfies<Fun, Negated> const&)
+    {}
+
+    inline double apply(Box const&) const
+    {
+        return 1.0;
+    }
+};
+
+template <typename Tag>
+struct is_estimated_tag
+    : std::integral_constant
+        <
+            bool,
+            std::is_same<Tag, index::detail::predicates::intersects_tag>::value
+         || std::is_same<Tag, index::detail::predicates::within_tag>::value
+         || std::is_same<Tag, index::detail::predicates::covered_by_tag>::value
+        >
+{};
+
+template <typename Geometry, typename Tag, typename Box>
+struct predicate_fraction<index::detail::predicates::spatial_predicate<Geometry, Tag, false>, Box>
+{
+    BOOST_GEOMETRY_STATIC_ASSERT((is_estimated_tag<Tag>::value),
+        "Only intersects(), within(), covered_by() and satisfies() predicates are supported.",
+        Tag);
+
+    explicit predicate_fraction(index::detail::predicates::spatial_predicate<Geometry, Tag, false> const& p)
+        : m_envelope(geometry::return_envelope<Box>(p.geometry))
+    {}
+
+    inline double apply(Box const& b) const
+    {
+        return boxes_overlap_fraction<0, geometry::dimension<Box>::value>::apply(b, m_envelope);
+    }
+
+private:
+    Box m_envelope;
+};
+
+// The predicates are treated as independent
+template <typename ...Ts, typename Box>
+struct predicate_fraction<std::tuple<Ts...>, Box>
+{
+    typedef std::tuple<Ts...> predicates_type;
+
+    explicit predicate_fraction(predicates_type const& p)
+        : m_fractions(make_fractions(p, std::index_sequence_for<Ts...>()))
+    {}
+
+    inline double apply(Box const& b) const
+    {
+        return apply(b, std::integral_constant<std::size_t, 0>());
+    }
+
+private:
+    typedef std::tuple<predicate_fraction<Ts, Box>...> fractions_type;
+
+    template <std::size_t ...Is>
+    static inline fractions_type make_fractions(predicates_type const& p, std::index_sequence<Is...>)
+    {
+        return fractions_type(predicate_fraction<Ts, Box>(std::get<Is>(p))...);
+    }
+
+    template <std::size_t I>
+    inline double apply(Box const& b, std::integral_constant<std::size_t, I>) const
+    {
+        return std::get<I>(m_fractions).apply(b)
+             * apply(b, std::integral_constant<std::size_t, I + 1>());
+    }
+
+    inline double apply(Box const&, std::integral_constant<std::size_t, sizeof...(Ts)>) const
+    {
+        return 1.0;
+    }
+
+    fractions_type m_fractions;
+};
+
+} // namespace estimate_count_detail
+
+// Estimates the number of values meeting spatial predicates traversing only
+// the nodes at the top levels of the tree. The nodes at the last traversed
+// level meeting the predicates are not visited. Instead the number of values
+// stored in their subtrees is scaled by the fraction of the bounds of the node
+// overlapped by the envelopes of the geometries passed into the predicates.
+// Values stored in the visited leafs are counted exactly.
+template <typename MembersHolder, typename Predicates>
+struct estimate_count
+{
+    typedef typename MembersHolder::box_type box_type;
+    typedef typename MembersHolder::parameters_type parameters_type;
+    typedef typename MembersHolder::translator_type translator_type;
+    typedef typename MembersHolder::allocators_type allocators_type;
+
+    typedef typename index::detail::strategy_type<parameters_type>::type strategy_type;
+
+    typedef typename MembersHolder::node node;
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+
+    typedef typename allocators_type::node_pointer node_pointer;
+    typedef typename allocators_type::size_type size_type;
+
+    typedef rtree::subtree_values_count<MembersHolder> subtree_values_count;
+    typedef spatial_count_detail::predicate_covers_bounds<Predicates> covers_bounds;
+    typedef estimate_count_detail::predicate_fraction<Predicates, box_type> predicate_fraction;
+
+    // levels is the number of levels of nodes whose children are tested, at least the root
+    estimate_count(MembersHolder const& members, Predicates const& p, size_type levels)
+        : m_tr(members.translator())
+        , m_strategy(index::detail::get_strategy(members.parameters()))
+        , m_pred(p)
+        , m_fraction(p)
+        , m_levels((std::max)(levels, size_type(1)))
+        , m_fanout(average_fanout(members))
+        , m_result(0)
+    {}
+
+    double apply(node_pointer ptr, size_type reverse_level, size_type level)
+    {
+        namespace id = index::detail;
+        if (reverse_level > 0)
+        {
+            internal_node& n = rtree::get<internal_node>(*ptr);
+            for (auto const& p : rtree::elements(n))
+            {
+                // if node meets predicates (0 is dummy value)
+                if (! id::predicates_check<id::bounds_tag>(m_pred, 0, p.first, m_strategy))
+                {
+                    continue;
+                }
+
+                // the covered nodes are traversed if the counts are not stored
+                // in the nodes so the result is exact if all levels are traversed
+                bool const covered = covers_bounds::apply(m_pred, p.first, m_strategy);
+                if ((! covered || ! subtree_values_count::is_stored) && level + 1 < m_levels)
+                {
+                    apply(p.second, reverse_level - 1, level + 1);
+                    continue;
+                }
+
+                double const count = subtree_count(p.second, reverse_level - 1);
+                m_result += covered ? count : count * m_fraction.apply(p.first);
+            }
+        }
+        else
+        {
+            leaf& n = rtree::get<leaf>(*ptr);
+            for (auto const& v : rtree::elements(n))
+            {
+                // if value meets predicates
+                if (id::predicates_check<id::value_tag>(m_pred, v, m_tr(v), m_strategy))
+                {
+                    m_result += 1;
+                }
+            }
+        }
+
+        return m_result;
+    }
+
+    size_type apply(MembersHolder const& members)
+    {
+        return static_cast<size_type>(apply(members.root, members.leafs_level, 0) + 0.5);
+    }
+
+private:
+    // The number of values stored in the subtree of the node. If the counts are not
+    // stored in the nodes it's estimated from the number of the children of the node.
+    double subtree_count(node_pointer ptr, size_type reverse_level) const
+    {
+        if (reverse_level == 0)
+        {
+            return double(subtree_values_count::get(rtree::get<leaf>(*ptr)));
+        }
+
+        internal_node const& n = rtree::get<internal_node>(*ptr);
+        return subtree_values_count::is_stored
+             ? double(subtree_values_count::get(n))
+             : double(rtree::elements(n).size()) * std::pow(m_fanout, double(reverse_level));
+    }
+
+    // the average number of children of internal nodes below the root
+    static double average_fanout(MembersHolder const& members)
+    {
+        if (members.leafs_level == 0)
+        {
+            return 1.0;
+        }
+
+        double const root_count = double(rtree::elements(rtree::get<internal_node>(*members.root)).size());
+        return std::pow(double(members.values_count) / root_count, 1.0 / double(members.leafs_level));
+    }
+
+    translator_type const& m_tr;
+    strategy_type m_strategy;
+
+    Predicates const& m_pred;
+    predicate_fraction m_fraction;
+
+    size_type m_levels;
+    double m_fanout;
+    double m_result;
+};
+
+}}} // namespace detail::rtree::visitors
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_ESTIMATE_COUNT_HPP
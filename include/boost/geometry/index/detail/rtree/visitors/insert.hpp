@@ -15,11 +15,16 @@
 #ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_INSERT_HPP
 #define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_INSERT_HPP
 
+#include <cstddef>
+#include <vector>
+
 #ifdef BOOST_GEOMETRY_INDEX_EXPERIMENTAL_ENLARGE_BY_EPSILON
 #include <type_traits>
 #endif
 
 #include <boost/geometry/algorithms/detail/expand_by_epsilon.hpp>
+#include <boost/geometry/core/access.hpp>
+#include <boost/geometry/core/coordinate_dimension.hpp>
 #include <boost/geometry/core/static_assert.hpp>
 
 #include <boost/geometry/index/detail/algorithms/bounds.hpp>
@@ -221,6 +226,88 @@ public:
 
 // ----------------------------------------------------------------------- //
 
+// The indexes of the children chosen at each level during the last insertion.
+// The path is tried first during the next insertion. The child is chosen
+// without calling choose_next_node as long as its box covers the inserted
+// element, so the path stays valid even if the tree was modified in the
+// meantime. If the next node is chosen by the smallest increase of content
+// the child is also chosen if its box is enlarged only slightly. Otherwise
+// the path is still followed at the lower levels if choose_next_node chooses
+// the same child. The path is not used if the height of the tree has changed.
+struct insert_hint
+{
+    insert_hint()
+        : leafs_level(0)
+    {}
+
+    std::vector<std::size_t> path;
+    std::size_t leafs_level;
+};
+
+// Checks if the box of a child contains the box of the inserted element. The
+// coordinates are compared directly so e.g. boxes crossing the antimeridian are
+// not detected but the result only decides whether the hint is followed.
+template <std::size_t Dimension, std::size_t DimensionCount>
+struct hint_box_covers
+{
+    template <typename Box>
+    static inline bool apply(Box const& b, Box const& element)
+    {
+        return geometry::get<min_corner, Dimension>(b) <= geometry::get<min_corner, Dimension>(element)
+            && geometry::get<max_corner, Dimension>(element) <= geometry::get<max_corner, Dimension>(b)
+            && hint_box_covers<Dimension + 1, DimensionCount>::apply(b, element);
+    }
+};
+
+template <std::size_t DimensionCount>
+struct hint_box_covers<DimensionCount, DimensionCount>
+{
+    template <typename Box>
+    static inline bool apply(Box const&, Box const&)
+    {
+        return true;
+    }
+};
+
+// Checks if the child from the hint may be chosen for the element, i.e. if its
+// box covers the box of the element. The nodes chosen by the overlap, as in R*-tree,
+// are not accepted otherwise because the overlap of the boxes could increase.
+template <typename ChooseNextNodeTag>
+struct is_hint_acceptable
+{
+    template <typename Box, typename Strategy>
+    static inline bool apply(Box const& b, Box const& element, Strategy const& )
+    {
+        return hint_box_covers<0, geometry::dimension<Box>::value>::apply(b, element);
+    }
+};
+
+// The nodes chosen by the increase of content are also accepted if the content
+// of the box increases by at most 1/8 when expanded. The degenerated boxes
+// have to cover the element.
+template <>
+struct is_hint_acceptable<choose_by_content_diff_tag>
+{
+    template <typename Box, typename Strategy>
+    static inline bool apply(Box const& b, Box const& element, Strategy const& strategy)
+    {
+        if ( hint_box_covers<0, geometry::dimension<Box>::value>::apply(b, element) )
+            return true;
+
+        typedef typename index::detail::default_content_result<Box>::type content_type;
+
+        content_type const content = index::detail::content(b);
+        if ( content <= content_type(0) )
+            return false;
+
+        Box expanded = b;
+        index::detail::expand(expanded, element, strategy);
+        return (index::detail::content(expanded) - content) * 8 <= content;
+    }
+};
+
+// ----------------------------------------------------------------------- //
+
 namespace visitors { namespace detail {
 
 template <typename InternalNode, typename InternalNodePtr, typename SizeType>
@@ -282,6 +369,7 @@ protected:
     typedef typename MembersHolder::leaf leaf;
 
     typedef rtree::subtree_destroyer<MembersHolder> subtree_destroyer;
+    typedef rtree::subtree_values_count<MembersHolder> values_count_type;
     typedef typename allocators_type::node_pointer node_pointer;
     typedef typename allocators_type::size_type size_type;
 
@@ -305,6 +393,10 @@ protected:
         , m_leafs_level(leafs_level)
         , m_traverse_data()
         , m_allocators(allocators)
+        , m_hint(0)
+        , m_follow_hint(false)
+        , m_values_count_added(values_count_type::element_count(element, relative_level))
+        , m_values_count_removed(0)
     {
         BOOST_GEOMETRY_INDEX_ASSERT(m_relative_level <= leafs_level, "unexpected level value");
         BOOST_GEOMETRY_INDEX_ASSERT(m_level <= m_leafs_level, "unexpected level value");
@@ -338,14 +430,55 @@ protected:
 #endif
     }
 
+public:
+    // The hint is used only for the insertion of an element to the leafs level.
+    inline void set_hint(insert_hint * hint)
+    {
+        if ( m_level != m_leafs_level )
+        {
+            return;
+        }
+
+        m_hint = hint;
+        m_follow_hint = hint->leafs_level == m_leafs_level
+                     && hint->path.size() == m_leafs_level;
+        hint->leafs_level = m_leafs_level;
+        hint->path.resize(m_leafs_level);
+    }
+
+protected:
+
     template <typename Visitor>
     inline void traverse(Visitor & visitor, internal_node & n)
     {
-        // choose next node
-        size_t choosen_node_index = rtree::choose_next_node<MembersHolder>
-            ::apply(n, rtree::element_indexable(m_element, m_translator),
-                    m_parameters,
-                    m_leafs_level - m_traverse_data.current_level);
+        size_type const level = m_traverse_data.current_level;
+
+        // choose next node, the one from the hint if it's acceptable for the element
+        size_t choosen_node_index = 0;
+        if ( m_follow_hint
+          && m_hint->path[level] < rtree::elements(n).size()
+          && is_hint_acceptable<typename MembersHolder::options_type::choose_next_node_tag>
+                ::apply(rtree::elements(n)[m_hint->path[level]].first, m_element_bounds,
+                        index::detail::get_strategy(m_parameters)) )
+        {
+            choosen_node_index = m_hint->path[level];
+        }
+        else
+        {
+            choosen_node_index = rtree::choose_next_node<MembersHolder>
+                ::apply(n, rtree::element_indexable(m_element, m_translator),
+                        m_parameters,
+                        m_leafs_level - level);
+
+            // the rest of the path is valid only in the same subtree
+            m_follow_hint = m_follow_hint
+                         && m_hint->path[level] == choosen_node_index;
+        }
+
+        if ( m_hint )
+        {
+            m_hint->path[level] = choosen_node_index;
+        }
 
         // expand the node to contain value
         index::detail::expand(
@@ -366,6 +499,8 @@ protected:
                                     &n == &rtree::get<Node>(*m_traverse_data.current_element().second),
                                     "if node isn't the root current_child_index should be valid");
 
+        update_values_count(n);
+
         // handle overflow
         if ( m_parameters.get_max_elements() < rtree::elements(n).size() )
         {
@@ -375,6 +510,15 @@ protected:
         }
     }
 
+    // applies the change of the number of values stored in the subtree of
+    // the node traversed on the way back from the level of the element
+    template <typename Node>
+    inline void update_values_count(Node & n) const
+    {
+        values_count_type::add(n, m_values_count_added);
+        values_count_type::subtract(n, m_values_count_removed);
+    }
+
     template <typename Visitor>
     inline void traverse_apply_visitor(Visitor & visitor, internal_node &n, size_t choosen_node_index)
     {
@@ -419,6 +563,9 @@ protected:
         // for exception safety
         subtree_destroyer additional_node_ptr(additional_nodes[0].second, m_allocators);
 
+        values_count_type::split(n, rtree::get<Node>(*additional_nodes[0].second),
+                                 m_leafs_level - m_traverse_data.current_level);
+
 #ifdef BOOST_GEOMETRY_INDEX_EXPERIMENTAL_ENLARGE_BY_EPSILON
         // Enlarge bounds of a leaf node.
         // It's because Points and Segments are compared WRT machine epsilon
@@ -464,6 +611,9 @@ protected:
             }
             BOOST_CATCH_END
 
+            values_count_type::update(rtree::get<internal_node>(*new_root),
+                                      m_leafs_level - m_traverse_data.current_level + 1);
+
             m_root_node = new_root.get();
             ++m_leafs_level;
 
@@ -489,6 +639,14 @@ protected:
     insert_traverse_data<internal_node, internal_node_pointer, size_type> m_traverse_data;
 
     allocators_type & m_allocators;
+
+    insert_hint * m_hint;
+    bool m_follow_hint;
+
+    // the number of values of the inserted element and of the elements
+    // removed from the nodes of the traversed path in order to reinsert them
+    size_type m_values_count_added;
+    size_type m_values_count_removed;
 };
 
 } // namespace detail
@@ -42,6 +42,7 @@ class remove
     typedef typename MembersHolder::leaf leaf;
 
     typedef rtree::subtree_destroyer<MembersHolder> subtree_destroyer;
+    typedef rtree::subtree_values_count<MembersHolder> values_count_type;
     typedef typename allocators_type::node_pointer node_pointer;
     typedef typename allocators_type::size_type size_type;
 
@@ -64,6 +65,7 @@ public:
         , m_root_node(root)
         , m_leafs_level(leafs_level)
         , m_is_value_removed(false)
+        , m_values_count_removed(values_count_type::element_count(value, 0))
         , m_parent(0)
         , m_current_child_index(0)
         , m_current_level(0)
@@ -107,6 +109,9 @@ public:
                 element_iterator underfl_el_it = elements.begin() + child_node_index;
                 size_type relative_level = m_leafs_level - m_current_level;
 
+                // the values of the node are reinserted later
+                m_values_count_removed += values_count_type::element_count(*underfl_el_it, relative_level);
+
                 // move node to the container - store node's relative level as well and return new underflow state
                 // NOTE: if the min elements number is 1, then after an underflow
                 //       here the child elements count is 0, so it's not required to store this node,
@@ -114,6 +119,8 @@ public:
                 m_is_underflow = store_underflowed_node(elements, underfl_el_it, relative_level);                       // MAY THROW (E: alloc, copy)
             }
 
+            values_count_type::subtract(n, m_values_count_removed);
+
             // n is not root - adjust aabb
             if ( 0 != m_parent )
             {
@@ -336,6 +343,10 @@ private:
     bool m_is_value_removed;
     underflow_nodes m_underflowed_nodes;
 
+    // the number of values removed from the subtrees of the traversed nodes,
+    // the value and the values of the underflowed nodes
+    size_type m_values_count_removed;
+
     // traversing input parameters
     internal_node_pointer m_parent;
     internal_size_type m_current_child_index;
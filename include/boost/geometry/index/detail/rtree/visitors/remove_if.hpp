@@ -0,0 +1,403 @@
+// Boost.Geometry Index
+//
+// R-tree removing values meeting predicates visitor implementation
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_REMOVE_IF_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_REMOVE_IF_HPP
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/index/detail/distance_predicates.hpp>
+#include <boost/geometry/index/detail/predicates.hpp>
+#include <boost/geometry/index/detail/rtree/node/node_elements.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/destroy.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/insert.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/is_leaf.hpp>
+#include <boost/geometry/index/parameters.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree { namespace visitors {
+
+// Removes all values meeting the predicates in one traversal.
+// Nodes which underflow are detached from the tree during the traversal and
+// their elements are reinserted after the whole tree is traversed.
+template <typename MembersHolder, typename Predicates>
+class remove_if
+    : public MembersHolder::visitor
+{
+    typedef typename MembersHolder::box_type box_type;
+    typedef typename MembersHolder::value_type value_type;
+    typedef typename MembersHolder::parameters_type parameters_type;
+    typedef typename MembersHolder::translator_type translator_type;
+    typedef typename MembersHolder::allocators_type allocators_type;
+
+    typedef typename MembersHolder::node node;
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+
+    typedef rtree::subtree_values_count<MembersHolder> values_count_type;
+    typedef typename allocators_type::node_pointer node_pointer;
+    typedef typename allocators_type::size_type size_type;
+
+    typedef typename rtree::elements_type<internal_node>::type::size_type internal_size_type;
+
+    //typedef typename Allocators::internal_node_pointer internal_node_pointer;
+    typedef internal_node * internal_node_pointer;
+
+    typedef index::detail::comparable_bounds_predicates
+        <
+            Predicates,
+            box_type,
+            typename index::detail::indexable_type<translator_type>::type,
+            typename index::detail::strategy_type<parameters_type>::type
+        > bounds_predicates;
+
+public:
+    inline remove_if(node_pointer & root,
+                     size_type & leafs_level,
+                     Predicates const& predicates,
+                     parameters_type const& parameters,
+                     translator_type const& translator,
+                     allocators_type & allocators)
+        : m_pred(bounds_predicates::apply(predicates, index::detail::get_strategy(parameters)))
+        , m_parameters(parameters)
+        , m_translator(translator)
+        , m_allocators(allocators)
+        , m_root_node(root)
+        , m_leafs_level(leafs_level)
+        , m_removed_count(0)
+        , m_detached_values_count(0)
+        , m_parent(0)
+        , m_current_child_index(0)
+        , m_current_level(0)
+        , m_is_underflow(false)
+    {}
+
+    inline void operator()(internal_node & n)
+    {
+        namespace id = index::detail;
+
+        typedef typename rtree::elements_type<internal_node>::type elements_type;
+        elements_type & elements = rtree::elements(n);
+
+        size_type const removed_count_bckup = m_removed_count;
+        size_type const detached_values_count_bckup = m_detached_values_count;
+
+        // traverse children which boxes meet the predicates
+        internal_size_type child_node_index = 0;
+        while ( child_node_index < elements.size() )
+        {
+            // if node meets predicates (0 is dummy value)
+            if ( ! id::predicates_check<id::bounds_tag>(m_pred, 0, elements[child_node_index].first,
+                                                        id::get_strategy(m_parameters)) )
+            {
+                ++child_node_index;
+                continue;
+            }
+
+            size_type const child_removed_count_bckup = m_removed_count;
+
+            // next traversing step
+            traverse_apply_visitor(n, child_node_index);                                                // MAY THROW
+
+            // underflow occured - child node should be removed
+            // the last element is moved in its place so the index is not incremented
+            if ( m_removed_count != child_removed_count_bckup && m_is_underflow )
+            {
+                // move node to the container - store node's relative level as well
+                size_type relative_level = m_leafs_level - m_current_level;
+                m_detached_values_count += values_count_type::element_count(elements[child_node_index], relative_level);
+                m_underflowed_nodes.push_back(std::make_pair(relative_level,
+                                                             elements[child_node_index].second));  // MAY THROW (E: alloc, copy)
+
+                rtree::move_from_back(elements, elements.begin() + child_node_index);                   // MAY THROW (E: copy)
+                elements.pop_back();
+            }
+            else
+            {
+                ++child_node_index;
+            }
+        }
+
+        if ( m_removed_count == removed_count_bckup )
+            return;
+
+        values_count_type::subtract(n, (m_removed_count - removed_count_bckup)
+                                     + (m_detached_values_count - detached_values_count_bckup));
+
+        // n is not root - adjust aabb
+        if ( 0 != m_parent )
+        {
+            m_is_underflow = elements.size() < m_parameters.get_min_elements();
+
+            if ( ! m_is_underflow )
+            {
+                rtree::elements(*m_parent)[m_current_child_index].first
+                    = rtree::elements_box<box_type>(elements.begin(), elements.end(), m_translator,
+                                                    index::detail::get_strategy(m_parameters));
+            }
+        }
+        // n is root node
+        else
+        {
+            BOOST_GEOMETRY_INDEX_ASSERT(&n == &rtree::get<internal_node>(*m_root_node), "node must be the root");
+
+            // shorten the tree
+            shorten_tree();                                                                             // MAY THROW (N: alloc)
+
+            // reinsert elements from removed nodes (underflows)
+            reinsert_removed_nodes_elements();                                                          // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+    }
+
+    inline void operator()(leaf & n)
+    {
+        namespace id = index::detail;
+
+        typedef typename rtree::elements_type<leaf>::type elements_type;
+        elements_type & elements = rtree::elements(n);
+
+        size_type const removed_count_bckup = m_removed_count;
+
+        // find values and remove them
+        // the last value is moved in place of the removed one so the index is not incremented
+        typename elements_type::size_type i = 0;
+        while ( i < elements.size() )
+        {
+            if ( id::predicates_check<id::value_tag>(m_pred, elements[i], m_translator(elements[i]),
+                                                     id::get_strategy(m_parameters)) )
+            {
+                rtree::move_from_back(elements, elements.begin() + i);                                  // MAY THROW (V: copy)
+                elements.pop_back();
+                ++m_removed_count;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        // if values were removed
+        if ( m_removed_count != removed_count_bckup )
+        {
+            BOOST_GEOMETRY_INDEX_ASSERT(0 < m_parameters.get_min_elements(), "min number of elements is too small");
+
+            // calc underflow
+            m_is_underflow = elements.size() < m_parameters.get_min_elements();
+
+            // n is not root - adjust aabb
+            if ( 0 != m_parent && ! m_is_underflow )
+            {
+                rtree::elements(*m_parent)[m_current_child_index].first
+                    = rtree::values_box<box_type>(elements.begin(), elements.end(), m_translator,
+                                                  index::detail::get_strategy(m_parameters));
+            }
+        }
+    }
+
+    size_type removed_count() const
+    {
+        return m_removed_count;
+    }
+
+    // Destroys nodes detached from the tree if the traversal was interrupted by an exception.
+    void destroy_removed_nodes()
+    {
+        for ( typename underflow_nodes::iterator it = m_underflowed_nodes.begin() ;
+              it != m_underflowed_nodes.end() ; ++it )
+        {
+            rtree::visitors::destroy<MembersHolder>::apply(it->second, m_allocators);
+        }
+        m_underflowed_nodes.clear();
+    }
+
+private:
+
+    typedef std::vector< std::pair<size_type, node_pointer> > underflow_nodes;
+
+    void traverse_apply_visitor(internal_node &n, internal_size_type choosen_node_index)
+    {
+        // save previous traverse inputs and set new ones
+        internal_node_pointer parent_bckup = m_parent;
+        internal_size_type current_child_index_bckup = m_current_child_index;
+        size_type current_level_bckup = m_current_level;
+
+        m_parent = &n;
+        m_current_child_index = choosen_node_index;
+        ++m_current_level;
+
+        // next traversing step
+        rtree::apply_visitor(*this, *rtree::elements(n)[choosen_node_index].second);                    // MAY THROW (V, E: alloc, copy, N: alloc)
+
+        // restore previous traverse inputs
+        m_parent = parent_bckup;
+        m_current_child_index = current_child_index_bckup;
+        m_current_level = current_level_bckup;
+    }
+
+    static inline bool is_leaf(node const& n)
+    {
+        visitors::is_leaf<MembersHolder> ilv;
+        rtree::apply_visitor(ilv, n);
+        return ilv.result;
+    }
+
+    // Removes the roots having at most one child. If there are no children
+    // left an empty leaf becomes the root.
+    void shorten_tree()
+    {
+        while ( ! is_leaf(*m_root_node) )
+        {
+            internal_node & root = rtree::get<internal_node>(*m_root_node);
+            if ( 1 < rtree::elements(root).size() )
+                break;
+
+            node_pointer root_to_destroy = m_root_node;
+            if ( rtree::elements(root).empty() )
+            {
+                m_root_node = rtree::create_node<allocators_type, leaf>::apply(m_allocators);           // MAY THROW (N: alloc)
+                m_leafs_level = 0;
+            }
+            else
+            {
+                m_root_node = rtree::elements(root)[0].second;
+                --m_leafs_level;
+            }
+
+            rtree::destroy_node<allocators_type, internal_node>::apply(m_allocators, root_to_destroy);
+        }
+    }
+
+    // The elements are reinserted beginning with levels closer to the root.
+    // If the tree was shortened and a node's elements are too high to be
+    // inserted, the children of the node are reinserted instead.
+    void reinsert_removed_nodes_elements()
+    {
+        std::make_heap(m_underflowed_nodes.begin(), m_underflowed_nodes.end(), level_less);
+
+        BOOST_TRY
+        {
+            while ( ! m_underflowed_nodes.empty() )
+            {
+                // the processed node is kept at the back in order to be destroyed in case of exception
+                std::pop_heap(m_underflowed_nodes.begin(), m_underflowed_nodes.end(), level_less);
+                size_type const relative_level = m_underflowed_nodes.back().first;
+                node_pointer const node_ptr = m_underflowed_nodes.back().second;
+
+                // relative_level is an index of a level of a node, not children
+                // counted from the leafs level
+                bool const node_is_leaf = relative_level == 1;
+                BOOST_GEOMETRY_INDEX_ASSERT(node_is_leaf == is_leaf(*node_ptr), "unexpected condition");
+                if ( node_is_leaf )
+                {
+                    reinsert_node_elements(rtree::get<leaf>(*node_ptr), relative_level);                // MAY THROW (V, E: alloc, copy, N: alloc)
+
+                    m_underflowed_nodes.pop_back();
+                    rtree::destroy_node<allocators_type, leaf>::apply(m_allocators, node_ptr);
+                }
+                else if ( relative_level - 1 <= m_leafs_level )
+                {
+                    reinsert_node_elements(rtree::get<internal_node>(*node_ptr), relative_level);       // MAY THROW (V, E: alloc, copy, N: alloc)
+
+                    m_underflowed_nodes.pop_back();
+                    rtree::destroy_node<allocators_type, internal_node>::apply(m_allocators, node_ptr);
+                }
+                else
+                {
+                    typedef typename rtree::elements_type<internal_node>::type elements_type;
+                    elements_type & elements = rtree::elements(rtree::get<internal_node>(*node_ptr));
+
+                    m_underflowed_nodes.reserve(m_underflowed_nodes.size() + elements.size());         // MAY THROW (E: alloc)
+                    m_underflowed_nodes.pop_back();
+
+                    for ( typename elements_type::iterator it = elements.begin() ; it != elements.end() ; ++it )
+                    {
+                        m_underflowed_nodes.push_back(std::make_pair(relative_level - 1, it->second));
+                        std::push_heap(m_underflowed_nodes.begin(), m_underflowed_nodes.end(), level_less);
+                    }
+                    elements.clear();
+
+                    rtree::destroy_node<allocators_type, internal_node>::apply(m_allocators, node_ptr);
+                }
+            }
+        }
+        BOOST_CATCH(...)
+        {
+            // destroy current and remaining nodes
+            destroy_removed_nodes();
+
+            BOOST_RETHROW                                                                               // RETHROW
+        }
+        BOOST_CATCH_END
+    }
+
+    template <typename Node>
+    void reinsert_node_elements(Node &n, size_type node_relative_level)
+    {
+        typedef typename rtree::elements_type<Node>::type elements_type;
+        elements_type & elements = rtree::elements(n);
+
+        typename elements_type::iterator it = elements.begin();
+        BOOST_TRY
+        {
+            for ( ; it != elements.end() ; ++it )
+            {
+                visitors::insert<typename elements_type::value_type, MembersHolder>
+                    insert_v(m_root_node, m_leafs_level, *it,
+                             m_parameters, m_translator, m_allocators,
+                             node_relative_level - 1);
+
+                rtree::apply_visitor(insert_v, *m_root_node);                                           // MAY THROW (V, E: alloc, copy, N: alloc)
+            }
+        }
+        BOOST_CATCH(...)
+        {
+            ++it;
+            rtree::destroy_elements<MembersHolder>::apply(it, elements.end(), m_allocators);
+            elements.clear();
+            BOOST_RETHROW                                                                               // RETHROW
+        }
+        BOOST_CATCH_END
+    }
+
+    static inline bool level_less(std::pair<size_type, node_pointer> const& l,
+                                  std::pair<size_type, node_pointer> const& r)
+    {
+        return l.first < r.first;
+    }
+
+    typename bounds_predicates::reference_type m_pred;
+    parameters_type const& m_parameters;
+    translator_type const& m_translator;
+    allocators_type & m_allocators;
+
+    node_pointer & m_root_node;
+    size_type & m_leafs_level;
+
+    size_type m_removed_count;
+    underflow_nodes m_underflowed_nodes;
+
+    // the number of values stored in the underflowed nodes detached from the tree
+    size_type m_detached_values_count;
+
+    // traversing input parameters
+    internal_node_pointer m_parent;
+    internal_size_type m_current_child_index;
+    size_type m_current_level;
+
+    // traversing output parameters
+    bool m_is_underflow;
+};
+
+}}} // namespace detail::rtree::visitors
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_REMOVE_IF_HPP
@@ -0,0 +1,211 @@
+// Boost.Geometry Index
+//
+// R-tree spatial count visitor implementation
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_SPATIAL_COUNT_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_SPATIAL_COUNT_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+#include <boost/geometry/core/tags.hpp>
+
+#include <boost/geometry/index/detail/algorithms/bounds.hpp>
+#include <boost/geometry/index/detail/distance_predicates.hpp>
+#include <boost/geometry/index/detail/rtree/node/node.hpp>
+#include <boost/geometry/index/detail/predicates.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/query_statistics.hpp>
+#include <boost/geometry/index/parameters.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree { namespace visitors {
+
+namespace spatial_count_detail {
+
+// Checks if all values stored in a node meet the predicate knowing only
+// the bounds of the node. It's known for intersects() and covered_by() with
+// a Box, then it's true if the bounds are covered by the Box. For other
+// predicates false is returned and the node is traversed.
+template <typename Predicate>
+struct predicate_covers_bounds
+{
+    template <typename Bounds, typename Strategy>
+    static inline bool apply(Predicate const&, Bounds const&, Strategy const&)
+    {
+        return false;
+    }
+};
+
+template
+<
+    typename Geometry, typename Tag,
+    bool IsBox = std::is_same<typename geometry::tag<Geometry>::type, box_tag>::value
+                 && ( std::is_same<Tag, index::detail::predicates::intersects_tag>::value
+                   || std::is_same<Tag, index::detail::predicates::covered_by_tag>::value )
+>
+struct spatial_predicate_covers_bounds
+{
+    template <typename Pred, typename Bounds, typename Strategy>
+    static inline bool apply(Pred const&, Bounds const&, Strategy const&)
+    {
+        return false;
+    }
+};
+
+template <typename Geometry, typename Tag>
+struct spatial_predicate_covers_bounds<Geometry, Tag, true>
+{
+    template <typename Pred, typename Bounds, typename Strategy>
+    static inline bool apply(Pred const& p, Bounds const& b, Strategy const& s)
+    {
+        return index::detail::covered_by_bounds(b, p.geometry, s);
+    }
+};
+
+template <typename Geometry, typename Tag>
+struct predicate_covers_bounds<index::detail::predicates::spatial_predicate<Geometry, Tag, false> >
+    : spatial_predicate_covers_bounds<Geometry, Tag>
+{};
+
+template <typename ...Ts>
+struct predicate_covers_bounds<std::tuple<Ts...> >
+{
+    typedef std::tuple<Ts...> predicates_type;
+
+    template <typename Bounds, typename Strategy>
+    static inline bool apply(predicates_type const& p, Bounds const& b, Strategy const& s)
+    {
+        return apply(p, b, s, std::integral_constant<std::size_t, 0>());
+    }
+
+private:
+    template <typename Bounds, typename Strategy, std::size_t I>
+    static inline bool apply(predicates_type const& p, Bounds const& b, Strategy const& s,
+                             std::integral_constant<std::size_t, I>)
+    {
+        typedef typename std::tuple_element<I, predicates_type>::type predicate_type;
+        return predicate_covers_bounds<predicate_type>::apply(std::get<I>(p), b, s)
+            && apply(p, b, s, std::integral_constant<std::size_t, I + 1>());
+    }
+
+    template <typename Bounds, typename Strategy>
+    static inline bool apply(predicates_type const&, Bounds const&, Strategy const&,
+                             std::integral_constant<std::size_t, sizeof...(Ts)>)
+    {
+        return true;
+    }
+};
+
+} // namespace spatial_count_detail
+
+// Counts the values meeting spatial predicates. If all values of a subtree
+// are known to meet the predicates the count stored in the node is used
+// instead of traversing the subtree.
+template <typename MembersHolder, typename Predicates>
+struct spatial_count
+{
+    typedef typename MembersHolder::parameters_type parameters_type;
+    typedef typename MembersHolder::translator_type translator_type;
+    typedef typename MembersHolder::allocators_type allocators_type;
+
+    typedef typename index::detail::strategy_type<parameters_type>::type strategy_type;
+
+    typedef typename MembersHolder::node node;
+    typedef typename MembersHolder::internal_node internal_node;
+    typedef typename MembersHolder::leaf leaf;
+
+    typedef typename allocators_type::node_pointer node_pointer;
+    typedef typename allocators_type::size_type size_type;
+
+    typedef index::detail::comparable_bounds_predicates
+        <
+            Predicates,
+            typename MembersHolder::box_type,
+            typename index::detail::indexable_type<translator_type>::type,
+            strategy_type
+        > bounds_predicates;
+
+    typedef rtree::subtree_values_count<MembersHolder> subtree_values_count;
+    typedef spatial_count_detail::predicate_covers_bounds
+        <
+            typename bounds_predicates::type
+        > covers_bounds;
+
+    spatial_count(MembersHolder const& members, Predicates const& p)
+        : m_tr(members.translator())
+        , m_strategy(index::detail::get_strategy(members.parameters()))
+        , m_pred(bounds_predicates::apply(p, m_strategy))
+        , m_found_count(0)
+    {}
+
+    size_type apply(node_pointer ptr, size_type reverse_level)
+    {
+        namespace id = index::detail;
+        if (reverse_level > 0)
+        {
+            internal_node& n = rtree::get<internal_node>(*ptr);
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(internal_nodes, 1);
+            for (auto const& p : rtree::elements(n))
+            {
+                // if node meets predicates (0 is dummy value)
+                BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(predicates_checks, 1);
+                if (id::predicates_check<id::bounds_tag>(m_pred, 0, p.first, m_strategy))
+                {
+                    // count all values of the node without traversing it
+                    if (covers_bounds::apply(m_pred, p.first, m_strategy))
+                    {
+                        m_found_count += reverse_level > 1
+                                       ? subtree_values_count::get(rtree::get<internal_node>(*p.second))
+                                       : subtree_values_count::get(rtree::get<leaf>(*p.second));
+                    }
+                    else
+                    {
+                        apply(p.second, reverse_level - 1);
+                    }
+                }
+            }
+        }
+        else
+        {
+            leaf& n = rtree::get<leaf>(*ptr);
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(leafs, 1);
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(values, rtree::elements(n).size());
+            for (auto const& v : rtree::elements(n))
+            {
+                // if value meets predicates
+                BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(predicates_checks, 1);
+                if (id::predicates_check<id::value_tag>(m_pred, v, m_tr(v), m_strategy))
+                {
+                    ++m_found_count;
+                }
+            }
+        }
+
+        return m_found_count;
+    }
+
+    size_type apply(MembersHolder const& members)
+    {
+        return apply(members.root, members.leafs_level);
+    }
+
+private:
+    translator_type const& m_tr;
+    strategy_type m_strategy;
+
+    typename bounds_predicates::reference_type m_pred;
+
+    size_type m_found_count;
+};
+
+}}} // namespace detail::rtree::visitors
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_SPATIAL_COUNT_HPP
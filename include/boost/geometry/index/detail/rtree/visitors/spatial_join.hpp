@@ -0,0 +1,334 @@
+// Boost.Geometry Index
+//
+// R-tree spatial join implementation
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_SPATIAL_JOIN_HPP
+#define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_SPATIAL_JOIN_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/index/detail/parallel.hpp>
+#include <boost/geometry/index/detail/predicates.hpp>
+#include <boost/geometry/index/detail/rtree/node/node_elements.hpp>
+#include <boost/geometry/index/parameters.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+namespace detail { namespace rtree { namespace visitors {
+
+// The predicate used if the pairs of values are not filtered.
+struct spatial_join_all
+{
+    template <typename Value1, typename Value2>
+    bool operator()(Value1 const&, Value2 const&) const
+    {
+        return true;
+    }
+};
+
+// Finds all pairs of values of two trees with intersecting indexables for which
+// the binary predicate is met. Both trees are traversed simultaneously and a pair
+// of nodes is visited only if their boxes intersect. The pairs of values are
+// written to the output iterator as std::pair<value_type1, value_type2>.
+template <typename MembersHolder1, typename MembersHolder2, typename Predicate>
+class spatial_join
+{
+    typedef typename MembersHolder1::value_type value_type1;
+    typedef typename MembersHolder2::value_type value_type2;
+    typedef typename MembersHolder1::box_type box_type1;
+    typedef typename MembersHolder2::box_type box_type2;
+    typedef typename MembersHolder1::parameters_type parameters_type;
+    typedef typename MembersHolder1::translator_type translator_type1;
+    typedef typename MembersHolder2::translator_type translator_type2;
+
+    typedef typename index::detail::strategy_type<parameters_type>::type strategy_type;
+
+    typedef typename MembersHolder1::internal_node internal_node1;
+    typedef typename MembersHolder2::internal_node internal_node2;
+    typedef typename MembersHolder1::leaf leaf1;
+    typedef typename MembersHolder2::leaf leaf2;
+
+    typedef typename MembersHolder1::node_pointer node_pointer1;
+    typedef typename MembersHolder2::node_pointer node_pointer2;
+    typedef typename MembersHolder1::size_type size_type;
+
+    typedef std::vector<std::size_t> indexes_type;
+
+    // pair of subtrees which is traversed independently,
+    // null box means that the node is a root
+    struct task
+    {
+        node_pointer1 ptr1;
+        box_type1 const* box1;
+        size_type reverse_level1;
+        node_pointer2 ptr2;
+        box_type2 const* box2;
+        size_type reverse_level2;
+    };
+
+public:
+    typedef std::pair<value_type1, value_type2> result_type;
+
+    spatial_join(MembersHolder1 const& members1, MembersHolder2 const& members2,
+                 Predicate const& pred)
+        : m_members1(members1)
+        , m_members2(members2)
+        , m_tr1(members1.translator())
+        , m_tr2(members2.translator())
+        , m_strategy(index::detail::get_strategy(members1.parameters()))
+        , m_pred(pred)
+    {}
+
+    template <typename OutIter>
+    size_type apply(OutIter out_it)
+    {
+        m_levels.resize(m_members1.leafs_level + m_members2.leafs_level + 1);
+        return traverse(root_task(), 0, out_it);
+    }
+
+    // The work is split into independent pairs of subtrees which are traversed
+    // in parallel. Then the results are written in the order in which they would
+    // be written by the sequential version.
+    template <typename OutIter>
+    size_type apply(OutIter out_it, std::size_t threads)
+    {
+        if ( threads <= 1 )
+            return apply(out_it);
+
+        std::vector<task> tasks(1, root_task());
+
+        // split the tasks, preserving the traversal order, until there is enough of them
+        std::size_t const min_tasks_count = 4 * threads;
+        while ( tasks.size() < min_tasks_count && split_tasks(tasks) )
+        {}
+
+        std::vector<std::vector<result_type> > results(tasks.size());
+        index::detail::parallel_for(tasks.size(), threads, [&](std::size_t i)
+        {
+            spatial_join join(m_members1, m_members2, m_pred);
+            join.m_levels.resize(tasks[i].reverse_level1 + tasks[i].reverse_level2 + 1);
+            auto out = std::back_inserter(results[i]);
+            join.traverse(tasks[i], 0, out);
+        });                                                                         // MAY THROW
+
+        size_type found_count = 0;
+        for ( std::vector<result_type> const& r : results )
+        {
+            for ( result_type const& v : r )
+            {
+                *out_it = v;
+                ++out_it;
+            }
+            found_count += r.size();
+        }
+        return found_count;
+    }
+
+private:
+    task root_task() const
+    {
+        task t;
+        t.ptr1 = m_members1.root;
+        t.box1 = nullptr;
+        t.reverse_level1 = m_members1.leafs_level;
+        t.ptr2 = m_members2.root;
+        t.box2 = nullptr;
+        t.reverse_level2 = m_members2.leafs_level;
+        return t;
+    }
+
+    template <typename OutIter>
+    size_type traverse(task const& t, std::size_t depth, OutIter & out_it)
+    {
+        if ( t.reverse_level1 == 0 && t.reverse_level2 == 0 )
+        {
+            return join_leafs(t, depth, out_it);
+        }
+
+        size_type found_count = 0;
+        for_each_child_task(t, depth, [&](task const& child)
+        {
+            found_count += traverse(child, depth + 1, out_it);
+        });
+        return found_count;
+    }
+
+    // Calls f for each pair of children of the nodes with intersecting boxes.
+    // If one of the nodes is a leaf then only the internal node is descended.
+    template <typename Function>
+    void for_each_child_task(task const& t, std::size_t depth, Function const& f)
+    {
+        indexes_type & children1 = m_levels[depth].first;
+        indexes_type & children2 = m_levels[depth].second;
+
+        if ( t.reverse_level1 > 0 )
+        {
+            internal_node1 const& n1 = rtree::get<internal_node1>(*t.ptr1);
+            children_intersecting(rtree::elements(n1), t.box2, children1);
+        }
+        if ( t.reverse_level2 > 0 )
+        {
+            internal_node2 const& n2 = rtree::get<internal_node2>(*t.ptr2);
+            children_intersecting(rtree::elements(n2), t.box1, children2);
+        }
+
+        if ( t.reverse_level2 == 0 )
+        {
+            auto const& elements1 = rtree::elements(rtree::get<internal_node1>(*t.ptr1));
+            for ( std::size_t i1 : children1 )
+            {
+                task child = t;
+                child.ptr1 = elements1[i1].second;
+                child.box1 = &elements1[i1].first;
+                child.reverse_level1 = t.reverse_level1 - 1;
+                f(child);
+            }
+        }
+        else if ( t.reverse_level1 == 0 )
+        {
+            auto const& elements2 = rtree::elements(rtree::get<internal_node2>(*t.ptr2));
+            for ( std::size_t i2 : children2 )
+            {
+                task child = t;
+                child.ptr2 = elements2[i2].second;
+                child.box2 = &elements2[i2].first;
+                child.reverse_level2 = t.reverse_level2 - 1;
+                f(child);
+            }
+        }
+        else
+        {
+            auto const& elements1 = rtree::elements(rtree::get<internal_node1>(*t.ptr1));
+            auto const& elements2 = rtree::elements(rtree::get<internal_node2>(*t.ptr2));
+            for ( std::size_t i1 : children1 )
+            {
+                for ( std::size_t i2 : children2 )
+                {
+                    if ( ! intersects(elements1[i1].first, elements2[i2].first) )
+                        continue;
+
+                    task child;
+                    child.ptr1 = elements1[i1].second;
+                    child.box1 = &elements1[i1].first;
+                    child.reverse_level1 = t.reverse_level1 - 1;
+                    child.ptr2 = elements2[i2].second;
+                    child.box2 = &elements2[i2].first;
+                    child.reverse_level2 = t.reverse_level2 - 1;
+                    f(child);
+                }
+            }
+        }
+    }
+
+    template <typename OutIter>
+    size_type join_leafs(task const& t, std::size_t depth, OutIter & out_it)
+    {
+        auto const& elements1 = rtree::elements(rtree::get<leaf1>(*t.ptr1));
+        auto const& elements2 = rtree::elements(rtree::get<leaf2>(*t.ptr2));
+
+        // values intersecting the box of the other node
+        indexes_type & values1 = m_levels[depth].first;
+        indexes_type & values2 = m_levels[depth].second;
+        values_intersecting(elements1, m_tr1, t.box2, values1);
+        values_intersecting(elements2, m_tr2, t.box1, values2);
+
+        size_type found_count = 0;
+        for ( std::size_t i1 : values1 )
+        {
+            value_type1 const& v1 = elements1[i1];
+            for ( std::size_t i2 : values2 )
+            {
+                value_type2 const& v2 = elements2[i2];
+                if ( intersects(m_tr1(v1), m_tr2(v2)) && m_pred(v1, v2) )
+                {
+                    *out_it = result_type(v1, v2);                                  // MAY THROW (V: copy)
+                    ++out_it;
+                    ++found_count;
+                }
+            }
+        }
+        return found_count;
+    }
+
+    template <typename Elements, typename Box>
+    void children_intersecting(Elements const& elements, Box const* box, indexes_type & result) const
+    {
+        result.clear();
+        for ( std::size_t i = 0 ; i < elements.size() ; ++i )
+        {
+            if ( ! box || intersects(elements[i].first, *box) )
+                result.push_back(i);
+        }
+    }
+
+    template <typename Elements, typename Translator, typename Box>
+    void values_intersecting(Elements const& elements, Translator const& tr, Box const* box,
+                             indexes_type & result) const
+    {
+        result.clear();
+        for ( std::size_t i = 0 ; i < elements.size() ; ++i )
+        {
+            if ( ! box || intersects(tr(elements[i]), *box) )
+                result.push_back(i);
+        }
+    }
+
+    template <typename Geometry1, typename Geometry2>
+    bool intersects(Geometry1 const& g1, Geometry2 const& g2) const
+    {
+        return index::detail::spatial_predicate_call
+            <
+                index::detail::predicates::intersects_tag
+            >::apply(g1, g2, m_strategy);
+    }
+
+    // Replaces tasks traversing internal nodes with tasks traversing their children.
+    // Returns false if there were no such tasks.
+    bool split_tasks(std::vector<task> & tasks)
+    {
+        std::vector<task> result;
+        bool split = false;
+        for ( task const& t : tasks )
+        {
+            if ( t.reverse_level1 == 0 && t.reverse_level2 == 0 )
+            {
+                result.push_back(t);
+                continue;
+            }
+
+            split = true;
+            m_levels.resize(1);
+            for_each_child_task(t, 0, [&](task const& child)
+            {
+                result.push_back(child);
+            });
+        }
+
+        tasks.swap(result);
+        return split;
+    }
+
+    MembersHolder1 const& m_members1;
+    MembersHolder2 const& m_members2;
+    translator_type1 const& m_tr1;
+    translator_type2 const& m_tr2;
+    strategy_type m_strategy;
+
+    Predicate const& m_pred;
+
+    // the children or values of both nodes meeting the predicates, for each depth
+    std::vector<std::pair<indexes_type, indexes_type> > m_levels;
+};
+
+}}} // namespace detail::rtree::visitors
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_SPATIAL_JOIN_HPP
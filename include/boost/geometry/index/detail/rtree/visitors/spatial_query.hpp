@@ -15,14 +15,97 @@
 #ifndef BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_SPATIAL_QUERY_HPP
 #define BOOST_GEOMETRY_INDEX_DETAIL_RTREE_VISITORS_SPATIAL_QUERY_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+#include <boost/geometry/core/coordinate_dimension.hpp>
+#include <boost/geometry/core/coordinate_type.hpp>
+#include <boost/geometry/core/cs.hpp>
+#include <boost/geometry/core/tags.hpp>
+
+#include <boost/geometry/index/detail/algorithms/boxes_disjoint_simd.hpp>
+#include <boost/geometry/index/detail/distance_predicates.hpp>
 #include <boost/geometry/index/detail/rtree/node/node_elements.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/query_statistics.hpp>
 #include <boost/geometry/index/detail/predicates.hpp>
 #include <boost/geometry/index/parameters.hpp>
 
+#include <boost/geometry/strategies/index/cartesian.hpp>
+
 namespace boost { namespace geometry { namespace index {
 
 namespace detail { namespace rtree { namespace visitors {
 
+namespace spatial_query_detail {
+
+template <typename Strategy>
+struct is_cartesian_strategy
+    : std::is_same<Strategy, geometry::default_strategy>
+{};
+
+template <typename CalculationType>
+struct is_cartesian_strategy<strategies::index::cartesian<CalculationType> >
+    : std::true_type
+{};
+
+template <typename Tag>
+struct is_intersects_bounds_tag
+    : std::integral_constant
+        <
+            bool,
+            ! std::is_same<Tag, index::detail::predicates::contains_tag>::value
+         && ! std::is_same<Tag, index::detail::predicates::covers_tag>::value
+         && ! std::is_same<Tag, index::detail::predicates::disjoint_tag>::value
+        >
+{};
+
+// Predicates for which the boxes of the children of internal nodes are tested
+// in blocks by simd::box_tester, i.e. a single spatial predicate checking
+// intersects(Box, Geometry) for nodes where the Geometry is a box, the boxes are
+// cartesian and have the same float or double coordinates.
+template <typename Predicates, typename Box, typename Strategy>
+struct is_simd
+    : std::false_type
+{};
+
+template <typename Geometry, typename Tag, typename Box, typename Strategy>
+struct is_simd
+    <
+        index::detail::predicates::spatial_predicate<Geometry, Tag, false>,
+        Box, Strategy
+    >
+    : std::integral_constant
+        <
+            bool,
+            is_intersects_bounds_tag<Tag>::value
+         && is_cartesian_strategy<Strategy>::value
+         && std::is_same<typename geometry::tag<Geometry>::type, box_tag>::value
+         && std::is_same<typename geometry::cs_tag<Geometry>::type, cartesian_tag>::value
+         && std::is_same<typename geometry::cs_tag<Box>::type, cartesian_tag>::value
+         && std::is_same
+                <
+                    typename geometry::coordinate_type<Geometry>::type,
+                    typename geometry::coordinate_type<Box>::type
+                >::value
+         && index::detail::simd::is_simd_coordinate
+                <
+                    typename geometry::coordinate_type<Box>::type
+                >::value
+         && geometry::dimension<Geometry>::value == geometry::dimension<Box>::value
+        >
+{};
+
+// Used instead of simd::box_tester if the predicates are not is_simd.
+struct no_box_tester
+{
+    template <typename Predicates>
+    explicit no_box_tester(Predicates const&)
+    {}
+};
+
+} // namespace spatial_query_detail
+
 template <typename MembersHolder, typename Predicates, typename OutIter>
 struct spatial_query
 {
@@ -39,12 +122,33 @@ struct spatial_query
     typedef typename allocators_type::node_pointer node_pointer;
     typedef typename allocators_type::size_type size_type;
 
+    typedef typename MembersHolder::box_type box_type;
+    typedef typename index::detail::indexable_type<translator_type>::type indexable_type;
+
+    typedef index::detail::comparable_bounds_predicates
+        <
+            Predicates, box_type, indexable_type, strategy_type
+        > bounds_predicates;
+
+    typedef spatial_query_detail::is_simd<Predicates, box_type, strategy_type> is_simd;
+    typedef std::conditional_t
+        <
+            is_simd::value,
+            index::detail::simd::box_tester
+                <
+                    typename geometry::coordinate_type<box_type>::type,
+                    geometry::dimension<box_type>::value
+                >,
+            spatial_query_detail::no_box_tester
+        > box_tester_type;
+
     spatial_query(MembersHolder const& members, Predicates const& p, OutIter out_it)
         : m_tr(members.translator())
         , m_strategy(index::detail::get_strategy(members.parameters()))
-        , m_pred(p)
+        , m_pred(bounds_predicates::apply(p, m_strategy))
         , m_out_iter(out_it)
         , m_found_count(0)
+        , m_box_tester(predicates_geometry(p, is_simd()))
     {}
 
     size_type apply(node_pointer ptr, size_type reverse_level)
@@ -53,23 +157,19 @@ struct spatial_query
         if (reverse_level > 0)
         {
             internal_node& n = rtree::get<internal_node>(*ptr);
-            // traverse nodes meeting predicates
-            for (auto const& p : rtree::elements(n))
-            {
-                // if node meets predicates (0 is dummy value)
-                if (id::predicates_check<id::bounds_tag>(m_pred, 0, p.first, m_strategy))
-                {
-                    apply(p.second, reverse_level - 1);
-                }
-            }
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(internal_nodes, 1);
+            apply_children(rtree::elements(n), reverse_level - 1, is_simd());
         }
         else
         {
             leaf& n = rtree::get<leaf>(*ptr);
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(leafs, 1);
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(values, rtree::elements(n).size());
             // get all values meeting predicates
             for (auto const& v : rtree::elements(n))
             {
                 // if value meets predicates
+                BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(predicates_checks, 1);
                 if (id::predicates_check<id::value_tag>(m_pred, v, m_tr(v), m_strategy))
                 {
                     *m_out_iter = v;
@@ -88,13 +188,66 @@ struct spatial_query
     }
 
 private:
+    template <typename Elements>
+    void apply_children(Elements const& elements, size_type reverse_level, std::false_type)
+    {
+        namespace id = index::detail;
+        // traverse nodes meeting predicates
+        for (auto const& p : elements)
+        {
+            // if node meets predicates (0 is dummy value)
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(predicates_checks, 1);
+            if (id::predicates_check<id::bounds_tag>(m_pred, 0, p.first, m_strategy))
+            {
+                apply(p.second, reverse_level);
+            }
+        }
+    }
+
+    template <typename Elements>
+    void apply_children(Elements const& elements, size_type reverse_level, std::true_type)
+    {
+        namespace simd = index::detail::simd;
+        // traverse nodes intersecting the box, the boxes are tested in blocks
+        std::size_t const size = elements.size();
+        for (std::size_t first = 0 ; first < size ; first += simd::block_size)
+        {
+            auto const it = elements.begin() + first;
+            std::size_t const count = (std::min)(size - first, simd::block_size);
+            unsigned const hits = m_box_tester.intersects(it, count);
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(simd_blocks, 1);
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(predicates_checks, count);
+            for (std::size_t i = 0 ; i < count ; ++i)
+            {
+                if (hits & (1u << i))
+                {
+                    apply(it[i].second, reverse_level);
+                }
+            }
+        }
+    }
+
+    template <typename P>
+    static P const& predicates_geometry(P const& p, std::false_type)
+    {
+        return p;
+    }
+
+    template <typename P>
+    static auto const& predicates_geometry(P const& p, std::true_type)
+    {
+        return p.geometry;
+    }
+
     translator_type const& m_tr;
     strategy_type m_strategy;
 
-    Predicates const& m_pred;
+    typename bounds_predicates::reference_type m_pred;
     OutIter m_out_iter;
 
     size_type m_found_count;
+
+    box_tester_type m_box_tester;
 };
 
 template <typename MembersHolder, typename Predicates>
@@ -119,6 +272,14 @@ class spatial_query_incremental
     typedef typename rtree::elements_type<leaf>::type leaf_elements;
     typedef typename rtree::elements_type<leaf>::type::const_iterator leaf_iterator;
 
+    typedef index::detail::comparable_bounds_predicates
+        <
+            Predicates,
+            typename MembersHolder::box_type,
+            typename index::detail::indexable_type<translator_type>::type,
+            strategy_type
+        > bounds_predicates;
+
     struct internal_data
     {
         internal_data(internal_iterator f, internal_iterator l, size_type rl)
@@ -141,7 +302,7 @@ public:
     spatial_query_incremental(Predicates const& p)
         : m_translator(nullptr)
 //        , m_strategy()
-        , m_pred(p)
+        , m_pred(bounds_predicates::apply(p, strategy_type()))
         , m_values(nullptr)
         , m_current()
     {}
@@ -149,7 +310,7 @@ public:
     spatial_query_incremental(MembersHolder const& members, Predicates const& p)
         : m_translator(::boost::addressof(members.translator()))
         , m_strategy(index::detail::get_strategy(members.parameters()))
-        , m_pred(p)
+        , m_pred(bounds_predicates::apply(p, m_strategy))
         , m_values(nullptr)
         , m_current()
     {}
@@ -191,11 +352,13 @@ private:
         {
             internal_node& n = rtree::get<internal_node>(*ptr);
             auto const& elements = rtree::elements(n);
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(internal_nodes, 1);
             m_internal_stack.push_back(internal_data(elements.begin(), elements.end(), reverse_level - 1));
         }
         else
         {
             leaf& n = rtree::get<leaf>(*ptr);
+            BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(leafs, 1);
             m_values = ::boost::addressof(rtree::elements(n));
             m_current = rtree::elements(n).begin();
         }
@@ -213,6 +376,8 @@ private:
                 {
                     // return if next value is found
                     value_type const& v = *m_current;
+                    BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(values, 1);
+                    BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(predicates_checks, 1);
                     if (id::predicates_check<id::value_tag>(m_pred, v, (*m_translator)(v), m_strategy))
                     {
                         return;
@@ -248,6 +413,7 @@ private:
                 ++current_data.first;
 
                 // next node is found, push it to the stack
+                BOOST_GEOMETRY_INDEX_DETAIL_QUERY_STATISTICS_ADD(predicates_checks, 1);
                 if (id::predicates_check<id::bounds_tag>(m_pred, 0, it->first, m_strategy))
                 {
                     apply(it->second, current_data.reverse_level);
@@ -259,7 +425,7 @@ private:
     const translator_type * m_translator;
     strategy_type m_strategy;
 
-    Predicates m_pred;
+    typename bounds_predicates::type m_pred;
 
     std::vector<internal_data> m_internal_stack;
     const leaf_elements * m_values;
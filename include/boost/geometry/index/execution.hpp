@@ -0,0 +1,63 @@
+// Boost.Geometry Index
+//
+// Execution policies
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_EXECUTION_HPP
+#define BOOST_GEOMETRY_INDEX_EXECUTION_HPP
+
+#include <cstddef>
+#include <thread>
+
+/*!
+\defgroup execution Execution policies (boost::geometry::index::execution::)
+*/
+
+namespace boost { namespace geometry { namespace index { namespace execution {
+
+/*!
+\brief Parallel execution policy.
+
+Passed to the operations supporting it, e.g. the r-tree packing constructor, in order
+to allow them to perform independent parts of the work concurrently. The result is
+always the same as the result of the corresponding sequential operation.
+
+\par Warning
+Nodes are created concurrently so the Allocator of the container must be safe to
+use from multiple threads (std::allocator, boost::container::new_allocator and
+boost::geometry::index::node_pool_allocator are).
+
+\ingroup execution
+*/
+class parallel_policy
+{
+public:
+    /*!
+    \brief The constructor.
+
+    \param threads  The maximum number of threads. 0 means the number of hardware threads.
+    */
+    explicit parallel_policy(std::size_t threads = 0)
+        : m_threads(threads)
+    {
+        if ( m_threads == 0 )
+            m_threads = std::thread::hardware_concurrency();
+        if ( m_threads == 0 )
+            m_threads = 1;
+    }
+
+    /*!
+    \brief Returns the maximum number of threads.
+    */
+    std::size_t threads() const { return m_threads; }
+
+private:
+    std::size_t m_threads;
+};
+
+}}}} // namespace boost::geometry::index::execution
+
+#endif // BOOST_GEOMETRY_INDEX_EXECUTION_HPP
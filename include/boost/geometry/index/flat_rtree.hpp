@@ -0,0 +1,753 @@
+// Boost.Geometry Index
+//
+// R-tree stored in a flat, pointer-free layout
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_FLAT_RTREE_HPP
+#define BOOST_GEOMETRY_INDEX_FLAT_RTREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/detail/rtree/flat_external.hpp>
+#include <boost/geometry/index/detail/rtree/flat_layout.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+/*!
+\brief Writes the rtree to the stream in the flat layout.
+
+The flat layout is pointer-free and may be queried in place by flat_rtree, e.g. after
+mapping the file into memory. The Value must be trivially copy constructible and
+destructible. The data is written in the native representation so it can be read only
+on a platform with the same endianness and the same representation of the Value.
+
+\ingroup rtree_functions
+
+\par Throws
+If memory allocation throws.
+std::runtime_error if writing to the stream fails.
+
+\param tree     The rtree.
+\param os       The output stream opened in binary mode.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator>
+inline void write_flat(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+                       std::ostream & os)
+{
+    detail::rtree::flat::write(tree, os);
+}
+
+/*!
+\brief Writes the rtree to the stream in the flat layout with quantized boxes.
+
+The box of each node other than the root is stored as 8 or 16-bit integers relative
+to the box of its parent. The coordinates are rounded outwards so the boxes used during
+the queries contain the original ones and the results are the same as for the exact
+layout. The memory used by the boxes is reduced 4 or 8 times for double coordinates at
+the cost of decoding the boxes during the traversal and testing more values in leafs.
+Only cartesian boxes with floating point coordinates may be quantized.
+
+\ingroup rtree_functions
+
+\par Throws
+If memory allocation throws.
+std::invalid_argument if the quantization is not supported.
+std::runtime_error if writing to the stream fails.
+
+\param tree                 The rtree.
+\param os                   The output stream opened in binary mode.
+\param quantization_bits    The number of bits of a quantized coordinate, 8 or 16.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator>
+inline void write_flat(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+                       std::ostream & os, unsigned int quantization_bits)
+{
+    detail::rtree::flat::write(tree, os, quantization_bits);
+}
+
+/*!
+\brief The options of packing the flat layout in external memory.
+
+\ingroup rtree_functions
+*/
+class external_memory_options
+{
+public:
+    /*!
+    \brief The constructor.
+
+    \param memory_limit     The approximate number of bytes of memory used to sort the values.
+    \param temp_directory   The directory of the temporary files. If empty, the directory
+                            defined by TMPDIR, TMP or TEMP environment variable is used.
+    */
+    explicit external_memory_options(std::size_t memory_limit = 256 * 1024 * 1024,
+                                     std::string const& temp_directory = std::string())
+        : m_memory_limit(memory_limit)
+        , m_temp_directory(temp_directory)
+    {}
+
+    std::size_t get_memory_limit() const { return m_memory_limit; }
+    std::string const& get_temp_directory() const { return m_temp_directory; }
+
+private:
+    std::size_t m_memory_limit;
+    std::string m_temp_directory;
+};
+
+/*!
+\brief Packs the values from the range and writes the rtree to the stream in the flat layout.
+
+The data is the same as the one written for the rtree created by the constructor taking
+hilbert_packing but the rtree is not stored in memory so the number of values may exceed
+the size of the memory. The input
+range is traversed once. The values are stored in sorted runs in temporary files limiting
+the memory used for the sorting to memory_limit and then merged. The nodes and values are
+written directly to the stream and the boxes of the nodes are gathered in temporary files,
+one per level of the tree. The boxes are not quantized.
+
+\ingroup rtree_functions
+
+\par Throws
+If memory allocation throws.
+std::runtime_error if creating, writing or reading a temporary file or writing to the stream fails.
+
+\param first        The beginning of the range of Values.
+\param last         The end of the range of Values.
+\param os           The output stream opened in binary mode. It must support seeking, e.g. std::ofstream.
+\param parameters   The parameters of the rtree which will read the data.
+\param getter       The function object extracting Indexable from Value.
+\param options      The memory limit and the directory of temporary files.
+*/
+template <typename Iterator, typename Parameters, typename IndexableGetter>
+inline void write_flat(Iterator first, Iterator last, std::ostream & os,
+                       Parameters const& parameters, IndexableGetter const& getter,
+                       external_memory_options const& options)
+{
+    typedef typename std::iterator_traits<Iterator>::value_type value_type;
+    typedef typename rtree<value_type, Parameters, IndexableGetter>::bounds_type box_type;
+
+    detail::rtree::flat::write_external<value_type, box_type>(first, last, os, parameters, getter,
+                                                              options.get_memory_limit(),
+                                                              options.get_temp_directory());
+}
+
+/*!
+\brief Packs the values from the range and writes the rtree to the stream in the flat layout.
+
+\ingroup rtree_functions
+
+\par Throws
+If memory allocation throws.
+std::runtime_error if creating, writing or reading a temporary file or writing to the stream fails.
+
+\param first        The beginning of the range of Values.
+\param last         The end of the range of Values.
+\param os           The output stream opened in binary mode. It must support seeking, e.g. std::ofstream.
+\param parameters   The parameters of the rtree which will read the data.
+\param options      The memory limit and the directory of temporary files.
+*/
+template <typename Iterator, typename Parameters>
+inline void write_flat(Iterator first, Iterator last, std::ostream & os,
+                       Parameters const& parameters,
+                       external_memory_options const& options = external_memory_options())
+{
+    typedef typename std::iterator_traits<Iterator>::value_type value_type;
+
+    index::write_flat(first, last, os, parameters, index::indexable<value_type>(), options);
+}
+
+/*!
+\brief The read-only R-tree stored in the flat layout.
+
+The flat_rtree doesn't own the data. It refers to the memory containing the rtree written
+by write_flat(), e.g. a file mapped into memory, and performs the queries in place.
+Therefore opening the index doesn't require any allocation and the memory may be shared
+between processes. The Parameters, IndexableGetter and EqualTo must be the same as the
+ones of the rtree which was written.
+
+The boxes of the children of a node are stored as a structure of arrays. For the
+intersects() predicate taking a cartesian box they are tested in blocks by loops
+which may be vectorized by the compiler. If the boxes were quantized they are decoded
+during the traversal.
+
+\par Example
+\verbatim
+boost::interprocess::file_mapping file("index.bin", boost::interprocess::read_only);
+boost::interprocess::mapped_region region(file, boost::interprocess::read_only);
+bgi::flat_rtree<Value, bgi::rstar<16> > tree(region.get_address(), region.get_size());
+tree.query(bgi::intersects(box), std::back_inserter(result));
+\endverbatim
+
+\tparam Value           The type of objects stored in the container.
+\tparam Parameters      Compile-time parameters.
+\tparam IndexableGetter The function object extracting Indexable from Value.
+\tparam EqualTo         The function object comparing objects of type Value.
+*/
+template
+<
+    typename Value,
+    typename Parameters,
+    typename IndexableGetter = index::indexable<Value>,
+    typename EqualTo = index::equal_to<Value>
+>
+class flat_rtree
+{
+    typedef detail::translator<IndexableGetter, EqualTo> translator_type;
+    typedef typename detail::strategy_type<Parameters>::type strategy_type;
+    typedef detail::rtree::flat::header header_type;
+    typedef detail::rtree::flat::node node_type;
+
+    BOOST_GEOMETRY_STATIC_ASSERT((detail::rtree::flat::is_storable<Value>::value),
+        "The Value stored in the flat layout must be trivially copy constructible and destructible.",
+        Value);
+
+public:
+    /*! \brief The type of Value stored in the container. */
+    typedef Value value_type;
+    /*! \brief R-tree parameters type. */
+    typedef Parameters parameters_type;
+    /*! \brief The function object extracting Indexable from Value. */
+    typedef IndexableGetter indexable_getter;
+    /*! \brief The function object comparing objects of type Value. */
+    typedef EqualTo value_equal;
+    /*! \brief The Box type used by the R-tree. */
+    typedef typename index::rtree<Value, Parameters, IndexableGetter, EqualTo>::bounds_type bounds_type;
+    /*! \brief Unsigned integral type used by the container. */
+    typedef std::size_t size_type;
+    /*! \brief Type of const iterator, category RandomAccessIterator. */
+    typedef value_type const* const_iterator;
+
+private:
+    typedef bounds_type box_type;
+    typedef typename geometry::coordinate_type<box_type>::type coordinate_type;
+    typedef detail::rtree::flat::soa_box<box_type> soa_box;
+
+    static const std::size_t dimension = geometry::dimension<box_type>::value;
+    // the number of children tested at once
+    static const std::size_t block_size = 64;
+
+public:
+    /*!
+    \brief The constructor.
+
+    \param data         The pointer to the data written by write_flat(), aligned to 64 bytes.
+    \param size         The size of the data.
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+
+    \par Throws
+    std::invalid_argument if the data doesn't contain the rtree of this type or if it is corrupted.
+    */
+    flat_rtree(void const* data, std::size_t size,
+               parameters_type const& parameters = parameters_type(),
+               indexable_getter const& getter = indexable_getter(),
+               value_equal const& equal = value_equal())
+        : m_translator(getter, equal)
+        , m_parameters(parameters)
+        , m_nodes(nullptr)
+        , m_bounds(nullptr)
+        , m_quantized_bounds(nullptr)
+        , m_values(nullptr)
+        , m_nodes_count(0)
+        , m_values_count(0)
+        , m_leafs_level(0)
+        , m_quantization_bits(0)
+    {
+        header_type h;
+        if ( size < sizeof(header_type)
+          || reinterpret_cast<std::uintptr_t>(data) % detail::rtree::flat::alignment != 0 )
+        {
+            detail::throw_invalid_argument("invalid flat rtree data");
+        }
+        std::memcpy(&h, data, sizeof(header_type));
+
+        // only the box of the root is stored exactly if the boxes are quantized
+        std::uint64_t const exact_boxes_count = h.quantization_bits == 0 ? h.nodes_count
+                                              : (std::min)(h.nodes_count, std::uint64_t(1));
+        std::uint64_t const quantized_boxes_count = h.quantization_bits == 0 ? 0 : h.nodes_count;
+        if ( h.magic != detail::rtree::flat::magic
+          || h.version != detail::rtree::flat::version
+          || h.value_size != sizeof(value_type)
+          || h.box_size != sizeof(box_type)
+          || ( h.quantization_bits != 0 && h.quantization_bits != 8 && h.quantization_bits != 16 )
+          || h.size > size
+          || h.nodes_offset % detail::rtree::flat::alignment != 0
+          || h.bounds_offset % detail::rtree::flat::alignment != 0
+          || h.quantized_bounds_offset % detail::rtree::flat::alignment != 0
+          || h.values_offset % detail::rtree::flat::alignment != 0
+          || ! fits(h.values_offset, h.values_count, sizeof(value_type), h.size)
+          || ! fits(h.quantized_bounds_offset, quantized_boxes_count, 2 * dimension * (h.quantization_bits / 8), h.values_offset)
+          || ! fits(h.bounds_offset, exact_boxes_count, 2 * dimension * sizeof(coordinate_type), h.quantized_bounds_offset)
+          || ! fits(h.nodes_offset, h.nodes_count, sizeof(node_type), h.bounds_offset) )
+        {
+            detail::throw_invalid_argument("invalid flat rtree data");
+        }
+
+        char const* bytes = static_cast<char const*>(data);
+        if ( ! are_nodes_ok(reinterpret_cast<node_type const*>(bytes + h.nodes_offset), h) )
+        {
+            detail::throw_invalid_argument("invalid flat rtree data");
+        }
+
+        m_nodes = reinterpret_cast<node_type const*>(bytes + h.nodes_offset);
+        m_bounds = reinterpret_cast<coordinate_type const*>(bytes + h.bounds_offset);
+        m_quantized_bounds = bytes + h.quantized_bounds_offset;
+        m_values = reinterpret_cast<value_type const*>(bytes + h.values_offset);
+        m_nodes_count = h.nodes_count;
+        m_values_count = h.values_count;
+        m_leafs_level = h.leafs_level;
+        m_quantization_bits = h.quantization_bits;
+    }
+
+    /*!
+    \brief Finds values meeting passed predicates e.g. nearest to some Point and/or intersecting some Box.
+
+    The same predicates as the ones accepted by rtree::query() may be passed.
+
+    \param predicates   Predicates.
+    \param out_it       The output iterator, e.g. generated by std::back_inserter().
+
+    \return             The number of values found.
+    */
+    template <typename Predicates, typename OutIter>
+    size_type query(Predicates const& predicates, OutIter out_it) const
+    {
+        return m_nodes_count > 0
+             ? query_dispatch(predicates, out_it)
+             : 0;
+    }
+
+    /*! \brief Returns the number of stored values. */
+    size_type size() const { return m_values_count; }
+
+    /*! \brief Query if the container is empty. */
+    bool empty() const { return m_values_count == 0; }
+
+    /*! \brief Returns the box able to contain all values stored in the container. */
+    bounds_type bounds() const
+    {
+        bounds_type result;
+        if ( m_nodes_count > 0 )
+            soa_box::load(result, m_bounds, 1, 0);
+        else
+            geometry::assign_inverse(result);
+        return result;
+    }
+
+    /*! \brief Returns the iterator pointing at the first value. The values are stored in the order of leafs. */
+    const_iterator begin() const { return m_values; }
+
+    /*! \brief Returns the iterator pointing after the last value. */
+    const_iterator end() const { return m_values + m_values_count; }
+
+private:
+    // Checks if count elements of the size starting at offset end before limit without overflow.
+    static bool fits(std::uint64_t offset, std::uint64_t count, std::uint64_t size, std::uint64_t limit)
+    {
+        return offset <= limit
+            && ( size == 0 || count <= (limit - offset) / size );
+    }
+
+    // Checks if the nodes are stored level by level, if the children of the internal
+    // nodes are the consecutive nodes of the next level and if the leafs reference
+    // the consecutive values, so the queries never access the data out of bounds.
+    static bool are_nodes_ok(node_type const* nodes, header_type const& h)
+    {
+        std::uint64_t level_first = 0;
+        std::uint64_t level_last = (std::min)(h.nodes_count, std::uint64_t(1));
+        for ( std::uint64_t reverse_level = h.leafs_level ; reverse_level > 0 ; --reverse_level )
+        {
+            if ( level_first == level_last )
+                return false;
+
+            std::uint64_t next = level_last;
+            for ( std::uint64_t i = level_first ; i < level_last ; ++i )
+            {
+                if ( nodes[i].first != next || nodes[i].count > h.nodes_count - next )
+                    return false;
+                next += nodes[i].count;
+            }
+            level_first = level_last;
+            level_last = next;
+        }
+
+        if ( level_last != h.nodes_count )
+            return false;
+
+        std::uint64_t next = 0;
+        for ( std::uint64_t i = level_first ; i < level_last ; ++i )
+        {
+            if ( nodes[i].first != next || nodes[i].count > h.values_count - next )
+                return false;
+            next += nodes[i].count;
+        }
+        return next == h.values_count;
+    }
+
+    template
+    <
+        typename Predicates, typename OutIter,
+        std::enable_if_t<(detail::predicates_count_distance<Predicates>::value == 0), int> = 0
+    >
+    size_type query_dispatch(Predicates const& predicates, OutIter out_it) const
+    {
+        typedef detail::comparable_bounds_predicates
+            <
+                Predicates, box_type, typename detail::indexable_type<translator_type>::type, strategy_type
+            > bounds_predicates;
+
+        strategy_type const strategy = detail::get_strategy(m_parameters);
+        auto&& prepared = bounds_predicates::apply(predicates, strategy);
+        size_type result = 0;
+        apply_bounds([&](auto const& bounds)
+        {
+            result = spatial_query(prepared, strategy, bounds, 0, m_bounds, m_leafs_level, out_it);
+        });
+        return result;
+    }
+
+    template <typename Predicates, typename Bounds, typename OutIter>
+    size_type spatial_query(Predicates const& predicates, strategy_type const& strategy,
+                            Bounds const& bounds, std::uint64_t node_index,
+                            coordinate_type const* node_bounds, std::uint64_t reverse_level,
+                            OutIter & out_it) const
+    {
+        namespace id = index::detail;
+
+        node_type const& n = m_nodes[node_index];
+        size_type found_count = 0;
+
+        if ( reverse_level > 0 )
+        {
+            typedef detail::rtree::flat::is_soa_intersects<Predicates, box_type> is_soa;
+            for_each_child(predicates, strategy, bounds, n, node_bounds,
+                           [&](std::uint64_t i, coordinate_type const* child_bounds)
+            {
+                found_count += spatial_query(predicates, strategy, bounds, i, child_bounds,
+                                             reverse_level - 1, out_it);
+            }, std::integral_constant<bool, is_soa::value>());
+        }
+        else
+        {
+            value_type const* const last = m_values + n.first + n.count;
+            for ( value_type const* it = m_values + n.first ; it != last ; ++it )
+            {
+                if ( id::predicates_check<id::value_tag>(predicates, *it, m_translator(*it), strategy) )
+                {
+                    *out_it = *it;
+                    ++out_it;
+                    ++found_count;
+                }
+            }
+        }
+
+        return found_count;
+    }
+
+    // Calls f for the children of the internal node meeting the predicates.
+    template <typename Predicates, typename Bounds, typename Function>
+    void for_each_child(Predicates const& predicates, strategy_type const& strategy,
+                        Bounds const& bounds, node_type const& n, coordinate_type const* node_bounds,
+                        Function const& f, std::false_type) const
+    {
+        namespace id = index::detail;
+
+        coordinate_type buffer[2 * dimension * block_size];
+        coordinate_type child_bounds[2 * dimension];
+        box_type box;
+        for ( std::uint64_t first = 0 ; first < n.count ; first += block_size )
+        {
+            std::size_t const count = std::size_t((std::min)(std::uint64_t(block_size), n.count - first));
+            std::size_t stride = 0;
+            coordinate_type const* group = bounds.block(n, node_bounds, first, count, buffer, stride);
+            for ( std::size_t i = 0 ; i < count ; ++i )
+            {
+                soa_box::load(box, group, stride, i);
+                // if current node meets predicates (0 is dummy value)
+                if ( id::predicates_check<id::bounds_tag>(predicates, 0, box, strategy) )
+                {
+                    f(n.first + first + i, load_bounds<Bounds>(group, stride, i, child_bounds));
+                }
+            }
+        }
+    }
+
+    // Calls f for the children of the internal node intersecting the box, the boxes
+    // of the children are tested in blocks.
+    template <typename Predicates, typename Bounds, typename Function>
+    void for_each_child(Predicates const& predicates, strategy_type const&,
+                        Bounds const& bounds, node_type const& n, coordinate_type const* node_bounds,
+                        Function const& f, std::true_type) const
+    {
+        coordinate_type query[2 * dimension];
+        detail::rtree::flat::soa_box<decltype(predicates.geometry)>::store(predicates.geometry, query, 1, 0);
+
+        coordinate_type buffer[2 * dimension * block_size];
+        coordinate_type child_bounds[2 * dimension];
+        unsigned char hits[block_size];
+        for ( std::uint64_t first = 0 ; first < n.count ; first += block_size )
+        {
+            std::size_t const count = std::size_t((std::min)(std::uint64_t(block_size), n.count - first));
+            std::size_t stride = 0;
+            coordinate_type const* group = bounds.block(n, node_bounds, first, count, buffer, stride);
+            detail::rtree::flat::soa_intersects<dimension>(group, stride, 0, count,
+                                                           query, query + dimension, hits);
+            for ( std::size_t i = 0 ; i < count ; ++i )
+            {
+                if ( hits[i] )
+                    f(n.first + first + i, load_bounds<Bounds>(group, stride, i, child_bounds));
+            }
+        }
+    }
+
+    // The boxes of the children stored exactly.
+    struct exact_bounds
+    {
+        static const bool is_quantized = false;
+
+        // Returns the structure of arrays of the boxes of the children [first, first + count)
+        // of the node. The coordinates of the i-th box are stored every stride elements.
+        coordinate_type const* block(node_type const& n, coordinate_type const* /*node_bounds*/,
+                                     std::uint64_t first, std::size_t /*count*/,
+                                     coordinate_type * /*buffer*/, std::size_t & stride) const
+        {
+            stride = std::size_t(n.count);
+            return data + n.first * 2 * dimension + first;
+        }
+
+        coordinate_type const* data;
+    };
+
+    // The quantized boxes of the children decoded relative to the box of the node.
+    template <typename Int>
+    struct quantized_bounds
+    {
+        static const bool is_quantized = true;
+
+        coordinate_type const* block(node_type const& n, coordinate_type const* node_bounds,
+                                     std::uint64_t first, std::size_t count,
+                                     coordinate_type * buffer, std::size_t & stride) const
+        {
+            detail::rtree::flat::soa_decode<dimension>(data + n.first * 2 * dimension,
+                                                       std::size_t(n.count), std::size_t(first), count,
+                                                       node_bounds, node_bounds + dimension, buffer);
+            stride = count;
+            return buffer;
+        }
+
+        Int const* data;
+    };
+
+    // Calls f with the object accessing the boxes of the children.
+    template <typename Function>
+    void apply_bounds(Function const& f) const
+    {
+        switch ( m_quantization_bits )
+        {
+        case 8:
+            f(quantized_bounds<std::uint8_t>{ static_cast<std::uint8_t const*>(m_quantized_bounds) });
+            break;
+        case 16:
+            f(quantized_bounds<std::uint16_t>{ static_cast<std::uint16_t const*>(m_quantized_bounds) });
+            break;
+        default:
+            f(exact_bounds{ m_bounds });
+        }
+    }
+
+    // The bounds of a child are needed to decode the boxes of its children
+    // only if the boxes are quantized.
+    template <typename Bounds>
+    static coordinate_type const* load_bounds(coordinate_type const* group, std::size_t stride,
+                                              std::size_t i, coordinate_type * result)
+    {
+        if ( ! Bounds::is_quantized )
+            return nullptr;
+
+        for ( std::size_t k = 0 ; k < 2 * dimension ; ++k )
+            result[k] = group[k * stride + i];
+        return result;
+    }
+
+    template
+    <
+        typename Predicates, typename OutIter,
+        std::enable_if_t<(detail::predicates_count_distance<Predicates>::value > 0), int> = 0
+    >
+    size_type query_dispatch(Predicates const& predicates, OutIter out_it) const
+    {
+        BOOST_GEOMETRY_STATIC_ASSERT((detail::predicates_count_distance<Predicates>::value == 1),
+                                     "Only one distance predicate can be passed.",
+                                     Predicates);
+
+        typedef detail::comparable_bounds_predicates
+            <
+                Predicates, box_type, typename detail::indexable_type<translator_type>::type, strategy_type
+            > bounds_predicates;
+
+        auto&& prepared = bounds_predicates::apply(predicates, detail::get_strategy(m_parameters));
+        size_type result = 0;
+        apply_bounds([&](auto const& bounds)
+        {
+            result = distance_query(prepared, bounds, out_it);
+        });
+        return result;
+    }
+
+    template <typename Predicates, typename Bounds, typename OutIter>
+    size_type distance_query(Predicates const& predicates, Bounds const& bounds, OutIter out_it) const
+    {
+        namespace id = index::detail;
+
+        typedef id::predicates_element
+            <
+                id::predicates_find_distance<Predicates>::value, Predicates
+            > nearest_predicate_access;
+        typedef typename nearest_predicate_access::type nearest_predicate_type;
+        typedef typename id::indexable_type<translator_type>::type indexable_type;
+        typedef id::calculate_distance<nearest_predicate_type, indexable_type, strategy_type, id::value_tag> calculate_value_distance;
+        typedef id::calculate_distance<nearest_predicate_type, box_type, strategy_type, id::bounds_tag> calculate_node_distance;
+        typedef typename calculate_value_distance::result_type value_distance_type;
+        typedef typename calculate_node_distance::result_type node_distance_type;
+
+        struct branch_data
+        {
+            branch_data(node_distance_type d, std::uint64_t rl, std::uint64_t i,
+                        coordinate_type const* b)
+                : distance(d), reverse_level(rl), index(i)
+            {
+                // the box of the node is needed to decode the quantized boxes of its children
+                if ( b )
+                    std::copy(b, b + 2 * dimension, node_bounds);
+            }
+
+            node_distance_type distance;
+            std::uint64_t reverse_level;
+            std::uint64_t index;
+            coordinate_type node_bounds[Bounds::is_quantized ? 2 * dimension : 1];
+        };
+
+        strategy_type const strategy = detail::get_strategy(m_parameters);
+        nearest_predicate_type const& predicate = nearest_predicate_access::get(predicates);
+        std::size_t const max_count = predicate.count;
+        if ( max_count == 0 )
+        {
+            return 0;
+        }
+
+        std::vector<std::pair<value_distance_type, value_type const*> > neighbors;
+        neighbors.reserve((std::min)(max_count, m_values_count));
+        id::rtree::visitors::priority_queue<branch_data, id::rtree::visitors::branch_data_comp> branches;
+
+        auto ignore_branch = [&](node_distance_type const& d)
+        {
+            return neighbors.size() == max_count && neighbors.front().first <= d;
+        };
+
+        coordinate_type buffer[2 * dimension * block_size];
+        coordinate_type child_bounds[2 * dimension];
+        coordinate_type node_bounds[2 * dimension];
+        std::copy(m_bounds, m_bounds + 2 * dimension, node_bounds);
+
+        std::uint64_t node_index = 0;
+        std::uint64_t reverse_level = m_leafs_level;
+        for (;;)
+        {
+            node_type const& n = m_nodes[node_index];
+            if ( reverse_level > 0 )
+            {
+                box_type box;
+                for ( std::uint64_t first = 0 ; first < n.count ; first += block_size )
+                {
+                    std::size_t const count = std::size_t((std::min)(std::uint64_t(block_size), n.count - first));
+                    std::size_t stride = 0;
+                    coordinate_type const* group = bounds.block(n, node_bounds, first, count, buffer, stride);
+                    for ( std::size_t i = 0 ; i < count ; ++i )
+                    {
+                        soa_box::load(box, group, stride, i);
+                        node_distance_type node_distance;
+                        if ( id::predicates_check<id::bounds_tag>(predicates, 0, box, strategy)
+                          && calculate_node_distance::apply(predicate, box, strategy, node_distance)
+                          && ! ignore_branch(node_distance) )
+                        {
+                            branches.push(branch_data(node_distance, reverse_level - 1, n.first + first + i,
+                                                      load_bounds<Bounds>(group, stride, i, child_bounds)));
+                        }
+                    }
+                }
+            }
+            else
+            {
+                for ( std::uint64_t i = n.first ; i < n.first + n.count ; ++i )
+                {
+                    value_type const& v = m_values[i];
+                    value_distance_type value_distance;
+                    if ( id::predicates_check<id::value_tag>(predicates, v, m_translator(v), strategy)
+                      && calculate_value_distance::apply(predicate, m_translator(v), strategy, value_distance) )
+                    {
+                        if ( neighbors.size() < max_count )
+                        {
+                            neighbors.push_back(std::make_pair(value_distance, &v));
+                            if ( neighbors.size() == max_count )
+                                std::make_heap(neighbors.begin(), neighbors.end(), id::rtree::visitors::pair_first_less());
+                        }
+                        else if ( value_distance < neighbors.front().first )
+                        {
+                            std::pop_heap(neighbors.begin(), neighbors.end(), id::rtree::visitors::pair_first_less());
+                            neighbors.back() = std::make_pair(value_distance, &v);
+                            std::push_heap(neighbors.begin(), neighbors.end(), id::rtree::visitors::pair_first_less());
+                        }
+                    }
+                }
+            }
+
+            if ( branches.empty() || ignore_branch(branches.top().distance) )
+            {
+                break;
+            }
+
+            node_index = branches.top().index;
+            reverse_level = branches.top().reverse_level;
+            if ( Bounds::is_quantized )
+                std::copy(branches.top().node_bounds, branches.top().node_bounds + 2 * dimension, node_bounds);
+            branches.pop();
+        }
+
+        for ( auto const& p : neighbors )
+        {
+            *out_it = *(p.second);
+            ++out_it;
+        }
+
+        return neighbors.size();
+    }
+
+    translator_type m_translator;
+    parameters_type m_parameters;
+
+    node_type const* m_nodes;
+    coordinate_type const* m_bounds;
+    void const* m_quantized_bounds;
+    value_type const* m_values;
+    std::size_t m_nodes_count;
+    std::size_t m_values_count;
+    std::uint64_t m_leafs_level;
+    unsigned int m_quantization_bits;
+};
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_FLAT_RTREE_HPP
@@ -0,0 +1,405 @@
+// Boost.Geometry Index
+//
+// R-tree storing moving points
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_MOVING_RTREE_HPP
+#define BOOST_GEOMETRY_INDEX_MOVING_RTREE_HPP
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <boost/container/new_allocator.hpp>
+
+#include <boost/geometry/core/coordinate_dimension.hpp>
+#include <boost/geometry/core/coordinate_type.hpp>
+#include <boost/geometry/core/cs.hpp>
+#include <boost/geometry/core/static_assert.hpp>
+#include <boost/geometry/geometries/point.hpp>
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/detail/moving.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+/*!
+\brief The point moving with constant velocity.
+
+The position of the point at time t is <tt>position + velocity * (t - time)</tt>.
+
+\tparam Point   The type of the position and the velocity, a cartesian point.
+\tparam Time    The type of the time.
+*/
+template <typename Point, typename Time = typename geometry::coordinate_type<Point>::type>
+struct moving_point
+{
+    typedef Point point_type;
+    typedef Time time_type;
+
+    moving_point()
+    {}
+
+    /*!
+    \brief The constructor.
+
+    \param p    The position at time t.
+    \param v    The velocity.
+    \param t    The time at which the point is at the position p.
+    */
+    moving_point(Point const& p, Point const& v, Time const& t = Time(0))
+        : position(p), velocity(v), time(t)
+    {}
+
+    Point position;
+    Point velocity;
+    Time time;
+};
+
+template <typename Point, typename Time>
+inline bool operator==(moving_point<Point, Time> const& l, moving_point<Point, Time> const& r)
+{
+    return geometry::equals(l.position, r.position)
+        && geometry::equals(l.velocity, r.velocity)
+        && l.time == r.time;
+}
+
+/*!
+\brief The default IndexableGetter of moving_rtree.
+
+It returns the moving_point if it's the Value or the first element of std::pair or std::tuple.
+
+\tparam Value   The Value type.
+*/
+template <typename Value>
+struct moving_indexable
+{
+    typedef Value const& result_type;
+
+    result_type operator()(Value const& v) const
+    {
+        return v;
+    }
+};
+
+template <typename MovingPoint, typename Second>
+struct moving_indexable<std::pair<MovingPoint, Second> >
+{
+    typedef MovingPoint const& result_type;
+
+    result_type operator()(std::pair<MovingPoint, Second> const& v) const
+    {
+        return v.first;
+    }
+};
+
+template <typename MovingPoint, typename ...Args>
+struct moving_indexable<std::tuple<MovingPoint, Args...> >
+{
+    typedef MovingPoint const& result_type;
+
+    result_type operator()(std::tuple<MovingPoint, Args...> const& v) const
+    {
+        return std::get<0>(v);
+    }
+};
+
+/*!
+\brief Generate \c intersects_at() predicate.
+
+Generate a predicate defining the relationship between the position of a moving point
+at the time and a Box. Value is returned by the query of moving_rtree if the position
+of the moving point at the time is covered by the Box.
+
+\par Example
+\verbatim
+tree.query(bgi::intersects_at(box, t), std::back_inserter(result));
+tree.query(bgi::intersects_at(box, t) && bgi::satisfies(is_vehicle), std::back_inserter(result));
+\endverbatim
+
+\ingroup predicates
+
+\param box  The Box.
+\param time The time.
+*/
+template <typename Box, typename Time> inline
+detail::predicates::intersects_at<Box, Time>
+intersects_at(Box const& box, Time const& time)
+{
+    return detail::predicates::intersects_at<Box, Time>(box, time);
+}
+
+/*!
+\brief Generate \c nearest_at() predicate.
+
+Generate a predicate defining the k-nearest neighbours of the Point at the time.
+Only one distance predicate may be passed to the query.
+
+\par Example
+\verbatim
+tree.query(bgi::nearest_at(pt, t, 5), std::back_inserter(result));
+\endverbatim
+
+\ingroup predicates
+
+\param point    The Point from which distance is calculated.
+\param time     The time of the positions of moving points.
+\param k        The maximum number of values to return.
+*/
+template <typename Point, typename Time> inline
+detail::predicates::nearest<detail::moving::position_at<Point, Time> >
+nearest_at(Point const& point, Time const& time, std::size_t k)
+{
+    return detail::predicates::nearest<detail::moving::position_at<Point, Time> >(
+                detail::moving::position_at<Point, Time>(point, time), k);
+}
+
+/*!
+\brief The R-tree storing points moving with constant velocities.
+
+The moving points are stored in the rtree as points of the space of twice as many
+dimensions containing the positions at the reference time and the velocities. The boxes
+of the nodes in this space contain the positions at the reference time and the ranges
+of the velocities of the moving points so the box containing all positions at any time
+is known for each node. Therefore the positions don't have to be updated as the time
+passes, a value has to be updated only if the velocity changes. The queries may be
+performed for any time using the intersects_at() and nearest_at() predicates, optionally
+combined with satisfies().
+
+The velocities are multiplied by the horizon so the nodes group the moving points by the
+positions at the reference time and the distances traveled during the horizon. The boxes
+of the nodes grow as the time moves away from the reference time. If most of the queries
+are performed long after the reference time the tree should be packed again with the
+reference time closer to the time of the queries.
+
+\par Example
+\verbatim
+typedef bgi::moving_point<point_t, double> moving_point_t;
+typedef std::pair<moving_point_t, int> value_t;
+bgi::moving_rtree<value_t, bgi::rstar<16> > tree(bgi::rstar<16>(), now, 60);
+tree.insert(std::make_pair(moving_point_t(position, velocity, now), id));
+tree.query(bgi::intersects_at(box, now + 10), std::back_inserter(result));
+\endverbatim
+
+\tparam Value           The type of objects stored in the container.
+\tparam Parameters      Compile-time parameters.
+\tparam IndexableGetter The function object extracting moving_point from Value.
+\tparam EqualTo         The function object comparing objects of type Value.
+\tparam Allocator       The allocator used to allocate/deallocate memory,
+                        construct/destroy nodes and Values.
+*/
+template
+<
+    typename Value,
+    typename Parameters,
+    typename IndexableGetter = index::moving_indexable<Value>,
+    typename EqualTo = index::equal_to<Value>,
+    typename Allocator = boost::container::new_allocator<Value>
+>
+class moving_rtree
+{
+    typedef typename std::remove_const
+        <
+            typename std::remove_reference<typename IndexableGetter::result_type>::type
+        >::type moving_point_type;
+
+public:
+    /*! \brief The type of Value stored in the container. */
+    typedef Value value_type;
+    /*! \brief R-tree parameters type. */
+    typedef Parameters parameters_type;
+    /*! \brief The function object extracting moving_point from Value. */
+    typedef IndexableGetter indexable_getter;
+    /*! \brief The function object comparing objects of type Value. */
+    typedef EqualTo value_equal;
+    /*! \brief The type of allocator used by the container. */
+    typedef Allocator allocator_type;
+    /*! \brief The type of the position and the velocity of moving points. */
+    typedef typename moving_point_type::point_type point_type;
+    /*! \brief The type of the time. */
+    typedef typename moving_point_type::time_type time_type;
+
+private:
+    typedef typename geometry::coordinate_type<point_type>::type coordinate_type;
+    static const std::size_t dimension = geometry::dimension<point_type>::value;
+
+    BOOST_GEOMETRY_STATIC_ASSERT(
+        (std::is_same<typename geometry::cs_tag<point_type>::type, cartesian_tag>::value),
+        "Only cartesian moving points are supported.",
+        point_type);
+
+    typedef model::point<coordinate_type, 2 * dimension, cs::cartesian> dual_point_type;
+    typedef detail::moving::dual_indexable<IndexableGetter, dual_point_type, time_type> dual_getter_type;
+    typedef index::rtree<Value, Parameters, dual_getter_type, EqualTo, Allocator> rtree_type;
+
+public:
+    /*! \brief Unsigned integral type used by the container. */
+    typedef typename rtree_type::size_type size_type;
+    /*! \brief Type of const iterator, category ForwardIterator. */
+    typedef typename rtree_type::const_iterator const_iterator;
+
+    /*!
+    \brief The constructor.
+
+    \param parameters       The parameters object.
+    \param reference_time   The reference time.
+    \param horizon          The time by which the velocities are multiplied, must be positive.
+    \param getter           The function object extracting moving_point from Value.
+    \param equal            The function object comparing Values.
+    \param allocator        The allocator object.
+
+    \par Throws
+    If allocator default constructor throws.
+    */
+    explicit moving_rtree(parameters_type const& parameters = parameters_type(),
+                          time_type const& reference_time = time_type(0),
+                          time_type const& horizon = time_type(1),
+                          indexable_getter const& getter = indexable_getter(),
+                          value_equal const& equal = value_equal(),
+                          allocator_type const& allocator = allocator_type())
+        : m_tree(parameters, dual_getter_type(getter, reference_time, horizon), equal, allocator)
+    {}
+
+    /*!
+    \brief The constructor.
+
+    The tree is created using packing algorithm.
+
+    \param first            The beginning of the range of Values.
+    \param last             The end of the range of Values.
+    \param parameters       The parameters object.
+    \param reference_time   The reference time.
+    \param horizon          The time by which the velocities are multiplied, must be positive.
+    \param getter           The function object extracting moving_point from Value.
+    \param equal            The function object comparing Values.
+    \param allocator        The allocator object.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+    */
+    template <typename Iterator>
+    moving_rtree(Iterator first, Iterator last,
+                 parameters_type const& parameters = parameters_type(),
+                 time_type const& reference_time = time_type(0),
+                 time_type const& horizon = time_type(1),
+                 indexable_getter const& getter = indexable_getter(),
+                 value_equal const& equal = value_equal(),
+                 allocator_type const& allocator = allocator_type())
+        : m_tree(first, last, parameters, dual_getter_type(getter, reference_time, horizon), equal, allocator)
+    {}
+
+    /*!
+    \brief Insert a value to the index.
+
+    \param value    The value which will be stored in the container.
+
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+    */
+    void insert(value_type const& value)
+    {
+        m_tree.insert(value);
+    }
+
+    /*!
+    \brief Insert a range of values to the index.
+
+    \param first    The beginning of the range of values.
+    \param last     The end of the range of values.
+
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+    */
+    template <typename Iterator>
+    void insert(Iterator first, Iterator last)
+    {
+        m_tree.insert(first, last);
+    }
+
+    /*!
+    \brief Remove a value from the container.
+
+    In order to update the velocity of a moving point the old value should be removed
+    and the new one inserted.
+
+    \param value    The value which will be removed from the container.
+
+    \return         1 if the value was removed, 0 otherwise.
+
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+    */
+    size_type remove(value_type const& value)
+    {
+        return m_tree.remove(value);
+    }
+
+    /*!
+    \brief Finds values meeting passed predicates at the times passed into them.
+
+    The predicates intersects_at() and nearest_at() and the predicates not depending on the
+    position, e.g. satisfies(), may be passed.
+
+    \param predicates   Predicates.
+    \param out_it       The output iterator, e.g. generated by std::back_inserter().
+
+    \return             The number of values found.
+
+    \par Throws
+    If Value copy constructor or copy assignment throws.
+    If predicates copy throws.
+    */
+    template <typename Predicates, typename OutIter>
+    size_type query(Predicates const& predicates, OutIter out_it) const
+    {
+        typedef detail::moving::convert_time<Predicates, coordinate_type> convert_time;
+
+        return m_tree.query(convert_time::apply(predicates, reference_time(), horizon()), out_it);
+    }
+
+    /*! \brief Returns the number of stored values. */
+    size_type size() const { return m_tree.size(); }
+
+    /*! \brief Query if the container is empty. */
+    bool empty() const { return m_tree.empty(); }
+
+    /*! \brief Removes all values stored in the container. */
+    void clear() { m_tree.clear(); }
+
+    /*! \brief Returns the iterator pointing at the begin of the rtree values range. */
+    const_iterator begin() const { return m_tree.begin(); }
+
+    /*! \brief Returns the iterator pointing at the end of the rtree values range. */
+    const_iterator end() const { return m_tree.end(); }
+
+    /*! \brief Returns the reference time. */
+    time_type reference_time() const { return m_tree.indexable_get().reference_time(); }
+
+    /*! \brief Returns the horizon. */
+    time_type horizon() const { return m_tree.indexable_get().horizon(); }
+
+    /*! \brief Returns parameters. */
+    parameters_type parameters() const { return m_tree.parameters(); }
+
+    /*! \brief Returns function retrieving moving_point from Value. */
+    indexable_getter indexable_get() const { return m_tree.indexable_get().getter(); }
+
+    /*! \brief Returns function comparing Values. */
+    value_equal value_eq() const { return m_tree.value_eq(); }
+
+private:
+    rtree_type m_tree;
+};
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_MOVING_RTREE_HPP
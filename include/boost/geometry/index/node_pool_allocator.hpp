@@ -0,0 +1,121 @@
+// Boost.Geometry Index
+//
+// R-tree nodes pool allocator
+//
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_GEOMETRY_INDEX_NODE_POOL_ALLOCATOR_HPP
+#define BOOST_GEOMETRY_INDEX_NODE_POOL_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include <boost/geometry/index/detail/rtree/node/node_pool.hpp>
+
+namespace boost { namespace geometry { namespace index {
+
+/*!
+\brief The allocator allocating the nodes of the rtree from a pool.
+
+It may be passed as the Allocator of the rtree in order to speed up the creation and
+destruction of trees containing many nodes. Small objects, i.e. nodes and containers of
+elements of dynamic nodes, are allocated from big chunks of memory and the memory of
+destroyed objects is reused for the objects of the same size. The chunks are released
+at once when the last allocator referring to the pool is destroyed, e.g. with the rtree.
+The memory is not returned to the system by rtree::clear(), it's reused by the
+subsequent insertions instead. Bigger objects are allocated with operator new.
+
+The copies of the allocator share the pool so the copies of the rtree use the same pool
+and the rtrees may be moved without copying the nodes. The pool may be used by multiple
+threads, e.g. during parallel packing or by rtrees sharing the pool.
+
+\tparam T   The type of allocated objects.
+*/
+template <typename T>
+class node_pool_allocator
+{
+    template <typename U> friend class node_pool_allocator;
+
+    typedef detail::rtree::node_pool pool_type;
+
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef node_pool_allocator<U> other;
+    };
+
+    /*!
+    \brief The constructor creating a new pool.
+
+    \param chunk_size   The size in bytes of chunks of memory allocated by the pool.
+
+    \par Throws
+    If allocation of the pool throws.
+    */
+    explicit node_pool_allocator(std::size_t chunk_size = 65536)
+        : m_pool(std::make_shared<pool_type>(chunk_size))
+    {}
+
+    /*!
+    \brief The constructor sharing the pool of other allocator.
+    */
+    template <typename U>
+    node_pool_allocator(node_pool_allocator<U> const& other) noexcept
+        : m_pool(other.m_pool)
+    {}
+
+    T * allocate(std::size_t n)
+    {
+        if ( is_pooled(n) )
+        {
+            return static_cast<T*>(m_pool->allocate(n * sizeof(T)));                // MAY THROW (alloc)
+        }
+        return std::allocator<T>().allocate(n);                                     // MAY THROW (alloc)
+    }
+
+    void deallocate(T * p, std::size_t n) noexcept
+    {
+        if ( is_pooled(n) )
+        {
+            m_pool->deallocate(p, n * sizeof(T));
+        }
+        else
+        {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    template <typename U>
+    bool operator==(node_pool_allocator<U> const& other) const noexcept
+    {
+        return m_pool == other.m_pool;
+    }
+
+    template <typename U>
+    bool operator!=(node_pool_allocator<U> const& other) const noexcept
+    {
+        return m_pool != other.m_pool;
+    }
+
+private:
+    static bool is_pooled(std::size_t n)
+    {
+        return alignof(T) <= pool_type::alignment
+            && 0 < n && n <= pool_type::max_block_size / sizeof(T);
+    }
+
+    std::shared_ptr<pool_type> m_pool;
+};
+
+}}} // namespace boost::geometry::index
+
+#endif // BOOST_GEOMETRY_INDEX_NODE_POOL_ALLOCATOR_HPP
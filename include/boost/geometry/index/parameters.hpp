@@ -16,6 +16,7 @@
 #define BOOST_GEOMETRY_INDEX_PARAMETERS_HPP
 
 #include <limits>
+#include <type_traits>
 
 #include <boost/geometry/core/static_assert.hpp>
 
@@ -150,12 +151,31 @@ struct rstar
     static size_t get_overlap_cost_threshold() { return OverlapCostThreshold; }
 };
 
-//template <size_t MaxElements, size_t MinElements>
-//struct kmeans
-//{
-//    static const size_t max_elements = MaxElements;
-//    static const size_t min_elements = MinElements;
-//};
+/*!
+\brief K-means r-tree creation algorithm parameters.
+
+Overflowing nodes are split by clustering the centers of the elements' boxes into
+two groups with the k-means algorithm, i.e. spatially close elements are kept in
+the same node. It's faster than R* and for clustered data results in less overlap
+than linear.
+
+\tparam MaxElements     Maximum number of elements in nodes.
+\tparam MinElements     Minimum number of elements in nodes. Default: 0.3*Max.
+*/
+template <size_t MaxElements,
+          size_t MinElements = detail::default_min_elements_s<MaxElements>::value>
+struct kmeans
+{
+    BOOST_GEOMETRY_STATIC_ASSERT((0 < MinElements && 2*MinElements <= MaxElements+1),
+        "Invalid MaxElements or MinElements.",
+        std::integer_sequence<size_t, MaxElements, MinElements>);
+
+    static const size_t max_elements = MaxElements;
+    static const size_t min_elements = MinElements;
+
+    static size_t get_max_elements() { return MaxElements; }
+    static size_t get_min_elements() { return MinElements; }
+};
 
 /*!
 \brief Linear r-tree creation algorithm parameters - run-time version.
@@ -260,6 +280,47 @@ private:
     size_t m_overlap_cost_threshold;
 };
 
+/*!
+\brief K-means r-tree creation algorithm parameters - run-time version.
+*/
+class dynamic_kmeans
+{
+public:
+    /*!
+    \brief The constructor.
+
+    \param max_elements     Maximum number of elements in nodes.
+    \param min_elements     Minimum number of elements in nodes. Default: 0.3*Max.
+    */
+    explicit dynamic_kmeans(size_t max_elements,
+                            size_t min_elements = detail::default_min_elements_d())
+        : m_max_elements(max_elements)
+        , m_min_elements(detail::default_min_elements_d_calc(max_elements, min_elements))
+    {
+        if (!(0 < m_min_elements && 2*m_min_elements <= m_max_elements+1))
+            detail::throw_invalid_argument("invalid min or/and max parameters of dynamic_kmeans");
+    }
+
+    size_t get_max_elements() const { return m_max_elements; }
+    size_t get_min_elements() const { return m_min_elements; }
+
+private:
+    size_t m_max_elements;
+    size_t m_min_elements;
+};
+
+
+/*!
+\brief Hilbert curve packing algorithm.
+
+Passed to the r-tree packing constructor in order to select the packing algorithm
+sorting the Values by the position of the centroids of their Indexables on the Hilbert
+curve and filling the nodes sequentially. It is faster than the default algorithm
+and preserves the locality of the Values but in general results in worse queries
+performance, especially for Indexables other than Points.
+*/
+struct hilbert_packing {};
+
 
 template <typename Parameters, typename Strategy>
 class parameters
@@ -286,9 +347,50 @@ public:
 };
 
 
+/*!
+\brief Parameters adaptor storing the numbers of values of subtrees in the internal nodes.
+
+Wraps the parameters of the r-tree creation algorithm, e.g. <tt>counted<rstar<16> ></tt>
+or <tt>counted<parameters<rstar<16>, Strategy> ></tt>. Each internal node stores the
+number of values stored in its subtree which is updated during insertion and removal.
+The counts allow rtree::query_count() to count the values of subtrees covered by the
+query region without traversing them and improve the precision of rtree::estimate_count()
+at the cost of one integer per internal node.
+*/
+template <typename Parameters>
+class counted
+    : public Parameters
+{
+public:
+    counted()
+        : Parameters()
+    {}
+
+    counted(Parameters const& params)
+        : Parameters(params)
+    {}
+};
+
+
 namespace detail
 {
 
+template <typename Parameters>
+struct is_counted
+    : std::false_type
+{};
+
+template <typename Parameters>
+struct is_counted< counted<Parameters> >
+    : std::true_type
+{};
+
+template <typename Parameters, typename Strategy>
+struct is_counted< parameters<Parameters, Strategy> >
+    : is_counted<Parameters>
+{};
+
+
 template <typename Parameters>
 struct strategy_type
 {
@@ -304,6 +406,12 @@ struct strategy_type< parameters<Parameters, Strategy> >
 };
 
 
+template <typename Parameters>
+struct strategy_type< counted<Parameters> >
+    : strategy_type<Parameters>
+{};
+
+
 template <typename Parameters>
 struct get_strategy_impl
 {
@@ -322,6 +430,16 @@ struct get_strategy_impl<parameters<Parameters, Strategy> >
     }
 };
 
+template <typename Parameters>
+struct get_strategy_impl<counted<Parameters> >
+{
+    static inline typename strategy_type<Parameters>::result_type
+        apply(counted<Parameters> const& parameters)
+    {
+        return get_strategy_impl<Parameters>::apply(parameters);
+    }
+};
+
 template <typename Parameters>
 inline typename strategy_type<Parameters>::result_type
     get_strategy(Parameters const& parameters)
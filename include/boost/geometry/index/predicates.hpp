@@ -343,6 +343,69 @@ nearest(Geometry const& geometry, std::size_t k)
     return detail::predicates::nearest<Geometry>(geometry, k);
 }
 
+/*!
+\brief Generate nearest() predicate with the maximum distance.
+
+When this predicate is passed to the query, k-nearest neighbour search will be performed
+but only \c Values not further than \c max_distance from the \c Geometry are returned.
+So less than k values may be returned. The nodes of the tree further than \c max_distance
+are not traversed. Internally boost::geometry::comparable_distance() is used to perform
+the calculation and the maximum distance is converted into the comparable distance
+with the distance strategy of the tree.
+
+\par Example
+\verbatim
+bgi::query(spatial_index, bgi::nearest(pt, 5, 100.0), std::back_inserter(result));
+bgi::query(spatial_index, bgi::nearest(pt, 5, 100.0) && bgi::intersects(box), std::back_inserter(result));
+\endverbatim
+
+\warning
+Only one \c nearest() predicate may be used in a query.
+
+\ingroup predicates
+
+\param geometry     The geometry from which distance is calculated.
+\param k            The maximum number of values to return.
+\param max_distance The maximum distance between the geometry and returned values.
+*/
+template <typename Geometry, typename Distance> inline
+detail::predicates::bounded_nearest<Geometry, Distance>
+nearest(Geometry const& geometry, std::size_t k, Distance const& max_distance)
+{
+    return detail::predicates::bounded_nearest<Geometry, Distance>(geometry, k, max_distance);
+}
+
+/*!
+\brief Generate within_distance() predicate.
+
+Generate a predicate defining Value and Geometry relationship. With this
+predicate query returns indexed Values not further than \c max_distance
+from the passed Geometry. Value is returned by the query if
+<tt>bg::distance(Geometry, Indexable) <= max_distance</tt>. The values
+are not sorted by the distance and may be returned in any order. The nodes
+of the tree further than \c max_distance are not traversed.
+
+\par Example
+\verbatim
+bgi::query(spatial_index, bgi::within_distance(pt, 100.0), std::back_inserter(result));
+bgi::query(spatial_index, bgi::within_distance(pt, 100.0) && bgi::satisfies(fun), std::back_inserter(result));
+\endverbatim
+
+\ingroup predicates
+
+\tparam Geometry    The Geometry type.
+\tparam Distance    The type of the distance.
+
+\param g            The Geometry object.
+\param max_distance The maximum distance between the geometry and returned values.
+*/
+template <typename Geometry, typename Distance> inline
+detail::predicates::within_distance<Geometry, Distance>
+within_distance(Geometry const& g, Distance const& max_distance)
+{
+    return detail::predicates::within_distance<Geometry, Distance>(g, max_distance);
+}
+
 #ifdef BOOST_GEOMETRY_INDEX_DETAIL_EXPERIMENTAL
 
 /*!
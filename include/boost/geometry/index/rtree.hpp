@@ -24,6 +24,7 @@
 // Boost
 #include <boost/container/new_allocator.hpp>
 #include <boost/move/move.hpp>
+#include <boost/range/iterator_range.hpp>
 #include <boost/tuple/tuple.hpp>
 
 // Boost.Geometry
@@ -52,6 +53,7 @@
 
 #include <boost/geometry/index/indexable.hpp>
 #include <boost/geometry/index/equal_to.hpp>
+#include <boost/geometry/index/execution.hpp>
 
 #include <boost/geometry/index/detail/translator.hpp>
 
@@ -68,9 +70,16 @@
 #include <boost/geometry/index/detail/rtree/visitors/insert.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/iterator.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/remove.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/remove_if.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/copy.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/destroy.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/spatial_join.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/all_nearest.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/spatial_query.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/spatial_count.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/estimate_count.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/batch_distance_query.hpp>
+#include <boost/geometry/index/detail/rtree/visitors/batch_spatial_query.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/distance_query.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/count.hpp>
 #include <boost/geometry/index/detail/rtree/visitors/children_box.hpp>
@@ -78,9 +87,12 @@
 #include <boost/geometry/index/detail/rtree/linear/linear.hpp>
 #include <boost/geometry/index/detail/rtree/quadratic/quadratic.hpp>
 #include <boost/geometry/index/detail/rtree/rstar/rstar.hpp>
-//#include <boost/geometry/extensions/index/detail/rtree/kmeans/kmeans.hpp>
+#include <boost/geometry/index/detail/rtree/kmeans/kmeans.hpp>
 
 #include <boost/geometry/index/detail/rtree/pack_create.hpp>
+#include <boost/geometry/index/detail/rtree/pack_hilbert.hpp>
+#include <boost/geometry/index/detail/rtree/pack_insert.hpp>
+#include <boost/geometry/index/detail/rtree/optimize.hpp>
 
 #include <boost/geometry/index/inserter.hpp>
 
@@ -120,13 +132,19 @@ algorithm with specific parameters like min and max number of elements in node.
 Predefined algorithms with compile-time parameters are:
  \li <tt>boost::geometry::index::linear</tt>,
  \li <tt>boost::geometry::index::quadratic</tt>,
- \li <tt>boost::geometry::index::rstar</tt>.
+ \li <tt>boost::geometry::index::rstar</tt>,
+ \li <tt>boost::geometry::index::kmeans</tt>.
 
 \par
 Predefined algorithms with run-time parameters are:
  \li \c boost::geometry::index::dynamic_linear,
  \li \c boost::geometry::index::dynamic_quadratic,
- \li \c boost::geometry::index::dynamic_rstar.
+ \li \c boost::geometry::index::dynamic_rstar,
+ \li \c boost::geometry::index::dynamic_kmeans.
+
+\par
+The parameters may be wrapped with <tt>boost::geometry::index::counted</tt> in order
+to store the numbers of values of subtrees in the internal nodes.
 
 \par IndexableGetter
 The object of IndexableGetter type translates from Value to Indexable each time
@@ -270,6 +288,7 @@ private:
             , allocators_type(boost::forward<Alloc>(alloc))
             , values_count(0)
             , leafs_level(0)
+            , optimize_cursor(0)
             , root(0)
         {}
 
@@ -282,6 +301,7 @@ private:
             , allocators_type()
             , values_count(0)
             , leafs_level(0)
+            , optimize_cursor(0)
             , root(0)
         {}
 
@@ -298,6 +318,7 @@ private:
 
         size_type values_count;
         size_type leafs_level;
+        size_type optimize_cursor;
         node_pointer root;
     };
 
@@ -312,6 +333,8 @@ private:
     typedef typename members_holder::allocator_traits_type allocator_traits_type;
 
     friend class detail::rtree::utilities::view<rtree>;
+    template <typename V, typename P, typename I, typename E, typename A>
+    friend class rtree;
 #ifdef BOOST_GEOMETRY_INDEX_DETAIL_EXPERIMENTAL
     friend class detail::rtree::private_view<rtree>;
     friend class detail::rtree::const_private_view<rtree>;
@@ -344,6 +367,9 @@ public:
             value_type, allocators_type
         > const_query_iterator;
 
+    /*! \brief Type of the hint of insertion, remembering the path to the leaf of the last inserted value. */
+    typedef index::detail::rtree::insert_hint insert_hint;
+
 public:
 
     /*!
@@ -584,6 +610,128 @@ public:
         pack_construct(::boost::begin(rng), ::boost::end(rng), temp_allocator);
     }
 
+    /*!
+    \brief The constructor.
+
+    The tree is created using packing algorithm. Subtrees are created concurrently
+    using at most the number of threads defined by the execution policy.
+    The resulting tree is the same as the one created by the sequential constructor.
+
+    \param first        The beginning of the range of Values.
+    \param last         The end of the range of Values.
+    \param policy       The parallel execution policy.
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+    \param allocator    The allocator object. It has to be safe to use concurrently.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+    */
+    template<typename Iterator>
+    inline rtree(Iterator first, Iterator last,
+                 execution::parallel_policy const& policy,
+                 parameters_type const& parameters = parameters_type(),
+                 indexable_getter const& getter = indexable_getter(),
+                 value_equal const& equal = value_equal(),
+                 allocator_type const& allocator = allocator_type())
+        : m_members(getter, equal, parameters, allocator)
+    {
+        pack_construct(first, last, boost::container::new_allocator<void>(), policy.threads());
+    }
+
+    /*!
+    \brief The constructor.
+
+    The tree is created using packing algorithm. Subtrees are created concurrently
+    using at most the number of threads defined by the execution policy.
+    The resulting tree is the same as the one created by the sequential constructor.
+
+    \param rng          The range of Values.
+    \param policy       The parallel execution policy.
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+    \param allocator    The allocator object. It has to be safe to use concurrently.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+    */
+    template<typename Range>
+    inline rtree(Range const& rng,
+                 execution::parallel_policy const& policy,
+                 parameters_type const& parameters = parameters_type(),
+                 indexable_getter const& getter = indexable_getter(),
+                 value_equal const& equal = value_equal(),
+                 allocator_type const& allocator = allocator_type())
+        : m_members(getter, equal, parameters, allocator)
+    {
+        pack_construct(::boost::begin(rng), ::boost::end(rng), boost::container::new_allocator<void>(), policy.threads());
+    }
+
+    /*!
+    \brief The constructor.
+
+    The tree is created using Hilbert curve packing algorithm.
+
+    \param first        The beginning of the range of Values.
+    \param last         The end of the range of Values.
+    \param packing      The packing algorithm tag.
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+    \param allocator    The allocator object.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+    */
+    template<typename Iterator>
+    inline rtree(Iterator first, Iterator last,
+                 hilbert_packing const& packing,
+                 parameters_type const& parameters = parameters_type(),
+                 indexable_getter const& getter = indexable_getter(),
+                 value_equal const& equal = value_equal(),
+                 allocator_type const& allocator = allocator_type())
+        : m_members(getter, equal, parameters, allocator)
+    {
+        pack_construct(first, last, boost::container::new_allocator<void>(), packing);
+    }
+
+    /*!
+    \brief The constructor.
+
+    The tree is created using Hilbert curve packing algorithm.
+
+    \param rng          The range of Values.
+    \param packing      The packing algorithm tag.
+    \param parameters   The parameters object.
+    \param getter       The function object extracting Indexable from Value.
+    \param equal        The function object comparing Values.
+    \param allocator    The allocator object.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+    */
+    template<typename Range>
+    inline rtree(Range const& rng,
+                 hilbert_packing const& packing,
+                 parameters_type const& parameters = parameters_type(),
+                 indexable_getter const& getter = indexable_getter(),
+                 value_equal const& equal = value_equal(),
+                 allocator_type const& allocator = allocator_type())
+        : m_members(getter, equal, parameters, allocator)
+    {
+        pack_construct(::boost::begin(rng), ::boost::end(rng), boost::container::new_allocator<void>(), packing);
+    }
+
     /*!
     \brief The destructor.
 
@@ -656,6 +804,7 @@ public:
         boost::swap(m_members.values_count, src.m_members.values_count);
         boost::swap(m_members.leafs_level, src.m_members.leafs_level);
         boost::swap(m_members.root, src.m_members.root);
+        boost::swap(m_members.optimize_cursor, src.m_members.optimize_cursor);
     }
 
     /*!
@@ -682,6 +831,7 @@ public:
             boost::swap(m_members.values_count, src.m_members.values_count);
             boost::swap(m_members.leafs_level, src.m_members.leafs_level);
             boost::swap(m_members.root, src.m_members.root);
+            boost::swap(m_members.optimize_cursor, src.m_members.optimize_cursor);
         }
         else
         {
@@ -757,6 +907,7 @@ public:
                 boost::swap(m_members.values_count, src.m_members.values_count);
                 boost::swap(m_members.leafs_level, src.m_members.leafs_level);
                 boost::swap(m_members.root, src.m_members.root);
+                boost::swap(m_members.optimize_cursor, src.m_members.optimize_cursor);
 
                 // NOTE: if propagate is true for std allocators on darwin 4.2.1, glibc++
                 // (allocators stored as base classes of members_holder)
@@ -807,6 +958,7 @@ public:
         boost::swap(m_members.values_count, other.m_members.values_count);
         boost::swap(m_members.leafs_level, other.m_members.leafs_level);
         boost::swap(m_members.root, other.m_members.root);
+        boost::swap(m_members.optimize_cursor, other.m_members.optimize_cursor);
     }
 
     /*!
@@ -832,6 +984,48 @@ public:
         this->raw_insert(value);
     }
 
+    /*!
+    \brief Insert a value to the index using the hint.
+
+    The path from the root to the leaf in which the previous value was inserted is
+    stored in the hint. The children on this path are chosen without checking the
+    other children of the nodes as long as their boxes contain the inserted value.
+    For the linear and quadratic algorithms they are also chosen if their boxes
+    are enlarged only slightly. Therefore inserting a stream of values close to each
+    other, e.g. the consecutive positions of a moving object, is faster with these
+    algorithms. For the R*-tree the gain is negligible because the insertion time is
+    dominated by the reinsertions and splits. The hint may be used with any sequence of
+    insertions and removals, if the path is no longer valid the next node is chosen
+    the regular way. The same hint should not be used with different rtrees.
+
+    \par Example
+    \verbatim
+    Rtree::insert_hint hint;
+    for ( Value const& v : positions )
+        tree.insert(v, hint);
+    \endverbatim
+
+    \param value    The value which will be stored in the container.
+    \param hint     The hint updated by the insertion.
+
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    This operation only guarantees that there will be no memory leaks.
+    After an exception is thrown the R-tree may be left in an inconsistent state,
+    elements must not be inserted or removed. Other operations are allowed however
+    some of them may return invalid data.
+    */
+    inline void insert(value_type const& value, insert_hint & hint)
+    {
+        if ( !m_members.root )
+            this->raw_create();
+
+        this->raw_insert(value, boost::addressof(hint));
+    }
+
     /*!
     \brief Insert a range of values to the index.
 
@@ -888,6 +1082,71 @@ public:
         this->insert_dispatch(conv_or_rng, is_conv_t());
     }
 
+    /*!
+    \brief Insert a range of values to the index using packing algorithm.
+
+    The values are packed into subtrees which are then inserted into the index.
+    The subtrees overlapping the nodes of the index are split and their elements
+    are inserted at lower levels, down to the insertion of single values. For big
+    ranges of values placed apart from the values already stored this is faster
+    than inserting the values one by one. The resulting tree is not guaranteed
+    to have better structure than the tree created by inserting the values
+    one by one.
+
+    \param first    The beginning of the range of values.
+    \param last     The end of the range of values.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    This operation only guarantees that there will be no memory leaks.
+    After an exception is thrown the R-tree may be left in an inconsistent state,
+    elements must not be inserted or removed. Other operations are allowed however
+    some of them may return invalid data.
+    */
+    template <typename Iterator>
+    inline void bulk_insert(Iterator first, Iterator last)
+    {
+        this->raw_bulk_insert(first, last);
+    }
+
+    /*!
+    \brief Insert a range of values to the index using packing algorithm.
+
+    The values are packed into subtrees which are then inserted into the index.
+    The subtrees overlapping the nodes of the index are split and their elements
+    are inserted at lower levels, down to the insertion of single values. For big
+    ranges of values placed apart from the values already stored this is faster
+    than inserting the values one by one. The resulting tree is not guaranteed
+    to have better structure than the tree created by inserting the values
+    one by one.
+
+    \param rng      The range of values.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    This operation only guarantees that there will be no memory leaks.
+    After an exception is thrown the R-tree may be left in an inconsistent state,
+    elements must not be inserted or removed. Other operations are allowed however
+    some of them may return invalid data.
+    */
+    template <typename Range>
+    inline void bulk_insert(Range const& rng)
+    {
+        BOOST_GEOMETRY_STATIC_ASSERT((range::detail::is_range<Range>::value),
+            "The argument has to be a Range.",
+            Range);
+
+        this->raw_bulk_insert(::boost::begin(rng), ::boost::end(rng));
+    }
+
     /*!
     \brief Remove a value from the container.
 
@@ -988,6 +1247,121 @@ public:
         return this->remove_dispatch(conv_or_rng, is_conv_t());
     }
 
+    /*!
+    \brief Remove all values meeting passed predicates from the container.
+
+    All values are removed in one traversal of the tree. The elements of nodes
+    which underflow are reinserted at the end. This is faster than querying
+    the values and removing them one by one.
+
+    Spatial predicates and satisfies predicate, possibly connected with \c operator&&(),
+    may be passed. See query() for more information.
+
+    \par Example
+    \verbatim
+    // remove elements intersecting box
+    tree.remove_if(bgi::intersects(box));
+    // remove elements within box and meeting some condition
+    tree.remove_if(bgi::within(box) && bgi::satisfies(is_expired));
+    \endverbatim
+
+    \param predicates   Predicates.
+
+    \return             The number of removed values.
+
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+    \li If predicates copy throws.
+
+    \warning
+    This operation only guarantees that there will be no memory leaks.
+    After an exception is thrown the R-tree may be left in an inconsistent state,
+    elements must not be inserted or removed. Other operations are allowed however
+    some of them may return invalid data.
+    */
+    template <typename Predicates>
+    inline size_type remove_if(Predicates const& predicates)
+    {
+        BOOST_GEOMETRY_STATIC_ASSERT((detail::predicates_count_distance<Predicates>::value == 0),
+            "Distance predicates can't be passed.",
+            Predicates);
+
+        if ( !m_members.root )
+            return 0;
+
+        return this->raw_remove_if(predicates);
+    }
+
+    /*!
+    \brief Repacks the worst subtrees of the tree.
+
+    The quality of the tree may degrade after many insertions and removals.
+    The internal nodes are rated by the overlap of the boxes of their children
+    relative to the content of their own box. The subtrees with the greatest
+    overlap, storing at most max_values values in total, are replaced by subtrees
+    created from their values with the packing algorithm. Other nodes are not
+    modified. The maintenance may be amortized by calling this function
+    periodically with a small max_values.
+
+    Only a part of the tree is rated in one step. The subtrees storing together
+    about 4 * max_values values are rated, starting where the previous step stopped,
+    so the consecutive steps go through the whole tree. The root is never repacked,
+    use <tt>optimize()</tt> for that.
+
+    The values of a repacked subtree are copied into a temporary container
+    so the additional memory is proportional to the number of values of the
+    greatest repacked subtree, not the size of the whole tree.
+
+    \par Example
+    \verbatim
+    // repack at most 10000 values
+    tree.optimize_step(10000);
+    \endverbatim
+
+    \param max_values   The maximum number of values of the repacked subtrees.
+
+    \return             The number of repacked values, 0 if there is nothing to repack.
+
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    This operation invalidates iterators.
+    */
+    inline size_type optimize_step(size_type max_values)
+    {
+        return detail::rtree::optimize<members_holder>
+                    ::apply_step(m_members.root, m_members.leafs_level,
+                                 m_members.optimize_cursor, max_values,
+                                 m_members.parameters(), m_members.translator(),
+                                 m_members.allocators());                                   // MAY THROW
+    }
+
+    /*!
+    \brief Repacks the subtrees of the tree in which the boxes of nodes overlap.
+
+    All nodes of the tree are rated, including the root, and the worst subtrees
+    not nested in each other are repacked. The whole tree may be repacked.
+
+    \return             The number of repacked values.
+
+    \par Throws
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+
+    \warning
+    This operation invalidates iterators.
+    */
+    inline size_type optimize()
+    {
+        return detail::rtree::optimize<members_holder>
+                    ::apply(m_members.root, m_members.leafs_level, m_members.values_count,
+                            m_members.parameters(), m_members.translator(),
+                            m_members.allocators());                                        // MAY THROW
+    }
+
     /*!
     \brief Finds values meeting passed predicates e.g. nearest to some Point and/or intersecting some Box.
 
@@ -1085,36 +1459,326 @@ public:
     }
 
     /*!
-    \brief Returns a query iterator pointing at the begin of the query range.
-
-    This method returns an iterator which may be used to perform iterative queries.
-    For the information about predicates which may be passed to this method see query().
+    \brief Counts values meeting passed predicates.
 
-    \par Example
-    \verbatim    
-    for ( Rtree::const_query_iterator it = tree.qbegin(bgi::nearest(pt, 10000)) ;
-          it != tree.qend() ; ++it )
-    {
-        // do something with value
-        if ( has_enough_nearest_values() )
-            break;
-    }
+    The result is the same as the number of values returned by query() but the values
+    are not copied. If the bounds of a node are covered by the Box passed into
+    \c intersects() or \c covered_by() predicate then all values of the node are counted
+    without checking the predicates. If the parameters are \c counted<> the internal nodes
+    store the number of values in their subtrees so such nodes are not traversed, otherwise
+    their values are counted traversing their subtrees. For other predicates the nodes are
+    traversed as in query().
 
-    // C++11 (auto)
-    for ( auto it = tree.qbegin(bgi::nearest(pt, 3)) ; it != tree.qend() ; ++it )
-    {
-        // do something with value
-    }
+    Spatial predicates and satisfies predicate, possibly connected with \c operator&&(),
+    may be passed. See query() for more information.
 
-    // C++14 (generic lambda expression)
-    std::for_each(tree.qbegin(bgi::nearest(pt, 3)), tree.qend(), [](auto const& val){
-        // do something with value
-    });
+    \par Example
+    \verbatim
+    // count elements intersecting box
+    std::size_t n = tree.query_count(bgi::intersects(box));
     \endverbatim
 
-    \par Iterator category
-    ForwardIterator
-
+    \par Throws
+    If predicates copy throws.
+
+    \param predicates   Predicates.
+
+    \return             The number of values meeting the predicates.
+    */
+    template <typename Predicates>
+    size_type query_count(Predicates const& predicates) const
+    {
+        BOOST_GEOMETRY_STATIC_ASSERT((detail::predicates_count_distance<Predicates>::value == 0),
+            "Distance predicates can't be passed.",
+            Predicates);
+
+        if ( ! m_members.root )
+            return 0;
+
+        detail::rtree::visitors::spatial_count<members_holder, Predicates>
+            count_v(m_members, predicates);
+        return count_v.apply(m_members);
+    }
+
+    /*!
+    \brief Estimates the number of values meeting passed predicates.
+
+    Only the nodes at the top levels of the tree are traversed so the cost of the
+    estimation depends on the number of levels and not on the number of values.
+    The nodes at the last traversed level meeting the predicates are not visited.
+    Instead the number of values stored in the subtree of a node is scaled by
+    the fraction of the bounds of the node overlapped by the envelopes of the
+    geometries passed into the predicates, i.e. the values are assumed to be
+    distributed uniformly in the bounds of the node. If the bounds of a node are
+    covered by the Box passed into \c intersects() or \c covered_by() predicate
+    then all values of the node are counted. Values stored in the visited leafs
+    are counted exactly so the result is exact if the number of levels is not
+    lesser than depth() + 1. If the parameters are not \c counted<> the number
+    of values stored in the subtree of a node is estimated from the number of
+    children of the node and the average number of children of the nodes.
+
+    \c intersects(), \c within(), \c covered_by() and \c satisfies() predicates,
+    possibly connected with \c operator&&(), may be passed. Predicates connected
+    with \c operator&&() are treated as independent. The \c satisfies() predicate
+    doesn't affect the estimation of the number of values stored in nodes which are
+    not visited.
+
+    \par Example
+    \verbatim
+    // estimate the number of elements intersecting box
+    std::size_t n = tree.estimate_count(bgi::intersects(box), 2);
+    \endverbatim
+
+    \par Throws
+    If predicates copy throws.
+
+    \param predicates   Predicates.
+    \param levels       The number of levels of nodes whose children are tested, at least 1.
+
+    \return             The estimated number of values meeting the predicates.
+    */
+    template <typename Predicates>
+    size_type estimate_count(Predicates const& predicates, size_type levels = 2) const
+    {
+        BOOST_GEOMETRY_STATIC_ASSERT((detail::predicates_count_distance<Predicates>::value == 0),
+            "Distance predicates can't be passed.",
+            Predicates);
+
+        if ( ! m_members.root )
+            return 0;
+
+        detail::rtree::visitors::estimate_count<members_holder, Predicates>
+            estimate_v(m_members, predicates, levels);
+        return estimate_v.apply(m_members);
+    }
+
+    /*!
+    \brief Finds values meeting passed predicates for many queries at once.
+
+    The tree is traversed once for all of the queries. Each node is visited only if its
+    bounds meet the predicates of at least one of the queries and the predicates are
+    checked only for those queries. Found values are written to the output iterator
+    as <tt>std::pair<std::size_t, value_type></tt> where the first element is the index
+    of the query in the range of predicates. For each query the result is the same as
+    the result of query() but the values of different queries are interleaved.
+
+    Spatial predicates, satisfies predicate and one distance predicate, possibly connected
+    with \c operator&&(), may be passed. See query() for more information. If a distance
+    predicate is passed then the queries are performed one by one, reusing the internal
+    storage, in the order of the Hilbert curve passing through the points of the queries,
+    and the values are written query after query. The queries are performed in batches
+    of several thousand queries and the values found for a batch are stored until they
+    are written, in the order of the range of predicates within the batch. So the order
+    of the range is kept for up to 4096 queries and the additional memory doesn't depend
+    on the total number of queries.
+
+    \par Example
+    \verbatim
+    std::vector<decltype(bgi::intersects(box))> predicates;
+    for ( Box const& b : boxes )
+        predicates.push_back(bgi::intersects(b));
+    std::vector<std::pair<std::size_t, Value> > result;
+    tree.query_batch(predicates.begin(), predicates.end(), std::back_inserter(result));
+    \endverbatim
+
+    \par Throws
+    If Value copy constructor or copy assignment throws.
+    If predicates copy throws.
+    If memory allocation throws.
+
+    \param first        The beginning of the range of predicates.
+    \param last         The end of the range of predicates.
+    \param out_it       The output iterator, e.g. generated by std::back_inserter().
+
+    \return             The number of values found for all of the queries.
+    */
+    template <typename PredicatesIterator, typename OutIter>
+    size_type query_batch(PredicatesIterator first, PredicatesIterator last, OutIter out_it) const
+    {
+        return query_batch_dispatch(first, last, out_it, 1);
+    }
+
+    /*!
+    \brief Finds values meeting passed predicates for many queries at once, in parallel.
+
+    The same as query_batch() but subtrees of the tree, or in the case of distance
+    predicates the queries, are processed concurrently using at most the number
+    of threads defined by the execution policy. The values are written
+    to the output iterator in the current thread, in the same order as the one of the
+    sequential version.
+
+    \par Throws
+    If Value copy constructor or copy assignment throws.
+    If predicates copy throws.
+    If memory allocation throws.
+
+    \param first        The beginning of the range of predicates.
+    \param last         The end of the range of predicates.
+    \param out_it       The output iterator, e.g. generated by std::back_inserter().
+    \param policy       The parallel execution policy.
+
+    \return             The number of values found for all of the queries.
+    */
+    template <typename PredicatesIterator, typename OutIter>
+    size_type query_batch(PredicatesIterator first, PredicatesIterator last, OutIter out_it,
+                          execution::parallel_policy const& policy) const
+    {
+        return query_batch_dispatch(first, last, out_it, policy.threads());
+    }
+
+    /*!
+    \brief Finds pairs of values of this and other rtree with intersecting indexables.
+
+    Both trees are traversed simultaneously. A pair of nodes is visited only if their
+    bounding boxes intersect so the pairs of subtrees which can't contain intersecting
+    values are skipped. For each pair of values with intersecting indexables the binary
+    predicate is called and if it returns true the pair is written to the output iterator
+    as <tt>std::pair<value_type, typename Rtree::value_type></tt>.
+
+    \par Example
+    \verbatim
+    std::vector<std::pair<Parcel, Zone> > result;
+    parcels.join(zones,
+                 [](Parcel const& p, Zone const& z) { return bg::intersects(p.poly, z.poly); },
+                 std::back_inserter(result));
+    \endverbatim
+
+    \par Throws
+    If Value copy constructor or copy assignment throws.
+    If the predicate throws.
+    If memory allocation throws.
+
+    \param other        The other rtree.
+    \param pred         The binary predicate called for pairs of values.
+    \param out_it       The output iterator, e.g. generated by std::back_inserter().
+
+    \return             The number of pairs found.
+    */
+    template <typename Rtree, typename BinaryPredicate, typename OutIter>
+    size_type join(Rtree const& other, BinaryPredicate const& pred, OutIter out_it) const
+    {
+        return join_dispatch(other, pred, out_it, 1);
+    }
+
+    /*!
+    \brief Finds pairs of values of this and other rtree with intersecting indexables, in parallel.
+
+    The same as join() but the pairs of subtrees of the upper levels of the trees are
+    traversed concurrently using at most the number of threads defined by the execution
+    policy. The pairs are written to the output iterator in the current thread, in the
+    same order as the one of the sequential version.
+
+    \par Throws
+    If Value copy constructor or copy assignment throws.
+    If the predicate throws.
+    If memory allocation throws.
+
+    \param other        The other rtree.
+    \param pred         The binary predicate called for pairs of values.
+    \param out_it       The output iterator, e.g. generated by std::back_inserter().
+    \param policy       The parallel execution policy.
+
+    \return             The number of pairs found.
+    */
+    template <typename Rtree, typename BinaryPredicate, typename OutIter>
+    size_type join(Rtree const& other, BinaryPredicate const& pred, OutIter out_it,
+                   execution::parallel_policy const& policy) const
+    {
+        return join_dispatch(other, pred, out_it, policy.threads());
+    }
+
+    /*!
+    \brief Finds k nearest neighbors of all values stored in the rtree.
+
+    The result is the same as the one of nearest() queries performed for each value
+    but the values are processed leaf by leaf and the neighbors of all values of a leaf
+    are found during one traversal of the tree. The values of the leaf itself and then
+    of the neighboring nodes are checked first so the remaining nodes, further than
+    the neighbors already found, are skipped. The pairs of values and their neighbors
+    are written to the output iterator as <tt>std::pair<value_type, value_type></tt>,
+    for each value in the order of increasing distance. A value is not its own neighbor
+    but equal values stored in the rtree are.
+
+    \par Example
+    \verbatim
+    std::vector<std::pair<Point, Point> > knn_graph;
+    tree.all_nearest(5, std::back_inserter(knn_graph));
+    \endverbatim
+
+    \par Throws
+    If Value copy constructor or copy assignment throws.
+    If memory allocation throws.
+
+    \param k            The maximum number of neighbors of each value.
+    \param out_it       The output iterator, e.g. generated by std::back_inserter().
+
+    \return             The number of pairs found.
+    */
+    template <typename OutIter>
+    size_type all_nearest(size_type k, OutIter out_it) const
+    {
+        return all_nearest_dispatch(k, out_it, 1);
+    }
+
+    /*!
+    \brief Finds k nearest neighbors of all values stored in the rtree, in parallel.
+
+    The same as all_nearest() but the leafs are processed concurrently using
+    at most the number of threads defined by the execution policy. The pairs are
+    written to the output iterator in the current thread, in the same order
+    as the one of the sequential version. The leafs are processed in batches
+    and the pairs found for a batch are stored until they are written, so the
+    additional memory is proportional to the number of threads times k,
+    not to the number of values.
+
+    \par Throws
+    If Value copy constructor or copy assignment throws.
+    If memory allocation throws.
+
+    \param k            The maximum number of neighbors of each value.
+    \param out_it       The output iterator, e.g. generated by std::back_inserter().
+    \param policy       The parallel execution policy.
+
+    \return             The number of pairs found.
+    */
+    template <typename OutIter>
+    size_type all_nearest(size_type k, OutIter out_it,
+                          execution::parallel_policy const& policy) const
+    {
+        return all_nearest_dispatch(k, out_it, policy.threads());
+    }
+
+    /*!
+    \brief Returns a query iterator pointing at the begin of the query range.
+
+    This method returns an iterator which may be used to perform iterative queries.
+    For the information about predicates which may be passed to this method see query().
+
+    \par Example
+    \verbatim    
+    for ( Rtree::const_query_iterator it = tree.qbegin(bgi::nearest(pt, 10000)) ;
+          it != tree.qend() ; ++it )
+    {
+        // do something with value
+        if ( has_enough_nearest_values() )
+            break;
+    }
+
+    // C++11 (auto)
+    for ( auto it = tree.qbegin(bgi::nearest(pt, 3)) ; it != tree.qend() ; ++it )
+    {
+        // do something with value
+    }
+
+    // C++14 (generic lambda expression)
+    std::for_each(tree.qbegin(bgi::nearest(pt, 3)), tree.qend(), [](auto const& val){
+        // do something with value
+    });
+    \endverbatim
+
+    \par Iterator category
+    ForwardIterator
+
     \par Throws
     If predicates copy throws.
     If allocation throws.
@@ -1129,7 +1793,7 @@ public:
     template <typename Predicates>
     const_query_iterator qbegin(Predicates const& predicates) const
     {
-        return const_query_iterator(qbegin_(predicates));
+        return const_query_iterator(qbegin_(predicates), m_members.allocators());
     }
 
     /*!
@@ -1644,11 +2308,12 @@ private:
     \brief Insert a value to the index.
 
     \param value    The value which will be stored in the container.
+    \param hint     The hint of insertion or null.
 
     \par Exception-safety
     basic
     */
-    inline void raw_insert(value_type const& value)
+    inline void raw_insert(value_type const& value, insert_hint * hint = 0)
     {
         BOOST_GEOMETRY_INDEX_ASSERT(m_members.root, "The root must exist");
         // CONSIDER: alternative - ignore invalid indexable or throw an exception
@@ -1657,6 +2322,8 @@ private:
         detail::rtree::visitors::insert<value_type, members_holder>
             insert_v(m_members.root, m_members.leafs_level, value,
                      m_members.parameters(), m_members.translator(), m_members.allocators());
+        if ( hint )
+            insert_v.set_hint(hint);
 
         detail::rtree::apply_visitor(insert_v, *m_members.root);
 
@@ -1669,6 +2336,30 @@ private:
         ++m_members.values_count;
     }
 
+    /*!
+    \brief Insert a range of values to the index using packing algorithm.
+
+    \param first    The beginning of the range of values.
+    \param last     The end of the range of values.
+
+    \par Exception-safety
+    basic
+    */
+    template <typename Iterator>
+    inline void raw_bulk_insert(Iterator first, Iterator last)
+    {
+        if ( !m_members.root )
+        {
+            pack_construct(first, last, boost::container::new_allocator<void>());
+            return;
+        }
+
+        detail::rtree::pack_insert<members_holder>
+            ::apply(first, last, m_members.root, m_members.values_count, m_members.leafs_level,
+                    m_members.parameters(), m_members.translator(), m_members.allocators(),
+                    boost::container::new_allocator<void>());                                       // MAY THROW
+    }
+
     /*!
     \brief Remove the value from the container.
 
@@ -1702,6 +2393,45 @@ private:
         return 0;
     }
 
+    /*!
+    \brief Remove the values meeting predicates from the container.
+
+    \param predicates   The predicates.
+
+    \return             The number of removed values.
+
+    \par Exception-safety
+    basic
+    */
+    template <typename Predicates>
+    inline size_type raw_remove_if(Predicates const& predicates)
+    {
+        BOOST_GEOMETRY_INDEX_ASSERT(m_members.root, "The root must exist");
+
+        detail::rtree::visitors::remove_if<members_holder, Predicates>
+            remove_v(m_members.root, m_members.leafs_level, predicates,
+                     m_members.parameters(), m_members.translator(), m_members.allocators());
+
+        BOOST_TRY
+        {
+            detail::rtree::apply_visitor(remove_v, *m_members.root);                       // MAY THROW (V, E: alloc, copy, N: alloc)
+        }
+        BOOST_CATCH(...)
+        {
+            remove_v.destroy_removed_nodes();
+            BOOST_RETHROW                                                                   // RETHROW
+        }
+        BOOST_CATCH_END
+
+        // If exception is thrown, m_values_count may be invalid
+
+        BOOST_GEOMETRY_INDEX_ASSERT(remove_v.removed_count() <= m_members.values_count, "unexpected state");
+
+        m_members.values_count -= remove_v.removed_count();
+
+        return remove_v.removed_count();
+    }
+
     /*!
     \brief Create an empty R-tree i.e. new empty root node and clear other attributes.
 
@@ -1861,6 +2591,131 @@ private:
         return query.apply(m_members);
     }
 
+    /*!
+    \brief Return values meeting predicates for many queries.
+
+    \par Exception-safety
+    strong
+    */
+    template <typename PredicatesIterator, typename OutIter>
+    size_type query_batch_dispatch(PredicatesIterator first, PredicatesIterator last, OutIter out_it,
+                                   std::size_t threads) const
+    {
+        if ( ! m_members.root || first == last )
+            return 0;
+
+        return query_batch_dispatch(first, last, out_it, threads,
+                                    typename std::iterator_traits<PredicatesIterator>::iterator_category());
+    }
+
+    /*!
+    \brief Return values meeting predicates for many queries, the predicates are accessed in place.
+
+    \par Exception-safety
+    strong
+    */
+    template <typename PredicatesIterator, typename OutIter>
+    size_type query_batch_dispatch(PredicatesIterator first, PredicatesIterator last, OutIter out_it,
+                                   std::size_t threads, std::random_access_iterator_tag) const
+    {
+        boost::iterator_range<PredicatesIterator> const predicates(first, last);
+        return query_batch_dispatch(predicates, out_it, threads);
+    }
+
+    /*!
+    \brief Return values meeting predicates for many queries, the predicates are copied.
+
+    \par Exception-safety
+    strong
+    */
+    template <typename PredicatesIterator, typename OutIter>
+    size_type query_batch_dispatch(PredicatesIterator first, PredicatesIterator last, OutIter out_it,
+                                   std::size_t threads, std::input_iterator_tag) const
+    {
+        typedef typename std::iterator_traits<PredicatesIterator>::value_type predicates_type;
+        typedef std::vector<predicates_type> predicates_range;
+
+        predicates_range predicates(first, last);
+        return query_batch_dispatch(predicates, out_it, threads);
+    }
+
+    /*!
+    \brief Return values meeting spatial predicates for many queries.
+
+    \par Exception-safety
+    strong
+    */
+    template
+    <
+        typename PredicatesRange, typename OutIter,
+        std::enable_if_t<(detail::predicates_count_distance<typename PredicatesRange::value_type>::value == 0), int> = 0
+    >
+    size_type query_batch_dispatch(PredicatesRange const& predicates, OutIter out_it,
+                                   std::size_t threads) const
+    {
+        detail::rtree::visitors::batch_spatial_query<members_holder, PredicatesRange>
+            query(m_members, predicates);
+        return query.apply(out_it, threads);
+    }
+
+    /*!
+    \brief Perform nearest neighbour search for many queries.
+
+    \par Exception-safety
+    strong
+    */
+    template
+    <
+        typename PredicatesRange, typename OutIter,
+        std::enable_if_t<(detail::predicates_count_distance<typename PredicatesRange::value_type>::value > 0), int> = 0
+    >
+    size_type query_batch_dispatch(PredicatesRange const& predicates, OutIter out_it,
+                                   std::size_t threads) const
+    {
+        typedef typename PredicatesRange::value_type predicates_type;
+
+        BOOST_GEOMETRY_STATIC_ASSERT((detail::predicates_count_distance<predicates_type>::value == 1),
+                                     "Only one distance predicate can be passed.",
+                                     predicates_type);
+
+        detail::rtree::visitors::batch_distance_query<members_holder, PredicatesRange>
+            query(m_members, predicates);
+        return query.apply(out_it, threads);
+    }
+
+    /*!
+    \brief Find pairs of values of two trees with intersecting indexables.
+
+    \par Exception-safety
+    strong
+    */
+    template <typename Rtree, typename BinaryPredicate, typename OutIter>
+    size_type join_dispatch(Rtree const& other, BinaryPredicate const& pred, OutIter out_it,
+                            std::size_t threads) const
+    {
+        typedef typename Rtree::members_holder other_members_holder;
+
+        if ( ! m_members.root || ! other.m_members.root )
+            return 0;
+
+        detail::rtree::visitors::spatial_join<members_holder, other_members_holder, BinaryPredicate>
+            join_v(m_members, other.m_members, pred);
+        return join_v.apply(out_it, threads);
+    }
+
+    /*!
+    \brief Find k nearest neighbors of all values.
+
+    \par Exception-safety
+    strong
+    */
+    template <typename OutIter>
+    size_type all_nearest_dispatch(size_type k, OutIter out_it, std::size_t threads) const
+    {
+        detail::rtree::visitors::all_nearest<members_holder> all_nearest_v(m_members, k);
+        return all_nearest_v.apply(out_it, threads);
+    }
+
     /*!
     \brief Perform nearest neighbour search.
 
@@ -1914,6 +2769,7 @@ private:
     \param first             The beginning of the range of Values.
     \param last              The end of the range of Values.
     \param temp_allocator    The temporary allocator object to be used by the packing algorithm.
+    \param threads           The maximum number of threads used by the packing algorithm.
 
     \par Throws
     \li If allocator copy constructor throws.
@@ -1921,10 +2777,36 @@ private:
     \li If allocation throws or returns invalid value.
     */
     template<typename Iterator, typename PackAlloc>
-    inline void pack_construct(Iterator first, Iterator last, PackAlloc const& temp_allocator)
+    inline void pack_construct(Iterator first, Iterator last, PackAlloc const& temp_allocator,
+                               std::size_t threads = 1)
     {
         typedef detail::rtree::pack<members_holder> pack;
         size_type vc = 0, ll = 0;
+        m_members.root = pack::apply(first, last, vc, ll,
+                                     m_members.parameters(), m_members.translator(),
+                                     m_members.allocators(), temp_allocator, threads);
+        m_members.values_count = vc;
+        m_members.leafs_level = ll;
+    }
+
+    /*!
+    \brief Create the tree using Hilbert curve packing algorithm.
+
+    \param first             The beginning of the range of Values.
+    \param last              The end of the range of Values.
+    \param temp_allocator    The temporary allocator object to be used by the packing algorithm.
+
+    \par Throws
+    \li If allocator copy constructor throws.
+    \li If Value copy constructor or copy assignment throws.
+    \li If allocation throws or returns invalid value.
+    */
+    template<typename Iterator, typename PackAlloc>
+    inline void pack_construct(Iterator first, Iterator last, PackAlloc const& temp_allocator,
+                               hilbert_packing const&)
+    {
+        typedef detail::rtree::pack_hilbert<members_holder> pack;
+        size_type vc = 0, ll = 0;
         m_members.root = pack::apply(first, last, vc, ll,
                                      m_members.parameters(), m_members.translator(),
                                      m_members.allocators(), temp_allocator);
@@ -1952,6 +2834,25 @@ inline void insert(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>
     tree.insert(v);
 }
 
+/*!
+\brief Insert a value to the index using the hint.
+
+It calls <tt>rtree::insert(value_type const&, insert_hint &)</tt>.
+
+\ingroup rtree_functions
+
+\param tree The spatial index.
+\param v    The value which will be stored in the index.
+\param hint The hint updated by the insertion.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator>
+inline void insert(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> & tree,
+                   Value const& v,
+                   typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::insert_hint & hint)
+{
+    tree.insert(v, hint);
+}
+
 /*!
 \brief Insert a range of values to the index.
 
@@ -1989,6 +2890,43 @@ inline void insert(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>
     tree.insert(conv_or_rng);
 }
 
+/*!
+\brief Insert a range of values to the index using packing algorithm.
+
+It calls <tt>rtree::bulk_insert(Iterator, Iterator)</tt>.
+
+\ingroup rtree_functions
+
+\param tree     The spatial index.
+\param first    The beginning of the range of values.
+\param last     The end of the range of values.
+*/
+template<typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+         typename Iterator>
+inline void bulk_insert(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> & tree,
+                        Iterator first, Iterator last)
+{
+    tree.bulk_insert(first, last);
+}
+
+/*!
+\brief Insert a range of values to the index using packing algorithm.
+
+It calls <tt>rtree::bulk_insert(Range const&)</tt>.
+
+\ingroup rtree_functions
+
+\param tree     The spatial index.
+\param rng      The range of values.
+*/
+template<typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+         typename Range>
+inline void bulk_insert(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> & tree,
+                        Range const& rng)
+{
+    tree.bulk_insert(rng);
+}
+
 /*!
 \brief Remove a value from the container.
 
@@ -2065,6 +3003,27 @@ remove(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> & tree,
     return tree.remove(conv_or_rng);
 }
 
+/*!
+\brief Remove all values meeting passed predicates from the container.
+
+It calls \c rtree::remove_if(Predicates const&).
+
+\ingroup rtree_functions
+
+\param tree         The spatial index.
+\param predicates   Predicates.
+
+\return             The number of removed values.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename Predicates>
+inline typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+remove_if(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> & tree,
+          Predicates const& predicates)
+{
+    return tree.remove_if(predicates);
+}
+
 /*!
 \brief Finds values meeting passed predicates e.g. nearest to some Point and/or intersecting some Box.
 
@@ -2148,6 +3107,250 @@ query(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
     return tree.query(predicates, out_it);
 }
 
+/*!
+\brief Counts values meeting passed predicates.
+
+It calls \c rtree::query_count(Predicates const&).
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param predicates   Predicates.
+
+\return             The number of values meeting the predicates.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename Predicates> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+query_count(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+            Predicates const& predicates)
+{
+    return tree.query_count(predicates);
+}
+
+/*!
+\brief Estimates the number of values meeting passed predicates.
+
+It calls \c rtree::estimate_count(Predicates const&, size_type).
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param predicates   Predicates.
+\param levels       The number of levels of nodes whose children are tested, at least 1.
+
+\return             The estimated number of values meeting the predicates.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename Predicates> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+estimate_count(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+               Predicates const& predicates,
+               typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type levels = 2)
+{
+    return tree.estimate_count(predicates, levels);
+}
+
+/*!
+\brief Finds values meeting passed predicates for many queries at once.
+
+It calls \c rtree::query_batch(PredicatesIterator, PredicatesIterator, OutIter).
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param first        The beginning of the range of predicates.
+\param last         The end of the range of predicates.
+\param out_it       The output iterator, e.g. generated by std::back_inserter().
+
+\return             The number of values found for all of the queries.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename PredicatesIterator, typename OutIter> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+query_batch(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+            PredicatesIterator first, PredicatesIterator last,
+            OutIter out_it)
+{
+    return tree.query_batch(first, last, out_it);
+}
+
+/*!
+\brief Finds values meeting passed predicates for many queries at once, in parallel.
+
+It calls \c rtree::query_batch(PredicatesIterator, PredicatesIterator, OutIter, execution::parallel_policy const&).
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param first        The beginning of the range of predicates.
+\param last         The end of the range of predicates.
+\param out_it       The output iterator, e.g. generated by std::back_inserter().
+\param policy       The parallel execution policy.
+
+\return             The number of values found for all of the queries.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename PredicatesIterator, typename OutIter> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+query_batch(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+            PredicatesIterator first, PredicatesIterator last,
+            OutIter out_it,
+            execution::parallel_policy const& policy)
+{
+    return tree.query_batch(first, last, out_it, policy);
+}
+
+/*!
+\brief Finds pairs of values of two rtrees with intersecting indexables.
+
+It calls \c rtree::join(Rtree const&, BinaryPredicate const&, OutIter) with a predicate
+accepting all pairs.
+
+\ingroup rtree_functions
+
+\param tree1        The first rtree.
+\param tree2        The second rtree.
+\param out_it       The output iterator, e.g. generated by std::back_inserter().
+
+\return             The number of pairs found.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename Rtree, typename OutIter> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+join(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree1,
+     Rtree const& tree2,
+     OutIter out_it)
+{
+    return tree1.join(tree2, detail::rtree::visitors::spatial_join_all(), out_it);
+}
+
+/*!
+\brief Finds pairs of values of two rtrees with intersecting indexables meeting the predicate.
+
+It calls \c rtree::join(Rtree const&, BinaryPredicate const&, OutIter).
+
+\ingroup rtree_functions
+
+\param tree1        The first rtree.
+\param tree2        The second rtree.
+\param pred         The binary predicate called for pairs of values.
+\param out_it       The output iterator, e.g. generated by std::back_inserter().
+
+\return             The number of pairs found.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename Rtree, typename BinaryPredicate, typename OutIter> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+join(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree1,
+     Rtree const& tree2,
+     BinaryPredicate const& pred,
+     OutIter out_it)
+{
+    return tree1.join(tree2, pred, out_it);
+}
+
+/*!
+\brief Finds pairs of values of two rtrees with intersecting indexables, in parallel.
+
+It calls \c rtree::join(Rtree const&, BinaryPredicate const&, OutIter, execution::parallel_policy const&)
+with a predicate accepting all pairs.
+
+\ingroup rtree_functions
+
+\param tree1        The first rtree.
+\param tree2        The second rtree.
+\param out_it       The output iterator, e.g. generated by std::back_inserter().
+\param policy       The parallel execution policy.
+
+\return             The number of pairs found.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename Rtree, typename OutIter> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+join(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree1,
+     Rtree const& tree2,
+     OutIter out_it,
+     execution::parallel_policy const& policy)
+{
+    return tree1.join(tree2, detail::rtree::visitors::spatial_join_all(), out_it, policy);
+}
+
+/*!
+\brief Finds pairs of values of two rtrees with intersecting indexables meeting the predicate, in parallel.
+
+It calls \c rtree::join(Rtree const&, BinaryPredicate const&, OutIter, execution::parallel_policy const&).
+
+\ingroup rtree_functions
+
+\param tree1        The first rtree.
+\param tree2        The second rtree.
+\param pred         The binary predicate called for pairs of values.
+\param out_it       The output iterator, e.g. generated by std::back_inserter().
+\param policy       The parallel execution policy.
+
+\return             The number of pairs found.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename Rtree, typename BinaryPredicate, typename OutIter> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+join(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree1,
+     Rtree const& tree2,
+     BinaryPredicate const& pred,
+     OutIter out_it,
+     execution::parallel_policy const& policy)
+{
+    return tree1.join(tree2, pred, out_it, policy);
+}
+
+/*!
+\brief Finds k nearest neighbors of all values stored in the rtree.
+
+It calls \c rtree::all_nearest(size_type, OutIter).
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param k            The maximum number of neighbors of each value.
+\param out_it       The output iterator, e.g. generated by std::back_inserter().
+
+\return             The number of pairs found.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename OutIter> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+all_nearest(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+            typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type k,
+            OutIter out_it)
+{
+    return tree.all_nearest(k, out_it);
+}
+
+/*!
+\brief Finds k nearest neighbors of all values stored in the rtree, in parallel.
+
+It calls \c rtree::all_nearest(size_type, OutIter, execution::parallel_policy const&).
+
+\ingroup rtree_functions
+
+\param tree         The rtree.
+\param k            The maximum number of neighbors of each value.
+\param out_it       The output iterator, e.g. generated by std::back_inserter().
+\param policy       The parallel execution policy.
+
+\return             The number of pairs found.
+*/
+template <typename Value, typename Parameters, typename IndexableGetter, typename EqualTo, typename Allocator,
+          typename OutIter> inline
+typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type
+all_nearest(rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator> const& tree,
+            typename rtree<Value, Parameters, IndexableGetter, EqualTo, Allocator>::size_type k,
+            OutIter out_it,
+            execution::parallel_policy const& policy)
+{
+    return tree.all_nearest(k, out_it, policy);
+}
+
 /*!
 \brief Returns the query iterator pointing at the begin of the query range.
 
@@ -16,10 +16,37 @@
 #include <boost/foreach.hpp>
 #include <boost/random.hpp>
 
+namespace bg = boost::geometry;
+namespace bgi = bg::index;
+
+template <typename RT>
+void query_boxes(RT const& t, std::vector< std::pair<float, float> > const& coords,
+                 size_t queries_count, const char * name)
+{
+    typedef boost::chrono::thread_clock clock_t;
+    typedef boost::chrono::duration<float> dur_t;
+    typedef typename RT::value_type B;
+    typedef typename bg::point_type<B>::type P;
+
+    std::vector<B> result;
+    result.reserve(100);
+
+    clock_t::time_point start = clock_t::now();
+    size_t temp = 0;
+    for (size_t i = 0 ; i < queries_count ; ++i )
+    {
+        float x = coords[i].first;
+        float y = coords[i].second;
+        result.clear();
+        t.query(bgi::intersects(B(P(x - 10, y - 10), P(x + 10, y + 10))), std::back_inserter(result));
+        temp += result.size();
+    }
+    dur_t time = clock_t::now() - start;
+    std::cout << time << " - query(B) " << name << " " << queries_count << " found " << temp << '\n';
+}
+
 int main()
 {
-    namespace bg = boost::geometry;
-    namespace bgi = bg::index;
     typedef boost::chrono::thread_clock clock_t;
     typedef boost::chrono::duration<float> dur_t;
 
@@ -56,8 +83,36 @@ int main()
 
     std::cout << "sizeof rtree: " << sizeof(RT) << std::endl;
 
+    std::vector<B> values;
+    values.reserve(values_count);
+    for ( size_t i = 0 ; i < values_count ; ++i )
+    {
+        float x = coords[i].first;
+        float y = coords[i].second;
+        values.push_back(B(P(x - 0.5f, y - 0.5f), P(x + 0.5f, y + 0.5f)));
+    }
+
     for (;;)
     {
+        // packing tests
+        {
+            clock_t::time_point start = clock_t::now();
+            RT t(values);
+            dur_t time = clock_t::now() - start;
+            std::cout << time << " - pack " << values_count << '\n';
+
+            query_boxes(t, coords, queries_count, "pack");
+        }
+
+        {
+            clock_t::time_point start = clock_t::now();
+            RT t(values, bgi::hilbert_packing());
+            dur_t time = clock_t::now() - start;
+            std::cout << time << " - pack hilbert " << values_count << '\n';
+
+            query_boxes(t, coords, queries_count, "pack hilbert");
+        }
+
         RT t;
 
         // inserting test
@@ -0,0 +1,115 @@
+// Boost.Geometry Index
+// Additional tests
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+// Compares the creation and destruction of rtrees using the default allocator
+// and the node_pool_allocator.
+
+#include <iostream>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/random.hpp>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/node_pool_allocator.hpp>
+
+namespace bg = boost::geometry;
+namespace bgi = bg::index;
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> P;
+typedef bg::model::box<P> B;
+
+template <typename RT>
+void test_rtree(std::vector<B> const& values, const char * name)
+{
+    typedef boost::chrono::thread_clock clock_t;
+    typedef boost::chrono::duration<float> dur_t;
+
+    float insert_time = 0, insert_destroy_time = 0;
+    float pack_time = 0, pack_destroy_time = 0;
+    float reinsert_time = 0;
+
+    {
+        clock_t::time_point start = clock_t::now();
+        RT * t = new RT();
+        for ( size_t i = 0 ; i < values.size() ; ++i )
+            t->insert(values[i]);
+        insert_time = dur_t(clock_t::now() - start).count();
+
+        // the nodes are destroyed and the memory is reused
+        start = clock_t::now();
+        t->clear();
+        for ( size_t i = 0 ; i < values.size() ; ++i )
+            t->insert(values[i]);
+        reinsert_time = dur_t(clock_t::now() - start).count();
+
+        start = clock_t::now();
+        delete t;
+        insert_destroy_time = dur_t(clock_t::now() - start).count();
+    }
+
+    {
+        clock_t::time_point start = clock_t::now();
+        RT * t = new RT(values);
+        pack_time = dur_t(clock_t::now() - start).count();
+
+        start = clock_t::now();
+        delete t;
+        pack_destroy_time = dur_t(clock_t::now() - start).count();
+    }
+
+    std::cout << name
+              << " insert: " << insert_time
+              << " clear+insert: " << reinsert_time
+              << " destroy: " << insert_destroy_time
+              << " pack: " << pack_time
+              << " destroy: " << pack_destroy_time << '\n';
+}
+
+template <typename Params>
+void test_params(std::vector<B> const& values, const char * name)
+{
+    typedef bgi::rtree<B, Params> rtree_t;
+    typedef bgi::rtree<B, Params, bgi::indexable<B>, bgi::equal_to<B>, bgi::node_pool_allocator<B> > pool_rtree_t;
+
+    std::cout << name << '\n';
+    test_rtree<rtree_t>(values, "  default  ");
+    // the default constructed allocator creates a new pool for each tree
+    test_rtree<pool_rtree_t>(values, "  node pool");
+}
+
+int main()
+{
+    size_t values_count = 1000000;
+
+    std::vector<B> values;
+
+    //randomize values
+    {
+        boost::mt19937 rng;
+        float max_val = static_cast<float>(values_count / 2);
+        boost::uniform_real<float> range(-max_val, max_val);
+        boost::variate_generator<boost::mt19937&, boost::uniform_real<float> > rnd(rng, range);
+
+        values.reserve(values_count);
+
+        std::cout << "randomizing data\n";
+        for ( size_t i = 0 ; i < values_count ; ++i )
+        {
+            float x = rnd();
+            float y = rnd();
+            values.push_back(B(P(x - 0.5f, y - 0.5f), P(x + 0.5f, y + 0.5f)));
+        }
+        std::cout << "randomized\n";
+    }
+
+    test_params<bgi::linear<16, 4> >(values, "linear<16, 4>");
+    test_params<bgi::rstar<16, 4> >(values, "rstar<16, 4>");
+
+    return 0;
+}
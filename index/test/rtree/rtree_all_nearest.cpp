@@ -0,0 +1,154 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <vector>
+
+#include <boost/geometry/index/rtree.hpp>
+
+template <typename Point>
+inline void fill(Point & pt, double x, double y)
+{
+    bg::set<0>(pt, x);
+    bg::set<1>(pt, y);
+}
+
+template <typename Point>
+inline void fill(bg::model::box<Point> & box, double x, double y)
+{
+    bg::set<0, 0>(box, x);
+    bg::set<0, 1>(box, y);
+    bg::set<1, 0>(box, x + 0.3);
+    bg::set<1, 1>(box, y + 0.2);
+}
+
+template <typename Rtree>
+void check_all_nearest(Rtree const& rt, std::vector<typename Rtree::value_type> const& values,
+                       std::size_t k)
+{
+    typedef typename Rtree::value_type value_t;
+    typedef std::pair<value_t, value_t> pair_t;
+
+    std::vector<pair_t> result;
+    std::size_t const count = rt.all_nearest(k, std::back_inserter(result));
+    BOOST_CHECK_EQUAL(count, result.size());
+
+    std::size_t const expected_k = values.empty() ? 0 : (std::min)(k, values.size() - 1);
+    BOOST_CHECK_EQUAL(result.size(), values.size() * expected_k);
+
+    // the neighbors of each value are written one after another
+    std::size_t checked = 0;
+    for ( std::size_t first = 0 ; first < result.size() ; first += expected_k, ++checked )
+    {
+        value_t const& v = result[first].first;
+
+        std::vector<double> expected;
+        std::size_t found_self = 0;
+        for ( value_t const& u : values )
+        {
+            if ( bg::equals(u, v) && found_self == 0 )
+                ++found_self;
+            else
+                expected.push_back(bg::comparable_distance(v, u));
+        }
+        BOOST_CHECK_EQUAL(found_self, 1u);
+        std::sort(expected.begin(), expected.end());
+        expected.resize(expected_k);
+
+        std::vector<double> dists;
+        for ( std::size_t i = first ; i < first + expected_k ; ++i )
+        {
+            BOOST_CHECK(bg::equals(result[i].first, v));
+            dists.push_back(bg::comparable_distance(v, result[i].second));
+        }
+        BOOST_CHECK(std::is_sorted(dists.begin(), dists.end()));
+        BOOST_CHECK(dists == expected);
+    }
+    BOOST_CHECK(expected_k == 0 || checked == values.size());
+
+    // the same result in parallel
+    std::vector<pair_t> par_result;
+    BOOST_CHECK_EQUAL(bgi::all_nearest(rt, k, std::back_inserter(par_result),
+                                       bgi::execution::parallel_policy(4)),
+                      result.size());
+    BOOST_CHECK_EQUAL(par_result.size(), result.size());
+    for ( std::size_t i = 0 ; i < result.size() && i < par_result.size() ; ++i )
+    {
+        BOOST_CHECK(bg::equals(result[i].first, par_result[i].first)
+                 && bg::equals(result[i].second, par_result[i].second));
+    }
+}
+
+template <typename Value, typename Params>
+void test_rtree(Params const& params, std::size_t values_count)
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+
+    std::vector<Value> values;
+    for ( std::size_t i = 0 ; i < values_count ; ++i )
+    {
+        Value v;
+        fill(v, -30.0 + double((i * 7919) % 601) / 10.0, -30.0 + double((i * 104729) % 599) / 10.0);
+        values.push_back(v);
+    }
+
+    rtree_t rt(values, params);
+    check_all_nearest(rt, values, 0);
+    check_all_nearest(rt, values, 1);
+    check_all_nearest(rt, values, 5);
+    check_all_nearest(rt, values, values_count + 3);
+
+    // the tree created by insertions
+    rtree_t rt2(params);
+    for ( Value const& v : values )
+        rt2.insert(v);
+    check_all_nearest(rt2, values, 7);
+}
+
+// more leafs than processed at once by the parallel version
+template <typename Point, typename Params>
+void test_many_leafs(Params const& params, std::size_t values_count)
+{
+    std::vector<Point> values;
+    for ( std::size_t i = 0 ; i < values_count ; ++i )
+    {
+        Point v;
+        fill(v, double((i * 7919) % 6007) / 10.0, double((i * 104729) % 5987) / 10.0);
+        values.push_back(v);
+    }
+
+    bgi::rtree<Point, Params> rt(values, params);
+    check_all_nearest(rt, values, 3);
+}
+
+template <typename Point, typename Params>
+void test_rtrees(Params const& params)
+{
+    test_rtree<Point>(params, 0);
+    test_rtree<Point>(params, 1);
+    test_rtree<Point>(params, 5);
+    test_rtree<Point>(params, 500);
+    test_rtree<bg::model::box<Point> >(params, 300);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> cpt;
+    typedef bg::model::point<double, 2, bg::cs::spherical_equatorial<bg::degree> > spt;
+
+    test_rtrees<cpt>(bgi::linear<4, 2>());
+    test_rtrees<cpt>(bgi::rstar<16, 4>());
+    test_rtrees<spt>(bgi::quadratic<8, 3>());
+
+    test_many_leafs<cpt>(bgi::linear<4, 2>(), 6000);
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <algorithm>
+#include <vector>
+
+
+template <typename Value, typename Params>
+void test_rtree(std::vector<Value> const& values, std::size_t first_count,
+                Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+
+    typename std::vector<Value>::const_iterator
+        middle = values.begin() + (std::min)(first_count, values.size());
+    std::vector<Value> second(middle, values.end());
+
+    // insert into a tree created by insert
+    {
+        rtree_t rt(params);
+        rt.insert(values.begin(), middle);
+        rt.bulk_insert(middle, values.end());
+        basictest::check_rtree(rt, values);
+    }
+
+    // insert into a packed tree
+    {
+        rtree_t rt(values.begin(), middle, params);
+        bgi::bulk_insert(rt, second);
+        basictest::check_rtree(rt, values);
+
+        // the tree can be modified afterwards
+        rt.remove(second.begin(), second.end());
+        rt.insert(second.begin(), second.end());
+        basictest::check_rtree(rt, values);
+    }
+
+    // insert many times
+    {
+        rtree_t rt(params);
+        for ( typename std::vector<Value>::const_iterator it = values.begin() ; it != values.end() ; )
+        {
+            typename std::vector<Value>::const_iterator
+                last = it + (std::min)(first_count + 1, std::size_t(values.end() - it));
+            bgi::bulk_insert(rt, it, last);
+            it = last;
+        }
+        basictest::check_rtree(rt, values);
+    }
+}
+
+template <typename Value>
+void test_rtree_params(std::vector<Value> const& values, std::size_t first_count)
+{
+    test_rtree<Value, bgi::linear<5, 2> >(values, first_count);
+    test_rtree<Value, bgi::quadratic<16, 4> >(values, first_count);
+    test_rtree<Value, bgi::rstar<4, 2> >(values, first_count);
+    test_rtree<Value>(values, first_count, bgi::dynamic_rstar(8, 4));
+}
+
+template <typename Point>
+void test_points(std::size_t vcount, std::size_t first_count)
+{
+    std::vector<Point> values;
+    for ( std::size_t i = 0 ; i < vcount ; ++i )
+    {
+        values.push_back(Point(double((i * 7919) % 101) / 2, double((i * 104729) % 97) / 2));
+    }
+    test_rtree_params(values, first_count);
+}
+
+void test_boxes(std::size_t vcount, std::size_t first_count)
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+
+    std::vector<box_t> values;
+    for ( std::size_t i = 0 ; i < vcount ; ++i )
+    {
+        double x = double((i * 7919) % 101) / 2, y = double((i * 104729) % 97) / 2;
+        values.push_back(box_t(point_t(x, y), point_t(x + double(i % 5), y + double(i % 3))));
+    }
+    test_rtree_params(values, first_count);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_c;
+    typedef bg::model::point<double, 2, bg::cs::geographic<bg::degree> > point_g;
+
+    test_points<point_c>(0, 0);
+    test_points<point_c>(5, 0);
+    test_points<point_c>(5, 3);
+    test_points<point_c>(177, 3);
+    test_points<point_c>(177, 170);
+    test_points<point_c>(5000, 100);
+    test_points<point_c>(5000, 2500);
+    test_points<point_c>(5000, 4990);
+    test_points<point_g>(1000, 300);
+    test_boxes(1000, 700);
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/index/concurrent_rtree.hpp>
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+typedef std::pair<point_t, int> value_t;
+
+inline value_t make_value(int i)
+{
+    return value_t(point_t(double((i * 7919) % 1009), double((i * 104729) % 997)), i);
+}
+
+// Generates values with consecutive ids, each position may be read only once.
+class single_pass_iterator
+{
+public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef value_t value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef value_t const* pointer;
+    typedef value_t reference;
+
+    single_pass_iterator(int * next, int last) : m_next(next), m_last(last) {}
+
+    reference operator*() const { return make_value(*m_next); }
+    single_pass_iterator & operator++() { ++*m_next; return *this; }
+    bool operator==(single_pass_iterator const& other) const
+    {
+        return is_end() == other.is_end();
+    }
+    bool operator!=(single_pass_iterator const& other) const { return !(*this == other); }
+
+private:
+    bool is_end() const { return ! m_next || *m_next == m_last; }
+
+    int * m_next;
+    int m_last;
+};
+
+// Values are inserted and removed in the order of ids so each version of the data
+// contains a contiguous range of ids.
+template <typename Rtree>
+bool is_consistent(typename Rtree::snapshot const& s)
+{
+    std::vector<value_t> found;
+    s->query(bgi::intersects(box_t(point_t(-1, -1), point_t(2000, 2000))), std::back_inserter(found));
+    if ( found.size() != s->size() )
+        return false;
+    if ( found.empty() )
+        return true;
+
+    std::vector<int> ids;
+    for ( value_t const& v : found )
+        ids.push_back(v.second);
+    std::sort(ids.begin(), ids.end());
+    return ids.back() - ids.front() + 1 == int(ids.size());
+}
+
+template <typename Params>
+void test_concurrent(Params const& params)
+{
+    typedef bgi::concurrent_rtree<value_t, Params> rtree_t;
+
+    int const count = 1000;
+    std::vector<value_t> initial;
+    for ( int i = 0 ; i < 100 ; ++i )
+        initial.push_back(make_value(i));
+    rtree_t rt(initial, params);
+    BOOST_CHECK_EQUAL(rt.size(), 100u);
+
+    std::atomic<bool> done(false);
+    std::atomic<int> errors(0);
+    std::vector<std::thread> readers;
+    for ( int r = 0 ; r < 3 ; ++r )
+    {
+        readers.push_back(std::thread([&]()
+        {
+            while ( ! done )
+            {
+                {
+                    auto s = rt.read();
+                    if ( ! is_consistent<rtree_t>(s) )
+                        ++errors;
+                }
+                std::this_thread::yield();
+            }
+        }));
+    }
+
+    for ( int i = 100 ; i < count ; ++i )
+        rt.insert(make_value(i));
+    for ( int i = 0 ; i < count / 2 ; ++i )
+        BOOST_CHECK_EQUAL(rt.remove(make_value(i)), 1u);
+
+    done = true;
+    for ( std::thread & t : readers )
+        t.join();
+
+    BOOST_CHECK_EQUAL(errors.load(), 0);
+    BOOST_CHECK_EQUAL(rt.size(), std::size_t(count - count / 2));
+    BOOST_CHECK(is_consistent<rtree_t>(rt.read()));
+
+    // both instances are modified
+    std::vector<value_t> found1, found2;
+    rt.insert(make_value(count));
+    rt.query(bgi::nearest(point_t(0, 0), 10), std::back_inserter(found1));
+    rt.remove(make_value(count));
+    rt.insert(make_value(count));
+    rt.query(bgi::nearest(point_t(0, 0), 10), std::back_inserter(found2));
+    BOOST_CHECK(std::is_permutation(found1.begin(), found1.end(), found2.begin(), found2.end(),
+                                    [](value_t const& l, value_t const& r) { return l.second == r.second; }));
+
+    // the modification is not published if it throws
+    std::size_t const size = rt.size();
+    BOOST_CHECK_THROW(rt.modify([](typename rtree_t::rtree_type & t)
+                                {
+                                    t.insert(make_value(count + 1));
+                                    throw std::runtime_error("modify");
+                                }),
+                      std::runtime_error);
+    BOOST_CHECK_EQUAL(rt.size(), size);
+    rt.insert(make_value(count + 2));
+    BOOST_CHECK_EQUAL(rt.size(), size + 1);
+    rt.insert(make_value(count + 3));
+    BOOST_CHECK_EQUAL(rt.size(), size + 2);
+
+    // single pass ranges are applied to both instances
+    {
+        int next = count + 10;
+        rt.insert(single_pass_iterator(&next, count + 20), single_pass_iterator(0, 0));
+        BOOST_CHECK_EQUAL(rt.size(), size + 12);
+        rt.insert(make_value(count + 30));
+        BOOST_CHECK_EQUAL(rt.size(), size + 13);
+
+        next = count + 10;
+        BOOST_CHECK_EQUAL(rt.remove(single_pass_iterator(&next, count + 20),
+                                    single_pass_iterator(0, 0)), 10u);
+        BOOST_CHECK_EQUAL(rt.size(), size + 3);
+        rt.remove(make_value(count + 30));
+        BOOST_CHECK_EQUAL(rt.size(), size + 2);
+    }
+
+    rt.clear();
+    BOOST_CHECK(rt.empty());
+}
+
+int test_main(int, char* [])
+{
+    test_concurrent(bgi::linear<4, 2>());
+    test_concurrent(bgi::rstar<8, 3>());
+    test_concurrent(bgi::dynamic_quadratic(8, 3));
+
+    return 0;
+}
@@ -0,0 +1,197 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_GEOMETRY_INDEX_ENABLE_QUERY_STATISTICS
+
+#include <geometry_index_test_common.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/query_statistics.hpp>
+
+namespace bgiu = bgi::detail::rtree::utilities;
+
+template <typename Point>
+inline void fill(Point & pt, double x, double y)
+{
+    bg::set<0>(pt, x);
+    bg::set<1>(pt, y);
+}
+
+template <typename Point>
+inline void fill(bg::model::box<Point> & box, double x, double y)
+{
+    bg::set<0, 0>(box, x);
+    bg::set<0, 1>(box, y);
+    bg::set<1, 0>(box, x + 0.5);
+    bg::set<1, 1>(box, y + 0.25);
+}
+
+template <typename Value>
+struct value_less
+{
+    bool operator()(Value const& v1, Value const& v2) const
+    {
+        return std::lexicographical_compare(reinterpret_cast<double const*>(&v1),
+                                            reinterpret_cast<double const*>(&v1) + sizeof(Value) / sizeof(double),
+                                            reinterpret_cast<double const*>(&v2),
+                                            reinterpret_cast<double const*>(&v2) + sizeof(Value) / sizeof(double));
+    }
+};
+
+template <typename Value>
+void check_same(std::vector<Value> result, std::vector<Value> expected)
+{
+    std::sort(result.begin(), result.end(), value_less<Value>());
+    std::sort(expected.begin(), expected.end(), value_less<Value>());
+    BOOST_CHECK_EQUAL(result.size(), expected.size());
+    BOOST_CHECK(std::equal(result.begin(), result.end(), expected.begin(), bgi::equal_to<Value>()));
+}
+
+template <typename Value, typename Params>
+void test_rtree(Params const& params, double max_distance)
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef typename bg::point_type<Value>::type point_t;
+
+    std::vector<Value> values;
+    for ( std::size_t i = 0 ; i < 3000 ; ++i )
+    {
+        Value v;
+        fill(v, -30.0 + double((i * 7919) % 601) / 10.0, -30.0 + double((i * 104729) % 599) / 10.0);
+        values.push_back(v);
+    }
+    rtree_t rt(values, params);
+
+    point_t pts[3];
+    fill(pts[0], 0.05, 0.05);
+    fill(pts[1], 12.34, -7.89);
+    fill(pts[2], 100.0, 50.0);
+
+    for ( point_t const& pt : pts )
+    {
+        // brute force
+        std::vector<Value> within;
+        for ( Value const& v : values )
+        {
+            if ( bg::distance(pt, v) <= max_distance )
+            {
+                within.push_back(v);
+            }
+        }
+
+        // within_distance()
+        {
+            std::vector<Value> result;
+            rt.query(bgi::within_distance(pt, max_distance), std::back_inserter(result));
+            check_same(result, within);
+            BOOST_CHECK_EQUAL(rt.query_count(bgi::within_distance(pt, max_distance)), within.size());
+
+            result.assign(rt.qbegin(bgi::within_distance(pt, max_distance)), rt.qend());
+            check_same(result, within);
+
+            rtree_t removed = rt;
+            BOOST_CHECK_EQUAL(removed.remove_if(bgi::within_distance(pt, max_distance)), within.size());
+            BOOST_CHECK_EQUAL(removed.size(), values.size() - within.size());
+            BOOST_CHECK_EQUAL(removed.query_count(bgi::within_distance(pt, max_distance)), 0u);
+        }
+
+        // nearest() with more values than within the maximum distance
+        {
+            std::vector<Value> result;
+            rt.query(bgi::nearest(pt, within.size() + 10, max_distance), std::back_inserter(result));
+            check_same(result, within);
+
+            result.assign(rt.qbegin(bgi::nearest(pt, within.size() + 10, max_distance)), rt.qend());
+            check_same(result, within);
+        }
+
+        // nearest() with less values than within the maximum distance
+        {
+            std::size_t const k = within.size() / 2;
+            std::vector<Value> result, expected;
+            rt.query(bgi::nearest(pt, k, max_distance), std::back_inserter(result));
+            rt.query(bgi::nearest(pt, k), std::back_inserter(expected));
+            // the values at the same distance may be different
+            BOOST_CHECK_EQUAL(result.size(), expected.size());
+            std::vector<double> result_dists, expected_dists;
+            for ( std::size_t i = 0 ; i < result.size() && i < expected.size() ; ++i )
+            {
+                result_dists.push_back(bg::distance(pt, result[i]));
+                expected_dists.push_back(bg::distance(pt, expected[i]));
+            }
+            std::sort(result_dists.begin(), result_dists.end());
+            std::sort(expected_dists.begin(), expected_dists.end());
+            BOOST_CHECK(result_dists == expected_dists);
+        }
+
+        // combined with other predicates
+        {
+            std::vector<Value> result, expected;
+            rt.query(bgi::nearest(pt, 1000, max_distance) && bgi::satisfies([](Value const& v) {
+                         return bg::get<0>(bg::return_centroid<point_t>(v)) > 0; }),
+                     std::back_inserter(result));
+            rt.query(bgi::within_distance(pt, max_distance) && bgi::satisfies([](Value const& v) {
+                         return bg::get<0>(bg::return_centroid<point_t>(v)) > 0; }),
+                     std::back_inserter(expected));
+            check_same(result, expected);
+
+            result.clear();
+            rt.query(bgi::nearest(pt, 1000) && bgi::within_distance(pt, max_distance),
+                     std::back_inserter(result));
+            check_same(result, within);
+        }
+
+        // the branches further than the maximum distance are not traversed
+        {
+            bgiu::query_statistics bounded, unbounded;
+            std::vector<Value> result;
+            {
+                bgiu::scoped_query_statistics guard(bounded);
+                rt.query(bgi::nearest(pt, 1000, max_distance), std::back_inserter(result));
+            }
+            {
+                bgiu::scoped_query_statistics guard(unbounded);
+                rt.query(bgi::nearest(pt, 1000), std::back_inserter(result));
+            }
+            BOOST_CHECK(bounded.leafs < unbounded.leafs);
+        }
+    }
+
+    // empty tree
+    {
+        rtree_t empty(params);
+        std::vector<Value> result;
+        empty.query(bgi::nearest(pts[0], 5, max_distance), std::back_inserter(result));
+        empty.query(bgi::within_distance(pts[0], max_distance), std::back_inserter(result));
+        BOOST_CHECK(result.empty());
+    }
+}
+
+template <typename Point, typename Params>
+void test_rtrees(Params const& params, double max_distance)
+{
+    test_rtree<Point>(params, max_distance);
+    test_rtree<bg::model::box<Point> >(params, max_distance);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> cpt;
+    typedef bg::model::point<double, 2, bg::cs::spherical_equatorial<bg::degree> > spt;
+    typedef bg::model::point<double, 2, bg::cs::geographic<bg::degree> > gpt;
+
+    test_rtrees<cpt>(bgi::rstar<16, 4>(), 7.5);
+    test_rtrees<cpt>(bgi::linear<8, 2>(), 2.0);
+    test_rtrees<spt>(bgi::quadratic<16, 4>(), 0.1);
+    test_rtrees<gpt>(bgi::rstar<16, 4>(), 500000.0);
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/geometries/polygon.hpp>
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+typedef bg::model::polygon<point_t> polygon_t;
+
+struct is_even_x
+{
+    bool operator()(point_t const& p) const
+    {
+        return int(bg::get<0>(p)) % 2 == 0;
+    }
+
+    bool operator()(box_t const& b) const
+    {
+        return operator()(b.min_corner());
+    }
+};
+
+template <typename Rtree, typename Predicates>
+void test_exact(Rtree const& rt, Predicates const& pred)
+{
+    // more levels than the depth of the tree
+    std::size_t const levels = 32;
+    BOOST_CHECK_EQUAL(rt.estimate_count(pred, levels), rt.query_count(pred));
+    BOOST_CHECK_EQUAL(bgi::estimate_count(rt, pred, levels + 1), rt.query_count(pred));
+}
+
+template <typename Rtree, typename Predicates>
+void test_estimate(Rtree const& rt, Predicates const& pred, double max_error)
+{
+    double const exact = double(rt.query_count(pred));
+    for ( std::size_t levels = 1 ; levels <= 6 ; ++levels )
+    {
+        double const estimated = double(rt.estimate_count(pred, levels));
+        BOOST_CHECK_MESSAGE(std::abs(estimated - exact) <= max_error * exact,
+                            "levels: " << levels << " exact: " << exact << " estimated: " << estimated);
+    }
+}
+
+template <typename Value, typename Params>
+void test_rtree(std::vector<Value> const& values, Params const& params)
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+
+    rtree_t empty(params);
+    BOOST_CHECK_EQUAL(empty.estimate_count(bgi::intersects(box_t(point_t(0, 0), point_t(10, 10)))), 0u);
+
+    rtree_t rt(values, params);
+
+    // all values, the root is covered, the counts of the values of the nodes
+    // are exact only if they are stored in the nodes
+    double const max_error = bgi::detail::is_counted<Params>::value ? 0.0 : 0.2;
+    for ( std::size_t levels = 0 ; levels < 4 ; ++levels )
+    {
+        double const estimated = double(rt.estimate_count(bgi::intersects(box_t(point_t(-1, -1), point_t(2000, 2000))), levels));
+        BOOST_CHECK(std::abs(estimated - double(values.size())) <= max_error * double(values.size()));
+    }
+
+    // no values
+    BOOST_CHECK_EQUAL(rt.estimate_count(bgi::intersects(box_t(point_t(3000, 3000), point_t(4000, 4000)))), 0u);
+
+    polygon_t poly;
+    bg::read_wkt("POLYGON((100 100,100 700,600 800,800 100,100 100))", poly);
+
+    for ( std::size_t i = 0 ; i < 10 ; ++i )
+    {
+        double const x = double((i * 131) % 500), y = double((i * 71) % 500);
+        double const w = double(200 + (i * 53) % 400), h = double(200 + (i * 37) % 400);
+        box_t const b(point_t(x, y), point_t(x + w, y + h));
+
+        // the result is exact if all levels are traversed
+        test_exact(rt, bgi::intersects(b));
+        test_exact(rt, bgi::within(b));
+        test_exact(rt, bgi::covered_by(b) && bgi::satisfies(is_even_x()));
+        test_exact(rt, bgi::intersects(b) && bgi::intersects(poly));
+
+        // the values are distributed uniformly so the estimation is close
+        test_estimate(rt, bgi::intersects(b), 0.2);
+        test_estimate(rt, bgi::within(b), 0.2);
+    }
+    test_estimate(rt, bgi::intersects(poly), 0.3);
+}
+
+int test_main(int, char* [])
+{
+    std::vector<point_t> points;
+    std::vector<box_t> boxes;
+    for ( std::size_t i = 0 ; i < 20000 ; ++i )
+    {
+        double const x = double((i * 7919) % 1009), y = double((i * 104729) % 997);
+        points.push_back(point_t(x, y));
+        boxes.push_back(box_t(point_t(x, y), point_t(x + 3, y + 2)));
+    }
+
+    test_rtree(points, bgi::linear<16, 4>());
+    test_rtree(points, bgi::rstar<8, 3>());
+    test_rtree(boxes, bgi::quadratic<16, 4>());
+    test_rtree(boxes, bgi::dynamic_rstar(32, 8));
+
+    test_rtree(points, bgi::counted<bgi::linear<16, 4> >());
+    test_rtree(boxes, bgi::counted<bgi::rstar<8, 3> >());
+
+    return 0;
+}
@@ -0,0 +1,235 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/index/flat_rtree.hpp>
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+
+// the buffer aligned as the data of a memory mapped file
+class aligned_buffer
+{
+public:
+    explicit aligned_buffer(std::string const& str)
+        : m_buffer(str.size() + 64)
+        , m_size(str.size())
+    {
+        std::size_t const misalignment = reinterpret_cast<std::uintptr_t>(m_buffer.data()) % 64;
+        m_data = m_buffer.data() + (misalignment == 0 ? 0 : 64 - misalignment);
+        std::memcpy(m_data, str.data(), str.size());
+    }
+
+    void const* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    std::vector<char> m_buffer;
+    char * m_data;
+    std::size_t m_size;
+};
+
+template <typename Value>
+inline bool same_values(std::vector<Value> l, std::vector<Value> r)
+{
+    auto less = [](Value const& a, Value const& b) { return a.second < b.second; };
+    std::sort(l.begin(), l.end(), less);
+    std::sort(r.begin(), r.end(), less);
+    return std::equal(l.begin(), l.end(), r.begin(), r.end(),
+                      [](Value const& a, Value const& b) { return a.second == b.second; });
+}
+
+template <typename Indexable, typename Params>
+void test_flat(std::vector<std::pair<Indexable, int> > const& values, Params const& params,
+               unsigned int quantization_bits)
+{
+    typedef std::pair<Indexable, int> value_t;
+    typedef bgi::rtree<value_t, Params> rtree_t;
+    typedef bgi::flat_rtree<value_t, Params> flat_rtree_t;
+
+    rtree_t rt(values, params);
+
+    std::ostringstream os(std::ios::binary);
+    bgi::write_flat(rt, os, quantization_bits);
+    aligned_buffer buffer(os.str());
+
+    flat_rtree_t flat(buffer.data(), buffer.size(), params);
+    BOOST_CHECK_EQUAL(flat.size(), rt.size());
+    BOOST_CHECK_EQUAL(flat.empty(), rt.empty());
+    BOOST_CHECK(same_values(std::vector<value_t>(flat.begin(), flat.end()),
+                            std::vector<value_t>(rt.begin(), rt.end())));
+    if ( rt.empty() )
+    {
+        std::vector<value_t> result;
+        BOOST_CHECK(flat.query(bgi::intersects(box_t(point_t(0, 0), point_t(1000, 1000))),
+                               std::back_inserter(result)) == 0);
+        return;
+    }
+    BOOST_CHECK(bg::equals(flat.bounds(), rt.bounds()));
+
+    for ( std::size_t i = 0 ; i < 50 ; ++i )
+    {
+        double x = double((i * 31) % 1000), y = double((i * 17) % 1000);
+        box_t b(point_t(x, y), point_t(x + 50, y + 40));
+        point_t p(x, y);
+
+        std::vector<value_t> expected, result;
+        rt.query(bgi::intersects(b), std::back_inserter(expected));
+        std::size_t n = flat.query(bgi::intersects(b), std::back_inserter(result));
+        BOOST_CHECK_EQUAL(n, result.size());
+        BOOST_CHECK(same_values(result, expected));
+
+        expected.clear(); result.clear();
+        rt.query(bgi::within(b) && bgi::satisfies([](value_t const& v) { return v.second % 3 == 0; }),
+                 std::back_inserter(expected));
+        flat.query(bgi::within(b) && bgi::satisfies([](value_t const& v) { return v.second % 3 == 0; }),
+                   std::back_inserter(result));
+        BOOST_CHECK(same_values(result, expected));
+
+        expected.clear(); result.clear();
+        rt.query(bgi::nearest(p, 1 + i % 7), std::back_inserter(expected));
+        n = flat.query(bgi::nearest(p, 1 + i % 7), std::back_inserter(result));
+        BOOST_CHECK_EQUAL(n, result.size());
+        BOOST_CHECK(same_values(result, expected));
+
+        expected.clear(); result.clear();
+        rt.query(bgi::nearest(p, 5) && !bgi::intersects(b), std::back_inserter(expected));
+        flat.query(bgi::nearest(p, 5) && !bgi::intersects(b), std::back_inserter(result));
+        BOOST_CHECK(same_values(result, expected));
+
+        expected.clear(); result.clear();
+        rt.query(bgi::within_distance(p, 30.0), std::back_inserter(expected));
+        flat.query(bgi::within_distance(p, 30.0), std::back_inserter(result));
+        BOOST_CHECK(same_values(result, expected));
+
+        expected.clear(); result.clear();
+        rt.query(bgi::nearest(p, 1000, 30.0), std::back_inserter(expected));
+        flat.query(bgi::nearest(p, 1000, 30.0), std::back_inserter(result));
+        BOOST_CHECK(same_values(result, expected));
+    }
+}
+
+template <typename Params>
+void test_params(Params const& params, std::size_t count)
+{
+    std::vector<std::pair<point_t, int> > points;
+    std::vector<std::pair<box_t, int> > boxes;
+    for ( std::size_t i = 0 ; i < count ; ++i )
+    {
+        double x = double((i * 7919) % 1009), y = double((i * 104729) % 997);
+        points.push_back(std::make_pair(point_t(x, y), int(i)));
+        boxes.push_back(std::make_pair(box_t(point_t(x, y), point_t(x + 5, y + 3)), int(i)));
+    }
+
+    // the quantized boxes contain the exact ones so the results are the same
+    for ( unsigned int bits : { 0u, 8u, 16u } )
+    {
+        test_flat(points, params, bits);
+        test_flat(boxes, params, bits);
+    }
+}
+
+// the boxes of the parents degenerated in some dimensions
+template <typename Params>
+void test_degenerated(Params const& params)
+{
+    std::vector<std::pair<point_t, int> > points;
+    for ( std::size_t i = 0 ; i < 500 ; ++i )
+    {
+        double y = double(i) + 0.25;
+        points.push_back(std::make_pair(point_t(500, y), int(i)));
+    }
+
+    for ( unsigned int bits : { 8u, 16u } )
+        test_flat(points, params, bits);
+}
+
+void test_invalid_data()
+{
+    typedef std::pair<point_t, int> value_t;
+    bgi::rtree<value_t, bgi::linear<4, 2> > rt;
+    rt.insert(std::make_pair(point_t(1, 1), 1));
+
+    std::ostringstream os(std::ios::binary);
+    bgi::write_flat(rt, os);
+    std::string str = os.str();
+
+    typedef bgi::flat_rtree<value_t, bgi::linear<4, 2> > flat_t;
+    aligned_buffer truncated(str.substr(0, str.size() - 1));
+    BOOST_CHECK_THROW(flat_t(truncated.data(), truncated.size()), std::invalid_argument);
+
+    typedef bgi::flat_rtree<std::pair<box_t, int>, bgi::linear<4, 2> > other_flat_t;
+    aligned_buffer buffer(str);
+    BOOST_CHECK_THROW(other_flat_t(buffer.data(), buffer.size()), std::invalid_argument);
+
+    BOOST_CHECK_THROW(bgi::write_flat(rt, os, 12), std::invalid_argument);
+
+    typedef bg::model::point<int, 2, bg::cs::cartesian> int_point_t;
+    bgi::rtree<int_point_t, bgi::linear<4, 2> > int_rt;
+    int_rt.insert(int_point_t(1, 1));
+    BOOST_CHECK_THROW(bgi::write_flat(int_rt, os, 8), std::invalid_argument);
+
+    std::string nodes_count_str = str;
+    std::uint64_t const nodes_count = std::uint64_t(-1) / 8;
+    std::memcpy(&nodes_count_str[offsetof(bgi::detail::rtree::flat::header, nodes_count)],
+                &nodes_count, sizeof(nodes_count));
+    aligned_buffer corrupted_nodes_count(nodes_count_str);
+    BOOST_CHECK_THROW(flat_t(corrupted_nodes_count.data(), corrupted_nodes_count.size()), std::invalid_argument);
+
+    std::string node_str = str;
+    std::uint64_t const count = 2;
+    std::memcpy(&node_str[bgi::detail::rtree::flat::alignment + offsetof(bgi::detail::rtree::flat::node, count)],
+                &count, sizeof(count));
+    aligned_buffer corrupted_node(node_str);
+    BOOST_CHECK_THROW(flat_t(corrupted_node.data(), corrupted_node.size()), std::invalid_argument);
+
+    // the quantized boxes of a single node are followed by the padding
+    // so the misaligned offset still fits into the data
+    std::ostringstream quantized_os(std::ios::binary);
+    bgi::write_flat(rt, quantized_os, 8);
+    std::string quantized_str = quantized_os.str();
+    aligned_buffer quantized(quantized_str);
+    BOOST_CHECK_EQUAL(flat_t(quantized.data(), quantized.size()).size(), 1u);
+    std::uint64_t offset = 0;
+    std::memcpy(&offset, &quantized_str[offsetof(bgi::detail::rtree::flat::header, quantized_bounds_offset)],
+                sizeof(offset));
+    ++offset;
+    std::memcpy(&quantized_str[offsetof(bgi::detail::rtree::flat::header, quantized_bounds_offset)],
+                &offset, sizeof(offset));
+    aligned_buffer misaligned(quantized_str);
+    BOOST_CHECK_THROW(flat_t(misaligned.data(), misaligned.size()), std::invalid_argument);
+
+    str[0] = 'X';
+    aligned_buffer corrupted(str);
+    BOOST_CHECK_THROW(flat_t(corrupted.data(), corrupted.size()), std::invalid_argument);
+}
+
+int test_main(int, char* [])
+{
+    test_params(bgi::linear<4, 2>(), 0);
+    test_params(bgi::linear<4, 2>(), 3);
+    test_params(bgi::quadratic<8, 3>(), 1000);
+    test_params(bgi::rstar<16, 4>(), 10000);
+    test_params(bgi::dynamic_rstar(16, 4), 5000);
+
+    test_degenerated(bgi::rstar<16, 4>());
+
+    test_invalid_data();
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/index/flat_rtree.hpp>
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+
+// the buffer aligned as the data of a memory mapped file
+class aligned_buffer
+{
+public:
+    explicit aligned_buffer(std::string const& str)
+        : m_buffer(str.size() + 64)
+        , m_size(str.size())
+    {
+        std::size_t const misalignment = reinterpret_cast<std::uintptr_t>(m_buffer.data()) % 64;
+        m_data = m_buffer.data() + (misalignment == 0 ? 0 : 64 - misalignment);
+        std::memcpy(m_data, str.data(), str.size());
+    }
+
+    void const* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    std::vector<char> m_buffer;
+    char * m_data;
+    std::size_t m_size;
+};
+
+template <typename Value>
+inline bool same_values(std::vector<Value> l, std::vector<Value> r)
+{
+    auto less = [](Value const& a, Value const& b) { return a.second < b.second; };
+    std::sort(l.begin(), l.end(), less);
+    std::sort(r.begin(), r.end(), less);
+    return std::equal(l.begin(), l.end(), r.begin(), r.end(),
+                      [](Value const& a, Value const& b) { return a.second == b.second; });
+}
+
+template <typename Indexable, typename Params>
+void test_external(std::vector<std::pair<Indexable, int> > const& values, Params const& params,
+                   std::size_t memory_limit)
+{
+    typedef std::pair<Indexable, int> value_t;
+    typedef bgi::rtree<value_t, Params> rtree_t;
+    typedef bgi::flat_rtree<value_t, Params> flat_rtree_t;
+
+    // the input range is traversed once so it doesn't have to be random access
+    std::list<value_t> input(values.begin(), values.end());
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    bgi::write_flat(input.begin(), input.end(), ss, params, bgi::external_memory_options(memory_limit));
+
+    // the same data is written for the rtree packed in memory
+    rtree_t rt(values, bgi::hilbert_packing(), params);
+    std::ostringstream os(std::ios::binary);
+    bgi::write_flat(rt, os);
+    BOOST_CHECK(ss.str() == os.str());
+
+    // the layout written after other data
+    std::string const prefix(64, 'x');
+    std::stringstream ss2(std::ios::in | std::ios::out | std::ios::binary);
+    ss2 << prefix;
+    bgi::write_flat(input.begin(), input.end(), ss2, params, bgi::external_memory_options(memory_limit));
+    BOOST_CHECK(ss2.str() == prefix + os.str());
+
+    aligned_buffer buffer(ss.str());
+    flat_rtree_t flat(buffer.data(), buffer.size(), params);
+    BOOST_CHECK_EQUAL(flat.size(), values.size());
+    BOOST_CHECK(same_values(std::vector<value_t>(flat.begin(), flat.end()), values));
+    if ( values.empty() )
+    {
+        return;
+    }
+    BOOST_CHECK(bg::equals(flat.bounds(), rt.bounds()));
+
+    for ( std::size_t i = 0 ; i < 20 ; ++i )
+    {
+        double x = double((i * 31) % 1000), y = double((i * 17) % 1000);
+        box_t b(point_t(x, y), point_t(x + 50, y + 40));
+        point_t p(x, y);
+
+        std::vector<value_t> expected, result;
+        std::copy_if(values.begin(), values.end(), std::back_inserter(expected),
+                     [&](value_t const& v) { return bg::intersects(v.first, b); });
+        flat.query(bgi::intersects(b), std::back_inserter(result));
+        BOOST_CHECK(same_values(result, expected));
+
+        expected.clear(); result.clear();
+        rt.query(bgi::nearest(p, 1 + i % 7), std::back_inserter(expected));
+        flat.query(bgi::nearest(p, 1 + i % 7), std::back_inserter(result));
+        BOOST_CHECK(same_values(result, expected));
+    }
+}
+
+template <typename Params>
+void test_params(Params const& params, std::size_t count)
+{
+    std::vector<std::pair<point_t, int> > points;
+    std::vector<std::pair<box_t, int> > boxes;
+    for ( std::size_t i = 0 ; i < count ; ++i )
+    {
+        double x = double((i * 7919) % 1009), y = double((i * 104729) % 997);
+        points.push_back(std::make_pair(point_t(x, y), int(i)));
+        boxes.push_back(std::make_pair(box_t(point_t(x, y), point_t(x + 5, y + 3)), int(i)));
+    }
+
+    // many sorted runs, a few sorted runs and all values sorted in memory
+    for ( std::size_t memory_limit : { std::size_t(1024), std::size_t(64 * 1024), std::size_t(64 * 1024 * 1024) } )
+    {
+        test_external(points, params, memory_limit);
+        test_external(boxes, params, memory_limit);
+    }
+}
+
+void test_invalid_temp_directory()
+{
+    typedef std::pair<point_t, int> value_t;
+    std::vector<value_t> values;
+    for ( int i = 0 ; i < 1000 ; ++i )
+    {
+        values.push_back(std::make_pair(point_t(i, i), i));
+    }
+
+    bgi::external_memory_options const options(1024, "/nonexistent/directory");
+    std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+    BOOST_CHECK_THROW(bgi::write_flat(values.begin(), values.end(), ss, bgi::linear<4, 2>(), options),
+                      std::runtime_error);
+}
+
+int test_main(int, char* [])
+{
+    test_params(bgi::linear<4, 2>(), 0);
+    test_params(bgi::linear<4, 2>(), 3);
+    test_params(bgi::quadratic<8, 3>(), 1000);
+    test_params(bgi::rstar<16, 4>(), 10000);
+    test_params(bgi::dynamic_rstar(16, 4), 5000);
+
+    test_invalid_temp_directory();
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+typedef std::pair<point_t, int> value_t;
+
+// the positions of objects moving in small steps, inserted one object after another
+std::vector<value_t> generate_tracks(std::size_t tracks, std::size_t track_length)
+{
+    std::vector<value_t> values;
+    for ( std::size_t t = 0 ; t < tracks ; ++t )
+    {
+        double x = double((t * 7919) % 200), y = double((t * 104729) % 150);
+        for ( std::size_t i = 0 ; i < track_length ; ++i )
+        {
+            x += double(int((t + i * 31) % 7) - 3) * 0.25;
+            y += double(int((t * 3 + i * 17) % 5) - 2) * 0.25;
+            values.push_back(std::make_pair(point_t(x, y), int(values.size())));
+        }
+    }
+    return values;
+}
+
+template <typename Params>
+void test_hint(Params const& params)
+{
+    typedef bgi::rtree<value_t, Params> rtree_t;
+
+    std::vector<value_t> const values = generate_tracks(20, 200);
+
+    rtree_t rt(params);
+    typename rtree_t::insert_hint hint;
+    for ( value_t const& v : values )
+    {
+        rt.insert(v, hint);
+    }
+    basictest::check_rtree(rt, values);
+
+    // the same tree with the free function
+    rtree_t rt2(params);
+    typename rtree_t::insert_hint hint2;
+    for ( value_t const& v : values )
+    {
+        bgi::insert(rt2, v, hint2);
+    }
+    basictest::check_rtree(rt2, values);
+
+    // the hint remains valid after removals and insertions without the hint
+    std::vector<value_t> remaining;
+    for ( value_t const& v : values )
+    {
+        if ( v.second % 3 == 0 )
+            rt.remove(v);
+        else
+            remaining.push_back(v);
+    }
+    std::vector<value_t> const more = generate_tracks(5, 100);
+    for ( std::size_t i = 0 ; i < more.size() ; ++i )
+    {
+        value_t const v(more[i].first, int(values.size() + i));
+        if ( i % 2 == 0 )
+            rt.insert(v, hint);
+        else
+            rt.insert(v);
+        remaining.push_back(v);
+    }
+    basictest::check_rtree(rt, remaining);
+
+    // the hint used for the first time with a non-empty tree
+    typename rtree_t::insert_hint hint3;
+    for ( value_t const& v : values )
+    {
+        rt.insert(value_t(v.first, v.second + 100000), hint3);
+        remaining.push_back(value_t(v.first, v.second + 100000));
+    }
+    basictest::check_rtree(rt, remaining);
+}
+
+int test_main(int, char* [])
+{
+    test_hint(bgi::linear<4, 2>());
+    test_hint(bgi::quadratic<8, 3>());
+    test_hint(bgi::rstar<16, 4>());
+    test_hint(bgi::rstar<8, 3, 0>());
+    test_hint(bgi::dynamic_linear(16, 4));
+    test_hint(bgi::dynamic_rstar(8, 3));
+    test_hint(bgi::counted<bgi::rstar<16, 4> >());
+
+    return 0;
+}
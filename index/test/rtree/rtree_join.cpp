@@ -0,0 +1,127 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/index/rtree.hpp>
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+typedef std::pair<point_t, int> point_value_t;
+
+struct different_ids
+{
+    bool operator()(std::pair<box_t, int> const& b, point_value_t const& p) const
+    {
+        return b.second != p.second;
+    }
+};
+
+template <typename Result>
+inline void sort_pairs(std::vector<Result> & pairs)
+{
+    std::sort(pairs.begin(), pairs.end(), [](Result const& l, Result const& r)
+    {
+        return std::make_tuple(l.first.second, l.second.second)
+             < std::make_tuple(r.first.second, r.second.second);
+    });
+}
+
+template <typename Result>
+inline bool equal_pairs(std::vector<Result> const& l, std::vector<Result> const& r)
+{
+    return std::equal(l.begin(), l.end(), r.begin(), r.end(), [](Result const& a, Result const& b)
+    {
+        return a.first.second == b.first.second && a.second.second == b.second.second;
+    });
+}
+
+template <typename Params1, typename Params2>
+void test_join(std::size_t count1, std::size_t count2,
+               Params1 const& params1 = Params1(), Params2 const& params2 = Params2())
+{
+    typedef std::pair<box_t, int> box_value_t;
+    typedef std::pair<box_value_t, point_value_t> result_t;
+    typedef bgi::rtree<box_value_t, Params1> rtree1_t;
+    typedef bgi::rtree<point_value_t, Params2> rtree2_t;
+
+    std::vector<box_value_t> boxes;
+    for ( std::size_t i = 0 ; i < count1 ; ++i )
+    {
+        double x = double((i * 7919) % 1009), y = double((i * 104729) % 997);
+        boxes.push_back(std::make_pair(box_t(point_t(x, y), point_t(x + 10, y + 5)), int(i)));
+    }
+    std::vector<point_value_t> points;
+    for ( std::size_t i = 0 ; i < count2 ; ++i )
+    {
+        double x = double((i * 31) % 1013), y = double((i * 17) % 1021);
+        points.push_back(std::make_pair(point_t(x, y), int(i % 100)));
+    }
+
+    rtree1_t rt1(boxes, params1);
+    rtree2_t rt2(params2);
+    for ( point_value_t const& p : points )
+        rt2.insert(p);
+
+    std::vector<result_t> expected;
+    std::vector<result_t> expected_pred;
+    for ( box_value_t const& b : boxes )
+    {
+        for ( point_value_t const& p : points )
+        {
+            if ( bg::intersects(b.first, p.first) )
+            {
+                expected.push_back(result_t(b, p));
+                if ( different_ids()(b, p) )
+                    expected_pred.push_back(result_t(b, p));
+            }
+        }
+    }
+    sort_pairs(expected);
+    sort_pairs(expected_pred);
+
+    std::vector<result_t> result;
+    std::size_t n = bgi::join(rt1, rt2, std::back_inserter(result));
+    BOOST_CHECK_EQUAL(n, result.size());
+
+    // the parallel version outputs pairs in the same order
+    std::vector<result_t> result_par;
+    n = bgi::join(rt1, rt2, std::back_inserter(result_par), bgi::execution::parallel_policy(3));
+    BOOST_CHECK_EQUAL(n, result_par.size());
+    BOOST_CHECK(equal_pairs(result, result_par));
+
+    sort_pairs(result);
+    BOOST_CHECK(equal_pairs(result, expected));
+
+    std::vector<result_t> result_pred;
+    rt1.join(rt2, different_ids(), std::back_inserter(result_pred));
+    sort_pairs(result_pred);
+    BOOST_CHECK(equal_pairs(result_pred, expected_pred));
+
+    std::vector<result_t> result_pred_par;
+    bgi::join(rt1, rt2, different_ids(), std::back_inserter(result_pred_par),
+              bgi::execution::parallel_policy(2));
+    sort_pairs(result_pred_par);
+    BOOST_CHECK(equal_pairs(result_pred_par, expected_pred));
+}
+
+int test_main(int, char* [])
+{
+    test_join<bgi::linear<4, 2>, bgi::quadratic<4, 2> >(0, 10);
+    test_join<bgi::linear<4, 2>, bgi::quadratic<4, 2> >(10, 0);
+    test_join<bgi::linear<4, 2>, bgi::quadratic<4, 2> >(3, 5);
+    test_join<bgi::rstar<16, 4>, bgi::linear<8, 3> >(2000, 5000);
+    test_join<bgi::quadratic<8, 3>, bgi::rstar<32, 8> >(10000, 300);
+    test_join<bgi::dynamic_rstar, bgi::rstar<32, 8> >(20000, 20000, bgi::dynamic_rstar(16, 4));
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/index/moving_rtree.hpp>
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+typedef bgi::moving_point<point_t, double> moving_point_t;
+typedef std::pair<moving_point_t, int> value_t;
+
+point_t position_at(moving_point_t const& mp, double t)
+{
+    return point_t(bg::get<0>(mp.position) + bg::get<0>(mp.velocity) * (t - mp.time),
+                   bg::get<1>(mp.position) + bg::get<1>(mp.velocity) * (t - mp.time));
+}
+
+// the values with positions defined at various times
+std::vector<value_t> generate_values(std::size_t count)
+{
+    std::vector<value_t> values;
+    for ( std::size_t i = 0 ; i < count ; ++i )
+    {
+        point_t const p(double((i * 7919) % 200), double((i * 104729) % 150));
+        point_t const v(double(int((i * 31) % 11) - 5) * 0.5, double(int((i * 17) % 9) - 4) * 0.5);
+        values.push_back(std::make_pair(moving_point_t(p, v, double(i % 5)), int(i)));
+    }
+    return values;
+}
+
+std::vector<int> ids(std::vector<value_t> const& values)
+{
+    std::vector<int> result;
+    for ( value_t const& v : values )
+        result.push_back(v.second);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+template <typename Rtree>
+void check_queries(Rtree const& rt, std::vector<value_t> const& values)
+{
+    BOOST_CHECK_EQUAL(rt.size(), values.size());
+
+    double const times[] = { -3.0, 0.0, 2.5, 10.0, 40.0 };
+    for ( double t : times )
+    {
+        for ( int i = 0 ; i < 10 ; ++i )
+        {
+            box_t const b(point_t(i * 20 - 10, i * 15 - 10), point_t(i * 20 + 30, i * 15 + 25));
+
+            std::vector<value_t> result;
+            rt.query(bgi::intersects_at(b, t), std::back_inserter(result));
+            std::vector<value_t> expected;
+            for ( value_t const& v : values )
+            {
+                if ( bg::covered_by(position_at(v.first, t), b) )
+                    expected.push_back(v);
+            }
+            BOOST_CHECK(ids(result) == ids(expected));
+
+            // combined with satisfies()
+            result.clear();
+            rt.query(bgi::intersects_at(b, t) && bgi::satisfies([](value_t const& v) { return v.second % 2 == 0; }),
+                     std::back_inserter(result));
+            expected.erase(std::remove_if(expected.begin(), expected.end(),
+                                          [](value_t const& v) { return v.second % 2 != 0; }),
+                           expected.end());
+            BOOST_CHECK(ids(result) == ids(expected));
+
+            // the distances of the k nearest positions at the time
+            point_t const q(i * 20 + 10, i * 15 + 5);
+            std::size_t const k = 7;
+            result.clear();
+            rt.query(bgi::nearest_at(q, t, k), std::back_inserter(result));
+            std::vector<double> distances, expected_distances;
+            for ( value_t const& v : result )
+                distances.push_back(bg::comparable_distance(q, position_at(v.first, t)));
+            for ( value_t const& v : values )
+                expected_distances.push_back(bg::comparable_distance(q, position_at(v.first, t)));
+            std::sort(distances.begin(), distances.end());
+            std::sort(expected_distances.begin(), expected_distances.end());
+            expected_distances.resize((std::min)(k, expected_distances.size()));
+            BOOST_CHECK_EQUAL(distances.size(), expected_distances.size());
+            for ( std::size_t j = 0 ; j < (std::min)(distances.size(), expected_distances.size()) ; ++j )
+                BOOST_CHECK_CLOSE(distances[j], expected_distances[j], 1e-9);
+        }
+    }
+}
+
+template <typename Params>
+void test_moving(Params const& params)
+{
+    typedef bgi::moving_rtree<value_t, Params> rtree_t;
+
+    std::vector<value_t> values = generate_values(500);
+
+    rtree_t rt(params, 2.0, 10.0);
+    BOOST_CHECK_EQUAL(rt.reference_time(), 2.0);
+    BOOST_CHECK_EQUAL(rt.horizon(), 10.0);
+    for ( value_t const& v : values )
+        rt.insert(v);
+    check_queries(rt, values);
+
+    // the velocities of some of the points change
+    for ( std::size_t i = 0 ; i < values.size() ; i += 3 )
+    {
+        BOOST_CHECK_EQUAL(rt.remove(values[i]), 1u);
+        value_t const v(moving_point_t(position_at(values[i].first, 6.0),
+                                       point_t(bg::get<1>(values[i].first.velocity),
+                                               -bg::get<0>(values[i].first.velocity)),
+                                       6.0),
+                        values[i].second);
+        rt.insert(v);
+        values[i] = v;
+    }
+    check_queries(rt, values);
+
+    // packed with a later reference time
+    rtree_t packed(values.begin(), values.end(), params, 20.0, 5.0);
+    check_queries(packed, values);
+
+    rt.clear();
+    BOOST_CHECK(rt.empty());
+    rt.insert(values.begin(), values.end());
+    check_queries(rt, values);
+}
+
+int test_main(int, char* [])
+{
+    test_moving(bgi::linear<4, 2>());
+    test_moving(bgi::quadratic<8, 3>());
+    test_moving(bgi::rstar<16, 4>());
+    test_moving(bgi::dynamic_rstar(8, 3));
+
+    return 0;
+}
@@ -0,0 +1,175 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/detail/algorithms/geographic_distance_lower_bound.hpp>
+
+typedef bg::model::point<double, 2, bg::cs::geographic<bg::degree> > point_t;
+typedef bg::model::box<point_t> box_t;
+typedef std::pair<point_t, int> value_t;
+
+double random_coord(unsigned & seed, double min, double max)
+{
+    seed = seed * 1103515245u + 12345u;
+    return min + (max - min) * double((seed >> 8) % 100000) / 99999.0;
+}
+
+template <typename Strategy, typename Spheroid>
+void test_lower_bound(Spheroid const& spheroid)
+{
+    Strategy const strategy(spheroid);
+
+    unsigned seed = 7;
+    for ( int i = 0 ; i < 300 ; ++i )
+    {
+        double const lon = random_coord(seed, -180, 180);
+        double const lat = random_coord(seed, -90, 90);
+        // boxes of various sizes, near the poles and crossing the antimeridian
+        double const w = i % 3 == 0 ? random_coord(seed, 0, 0.01) : random_coord(seed, 0, 120);
+        double const h = i % 3 == 0 ? random_coord(seed, 0, 0.01) : random_coord(seed, 0, 60);
+        double const min_lon = i % 5 == 0 ? 179.9 - w / 2 : random_coord(seed, -180, 180 - w);
+        double const min_lat = i % 7 == 0 ? 90 - h : random_coord(seed, -90, 90 - h);
+        box_t const box(point_t(min_lon, min_lat), point_t(min_lon + w, min_lat + h));
+
+        point_t const pts[] = { point_t(lon, lat),
+                                point_t(min_lon + w / 2 + random_coord(seed, -0.001, 0.001), min_lat - 0.0001),
+                                point_t(min_lon + w + 0.00001, min_lat + h / 3) };
+        for ( point_t const& p : pts )
+        {
+            double const bound = bgi::detail::geographic_distance_lower_bound<double>(p, box, spheroid);
+            BOOST_CHECK(bound >= 0);
+
+            double min_distance = bg::distance(p, box.min_corner(), strategy);
+            for ( int x = 0 ; x <= 20 ; ++x )
+            {
+                for ( int y = 0 ; y <= 20 ; ++y )
+                {
+                    point_t const q(min_lon + w * x / 20, min_lat + h * y / 20);
+                    min_distance = (std::min)(min_distance, bg::distance(p, q, strategy));
+                }
+            }
+            BOOST_CHECK(bound <= min_distance);
+
+            // the point inside the box
+            point_t const c(min_lon + w / 2, min_lat + h / 2);
+            BOOST_CHECK_EQUAL(bgi::detail::geographic_distance_lower_bound<double>(c, box, spheroid), 0.0);
+        }
+    }
+}
+
+std::vector<value_t> generate_values(std::size_t count)
+{
+    unsigned seed = 3;
+    std::vector<value_t> values;
+    for ( std::size_t i = 0 ; i < count ; ++i )
+    {
+        // clusters near the poles, at the antimeridian and scattered points
+        double lon = 0, lat = 0;
+        if ( i % 4 == 0 )
+        {
+            lon = random_coord(seed, -180, 180);
+            lat = random_coord(seed, 85, 90);
+        }
+        else if ( i % 4 == 1 )
+        {
+            lon = random_coord(seed, 178, 182);
+            lon = lon > 180 ? lon - 360 : lon;
+            lat = random_coord(seed, -10, 10);
+        }
+        else
+        {
+            lon = random_coord(seed, -180, 180);
+            lat = random_coord(seed, -80, 80);
+        }
+        values.push_back(std::make_pair(point_t(lon, lat), int(i)));
+    }
+    return values;
+}
+
+template <typename Rtree, typename Strategy>
+void check_nearest(Rtree const& rt, std::vector<value_t> const& values, Strategy const& strategy)
+{
+    unsigned seed = 11;
+    for ( int i = 0 ; i < 40 ; ++i )
+    {
+        point_t const q(random_coord(seed, -180, 180),
+                        i % 4 == 0 ? random_coord(seed, 80, 90) : random_coord(seed, -90, 90));
+        std::size_t const k = i % 2 == 0 ? 1 : 10;
+
+        std::vector<value_t> result;
+        rt.query(bgi::nearest(q, k), std::back_inserter(result));
+
+        std::vector<double> distances, expected;
+        for ( value_t const& v : result )
+            distances.push_back(bg::distance(q, v.first, strategy));
+        for ( value_t const& v : values )
+            expected.push_back(bg::distance(q, v.first, strategy));
+        std::sort(distances.begin(), distances.end());
+        std::sort(expected.begin(), expected.end());
+        expected.resize(k);
+
+        BOOST_CHECK_EQUAL(distances.size(), k);
+        for ( std::size_t j = 0 ; j < (std::min)(k, distances.size()) ; ++j )
+            BOOST_CHECK_CLOSE(distances[j], expected[j], 1e-9);
+
+        // the nodes are pruned by the lower bound of the distance
+        double const max_distance = 500000;
+        result.clear();
+        rt.query(bgi::nearest(q, k, max_distance), std::back_inserter(result));
+
+        distances.clear();
+        for ( value_t const& v : result )
+            distances.push_back(bg::distance(q, v.first, strategy));
+        std::sort(distances.begin(), distances.end());
+        while ( ! expected.empty() && expected.back() > max_distance )
+            expected.pop_back();
+
+        BOOST_CHECK_EQUAL(distances.size(), expected.size());
+        for ( std::size_t j = 0 ; j < (std::min)(expected.size(), distances.size()) ; ++j )
+            BOOST_CHECK_CLOSE(distances[j], expected[j], 1e-9);
+    }
+}
+
+int test_main(int, char* [])
+{
+    bg::srs::spheroid<double> const wgs84;
+    // prolate spheroid
+    bg::srs::spheroid<double> const prolate(6356752.3142, 6378137.0);
+
+    test_lower_bound<bg::strategy::distance::andoyer<> >(wgs84);
+    test_lower_bound<bg::strategy::distance::thomas<> >(wgs84);
+    test_lower_bound<bg::strategy::distance::vincenty<> >(wgs84);
+    test_lower_bound<bg::strategy::distance::vincenty<bg::srs::spheroid<double> > >(prolate);
+
+    std::vector<value_t> const values = generate_values(3000);
+
+    {
+        bgi::rtree<value_t, bgi::rstar<16> > rt(values);
+        check_nearest(rt, values, bg::strategies::distance::geographic<>());
+
+        bgi::rtree<value_t, bgi::linear<8> > rt2;
+        rt2.insert(values.begin(), values.end());
+        check_nearest(rt2, values, bg::strategies::distance::geographic<>());
+    }
+
+    {
+        typedef bg::strategies::index::geographic<bg::strategy::vincenty> strategy_t;
+        typedef bgi::parameters<bgi::quadratic<8>, strategy_t> params_t;
+        bgi::rtree<value_t, params_t> rt(values, params_t(bgi::quadratic<8>(), strategy_t(wgs84)));
+        check_nearest(rt, values, bg::strategies::distance::geographic<bg::strategy::vincenty>(wgs84));
+    }
+
+    return 0;
+}
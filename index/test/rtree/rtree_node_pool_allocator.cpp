@@ -0,0 +1,90 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <vector>
+
+#include <boost/geometry/index/execution.hpp>
+#include <boost/geometry/index/node_pool_allocator.hpp>
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+
+template <typename Params>
+void test_pool(Params const& params, std::size_t chunk_size)
+{
+    typedef bgi::node_pool_allocator<point_t> allocator_t;
+    typedef bgi::rtree<point_t, Params, bgi::indexable<point_t>, bgi::equal_to<point_t>, allocator_t> rtree_t;
+
+    std::vector<point_t> values;
+    for ( std::size_t i = 0 ; i < 10000 ; ++i )
+    {
+        values.push_back(point_t(double((i * 7919) % 1009), double((i * 104729) % 997)));
+    }
+
+    allocator_t allocator(chunk_size);
+    rtree_t rt(params, bgi::indexable<point_t>(), bgi::equal_to<point_t>(), allocator);
+    BOOST_CHECK(rt.get_allocator() == allocator);
+
+    rt.insert(values.begin(), values.end());
+    basictest::check_rtree(rt, values);
+
+    // the memory of the removed nodes is reused
+    rt.remove(values.begin(), values.begin() + values.size() / 2);
+    basictest::check_rtree(rt, std::vector<point_t>(values.begin() + values.size() / 2, values.end()));
+    rt.insert(values.begin(), values.begin() + values.size() / 2);
+    basictest::check_rtree(rt, values);
+
+    rt.clear();
+    basictest::check_rtree(rt, std::vector<point_t>());
+    rt.insert(values.begin(), values.end());
+    basictest::check_rtree(rt, values);
+
+    // the copy shares the pool
+    rtree_t copy(rt);
+    BOOST_CHECK(copy.get_allocator() == rt.get_allocator());
+    basictest::check_rtree(copy, values);
+
+    rtree_t moved(boost::move(copy));
+    BOOST_CHECK(copy.empty());
+    basictest::check_rtree(moved, values);
+
+    // the nodes are copied between the trees using different pools
+    rtree_t assigned(params, bgi::indexable<point_t>(), bgi::equal_to<point_t>(), allocator_t(chunk_size));
+    BOOST_CHECK(assigned.get_allocator() != rt.get_allocator());
+    assigned = rt;
+    basictest::check_rtree(assigned, values);
+    moved.clear();
+    BOOST_CHECK_EQUAL(assigned.count(values.front()), rt.count(values.front()));
+
+    // the pool is used concurrently
+    rtree_t parallel(values.begin(), values.end(), bgi::execution::parallel_policy(4),
+                     params, bgi::indexable<point_t>(), bgi::equal_to<point_t>(), allocator);
+    basictest::check_rtree(parallel, values);
+
+    box_t b(point_t(100, 100), point_t(400, 300));
+    std::vector<point_t> expected, result;
+    rtree_t packed(values, params);
+    packed.query(bgi::intersects(b), std::back_inserter(expected));
+    parallel.query(bgi::intersects(b), std::back_inserter(result));
+    basictest::exactly_the_same_outputs(parallel, result, expected);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> P2d;
+
+    test_rtree_for_point<P2d>(bgi::rstar<8, 3>(), bgi::node_pool_allocator<void>());
+    test_rtree_for_box<P2d>(bgi::dynamic_quadratic(8, 3), bgi::node_pool_allocator<void>(1024));
+
+    test_pool(bgi::linear<16, 4>(), 65536);
+    test_pool(bgi::rstar<4, 2>(), 16);
+    test_pool(bgi::dynamic_rstar(32, 8), 4096);
+
+    return 0;
+}
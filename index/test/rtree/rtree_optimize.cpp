@@ -0,0 +1,166 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_GEOMETRY_INDEX_ENABLE_QUERY_STATISTICS
+
+#include <rtree/test_rtree.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/index/detail/rtree/utilities/query_statistics.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/view.hpp>
+
+namespace bgiu = bgi::detail::rtree::utilities;
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+
+inline void fill(point_t & pt, double x, double y)
+{
+    pt = point_t(x, y);
+}
+
+inline void fill(box_t & box, double x, double y)
+{
+    box = box_t(point_t(x, y), point_t(x + 0.5, y + 0.75));
+}
+
+template <typename Indexable>
+Indexable generate_indexable(unsigned & seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    double const x = double((seed >> 8) % 10000) / 10.0;
+    seed = seed * 1103515245u + 12345u;
+    double const y = double((seed >> 8) % 10000) / 10.0;
+    Indexable result;
+    fill(result, x, y);
+    return result;
+}
+
+template <typename Rtree>
+std::size_t visited_nodes(Rtree const& rt)
+{
+    typedef typename Rtree::value_type value_t;
+
+    bgiu::query_statistics stats;
+    bgiu::scoped_query_statistics guard(stats);
+    for ( int i = 0 ; i < 100 ; ++i )
+    {
+        box_t const b(point_t(i * 9, (i * 37) % 900), point_t(i * 9 + 30, (i * 37) % 900 + 30));
+        std::vector<value_t> result;
+        rt.query(bgi::intersects(b), std::back_inserter(result));
+    }
+    return stats.internal_nodes + stats.leafs;
+}
+
+template <typename Indexable, typename Params>
+void test_optimize(Params const& params)
+{
+    typedef std::pair<Indexable, int> value_t;
+    typedef bgi::rtree<value_t, Params> rtree_t;
+
+    // insertions and removals degrading the tree
+    unsigned seed = 1;
+    std::vector<value_t> values;
+    rtree_t rt(params);
+    for ( int i = 0 ; i < 6000 ; ++i )
+    {
+        value_t const v(generate_indexable<Indexable>(seed), i);
+        rt.insert(v);
+        values.push_back(v);
+
+        if ( i % 3 == 2 )
+        {
+            std::size_t const j = (seed >> 4) % values.size();
+            BOOST_CHECK_EQUAL(rt.remove(values[j]), 1u);
+            values[j] = values.back();
+            values.pop_back();
+        }
+    }
+    basictest::check_rtree(rt, values);
+
+    rtree_t original = rt;
+    rtree_t stepped = rt;
+    std::vector<value_t> const values_before_step = values;
+
+    // the budget is not exceeded
+    std::size_t const repacked = rt.optimize_step(500);
+    BOOST_CHECK(repacked <= 500u);
+    basictest::check_rtree(rt, values);
+
+    // the tree is still modifiable
+    for ( int i = 0 ; i < 300 ; ++i )
+    {
+        value_t const v(generate_indexable<Indexable>(seed), 100000 + i);
+        rt.insert(v);
+        values.push_back(v);
+    }
+    for ( std::size_t i = 0 ; i < values.size() ; i += 7 )
+    {
+        BOOST_CHECK_EQUAL(rt.remove(values[i]), 1u);
+        values[i] = values.back();
+        values.pop_back();
+    }
+    basictest::check_rtree(rt, values);
+
+    // the whole tree
+    BOOST_CHECK(rt.optimize() > 0u);
+    basictest::check_rtree(rt, values);
+
+    // repacked tree is not noticeably worse than the degraded one,
+    // the subtrees of R*-tree may be as good as the packed ones
+    std::size_t const before = visited_nodes(original);
+    BOOST_CHECK(original.optimize() > 0u);
+    basictest::check_rtree(original, values_before_step);
+    BOOST_CHECK(visited_nodes(original) <= before + before / 20);
+
+    // consecutive steps go through the whole tree
+    std::size_t const depth = bgiu::view<rtree_t>(stepped).depth();
+    std::size_t repacked_steps = 0;
+    for ( int i = 0 ; i < 50 ; ++i )
+    {
+        std::size_t const r = stepped.optimize_step(200);
+        BOOST_CHECK(r <= 200u);
+        repacked_steps += r;
+    }
+    BOOST_CHECK(repacked_steps > 200u);
+    BOOST_CHECK_EQUAL(bgiu::view<rtree_t>(stepped).depth(), depth);
+    basictest::check_rtree(stepped, values_before_step);
+
+    // the root is repacked only by optimize()
+    rtree_t small(params);
+    std::vector<value_t> small_values;
+    for ( int i = 0 ; i < 20 ; ++i )
+    {
+        value_t const v(generate_indexable<Indexable>(seed), i);
+        small.insert(v);
+        small_values.push_back(v);
+    }
+    BOOST_CHECK_EQUAL(small.optimize_step(1000), 0u);
+    small.optimize();
+    basictest::check_rtree(small, small_values);
+
+    // nothing to repack
+    rtree_t empty(params);
+    BOOST_CHECK_EQUAL(empty.optimize(), 0u);
+    BOOST_CHECK_EQUAL(rt.optimize_step(0), 0u);
+}
+
+int test_main(int, char* [])
+{
+    test_optimize<point_t>(bgi::linear<8, 3>());
+    test_optimize<point_t>(bgi::quadratic<8, 3>());
+    test_optimize<point_t>(bgi::rstar<16, 4>());
+    test_optimize<point_t>(bgi::dynamic_rstar(8, 3));
+    test_optimize<box_t>(bgi::rstar<16, 4>());
+    test_optimize<box_t>(bgi::dynamic_quadratic(16, 4));
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/detail/algorithms/hilbert_key.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_counts_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_levels_ok.hpp>
+
+// consecutive cells of the curve have to be adjacent
+void test_hilbert_key()
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+
+    typedef bgi::detail::hilbert_key<point_t> key_t;
+    double const side = double(std::uint64_t(1) << key_t::bits);
+    key_t const key(box_t(point_t(0, 0), point_t(side - 1, side - 1)));
+
+    // the first cells of the curve are in the corner of the box
+    std::vector<std::pair<key_t::result_type, point_t> > cells;
+    for ( double x = 0 ; x < 16 ; ++x )
+        for ( double y = 0 ; y < 16 ; ++y )
+            cells.push_back(std::make_pair(key(point_t(x, y)), point_t(x, y)));
+
+    std::sort(cells.begin(), cells.end(),
+              [](std::pair<key_t::result_type, point_t> const& l,
+                 std::pair<key_t::result_type, point_t> const& r) { return l.first < r.first; });
+
+    for ( std::size_t i = 0 ; i < cells.size() ; ++i )
+    {
+        BOOST_CHECK_EQUAL(cells[i].first, key_t::result_type(i));
+        if ( 0 < i )
+        {
+            double const dx = std::abs(bg::get<0>(cells[i].second) - bg::get<0>(cells[i - 1].second));
+            double const dy = std::abs(bg::get<1>(cells[i].second) - bg::get<1>(cells[i - 1].second));
+            BOOST_CHECK_EQUAL(dx + dy, 1.0);
+        }
+    }
+}
+
+template <typename Value, typename Params>
+void test_rtree(std::vector<Value> const& values, Params const& params = Params())
+{
+    typedef bgi::rtree<Value, Params> rtree_t;
+    typedef typename rtree_t::bounds_type box_t;
+    typedef typename bg::point_type<box_t>::type point_t;
+
+    rtree_t rt(values, bgi::hilbert_packing(), params);
+    rtree_t rt_it(values.begin(), values.end(), bgi::hilbert_packing(), params);
+
+    BOOST_CHECK(rt.size() == values.size());
+    BOOST_CHECK(rt_it.size() == values.size());
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_levels_ok(rt));
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_counts_ok(rt));
+
+    if ( values.empty() )
+    {
+        BOOST_CHECK(rt.empty());
+        return;
+    }
+
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rt));
+
+    rtree_t rt_ref(values, params);
+    BOOST_CHECK(bg::equals(rt.bounds(), rt_ref.bounds()));
+
+    box_t qbox(point_t(10, 10), point_t(40, 30));
+    std::vector<Value> result, expected;
+    rt.query(bgi::intersects(qbox), std::back_inserter(result));
+    rt_ref.query(bgi::intersects(qbox), std::back_inserter(expected));
+    BOOST_CHECK_EQUAL(result.size(), expected.size());
+
+    result.clear();
+    expected.clear();
+    rt.query(bgi::nearest(point_t(25, 25), 10), std::back_inserter(result));
+    rt_ref.query(bgi::nearest(point_t(25, 25), 10), std::back_inserter(expected));
+    BOOST_CHECK_EQUAL(result.size(), expected.size());
+
+    // the tree can be modified afterwards
+    rt.remove(values.begin(), values.begin() + values.size() / 2);
+    rt.insert(values.front());
+    BOOST_CHECK(rt.size() == values.size() - values.size() / 2 + 1);
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_counts_ok(rt));
+}
+
+template <typename Value>
+void test_rtree_params(std::vector<Value> const& values)
+{
+    test_rtree<Value, bgi::linear<5, 2> >(values);
+    test_rtree<Value, bgi::quadratic<16, 4> >(values);
+    test_rtree<Value, bgi::rstar<4, 2> >(values);
+    test_rtree<Value>(values, bgi::dynamic_rstar(8, 4));
+}
+
+template <typename Point>
+void test_points(std::size_t vcount)
+{
+    std::vector<Point> values;
+    for ( std::size_t i = 0 ; i < vcount ; ++i )
+    {
+        values.push_back(Point(double((i * 7919) % 101) / 2, double((i * 104729) % 97) / 2));
+    }
+    test_rtree_params(values);
+}
+
+void test_boxes(std::size_t vcount)
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+
+    std::vector<box_t> values;
+    for ( std::size_t i = 0 ; i < vcount ; ++i )
+    {
+        double x = double((i * 7919) % 101) / 2, y = double((i * 104729) % 97) / 2;
+        values.push_back(box_t(point_t(x, y), point_t(x + double(i % 5), y + double(i % 3))));
+    }
+    test_rtree_params(values);
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_c;
+    typedef bg::model::point<float, 2, bg::cs::cartesian> point_f;
+    typedef bg::model::point<double, 2, bg::cs::geographic<bg::degree> > point_g;
+
+    test_hilbert_key();
+
+    test_points<point_c>(0);
+    test_points<point_c>(1);
+    test_points<point_c>(5);
+    test_points<point_c>(177);
+    test_points<point_c>(10000);
+    test_points<point_f>(1000);
+    test_points<point_g>(1000);
+    test_boxes(1000);
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_levels_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/print.hpp>
+
+// The printed tree without the addresses of nodes
+template <typename Rtree>
+std::string structure(Rtree const& rt)
+{
+    std::ostringstream os;
+    os << std::setprecision(20);
+    bgi::detail::rtree::utilities::print(os, rt);
+
+    std::istringstream is(os.str());
+    std::string result, line;
+    while ( std::getline(is, line) )
+    {
+        std::string::size_type const pos = std::min(line.find(" @:"), line.find(" ->"));
+        result += line.substr(0, pos) + '\n';
+    }
+    return result;
+}
+
+template <typename Point, typename Params>
+void test_rtree(std::size_t vcount, std::size_t threads, Params const& params = Params())
+{
+    typedef bgi::rtree<Point, Params> rtree_t;
+
+    std::vector<Point> values;
+    for ( std::size_t i = 0 ; i < vcount ; ++i )
+    {
+        // deterministic, unordered, with duplicates
+        double x = double((i * 7919) % 1009);
+        double y = double((i * 104729) % 997);
+        values.push_back(Point(x, y));
+    }
+
+    rtree_t rt_seq(values, params);
+    rtree_t rt_par(values, bgi::execution::parallel_policy(threads), params);
+    rtree_t rt_par_it(values.begin(), values.end(), bgi::execution::parallel_policy(threads), params);
+
+    BOOST_CHECK(rt_par.size() == vcount);
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_levels_ok(rt_par));
+
+    BOOST_CHECK(std::equal(rt_seq.begin(), rt_seq.end(), rt_par.begin(), rt_par.end(),
+                           [](Point const& l, Point const& r) { return bg::equals(l, r); }));
+
+    std::string const s = structure(rt_seq);
+    BOOST_CHECK(s == structure(rt_par));
+    BOOST_CHECK(s == structure(rt_par_it));
+}
+
+template <typename Point>
+void test_rtree_params(std::size_t vcount, std::size_t threads)
+{
+    test_rtree<Point, bgi::linear<8, 3> >(vcount, threads);
+    test_rtree<Point, bgi::quadratic<16, 4> >(vcount, threads);
+    test_rtree<Point, bgi::rstar<4, 2> >(vcount, threads);
+    test_rtree<Point>(vcount, threads, bgi::dynamic_rstar(8, 3));
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_c;
+    typedef bg::model::point<double, 2, bg::cs::spherical_equatorial<bg::degree> > point_s;
+
+    test_rtree_params<point_c>(0, 4);
+    test_rtree_params<point_c>(100, 4);
+    test_rtree_params<point_c>(20000, 1);
+    test_rtree_params<point_c>(20000, 3);
+    test_rtree_params<point_c>(50000, 8);
+    test_rtree_params<point_s>(30000, 4);
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <algorithm>
+#include <list>
+#include <tuple>
+#include <vector>
+
+#include <boost/geometry/index/rtree.hpp>
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+
+struct is_even_x
+{
+    template <typename Value>
+    bool operator()(Value const& v) const { return int(bg::get<bg::min_corner, 0>(v)) % 2 == 0; }
+};
+
+template <typename Rtree, typename Predicates>
+void test_query_batch(Rtree const& rt, std::vector<Predicates> const& predicates)
+{
+    typedef typename Rtree::value_type value_t;
+    typedef std::pair<std::size_t, value_t> result_t;
+
+    std::vector<result_t> expected;
+    for ( std::size_t i = 0 ; i < predicates.size() ; ++i )
+    {
+        std::vector<value_t> found;
+        rt.query(predicates[i], std::back_inserter(found));
+        for ( value_t const& v : found )
+            expected.push_back(result_t(i, v));
+    }
+
+    std::vector<result_t> result;
+    std::size_t n = rt.query_batch(predicates.begin(), predicates.end(), std::back_inserter(result));
+    BOOST_CHECK_EQUAL(n, result.size());
+
+    std::vector<result_t> result_par;
+    n = rt.query_batch(predicates.begin(), predicates.end(), std::back_inserter(result_par),
+                       bgi::execution::parallel_policy(3));
+    BOOST_CHECK_EQUAL(n, result_par.size());
+
+    std::vector<result_t> result_fun;
+    bgi::query_batch(rt, predicates.begin(), predicates.end(), std::back_inserter(result_fun));
+
+    std::vector<result_t> result_fun_par;
+    bgi::query_batch(rt, predicates.begin(), predicates.end(), std::back_inserter(result_fun_par),
+                     bgi::execution::parallel_policy(2));
+
+    // the predicates not accessible randomly are copied
+    std::list<Predicates> const predicates_list(predicates.begin(), predicates.end());
+    std::vector<result_t> result_list;
+    rt.query_batch(predicates_list.begin(), predicates_list.end(), std::back_inserter(result_list));
+
+    // the parallel version outputs values in the same order
+    BOOST_CHECK(result.size() == result_par.size());
+    BOOST_CHECK(std::equal(result.begin(), result.end(), result_par.begin(), result_par.end(),
+                           [](result_t const& l, result_t const& r)
+                           { return l.first == r.first && bg::equals(l.second, r.second); }));
+    auto equal = [](result_t const& l, result_t const& r)
+    {
+        return l.first == r.first && bg::equals(l.second, r.second);
+    };
+    BOOST_CHECK(std::equal(result.begin(), result.end(), result_fun.begin(), result_fun.end(), equal));
+    BOOST_CHECK(std::equal(result.begin(), result.end(), result_fun_par.begin(), result_fun_par.end(), equal));
+    BOOST_CHECK(std::equal(result.begin(), result.end(), result_list.begin(), result_list.end(), equal));
+
+    // for each query the values are the same as the ones returned by query()
+    auto less = [](result_t const& l, result_t const& r)
+    {
+        return std::make_tuple(l.first, bg::get<bg::min_corner, 0>(l.second), bg::get<bg::min_corner, 1>(l.second))
+             < std::make_tuple(r.first, bg::get<bg::min_corner, 0>(r.second), bg::get<bg::min_corner, 1>(r.second));
+    };
+    std::sort(expected.begin(), expected.end(), less);
+    std::sort(result.begin(), result.end(), less);
+    BOOST_CHECK(result.size() == expected.size());
+    BOOST_CHECK(std::equal(result.begin(), result.end(), expected.begin(), expected.end(),
+                           [](result_t const& l, result_t const& r)
+                           { return l.first == r.first && bg::equals(l.second, r.second); }));
+}
+
+template <typename Rtree, typename Predicates>
+void test_query_batch_nearest(Rtree const& rt, std::vector<Predicates> const& predicates)
+{
+    typedef typename Rtree::value_type value_t;
+    typedef std::pair<std::size_t, value_t> result_t;
+
+    std::vector<result_t> expected;
+    for ( std::size_t i = 0 ; i < predicates.size() ; ++i )
+    {
+        std::vector<value_t> found;
+        rt.query(predicates[i], std::back_inserter(found));
+        for ( value_t const& v : found )
+            expected.push_back(result_t(i, v));
+    }
+
+    auto equal = [](result_t const& l, result_t const& r)
+    {
+        return l.first == r.first && bg::equals(l.second, r.second);
+    };
+
+    // the values are written query after query, the same as the ones returned by query(),
+    // the queries are written in the order of the range within the batches of 4096 queries
+    std::vector<result_t> result;
+    std::size_t n = rt.query_batch(predicates.begin(), predicates.end(), std::back_inserter(result));
+    BOOST_CHECK_EQUAL(n, result.size());
+
+    std::vector<result_t> result_par;
+    n = rt.query_batch(predicates.begin(), predicates.end(), std::back_inserter(result_par),
+                       bgi::execution::parallel_policy(3));
+    BOOST_CHECK_EQUAL(n, result_par.size());
+    BOOST_CHECK(std::equal(result.begin(), result.end(), result_par.begin(), result_par.end(), equal));
+
+    if ( predicates.size() <= 4096 )
+    {
+        BOOST_CHECK(std::equal(result.begin(), result.end(), expected.begin(), expected.end(), equal));
+    }
+
+    auto less_query = [](result_t const& l, result_t const& r) { return l.first < r.first; };
+    std::stable_sort(result.begin(), result.end(), less_query);
+    BOOST_CHECK(std::equal(result.begin(), result.end(), expected.begin(), expected.end(), equal));
+}
+
+template <typename Params>
+void test_rtree(std::size_t vcount)
+{
+    typedef bgi::rtree<box_t, Params> rtree_t;
+
+    std::vector<box_t> values;
+    for ( std::size_t i = 0 ; i < vcount ; ++i )
+    {
+        double x = double((i * 7919) % 1009), y = double((i * 104729) % 997);
+        values.push_back(box_t(point_t(x, y), point_t(x + 1, y + 1)));
+    }
+    rtree_t rt(values);
+
+    std::vector<box_t> boxes;
+    for ( std::size_t i = 0 ; i < 200 ; ++i )
+    {
+        double x = double((i * 31) % 1000), y = double((i * 17) % 1000);
+        boxes.push_back(box_t(point_t(x, y), point_t(x + 30, y + 20)));
+    }
+
+    typedef decltype(bgi::intersects(box_t())) intersects_t;
+    std::vector<intersects_t> intersects;
+    for ( box_t const& b : boxes )
+        intersects.push_back(bgi::intersects(b));
+    test_query_batch(rt, intersects);
+
+    typedef decltype(bgi::within(box_t()) && !bgi::covered_by(box_t()) && bgi::satisfies(is_even_x())) complex_t;
+    std::vector<complex_t> complex;
+    for ( std::size_t i = 0 ; i + 1 < boxes.size() ; ++i )
+        complex.push_back(bgi::within(boxes[i]) && !bgi::covered_by(boxes[i + 1]) && bgi::satisfies(is_even_x()));
+    test_query_batch(rt, complex);
+
+    typedef decltype(bgi::nearest(point_t(), 1)) nearest_t;
+    std::vector<nearest_t> nearest;
+    for ( std::size_t i = 0 ; i < 1000 ; ++i )
+        nearest.push_back(bgi::nearest(point_t(double((i * 211) % 1013), double((i * 97) % 1021)), 1 + i % 10));
+    nearest.push_back(bgi::nearest(point_t(0, 0), 0));
+    nearest.push_back(bgi::nearest(point_t(2000, 2000), vcount + 5));
+    test_query_batch_nearest(rt, nearest);
+
+    // many batches of queries
+    std::vector<nearest_t> many_nearest;
+    for ( std::size_t i = 0 ; i < 10000 ; ++i )
+        many_nearest.push_back(bgi::nearest(point_t(double((i * 211) % 1013), double((i * 97) % 1021)), 1 + i % 3));
+    test_query_batch_nearest(rt, many_nearest);
+
+    typedef decltype(bgi::nearest(box_t(), 1) && bgi::satisfies(is_even_x())) nearest_box_t;
+    std::vector<nearest_box_t> nearest_box;
+    for ( box_t const& b : boxes )
+        nearest_box.push_back(bgi::nearest(b, 5) && bgi::satisfies(is_even_x()));
+    test_query_batch_nearest(rt, nearest_box);
+
+    typedef decltype(bgi::within_distance(point_t(), 1.0) && bgi::satisfies(is_even_x())) within_distance_t;
+    std::vector<within_distance_t> within_distance;
+    for ( std::size_t i = 0 ; i < 100 ; ++i )
+        within_distance.push_back(bgi::within_distance(point_t(double((i * 211) % 1013), double((i * 97) % 1021)), 1.0 + i % 20)
+                               && bgi::satisfies(is_even_x()));
+    test_query_batch(rt, within_distance);
+
+    typedef decltype(bgi::nearest(point_t(), 1, 1.0)) bounded_nearest_t;
+    std::vector<bounded_nearest_t> bounded_nearest;
+    for ( std::size_t i = 0 ; i < 100 ; ++i )
+        bounded_nearest.push_back(bgi::nearest(point_t(double((i * 211) % 1013), double((i * 97) % 1021)), 1 + i % 10, 1.0 + i % 20));
+    test_query_batch_nearest(rt, bounded_nearest);
+
+    // no queries
+    std::vector<std::pair<std::size_t, box_t> > result;
+    BOOST_CHECK(rt.query_batch(intersects.begin(), intersects.begin(), std::back_inserter(result)) == 0);
+}
+
+int test_main(int, char* [])
+{
+    test_rtree<bgi::linear<4, 2> >(0);
+    test_rtree<bgi::linear<4, 2> >(3);
+    test_rtree<bgi::quadratic<8, 3> >(5000);
+    test_rtree<bgi::rstar<16, 4> >(20000);
+
+    return 0;
+}
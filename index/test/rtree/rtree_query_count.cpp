@@ -0,0 +1,131 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <iterator>
+#include <vector>
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_values_counts_ok.hpp>
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+typedef bg::model::polygon<point_t> polygon_t;
+
+struct is_even_x
+{
+    bool operator()(point_t const& p) const { return int(bg::get<0>(p)) % 2 == 0; }
+};
+
+template <typename Rtree, typename Predicates>
+void check_count(Rtree const& rt, Predicates const& pred)
+{
+    std::vector<typename Rtree::value_type> result;
+    rt.query(pred, std::back_inserter(result));
+    BOOST_CHECK_EQUAL(rt.query_count(pred), result.size());
+    BOOST_CHECK_EQUAL(bgi::query_count(rt, pred), result.size());
+}
+
+template <typename Rtree>
+void check_counts(Rtree const& rt)
+{
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_values_counts_ok(rt));
+
+    polygon_t poly;
+    bg::read_wkt("POLYGON((100 100,100 600,500 900,800 200,100 100))", poly);
+
+    for ( std::size_t i = 0 ; i < 50 ; ++i )
+    {
+        double x = double((i * 31) % 1000), y = double((i * 17) % 1000);
+        double w = double(1 + (i * 13) % 400), h = double(1 + (i * 7) % 300);
+        box_t b(point_t(x, y), point_t(x + w, y + h));
+
+        check_count(rt, bgi::intersects(b));
+        check_count(rt, bgi::covered_by(b));
+        check_count(rt, bgi::within(b));
+        check_count(rt, !bgi::intersects(b));
+        check_count(rt, bgi::intersects(b) && bgi::satisfies(is_even_x()));
+        check_count(rt, bgi::intersects(b) && bgi::covered_by(box_t(point_t(0, 0), point_t(500, 500))));
+    }
+
+    check_count(rt, bgi::intersects(box_t(point_t(-1, -1), point_t(2000, 2000))));
+    check_count(rt, bgi::intersects(poly));
+}
+
+template <typename Params>
+void test_rtree(Params const& params, std::size_t vcount)
+{
+    typedef bgi::rtree<point_t, Params> rtree_t;
+
+    std::vector<point_t> values;
+    for ( std::size_t i = 0 ; i < vcount ; ++i )
+    {
+        values.push_back(point_t(double((i * 7919) % 1009), double((i * 104729) % 997)));
+    }
+
+    // insert
+    rtree_t rt(params);
+    rt.insert(values.begin(), values.end());
+    check_counts(rt);
+
+    // remove
+    for ( std::size_t i = 0 ; i < values.size() ; i += 3 )
+    {
+        rt.remove(values[i]);
+    }
+    check_counts(rt);
+
+    // copy
+    rtree_t rt_copy(rt);
+    check_counts(rt_copy);
+
+    // pack
+    rtree_t rt_pack(values, params);
+    check_counts(rt_pack);
+
+    rtree_t rt_par(values, bgi::execution::parallel_policy(3), params);
+    check_counts(rt_par);
+
+    rtree_t rt_hilbert(values, bgi::hilbert_packing(), params);
+    check_counts(rt_hilbert);
+
+    // remove all
+    for ( point_t const& v : values )
+    {
+        rt_pack.remove(v);
+    }
+    BOOST_CHECK(rt_pack.empty());
+    check_counts(rt_pack);
+}
+
+int test_main(int, char* [])
+{
+    test_rtree(bgi::linear<4, 2>(), 0);
+    test_rtree(bgi::linear<4, 2>(), 3);
+    test_rtree(bgi::linear<4, 2>(), 2000);
+    test_rtree(bgi::quadratic<8, 3>(), 5000);
+    test_rtree(bgi::rstar<16, 4>(), 5000);
+    test_rtree(bgi::kmeans<8, 3>(), 5000);
+    test_rtree(bgi::dynamic_rstar(8, 3), 5000);
+
+    // the counts stored in the internal nodes
+    test_rtree(bgi::counted<bgi::linear<4, 2> >(), 0);
+    test_rtree(bgi::counted<bgi::linear<4, 2> >(), 3);
+    test_rtree(bgi::counted<bgi::linear<4, 2> >(), 2000);
+    test_rtree(bgi::counted<bgi::quadratic<8, 3> >(), 5000);
+    test_rtree(bgi::counted<bgi::rstar<16, 4> >(), 5000);
+    test_rtree(bgi::counted<bgi::rstar<4, 1> >(), 2000);
+    test_rtree(bgi::counted<bgi::kmeans<8, 3> >(), 5000);
+    test_rtree(bgi::counted<bgi::dynamic_rstar>(bgi::dynamic_rstar(8, 3)), 5000);
+
+    typedef bg::strategies::index::cartesian<> strategy_t;
+    test_rtree(bgi::counted<bgi::parameters<bgi::rstar<8, 3>, strategy_t> >(), 3000);
+    test_rtree(bgi::parameters<bgi::counted<bgi::quadratic<8, 3> >, strategy_t>(), 3000);
+
+    return 0;
+}
@@ -0,0 +1,205 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/index/node_pool_allocator.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+// counts the allocations made by the rtree, including the allocations
+// of the type-erased query iterators, the wrapped iterators allocate
+// their stacks with the default allocator
+struct allocations_counter
+{
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+};
+
+template <typename T>
+class counting_allocator
+{
+    template <typename U> friend class counting_allocator;
+
+public:
+    typedef T value_type;
+
+    explicit counting_allocator(allocations_counter & counter)
+        : m_counter(&counter)
+    {}
+
+    template <typename U>
+    counting_allocator(counting_allocator<U> const& other)
+        : m_counter(other.m_counter)
+    {}
+
+    T * allocate(std::size_t n)
+    {
+        ++m_counter->allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T * p, std::size_t n)
+    {
+        ++m_counter->deallocations;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(counting_allocator<U> const& other) const { return m_counter == other.m_counter; }
+    template <typename U>
+    bool operator!=(counting_allocator<U> const& other) const { return m_counter != other.m_counter; }
+
+private:
+    allocations_counter * m_counter;
+};
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+
+struct is_even_x
+{
+    bool operator()(point_t const& p) const { return int(bg::get<0>(p)) % 2 == 0; }
+};
+
+// the predicate too big to be stored in the buffer of the type-erased iterator
+struct is_even_x_big
+{
+    is_even_x_big() : data() {}
+    bool operator()(point_t const& p) const { return int(bg::get<0>(p)) % 2 == int(data[0]); }
+    double data[64];
+};
+
+template <typename Rtree, typename Predicates>
+void test_iterator(Rtree const& rt, allocations_counter const& counter,
+                   Predicates const& pred, bool is_buffered = true)
+{
+    typedef typename Rtree::value_type value_t;
+    typedef typename Rtree::const_query_iterator iterator_t;
+
+    std::vector<value_t> expected, result;
+    rt.query(pred, std::back_inserter(expected));
+    result.reserve(expected.size());
+
+    // the type-erased iterators storing the wrapped iterators in the buffer
+    // are created, copied, moved and assigned without allocation
+    std::size_t const allocations_before = counter.allocations;
+    std::size_t const deallocations_before = counter.deallocations;
+    {
+        iterator_t first = rt.qbegin(pred);
+        iterator_t copy = first;
+        iterator_t moved = std::move(copy);
+        BOOST_CHECK(moved == first);
+
+        iterator_t assigned;
+        assigned = first;
+        BOOST_CHECK(assigned == first);
+        assigned = std::move(moved);
+        BOOST_CHECK(assigned == first);
+
+        if ( is_buffered )
+            BOOST_CHECK_EQUAL(counter.allocations, allocations_before);
+        else
+            BOOST_CHECK(counter.allocations > allocations_before);
+
+        for ( ; first != rt.qend() ; ++first )
+            result.push_back(*first);
+    }
+    BOOST_CHECK_EQUAL(result.size(), expected.size());
+    BOOST_CHECK_EQUAL(counter.allocations - allocations_before,
+                      counter.deallocations - deallocations_before);
+
+    // iterators are copied and moved in the middle of the traversal
+    if ( expected.size() > 2 )
+    {
+        iterator_t it = rt.qbegin(pred);
+        ++it;
+        iterator_t copy = it;
+        iterator_t moved = std::move(it);
+        ++copy;
+        ++moved;
+        BOOST_CHECK(copy == moved);
+        BOOST_CHECK(bg::equals(*copy, *moved));
+        it = copy;
+        BOOST_CHECK(it == moved);
+        BOOST_CHECK_EQUAL(std::distance(it, rt.qend()), std::ptrdiff_t(expected.size() - 2));
+    }
+}
+
+template <typename Rtree>
+void test_iterators(Rtree const& rt, allocations_counter const& counter)
+{
+    box_t const b(point_t(100, 100), point_t(500, 400));
+
+    test_iterator(rt, counter, bgi::intersects(b));
+    test_iterator(rt, counter, bgi::intersects(b) && bgi::satisfies(is_even_x()));
+    test_iterator(rt, counter, bgi::nearest(point_t(250, 250), 20));
+    test_iterator(rt, counter, bgi::nearest(b, 20) && bgi::satisfies(is_even_x()));
+
+    // the wrapped iterator is allocated with the allocator of the rtree
+    test_iterator(rt, counter, bgi::intersects(b) && bgi::satisfies(is_even_x_big()), false);
+}
+
+// the allocated wrapped iterator may be destroyed after the rtree
+void test_iterator_outliving_rtree()
+{
+    typedef bgi::node_pool_allocator<point_t> allocator_t;
+    typedef bgi::rtree<point_t, bgi::rstar<16, 4>, bgi::indexable<point_t>, bgi::equal_to<point_t>, allocator_t> rtree_t;
+    typedef rtree_t::const_query_iterator iterator_t;
+
+    box_t const b(point_t(100, 100), point_t(500, 400));
+
+    bgi::rstar<16, 4> const params;
+
+    iterator_t it, copy;
+    {
+        allocator_t const allocator;
+        rtree_t rt(params, bgi::indexable<point_t>(), bgi::equal_to<point_t>(), allocator);
+        for ( std::size_t i = 0 ; i < 2000 ; ++i )
+        {
+            rt.insert(point_t(double((i * 7919) % 1009), double((i * 104729) % 997)));
+        }
+
+        it = rt.qbegin(bgi::intersects(b) && bgi::satisfies(is_even_x_big()));
+        BOOST_CHECK(it != rt.qend());
+        copy = it;
+
+        rtree_t moved(std::move(rt));
+    }
+    iterator_t copy2 = copy;
+}
+
+int test_main(int, char* [])
+{
+    typedef counting_allocator<point_t> allocator_t;
+    typedef bgi::rtree<point_t, bgi::rstar<16, 4>, bgi::indexable<point_t>, bgi::equal_to<point_t>, allocator_t> rtree_t;
+
+    allocations_counter counter;
+    allocator_t const allocator(counter);
+    bgi::rstar<16, 4> const params;
+
+    rtree_t rt(params, bgi::indexable<point_t>(), bgi::equal_to<point_t>(), allocator);
+    test_iterators(rt, counter);
+
+    for ( std::size_t i = 0 ; i < 2000 ; ++i )
+    {
+        rt.insert(point_t(double((i * 7919) % 1009), double((i * 104729) % 997)));
+    }
+    test_iterators(rt, counter);
+
+    rtree_t rt_small(params, bgi::indexable<point_t>(), bgi::equal_to<point_t>(), allocator);
+    rt_small.insert(point_t(150, 150));
+    test_iterators(rt_small, counter);
+
+    test_iterator_outliving_rtree();
+
+    return 0;
+}
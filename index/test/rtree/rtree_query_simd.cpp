@@ -0,0 +1,174 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <geometry_index_test_common.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <boost/geometry/index/rtree.hpp>
+
+namespace bgid = bgi::detail;
+
+template <typename Box, typename Rtree>
+struct is_simd
+    : bgid::rtree::visitors::spatial_query_detail::is_simd
+        <
+            Box, typename bgid::rtree::utilities::view<Rtree>::box_type,
+            typename bgid::strategy_type<typename Rtree::parameters_type>::type
+        >
+{};
+
+template <typename Box, std::size_t I = 0, std::size_t D = bg::dimension<Box>::value>
+struct make_box
+{
+    template <typename T>
+    static void apply(Box & b, std::size_t i, T size)
+    {
+        T const c = T((i * (7919 + I * 104729)) % 1009);
+        bg::set<bg::min_corner, I>(b, c);
+        bg::set<bg::max_corner, I>(b, c + size);
+        make_box<Box, I + 1, D>::apply(b, i, size);
+    }
+};
+
+template <typename Box, std::size_t D>
+struct make_box<Box, D, D>
+{
+    template <typename T>
+    static void apply(Box &, std::size_t, T) {}
+};
+
+template <typename Box>
+inline Box box(std::size_t i, typename bg::coordinate_type<Box>::type size)
+{
+    Box b;
+    make_box<Box>::apply(b, i, size);
+    return b;
+}
+
+template <typename Rtree, typename Predicates>
+inline void check_query(Rtree const& rt, std::vector<typename Rtree::value_type> const& values,
+                        Predicates const& pred)
+{
+    typedef typename Rtree::value_type value_t;
+
+    std::vector<value_t> expected;
+    std::copy_if(values.begin(), values.end(), std::back_inserter(expected), [&](value_t const& v)
+    {
+        return bgid::predicates_check<bgid::value_tag>(pred, v, v.first,
+                                                       bgid::get_strategy(rt.parameters()));
+    });
+
+    std::vector<value_t> result;
+    BOOST_CHECK_EQUAL(rt.query(pred, std::back_inserter(result)), expected.size());
+
+    auto const less = [](value_t const& l, value_t const& r) { return l.second < r.second; };
+    std::sort(result.begin(), result.end(), less);
+    std::sort(expected.begin(), expected.end(), less);
+    BOOST_CHECK(std::equal(result.begin(), result.end(), expected.begin(), expected.end(),
+                           [](value_t const& l, value_t const& r) { return l.second == r.second; }));
+}
+
+template <typename Box, typename Params>
+void test_query(std::size_t count, Params const& params = Params())
+{
+    typedef std::pair<Box, int> value_t;
+    typedef bgi::rtree<value_t, Params> rtree_t;
+
+    typedef typename bg::coordinate_type<Box>::type coordinate_t;
+    BOOST_CHECK((is_simd<bgid::predicates::spatial_predicate<Box, bgid::predicates::intersects_tag, false>, rtree_t>::value
+              == bgid::simd::is_simd_coordinate<coordinate_t>::value));
+
+    std::vector<value_t> values;
+    for ( std::size_t i = 0 ; i < count ; ++i )
+        values.push_back(std::make_pair(box<Box>(i, 5), int(i)));
+
+    rtree_t rt(values, params);
+    rtree_t rt_inserted(params);
+    for ( value_t const& v : values )
+        rt_inserted.insert(v);
+
+    for ( std::size_t i = 0 ; i < 20 ; ++i )
+    {
+        Box const q = box<Box>(i * 13, 50);
+        check_query(rt, values, bgi::intersects(q));
+        check_query(rt, values, bgi::within(q));
+        check_query(rt, values, bgi::covered_by(q));
+        check_query(rt, values, bgi::overlaps(q));
+        check_query(rt_inserted, values, bgi::intersects(q));
+        check_query(rt_inserted, values, bgi::covered_by(q));
+    }
+
+    // touching boxes
+    check_query(rt, values, bgi::intersects(box<Box>(0, 0)));
+    check_query(rt, values, bgi::intersects(box<Box>(1, 0)));
+    // the whole tree and no values
+    Box all = box<Box>(0, 2000);
+    bg::set<bg::min_corner, 0>(all, -10);
+    check_query(rt, values, bgi::intersects(all));
+    bg::assign_inverse(all);
+    check_query(rt, values, bgi::intersects(all));
+}
+
+void test_nan()
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+    typedef bg::model::box<point_t> box_t;
+    typedef std::pair<box_t, int> value_t;
+    typedef bgi::rtree<value_t, bgi::quadratic<16> > rtree_t;
+
+    double const nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<value_t> values;
+    for ( std::size_t i = 0 ; i < 100 ; ++i )
+        values.push_back(std::make_pair(box<box_t>(i, 5), int(i)));
+    rtree_t rt(values);
+
+    // the same as the generic intersects(box, box)
+    check_query(rt, values, bgi::intersects(box_t(point_t(nan, 0), point_t(nan, 10))));
+    check_query(rt, values, bgi::intersects(box_t(point_t(0, nan), point_t(1000, 10))));
+}
+
+int test_main(int, char* [])
+{
+    typedef bg::model::point<double, 2, bg::cs::cartesian> point2d_t;
+    typedef bg::model::point<float, 2, bg::cs::cartesian> point2f_t;
+    typedef bg::model::point<double, 3, bg::cs::cartesian> point3d_t;
+    typedef bg::model::point<float, 3, bg::cs::cartesian> point3f_t;
+    typedef bg::model::box<point2d_t> box2d_t;
+    typedef bg::model::box<point2f_t> box2f_t;
+    typedef bg::model::box<point3d_t> box3d_t;
+    typedef bg::model::box<point3f_t> box3f_t;
+
+    // not vectorized
+    typedef bg::model::point<int, 2, bg::cs::cartesian> point2i_t;
+    typedef bg::model::point<double, 2, bg::cs::spherical_equatorial<bg::degree> > point2s_t;
+    typedef bgi::rtree<std::pair<box2d_t, int>, bgi::linear<8> > rtree2d_t;
+    BOOST_CHECK((! is_simd<bgid::predicates::spatial_predicate<box2d_t, bgid::predicates::covers_tag, false>, rtree2d_t>::value));
+    BOOST_CHECK((! is_simd<bgid::predicates::spatial_predicate<box2d_t, bgid::predicates::intersects_tag, true>, rtree2d_t>::value));
+    BOOST_CHECK((! is_simd<bgid::predicates::spatial_predicate<point2d_t, bgid::predicates::intersects_tag, false>, rtree2d_t>::value));
+    BOOST_CHECK((! is_simd<bgid::predicates::spatial_predicate<box2f_t, bgid::predicates::intersects_tag, false>, rtree2d_t>::value));
+    BOOST_CHECK((! is_simd<bgid::predicates::spatial_predicate<bg::model::box<point2i_t>, bgid::predicates::intersects_tag, false>,
+                           bgi::rtree<std::pair<bg::model::box<point2i_t>, int>, bgi::linear<8> > >::value));
+    BOOST_CHECK((! is_simd<bgid::predicates::spatial_predicate<bg::model::box<point2s_t>, bgid::predicates::intersects_tag, false>,
+                           bgi::rtree<std::pair<bg::model::box<point2s_t>, int>, bgi::linear<8> > >::value));
+
+    // nodes smaller and bigger than a block, not a multiple of the block size
+    test_query<box2d_t, bgi::linear<4, 2> >(1000);
+    test_query<box2d_t, bgi::quadratic<13, 4> >(3000);
+    test_query<box2f_t, bgi::rstar<16, 4> >(3000);
+    test_query<box3d_t, bgi::quadratic<8, 3> >(3000);
+    test_query<box3f_t, bgi::linear<33, 10> >(5000);
+    test_query<box2d_t, bgi::dynamic_rstar>(3000, bgi::dynamic_rstar(21, 7));
+    test_query<box2d_t, bgi::linear<8> >(0);
+
+    test_nan();
+
+    return 0;
+}
@@ -0,0 +1,184 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_GEOMETRY_INDEX_ENABLE_QUERY_STATISTICS
+
+#include <geometry_index_test_common.hpp>
+
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/query_statistics.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/statistics.hpp>
+
+namespace bgiu = bgi::detail::rtree::utilities;
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+
+template <typename Params>
+void test_rtree(Params const& params, std::size_t vcount)
+{
+    typedef bgi::rtree<point_t, Params> rtree_t;
+
+    std::vector<point_t> values;
+    for ( std::size_t i = 0 ; i < vcount ; ++i )
+    {
+        values.push_back(point_t(double((i * 7919) % 1009), double((i * 104729) % 997)));
+    }
+    rtree_t rt(values, params);
+
+    std::size_t const internal_nodes = std::get<1>(bgiu::statistics(rt));
+    std::size_t const leafs = std::get<2>(bgiu::statistics(rt));
+
+    std::vector<point_t> result;
+
+    // nothing is gathered without the guard
+    {
+        bgiu::query_statistics stats;
+        rt.query(bgi::intersects(rt.bounds()), std::back_inserter(result));
+        BOOST_CHECK_EQUAL(stats.internal_nodes, 0u);
+        BOOST_CHECK_EQUAL(stats.values, 0u);
+    }
+
+    // all nodes are visited
+    {
+        bgiu::query_statistics stats;
+        {
+            bgiu::scoped_query_statistics guard(stats);
+            result.clear();
+            rt.query(bgi::intersects(rt.bounds()), std::back_inserter(result));
+        }
+        BOOST_CHECK_EQUAL(stats.internal_nodes, internal_nodes);
+        BOOST_CHECK_EQUAL(stats.leafs, leafs);
+        BOOST_CHECK_EQUAL(stats.values, vcount);
+        BOOST_CHECK_EQUAL(stats.predicates_checks, internal_nodes + leafs - 1 + vcount);
+        BOOST_CHECK_EQUAL(stats.branches_pushed, 0u);
+
+        // the same numbers for the query iterators
+        bgiu::query_statistics it_stats;
+        {
+            bgiu::scoped_query_statistics guard(it_stats);
+            BOOST_CHECK_EQUAL(std::size_t(std::distance(rt.qbegin(bgi::intersects(rt.bounds())), rt.qend())),
+                              vcount);
+        }
+        BOOST_CHECK_EQUAL(it_stats.internal_nodes, internal_nodes);
+        BOOST_CHECK_EQUAL(it_stats.leafs, leafs);
+        BOOST_CHECK_EQUAL(it_stats.values, vcount);
+        BOOST_CHECK_EQUAL(it_stats.predicates_checks, stats.predicates_checks);
+        // the iterators don't test the boxes in blocks
+        BOOST_CHECK_EQUAL(it_stats.simd_blocks, 0u);
+
+        typedef bgi::detail::rtree::visitors::spatial_query_detail::is_simd
+            <
+                decltype(bgi::intersects(box_t())), box_t, bg::default_strategy
+            > is_simd;
+        BOOST_CHECK_EQUAL(stats.simd_blocks > 0, bool(is_simd::value));
+    }
+
+    // the checks are counted where they are made, also for the predicates
+    // not tested in blocks and combined with other predicates
+    {
+        bgiu::query_statistics stats;
+        {
+            bgiu::scoped_query_statistics guard(stats);
+            result.clear();
+            rt.query(bgi::intersects(rt.bounds()) && bgi::satisfies([](point_t const&) { return true; }),
+                     std::back_inserter(result));
+        }
+        BOOST_CHECK_EQUAL(result.size(), vcount);
+        BOOST_CHECK_EQUAL(stats.predicates_checks, internal_nodes + leafs - 1 + vcount);
+        BOOST_CHECK_EQUAL(stats.simd_blocks, 0u);
+
+        // a child is checked once even if the first predicate is not met
+        box_t const outside(point_t(2000, 2000), point_t(3000, 3000));
+        stats.reset();
+        {
+            bgiu::scoped_query_statistics guard(stats);
+            result.clear();
+            rt.query(bgi::intersects(outside) && bgi::satisfies([](point_t const&) { return true; }),
+                     std::back_inserter(result));
+        }
+        BOOST_CHECK(result.empty());
+        BOOST_CHECK_EQUAL(stats.internal_nodes, 1u);
+        BOOST_CHECK_EQUAL(stats.leafs, 0u);
+        BOOST_CHECK(0 < stats.predicates_checks && stats.predicates_checks <= rt.parameters().get_max_elements());
+    }
+
+    // a small query visits fewer nodes, the statistics are aggregated
+    {
+        box_t const b(point_t(100, 100), point_t(150, 130));
+        bgiu::query_statistics stats, total;
+        {
+            bgiu::scoped_query_statistics guard(stats);
+            result.clear();
+            rt.query(bgi::intersects(b), std::back_inserter(result));
+            {
+                // nested guard
+                bgiu::scoped_query_statistics nested_guard(total);
+                rt.query(bgi::intersects(b), std::back_inserter(result));
+            }
+            total += stats;
+            rt.query(bgi::intersects(b), std::back_inserter(result));
+        }
+        BOOST_CHECK(stats.values < vcount);
+        BOOST_CHECK(stats.leafs < leafs);
+        BOOST_CHECK(stats.values >= 2 * (result.size() / 3));
+        // the first and the third query are gathered in stats, the first and the second in total
+        BOOST_CHECK_EQUAL(total.values, stats.values);
+        BOOST_CHECK_EQUAL(total.internal_nodes, stats.internal_nodes);
+
+        stats.reset();
+        BOOST_CHECK_EQUAL(stats.values, 0u);
+    }
+
+    // distance query
+    {
+        bgiu::query_statistics stats;
+        {
+            bgiu::scoped_query_statistics guard(stats);
+            result.clear();
+            rt.query(bgi::nearest(point_t(500, 500), 10), std::back_inserter(result));
+        }
+        BOOST_CHECK_EQUAL(result.size(), 10u);
+        BOOST_CHECK(0 < stats.leafs && stats.leafs < leafs);
+        BOOST_CHECK(stats.values >= 10u);
+        BOOST_CHECK(stats.branches_pushed >= stats.branches_popped);
+        BOOST_CHECK_EQUAL(stats.internal_nodes + stats.leafs, stats.branches_popped + 1);
+
+        bgiu::query_statistics it_stats;
+        {
+            bgiu::scoped_query_statistics guard(it_stats);
+            BOOST_CHECK_EQUAL(std::distance(rt.qbegin(bgi::nearest(point_t(500, 500), 10)), rt.qend()), 10);
+        }
+        BOOST_CHECK(it_stats.branches_pushed >= it_stats.branches_popped);
+        BOOST_CHECK_EQUAL(it_stats.internal_nodes + it_stats.leafs, it_stats.branches_popped + 1);
+    }
+
+    // count query
+    {
+        bgiu::query_statistics stats;
+        {
+            bgiu::scoped_query_statistics guard(stats);
+            BOOST_CHECK_EQUAL(rt.query_count(bgi::intersects(rt.bounds())), vcount);
+        }
+        // all values are counted at the root
+        BOOST_CHECK_EQUAL(stats.internal_nodes, 1u);
+        BOOST_CHECK_EQUAL(stats.leafs, 0u);
+    }
+}
+
+int test_main(int, char* [])
+{
+    test_rtree(bgi::linear<4, 2>(), 1000);
+    test_rtree(bgi::rstar<16, 4>(), 10000);
+    test_rtree(bgi::dynamic_quadratic(8, 3), 5000);
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+// Boost.Geometry Index
+// Unit Test
+
+// Use, modification and distribution is subject to the Boost Software License,
+// Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+
+#include <rtree/test_rtree.hpp>
+
+#include <algorithm>
+#include <vector>
+
+
+typedef bg::model::point<double, 2, bg::cs::cartesian> point_t;
+typedef bg::model::box<point_t> box_t;
+
+struct is_even_x
+{
+    bool operator()(point_t const& p) const { return int(bg::get<0>(p)) % 2 == 0; }
+};
+
+struct is_any
+{
+    bool operator()(point_t const&) const { return true; }
+};
+
+struct point_less
+{
+    bool operator()(point_t const& l, point_t const& r) const
+    {
+        return bg::get<0>(l) < bg::get<0>(r)
+            || (bg::get<0>(l) == bg::get<0>(r) && bg::get<1>(l) < bg::get<1>(r));
+    }
+};
+
+template <typename Rtree, typename Predicates>
+void test_remove_if(Rtree & rt, Predicates const& pred)
+{
+    typedef typename Rtree::value_type value_t;
+
+    std::vector<value_t> all, removed;
+    rt.query(bgi::satisfies(is_any()), std::back_inserter(all));
+    rt.query(pred, std::back_inserter(removed));
+
+    std::vector<value_t> remaining;
+    std::sort(all.begin(), all.end(), point_less());
+    std::sort(removed.begin(), removed.end(), point_less());
+    std::set_difference(all.begin(), all.end(), removed.begin(), removed.end(),
+                        std::back_inserter(remaining), point_less());
+
+    BOOST_CHECK_EQUAL(bgi::remove_if(rt, pred), removed.size());
+    basictest::check_rtree(rt, remaining);
+
+    // removed values are not in the tree, the other ones are
+    for ( value_t const& v : removed )
+    {
+        BOOST_CHECK_EQUAL(rt.count(v), 0u);
+    }
+    BOOST_CHECK_EQUAL(rt.query_count(pred), 0u);
+    BOOST_CHECK_EQUAL(rt.query_count(bgi::satisfies(is_any())), all.size() - removed.size());
+
+    // nothing to remove
+    BOOST_CHECK_EQUAL(rt.remove_if(pred), 0u);
+    basictest::check_rtree(rt, remaining);
+
+    // the tree can be modified afterwards
+    rt.insert(removed.begin(), removed.end());
+    basictest::check_rtree(rt, all);
+}
+
+template <typename Params>
+void test_rtree(Params const& params, std::size_t vcount)
+{
+    typedef bgi::rtree<point_t, Params> rtree_t;
+
+    std::vector<point_t> values;
+    for ( std::size_t i = 0 ; i < vcount ; ++i )
+    {
+        values.push_back(point_t(double((i * 7919) % 1009), double((i * 104729) % 997)));
+    }
+
+    rtree_t rt(params);
+    rt.insert(values.begin(), values.end());
+
+    rtree_t rt_pack(values, params);
+
+    for ( std::size_t i = 0 ; i < 10 ; ++i )
+    {
+        double x = double((i * 131) % 800), y = double((i * 71) % 800);
+        double w = double(10 + (i * 53) % 400), h = double(10 + (i * 37) % 300);
+        box_t b(point_t(x, y), point_t(x + w, y + h));
+
+        test_remove_if(rt, bgi::intersects(b));
+        test_remove_if(rt_pack, bgi::within(b));
+        test_remove_if(rt, bgi::intersects(b) && bgi::satisfies(is_even_x()));
+        test_remove_if(rt_pack, !bgi::intersects(b));
+    }
+
+    test_remove_if(rt, bgi::satisfies(is_even_x()));
+
+    // remove all
+    BOOST_CHECK_EQUAL(rt.remove_if(bgi::satisfies(is_any())), values.size());
+    basictest::check_rtree(rt, std::vector<point_t>());
+    BOOST_CHECK(rt.empty());
+
+    rt.insert(values.begin(), values.end());
+    basictest::check_rtree(rt, values);
+
+    // remove all but a few values
+    rt_pack.remove_if(bgi::intersects(box_t(point_t(0, 0), point_t(2000, 2000)))
+                      && ! bgi::intersects(box_t(point_t(0, 0), point_t(100, 100))));
+    std::vector<point_t> remaining;
+    for ( point_t const& v : values )
+    {
+        if ( bg::covered_by(v, box_t(point_t(0, 0), point_t(100, 100))) )
+            remaining.push_back(v);
+    }
+    basictest::check_rtree(rt_pack, remaining);
+
+    // empty tree
+    rtree_t rt_empty(params);
+    BOOST_CHECK_EQUAL(rt_empty.remove_if(bgi::satisfies(is_any())), 0u);
+}
+
+int test_main(int, char* [])
+{
+    test_rtree(bgi::linear<4, 2>(), 0);
+    test_rtree(bgi::linear<4, 2>(), 3);
+    test_rtree(bgi::linear<4, 2>(), 2000);
+    test_rtree(bgi::quadratic<8, 3>(), 3000);
+    test_rtree(bgi::rstar<16, 4>(), 3000);
+    test_rtree(bgi::rstar<4, 1>(), 1000);
+    test_rtree(bgi::dynamic_rstar(8, 3), 3000);
+    test_rtree(bgi::counted<bgi::quadratic<8, 3> >(), 3000);
+    test_rtree(bgi::counted<bgi::rstar<4, 1> >(), 1000);
+
+    return 0;
+}
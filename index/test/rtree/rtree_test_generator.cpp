@@ -37,6 +37,8 @@ int main()
     parameters.push_back(boost::make_tuple("bgi::dynamic_quadratic(5, 2)", "dqua"));
     parameters.push_back(boost::make_tuple("bgi::rstar<5, 2>()", "rst"));
     parameters.push_back(boost::make_tuple("bgi::dynamic_rstar(5, 2)","drst"));
+    parameters.push_back(boost::make_tuple("bgi::kmeans<5, 2>()", "kme"));
+    parameters.push_back(boost::make_tuple("bgi::dynamic_kmeans(5, 2)", "dkme"));
     
     std::vector<std::string> indexables;
     indexables.push_back("p");
@@ -28,6 +28,7 @@
 #include <boost/geometry/index/detail/rtree/utilities/are_boxes_ok.hpp>
 #include <boost/geometry/index/detail/rtree/utilities/are_counts_ok.hpp>
 #include <boost/geometry/index/detail/rtree/utilities/are_levels_ok.hpp>
+#include <boost/geometry/index/detail/rtree/utilities/are_values_counts_ok.hpp>
 
 //#include <boost/geometry/geometries/ring.hpp>
 //#include <boost/geometry/geometries/polygon.hpp>
@@ -732,6 +733,49 @@ void exactly_the_same_outputs(Rtree const& rtree, Range1 const& output, Range2 c
     }
 }
 
+// checks the structure of the tree and compares the results of spatial queries
+// with the values tested one by one
+template <typename Rtree, typename Value>
+void check_rtree(Rtree const& rtree, std::vector<Value> const& values)
+{
+    typedef typename Rtree::bounds_type B;
+    typedef typename bg::coordinate_type<B>::type coord_t;
+
+    BOOST_CHECK_EQUAL(rtree.size(), values.size());
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_levels_ok(rtree));
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_counts_ok(rtree));
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_values_counts_ok(rtree));
+    if ( rtree.empty() )
+        return;
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rtree));
+
+    // the boxes along the diagonal of the bounds of the tree and the bounds
+    B const bounds = rtree.bounds();
+    for ( int i = 0 ; i <= 10 ; ++i )
+    {
+        B qbox = bounds;
+        if ( i < 10 )
+        {
+            bg::detail::for_each_dimension<B>([&](auto index)
+            {
+                double const min = double(bg::get<0, index>(bounds));
+                double const width = double(bg::get<1, index>(bounds)) - min;
+                bg::set<0, index>(qbox, coord_t(min + width * i / 10));
+                bg::set<1, index>(qbox, coord_t(min + width * (i + 2) / 10));
+            });
+        }
+
+        std::vector<Value> output, expected_output;
+        rtree.query(bgi::intersects(qbox), std::back_inserter(output));
+        for ( Value const& v : values )
+        {
+            if ( bg::intersects(rtree.indexable_get()(v), qbox) )
+                expected_output.push_back(v);
+        }
+        compare_outputs(rtree, output, expected_output);
+    }
+}
+
 // alternative version of std::copy taking iterators of differnet types
 template <typename First, typename Last, typename Out>
 void copy_alt(First first, Last last, Out out)
@@ -780,11 +824,14 @@ void spatial_query(Rtree & rtree, Predicates const& pred, std::vector<Value> con
     BOOST_CHECK(bgi::detail::rtree::utilities::are_levels_ok(rtree));
     if (!rtree.empty())
         BOOST_CHECK(bgi::detail::rtree::utilities::are_boxes_ok(rtree));
+    BOOST_CHECK(bgi::detail::rtree::utilities::are_values_counts_ok(rtree));
 
     std::vector<Value> output;
     size_t n = rtree.query(pred, std::back_inserter(output));
 
     BOOST_CHECK(expected_output.size() == n);
+    BOOST_CHECK(expected_output.size() == rtree.query_count(pred));
+    BOOST_CHECK(expected_output.size() == bgi::query_count(rtree, pred));
     compare_outputs(rtree, output, expected_output);
 
     std::vector<Value> output2;